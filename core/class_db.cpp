@@ -1155,6 +1155,49 @@ StringName ClassDB::get_property_getter(StringName p_class, const StringName p_p
 	return StringName();
 }
 
+MethodBind *ClassDB::get_property_setter_method(const StringName &p_class, const StringName &p_property) {
+
+	OBJTYPE_RLOCK;
+
+	// only returns the bind when set_property() would call it directly with just the value
+	ClassInfo *type = classes.getptr(p_class);
+	ClassInfo *check = type;
+	while (check) {
+		const PropertySetGet *psg = check->property_setget.getptr(p_property);
+		if (psg) {
+
+			return psg->index < 0 ? psg->_setptr : NULL;
+		}
+
+		check = check->inherits_ptr;
+	}
+
+	return NULL;
+}
+
+MethodBind *ClassDB::get_property_getter_method(const StringName &p_class, const StringName &p_property) {
+
+	OBJTYPE_RLOCK;
+
+	// same as above for get_property(), which also looks for constants on each level
+	ClassInfo *type = classes.getptr(p_class);
+	ClassInfo *check = type;
+	while (check) {
+		const PropertySetGet *psg = check->property_setget.getptr(p_property);
+		if (psg) {
+
+			return psg->index < 0 ? psg->_getptr : NULL;
+		}
+
+		if (check->constant_map.has(p_property))
+			return NULL;
+
+		check = check->inherits_ptr;
+	}
+
+	return NULL;
+}
+
 bool ClassDB::has_property(const StringName &p_class, const StringName &p_property, bool p_no_inheritance) {
 
 	ClassInfo *type = classes.getptr(p_class);
@@ -34,84 +34,144 @@
 
 void CommandQueueMT::lock() {
 
-	if (mutex)
-		mutex->lock();
+	// Only producers take it, and only briefly, so spin rather than sleep.
+	int spins = 0;
+	while (atomic_increment(&producer_lock) != 1) {
+
+		atomic_decrement(&producer_lock);
+		if (++spins > 1000) {
+			OS::get_singleton()->delay_usec(1);
+			spins = 0;
+		}
+	}
 }
 
 void CommandQueueMT::unlock() {
 
-	if (mutex)
-		mutex->unlock();
+	if (write_pos != write_published) {
+
+		// publish, this is also a full barrier
+		atomic_add(&write_total, write_pos - write_published);
+		write_published = write_pos;
+
+		// wake the consumer up only if it went to sleep since the last time
+		uint32_t sleeping = atomic_add(&sleep_count, 0);
+		if (sync && sleeping != wake_count) {
+			wake_count = sleeping;
+			sync->post();
+		}
+	}
+
+	atomic_decrement(&producer_lock);
 }
 
 void CommandQueueMT::wait_for_flush() {
 
+	uint64_t from = OS::get_singleton()->get_ticks_usec();
+
 	// wait one millisecond for a flush to happen
 	OS::get_singleton()->delay_usec(1000);
+
+	atomic_add(&stall_usec, (uint32_t)(OS::get_singleton()->get_ticks_usec() - from));
 }
 
 CommandQueueMT::SyncSemaphore *CommandQueueMT::_alloc_sync_sem() {
 
-	int idx = -1;
-
 	while (true) {
 
-		lock();
 		for (int i = 0; i < SYNC_SEMAPHORES; i++) {
 
-			if (!sync_sems[i].in_use) {
-				sync_sems[i].in_use = true;
-				idx = i;
-				break;
+			if (atomic_increment(&sync_sems[i].in_use) == 1) {
+				return &sync_sems[i];
 			}
+			atomic_decrement(&sync_sems[i].in_use);
 		}
-		unlock();
 
-		if (idx == -1) {
-			wait_for_flush();
-		} else {
-			break;
-		}
+		wait_for_flush();
 	}
+}
+
+void CommandQueueMT::_wait_sync_sem(SyncSemaphore *p_sync_sem) {
+
+	uint64_t from = OS::get_singleton()->get_ticks_usec();
+
+	p_sync_sem->sem->wait();
 
-	return &sync_sems[idx];
+	atomic_add(&stall_usec, (uint32_t)(OS::get_singleton()->get_ticks_usec() - from));
 }
 
-bool CommandQueueMT::dealloc_one() {
-tryagain:
-	if (dealloc_ptr == write_ptr) {
-		// The queue is empty
-		return false;
-	}
+uint32_t CommandQueueMT::_flush() {
+
+	// everything published so far, the read is also a full barrier
+	uint32_t end = atomic_add(&write_total, 0);
+	uint32_t flushed = 0;
+
+	while (read_pos != end) {
+
+		uint32_t pos = read_pos & COMMAND_MEM_MASK;
+		uint32_t size = ((CommandHeader *)&command_mem[pos])->size;
+
+		if (size == 0) {
+			// end of the ring, wrap down
+			read_pos += COMMAND_MEM_SIZE - pos;
+			continue;
+		}
+
+		CommandBase *cmd = reinterpret_cast<CommandBase *>(&command_mem[pos + sizeof(CommandHeader)]);
+
+		cmd->call();
+		cmd->post();
+		cmd->~CommandBase();
 
-	uint32_t size = *(uint32_t *)&command_mem[dealloc_ptr];
+		read_pos += size;
+		flush_count++;
+		flushed++;
 
-	if (size == 0) {
-		// End of command buffer wrap down
-		dealloc_ptr = 0;
-		goto tryagain;
+		if (read_pos - read_published >= COMMAND_MEM_SIZE / 8) {
+			// give memory back now and then, in case producers wait for room
+			atomic_add(&read_total, read_pos - read_published);
+			read_published = read_pos;
+		}
 	}
 
-	if (size & 1) {
-		// Still used, nothing can be deallocated
-		return false;
+	if (read_pos != read_published) {
+		atomic_add(&read_total, read_pos - read_published);
+		read_published = read_pos;
 	}
 
-	dealloc_ptr += (size >> 1) + sizeof(uint32_t);
-	return true;
+	return flushed;
+}
+
+uint32_t CommandQueueMT::take_stall_usec() {
+
+	uint32_t usec = atomic_add(&stall_usec, 0);
+	atomic_sub(&stall_usec, usec); // keeps what was added meanwhile
+	return usec;
 }
 
 CommandQueueMT::CommandQueueMT(bool p_sync) {
 
-	read_ptr = 0;
-	write_ptr = 0;
-	dealloc_ptr = 0;
-	mutex = Mutex::create();
+	write_total = 0;
+	read_total = 0;
+
+	producer_lock = 0;
+	write_pos = 0;
+	write_published = 0;
+	read_total_cache = 0;
+	wake_count = 0;
+	push_count = 0;
+
+	read_pos = 0;
+	read_published = 0;
+	flush_count = 0;
+	sleep_count = 0;
+
+	stall_usec = 0;
 
 	for (int i = 0; i < SYNC_SEMAPHORES; i++) {
 
 		sync_sems[i].sem = Semaphore::create();
-		sync_sems[i].in_use = false;
+		sync_sems[i].in_use = 0;
 	}
 	if (p_sync)
 		sync = Semaphore::create();
@@ -123,7 +183,6 @@ CommandQueueMT::~CommandQueueMT() {
 
 	if (sync)
 		memdelete(sync);
-	memdelete(mutex);
 	for (int i = 0; i < SYNC_SEMAPHORES; i++) {
 
 		memdelete(sync_sems[i].sem);
@@ -34,6 +34,7 @@
 #include "core/os/memory.h"
 #include "core/os/mutex.h"
 #include "core/os/semaphore.h"
+#include "core/safe_refcount.h"
 #include "core/simple_type.h"
 #include "core/typedefs.h"
 /**
@@ -236,7 +237,6 @@
 		cmd->method = p_method;                                              \
 		SEMIC_SEP_LIST(CMD_ASSIGN_PARAM, N);                                 \
 		unlock();                                                            \
-		if (sync) sync->post();                                              \
 	}
 
 #define CMD_RET_TYPE(N) CommandRet##N<T, M, COMMA_SEP_LIST(TYPE_ARG, N) COMMA(N) R>
@@ -252,8 +252,7 @@
 		cmd->ret = r_ret;                                                                      \
 		cmd->sync_sem = ss;                                                                    \
 		unlock();                                                                              \
-		if (sync) sync->post();                                                                \
-		ss->sem->wait();                                                                       \
+		_wait_sync_sem(ss);                                                                    \
 	}
 
 #define CMD_SYNC_TYPE(N) CommandSync##N<T, M COMMA(N) COMMA_SEP_LIST(TYPE_ARG, N)>
@@ -268,18 +267,29 @@
 		SEMIC_SEP_LIST(CMD_ASSIGN_PARAM, N);                                          \
 		cmd->sync_sem = ss;                                                           \
 		unlock();                                                                     \
-		if (sync) sync->post();                                                       \
-		ss->sem->wait();                                                              \
+		_wait_sync_sem(ss);                                                           \
 	}
 
 #define MAX_CMD_PARAMS 13
 
+/**
+ * Ring buffer of commands sent to a server running on its own thread.
+ *
+ * There is a single consumer (the server thread, or the main thread calling
+ * flush_all()) and producers publish commands without ever waiting for it:
+ * the ring is lock-free in both directions. Producers are only serialized
+ * among themselves by a spin lock, so the usual case of a single thread
+ * pushing never blocks. A producer only waits when the ring is full or when
+ * it needs the result of the command. The consumer runs every command
+ * available each time it wakes up, and is only woken up when it went to sleep.
+ */
+
 class CommandQueueMT {
 
 	struct SyncSemaphore {
 
 		Semaphore *sem;
-		bool in_use;
+		volatile uint32_t in_use;
 	};
 
 	struct CommandBase {
@@ -295,7 +305,7 @@ class CommandQueueMT {
 
 		virtual void post() {
 			sync_sem->sem->post();
-			sync_sem->in_use = false;
+			atomic_decrement(&sync_sem->in_use);
 		}
 	};
 
@@ -314,70 +324,74 @@ class CommandQueueMT {
 
 	enum {
 		COMMAND_MEM_SIZE_KB = 256,
-		COMMAND_MEM_SIZE = COMMAND_MEM_SIZE_KB * 1024,
+		COMMAND_MEM_SIZE = COMMAND_MEM_SIZE_KB * 1024, // must be a power of 2
+		COMMAND_MEM_MASK = COMMAND_MEM_SIZE - 1,
+		COMMAND_ALIGN = 8,
 		SYNC_SEMAPHORES = 8
 	};
 
+	struct CommandHeader {
+
+		uint32_t size; // header included, 0 means the rest of the ring is unused
+		uint32_t pad; // keeps commands aligned
+	};
+
 	uint8_t command_mem[COMMAND_MEM_SIZE];
-	uint32_t read_ptr;
-	uint32_t write_ptr;
-	uint32_t dealloc_ptr;
+
+	// Bytes published by producers and given back by the consumer since the
+	// queue was created, wrapping around (positions in the ring are these
+	// counts masked). Each side only writes its own, and only reads the
+	// other one atomically.
+	volatile uint32_t write_total;
+	volatile uint32_t read_total;
+
+	// producer side, only used with producer_lock held
+	volatile uint32_t producer_lock;
+	uint32_t write_pos;
+	uint32_t write_published;
+	uint32_t read_total_cache;
+	uint32_t wake_count;
+	uint32_t push_count;
+
+	// consumer side
+	uint32_t read_pos;
+	uint32_t read_published;
+	uint32_t flush_count;
+	volatile uint32_t sleep_count;
+
+	volatile uint32_t stall_usec;
+
 	SyncSemaphore sync_sems[SYNC_SEMAPHORES];
-	Mutex *mutex;
 	Semaphore *sync;
 
 	template <class T>
 	T *allocate() {
 
-		// alloc size is size+T+safeguard
-		uint32_t alloc_size = sizeof(T) + sizeof(uint32_t);
-
-	tryagain:
+		// header and command, rounded so the next header stays aligned
+		uint32_t alloc_size = (sizeof(CommandHeader) + sizeof(T) + COMMAND_ALIGN - 1) & ~(COMMAND_ALIGN - 1);
+		uint32_t pos = write_pos & COMMAND_MEM_MASK;
+		// commands are contiguous, skip the end of the ring if it does not fit
+		uint32_t skip = (COMMAND_MEM_SIZE - pos < alloc_size) ? COMMAND_MEM_SIZE - pos : 0;
 
-		if (write_ptr < dealloc_ptr) {
-			// behind dealloc_ptr, check that there is room
-			if ((dealloc_ptr - write_ptr) <= alloc_size) {
+		if (write_pos + skip + alloc_size - read_total_cache > COMMAND_MEM_SIZE) {
 
-				// There is no more room, try to deallocate something
-				if (dealloc_one()) {
-					goto tryagain;
-				}
+			read_total_cache = atomic_add(&read_total, 0);
+			if (write_pos + skip + alloc_size - read_total_cache > COMMAND_MEM_SIZE) {
+				// full, must wait for the consumer
 				return NULL;
 			}
-		} else if (write_ptr >= dealloc_ptr) {
-			// ahead of dealloc_ptr, check that there is room
-
-			if ((COMMAND_MEM_SIZE - write_ptr) < alloc_size + sizeof(uint32_t)) {
-				// no room at the end, wrap down;
-
-				if (dealloc_ptr == 0) { // don't want write_ptr to become dealloc_ptr
-
-					// There is no more room, try to deallocate something
-					if (dealloc_one()) {
-						goto tryagain;
-					}
-					return NULL;
-				}
-
-				// if this happens, it's a bug
-				ERR_FAIL_COND_V((COMMAND_MEM_SIZE - write_ptr) < sizeof(uint32_t), NULL);
-				// zero means, wrap to beginning
+		}
 
-				uint32_t *p = (uint32_t *)&command_mem[write_ptr];
-				*p = 0;
-				write_ptr = 0;
-				goto tryagain;
-			}
+		if (skip) {
+			((CommandHeader *)&command_mem[pos])->size = 0;
+			write_pos += skip;
+			pos = 0;
 		}
-		// Allocate the size and the 'in use' bit.
-		// First bit used to mark if command is still in use (1)
-		// or if it has been destroyed and can be deallocated (0).
-		uint32_t *p = (uint32_t *)&command_mem[write_ptr];
-		*p = (sizeof(T) << 1) | 1;
-		write_ptr += sizeof(uint32_t);
-		// allocate the command
-		T *cmd = memnew_placement(&command_mem[write_ptr], T);
-		write_ptr += sizeof(T);
+
+		((CommandHeader *)&command_mem[pos])->size = alloc_size;
+		T *cmd = memnew_placement(&command_mem[pos + sizeof(CommandHeader)], T);
+		write_pos += alloc_size;
+		push_count++;
 		return cmd;
 	}
 
@@ -398,46 +412,12 @@ class CommandQueueMT {
 		return ret;
 	}
 
-	bool flush_one(bool p_lock = true) {
-		if (p_lock) lock();
-	tryagain:
-
-		// tried to read an empty queue
-		if (read_ptr == write_ptr)
-			return false;
-
-		uint32_t size_ptr = read_ptr;
-		uint32_t size = *(uint32_t *)&command_mem[read_ptr] >> 1;
-
-		if (size == 0) {
-			//end of ringbuffer, wrap
-			read_ptr = 0;
-			goto tryagain;
-		}
-
-		read_ptr += sizeof(uint32_t);
-
-		CommandBase *cmd = reinterpret_cast<CommandBase *>(&command_mem[read_ptr]);
-
-		read_ptr += size;
-
-		if (p_lock) unlock();
-		cmd->call();
-		if (p_lock) lock();
-
-		cmd->post();
-		cmd->~CommandBase();
-		*(uint32_t *)&command_mem[size_ptr] &= ~1;
-
-		if (p_lock) unlock();
-		return true;
-	}
-
 	void lock();
 	void unlock();
 	void wait_for_flush();
 	SyncSemaphore *_alloc_sync_sem();
-	bool dealloc_one();
+	void _wait_sync_sem(SyncSemaphore *p_sync_sem);
+	uint32_t _flush();
 
 public:
 	/* NORMAL PUSH COMMANDS */
@@ -452,21 +432,34 @@ public:
 	DECL_PUSH_AND_SYNC(0)
 	SPACE_SEP_LIST(DECL_PUSH_AND_SYNC, 13)
 
-	void wait_and_flush_one() {
+	// Waits until commands are pushed, then runs all of them.
+	void wait_and_flush() {
 		ERR_FAIL_COND(!sync);
+		if (_flush())
+			return;
+
+		// Tell producers we are about to sleep, then check again, so a
+		// command published in between is never missed.
+		atomic_increment(&sleep_count);
+		if (_flush())
+			return;
+
 		sync->wait();
-		flush_one();
+		_flush();
 	}
 
 	void flush_all() {
 
 		//ERR_FAIL_COND(sync);
-		lock();
-		while (flush_one(false))
+		while (_flush())
 			;
-		unlock();
 	}
 
+	// Commands pushed and not run yet.
+	uint32_t get_pending_count() const { return push_count - flush_count; }
+	// Time producers spent waiting (full ring or results) since the last call.
+	uint32_t take_stall_usec();
+
 	CommandQueueMT(bool p_sync);
 	~CommandQueueMT();
 };
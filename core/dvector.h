@@ -488,6 +488,14 @@ void PoolVector<T>::set(int p_index, const T &p_val) {
 		ERR_FAIL_COND(p_index < 0 || p_index >= size());
 	}
 
+	_copy_on_write(); // make it unique
+
+	if (!MemoryPool::memory_pool) {
+		// without a pool allocator the memory never moves, no need to lock it
+		((T *)alloc->mem)[p_index] = p_val;
+		return;
+	}
+
 	Write w = write();
 	w[p_index] = p_val;
 }
@@ -504,6 +512,11 @@ const T PoolVector<T>::operator[](int p_index) const {
 
 	CRASH_BAD_INDEX(p_index, size());
 
+	if (!MemoryPool::memory_pool) {
+		// same as above, single element reads don't need a Read lock
+		return ((const T *)alloc->mem)[p_index];
+	}
+
 	Read r = read();
 	return r[p_index];
 }
@@ -2170,6 +2170,8 @@ PoolVector<uint8_t> (*Image::lossy_packer)(const Ref<Image> &, float) = NULL;
 Ref<Image> (*Image::lossy_unpacker)(const PoolVector<uint8_t> &) = NULL;
 PoolVector<uint8_t> (*Image::lossless_packer)(const Ref<Image> &) = NULL;
 Ref<Image> (*Image::lossless_unpacker)(const PoolVector<uint8_t> &) = NULL;
+Ref<Image> (*Image::lossy_buffer_unpacker)(const uint8_t *, int) = NULL;
+Ref<Image> (*Image::lossless_buffer_unpacker)(const uint8_t *, int) = NULL;
 
 void Image::_set_data(const Dictionary &p_data) {
 
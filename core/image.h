@@ -143,6 +143,8 @@ public:
 	static Ref<Image> (*lossy_unpacker)(const PoolVector<uint8_t> &p_buffer);
 	static PoolVector<uint8_t> (*lossless_packer)(const Ref<Image> &p_image);
 	static Ref<Image> (*lossless_unpacker)(const PoolVector<uint8_t> &p_buffer);
+	static Ref<Image> (*lossy_buffer_unpacker)(const uint8_t *p_buffer, int p_size); //same as lossy_unpacker, for data not held in a PoolVector
+	static Ref<Image> (*lossless_buffer_unpacker)(const uint8_t *p_buffer, int p_size);
 
 	PoolVector<uint8_t>::Write write_lock;
 
@@ -30,14 +30,77 @@
 
 #include "file_access_pack.h"
 
+#include "core/io/marshalls.h"
+#include "core/os/copymem.h"
+#include "core/os/worker_thread_pool.h"
+#include "core/safe_refcount.h"
 #include "core/version.h"
 
 #include <stdio.h>
 
-#define PACK_VERSION 1
+#define PACK_VERSION 2
+
+PackedData::PathMD5::PathMD5(const Vector<uint8_t> p_buf) {
+
+	// little endian regardless of the host, so hashes stored in packs match
+	a = decode_uint64(&p_buf[0]);
+	b = decode_uint64(&p_buf[8]);
+}
+
+bool PackedData::PackIndex::find(const PathMD5 &p_md5, PackedFile &r_file) const {
+
+	uint64_t bucket = bucket_bits ? p_md5.a >> (64 - bucket_bits) : 0;
+	uint32_t from = decode_uint32(&buckets[bucket * 4]);
+	uint32_t to = MIN(decode_uint32(&buckets[(bucket + 1) * 4]), file_count);
+
+	while (from < to) {
+
+		uint32_t mid = (from + to) / 2;
+		const uint8_t *e = &entries[mid * ENTRY_SIZE];
+
+		PathMD5 md5;
+		md5.a = decode_uint64(&e[0]);
+		md5.b = decode_uint64(&e[8]);
+
+		if (md5 == p_md5) {
+
+			r_file.pack = pack;
+			r_file.offset = decode_uint64(&e[16]);
+			r_file.size = decode_uint64(&e[24]);
+			copymem(r_file.md5, &e[32], 16);
+			r_file.stored_size = decode_uint64(&e[56]);
+			r_file.flags = decode_uint32(&e[64]);
+			r_file.src = src;
+			r_file.pack_order = pack_order;
+			return true;
+		}
+
+		if (md5 < p_md5) {
+			from = mid + 1;
+		} else {
+			to = mid;
+		}
+	}
+
+	return false;
+}
+
+String PackedData::PackIndex::get_path(uint32_t p_entry) const {
+
+	const uint8_t *e = &entries[p_entry * ENTRY_SIZE];
+	uint32_t ofs = decode_uint32(&e[48]);
+	uint32_t len = decode_uint32(&e[52]);
+	ERR_FAIL_COND_V(uint64_t(ofs) + len > paths_size, String());
+
+	String path;
+	path.parse_utf8((const char *)&paths[ofs], len);
+	return path;
+}
 
 Error PackedData::add_pack(const String &p_path) {
 
+	pack_order++;
+
 	for (int i = 0; i < sources.size(); i++) {
 
 		if (sources[i]->try_open_pack(p_path)) {
@@ -60,41 +123,116 @@ void PackedData::add_path(const String &pkg_path, const String &path, uint64_t o
 	pf.pack = pkg_path;
 	pf.offset = ofs;
 	pf.size = size;
+	pf.stored_size = size;
+	pf.flags = 0;
 	for (int i = 0; i < 16; i++)
 		pf.md5[i] = p_md5[i];
 	pf.src = p_src;
+	pf.pack_order = pack_order;
 
 	files[pmd5] = pf;
 
 	if (!exists) {
-		//search for dir
-		String p = path.replace_first("res://", "");
-		PackedDir *cd = root;
+		MutexLock lock(dirs_mutex);
+		_add_to_dirs(path);
+	}
+}
 
-		if (p.find("/") != -1) { //in a subdir
+void PackedData::add_pack_index(PackIndex *p_index) {
+
+	p_index->pack_order = pack_order;
+	p_index->dirs_added = false; // done on first directory access, see _get_root()
+	indexes.push_back(p_index);
+}
 
-			Vector<String> ds = p.get_base_dir().split("/");
+void PackedData::_add_to_dirs(const String &p_path) {
 
-			for (int j = 0; j < ds.size(); j++) {
+	//search for dir
+	String p = p_path.replace_first("res://", "");
+	PackedDir *cd = root;
 
-				if (!cd->subdirs.has(ds[j])) {
+	if (p.find("/") != -1) { //in a subdir
 
-					PackedDir *pd = memnew(PackedDir);
-					pd->name = ds[j];
-					pd->parent = cd;
-					cd->subdirs[pd->name] = pd;
-					cd = pd;
-				} else {
-					cd = cd->subdirs[ds[j]];
-				}
+		Vector<String> ds = p.get_base_dir().split("/");
+
+		for (int j = 0; j < ds.size(); j++) {
+
+			if (!cd->subdirs.has(ds[j])) {
+
+				PackedDir *pd = memnew(PackedDir);
+				pd->name = ds[j];
+				pd->parent = cd;
+				cd->subdirs[pd->name] = pd;
+				cd = pd;
+			} else {
+				cd = cd->subdirs[ds[j]];
 			}
 		}
-		String filename = path.get_file();
-		// Don't add as a file if the path points to a directoryy
-		if (!filename.empty()) {
-			cd->files.insert(filename);
+	}
+	String filename = p_path.get_file();
+	// Don't add as a file if the path points to a directoryy
+	if (!filename.empty()) {
+		cd->files.insert(filename);
+	}
+}
+
+PackedData::PackedDir *PackedData::_get_root() {
+
+	// DirAccessPack walks the tree without the lock, which is fine as long
+	// as no pack is added meanwhile
+	MutexLock lock(dirs_mutex);
+
+	for (int i = 0; i < indexes.size(); i++) {
+
+		PackIndex *index = indexes[i];
+		if (index->dirs_added)
+			continue;
+
+		for (uint32_t j = 0; j < index->file_count; j++) {
+			_add_to_dirs(index->get_path(j));
 		}
+		index->dirs_added = true;
+	}
+
+	return root;
+}
+
+bool PackedData::_find_path(const String &p_path, PackedFile &r_file) {
+
+	PathMD5 pmd5(p_path.md5_buffer());
+	Map<PathMD5, PackedFile>::Element *E = files.find(pmd5);
+
+	// packs added later override earlier ones
+	for (int i = indexes.size() - 1; i >= 0; i--) {
+
+		if (E && E->get().pack_order > indexes[i]->pack_order)
+			break;
+		if (indexes[i]->find(pmd5, r_file))
+			return true;
 	}
+
+	if (!E)
+		return false; //not found
+
+	r_file = E->get();
+	return true;
+}
+
+FileAccess *PackedData::try_open_path(const String &p_path) {
+
+	PackedFile pf;
+	if (!_find_path(p_path, pf))
+		return NULL; //not found
+	if (pf.offset == 0)
+		return NULL; //was erased
+
+	return pf.src->get_file(p_path, &pf);
+}
+
+bool PackedData::has_path(const String &p_path) {
+
+	PackedFile pf;
+	return _find_path(p_path, pf);
 }
 
 void PackedData::add_pack_source(PackSource *p_source) {
@@ -111,7 +249,10 @@ PackedData::PackedData() {
 	singleton = this;
 	root = memnew(PackedDir);
 	root->parent = NULL;
+	dirs_mutex = Mutex::create();
 	disabled = false;
+	mmap_enabled = true;
+	pack_order = 0;
 
 	add_pack_source(memnew(PackedSourcePCK));
 }
@@ -125,10 +266,16 @@ void PackedData::_free_packed_dirs(PackedDir *p_dir) {
 
 PackedData::~PackedData() {
 
+	for (int i = 0; i < indexes.size(); i++) {
+		memdelete(indexes[i]);
+	}
 	for (int i = 0; i < sources.size(); i++) {
 		memdelete(sources[i]);
 	}
 	_free_packed_dirs(root);
+	if (dirs_mutex) {
+		memdelete(dirs_mutex);
+	}
 }
 
 //////////////////////////////////////////////////////////////////
@@ -172,7 +319,7 @@ bool PackedSourcePCK::try_open_pack(const String &p_path) {
 	f->get_32(); // ver_rev
 
 	ERR_EXPLAIN("Pack version unsupported: " + itos(version));
-	ERR_FAIL_COND_V(version != PACK_VERSION, false);
+	ERR_FAIL_COND_V(version == 0 || version > PACK_VERSION, false);
 	ERR_EXPLAIN("Pack created with a newer version of the engine: " + itos(ver_major) + "." + itos(ver_minor));
 	ERR_FAIL_COND_V(ver_major > VERSION_MAJOR || (ver_major == VERSION_MAJOR && ver_minor > VERSION_MINOR), false);
 
@@ -181,34 +328,156 @@ bool PackedSourcePCK::try_open_pack(const String &p_path) {
 		f->get_32();
 	}
 
-	int file_count = f->get_32();
+	if (version == 1) {
 
-	for (int i = 0; i < file_count; i++) {
+		int file_count = f->get_32();
 
-		uint32_t sl = f->get_32();
-		CharString cs;
-		cs.resize(sl + 1);
-		f->get_buffer((uint8_t *)cs.ptr(), sl);
-		cs[sl] = 0;
+		for (int i = 0; i < file_count; i++) {
 
-		String path;
-		path.parse_utf8(cs.ptr());
+			uint32_t sl = f->get_32();
+			CharString cs;
+			cs.resize(sl + 1);
+			f->get_buffer((uint8_t *)cs.ptr(), sl);
+			cs[sl] = 0;
 
-		uint64_t ofs = f->get_64();
-		uint64_t size = f->get_64();
-		uint8_t md5[16];
-		f->get_buffer(md5, 16);
-		PackedData::get_singleton()->add_path(p_path, path, ofs, size, md5, this);
-	};
+			String path;
+			path.parse_utf8(cs.ptr());
+
+			uint64_t ofs = f->get_64();
+			uint64_t size = f->get_64();
+			uint8_t md5[16];
+			f->get_buffer(md5, 16);
+			PackedData::get_singleton()->add_path(p_path, path, ofs, size, md5, this);
+		};
+
+		if (!_map_pack(p_path, f))
+			memdelete(f);
+		return true;
+	}
+
+	// Version 2 keeps the directory as a hash index that is searched in
+	// place, nothing is added per file.
+
+	uint32_t file_count = f->get_32();
+	uint32_t bucket_bits = f->get_32();
+	if (bucket_bits > 24) {
+		memdelete(f);
+		ERR_EXPLAIN("Corrupt pack directory: " + p_path);
+		ERR_FAIL_V(false);
+	}
+
+	uint64_t buckets_size = ((uint64_t(1) << bucket_bits) + 1) * 4;
+	uint64_t entries_size = uint64_t(file_count) * PackedData::PackIndex::ENTRY_SIZE;
+	uint64_t dir_ofs = f->get_position();
+
+	f->seek(dir_ofs + buckets_size + entries_size);
+	uint32_t paths_size = f->get_32();
+	uint64_t dir_size = buckets_size + entries_size + 4 + paths_size;
+
+	PackedData::PackIndex *index = memnew(PackedData::PackIndex);
+	index->pack = p_path;
+	index->src = this;
+	index->file_count = file_count;
+	index->bucket_bits = bucket_bits;
+
+	const uint8_t *dir = NULL;
+
+	if (_map_pack(p_path, f)) {
+
+		const MappedPack &mp = mapped_packs[p_path];
+		if (dir_ofs + dir_size <= mp.size) {
+			dir = &mp.data[dir_ofs];
+		}
+	} else {
+
+		if (dir_size <= 0x7FFFFFFF) {
+			index->data.resize(dir_size);
+			f->seek(dir_ofs);
+			if (f->get_buffer(index->data.ptrw(), dir_size) == int(dir_size)) {
+				dir = index->data.ptr();
+			}
+		}
+		memdelete(f);
+	}
+
+	if (!dir) {
+		memdelete(index);
+		ERR_EXPLAIN("Corrupt pack directory: " + p_path);
+		ERR_FAIL_V(false);
+	}
+
+	index->buckets = dir;
+	index->entries = &dir[buckets_size];
+	index->paths = &dir[buckets_size + entries_size + 4];
+	index->paths_size = paths_size;
+
+	PackedData::get_singleton()->add_pack_index(index);
 
 	return true;
 };
 
+bool PackedSourcePCK::_map_pack(const String &p_path, FileAccess *p_file) {
+
+	if (!PackedData::get_singleton()->is_mmap_enabled())
+		return false;
+
+	if (mapped_packs.has(p_path)) {
+		// already mapped by an earlier add_pack, keep that one
+		memdelete(p_file);
+		return true;
+	}
+
+	// Keep the pack open and mapped, files inside it are then read
+	// straight from memory instead of opening the pack again for each one.
+	MappedPack mp;
+	mp.data = p_file->map_read_only(mp.size);
+	if (!mp.data)
+		return false;
+
+	mp.f = p_file;
+	mapped_packs[p_path] = mp;
+	return true;
+}
+
+FileAccess *PackedSourcePCK::_open_stored(const String &p_path, const PackedData::PackedFile &p_file) {
+
+	if (PackedData::get_singleton()->is_mmap_enabled()) {
+
+		Map<String, MappedPack>::Element *E = mapped_packs.find(p_file.pack);
+		if (E && p_file.offset + p_file.size <= E->get().size) {
+			return memnew(FileAccessPack(p_path, p_file, E->get().data + p_file.offset));
+		}
+	}
+
+	return memnew(FileAccessPack(p_path, p_file));
+}
+
 FileAccess *PackedSourcePCK::get_file(const String &p_path, PackedData::PackedFile *p_file) {
 
-	return memnew(FileAccessPack(p_path, *p_file));
+	if (!(p_file->flags & PackedData::PACK_FILE_COMPRESSED))
+		return _open_stored(p_path, *p_file);
+
+	PackedData::PackedFile stored = *p_file;
+	stored.size = p_file->stored_size;
+
+	FileAccessPackCompressed *fpc = memnew(FileAccessPackCompressed);
+	Error err = fpc->open_stored(_open_stored(p_path, stored), p_file->size);
+	if (err != OK) {
+		memdelete(fpc);
+		ERR_EXPLAIN("Corrupt compressed file in pack: " + p_path);
+		ERR_FAIL_V(NULL);
+	}
+
+	return fpc;
 };
 
+PackedSourcePCK::~PackedSourcePCK() {
+
+	for (Map<String, MappedPack>::Element *E = mapped_packs.front(); E; E = E->next()) {
+		memdelete(E->get().f);
+	}
+}
+
 //////////////////////////////////////////////////////////////////
 
 Error FileAccessPack::_open(const String &p_path, int p_mode_flags) {
@@ -219,12 +488,16 @@ Error FileAccessPack::_open(const String &p_path, int p_mode_flags) {
 
 void FileAccessPack::close() {
 
-	f->close();
+	if (f)
+		f->close();
+	data = NULL;
 }
 
 bool FileAccessPack::is_open() const {
 
-	return f->is_open();
+	if (f)
+		return f->is_open();
+	return data != NULL;
 }
 
 void FileAccessPack::seek(size_t p_position) {
@@ -235,7 +508,8 @@ void FileAccessPack::seek(size_t p_position) {
 		eof = false;
 	}
 
-	f->seek(pf.offset + p_position);
+	if (f)
+		f->seek(pf.offset + p_position);
 	pos = p_position;
 }
 void FileAccessPack::seek_end(int64_t p_position) {
@@ -263,6 +537,9 @@ uint8_t FileAccessPack::get_8() const {
 		return 0;
 	}
 
+	if (data)
+		return data[pos++];
+
 	pos++;
 	return f->get_8();
 }
@@ -278,18 +555,35 @@ int FileAccessPack::get_buffer(uint8_t *p_dst, int p_length) const {
 		to_read = int64_t(pf.size) - int64_t(pos);
 	}
 
+	if (to_read > 0 && data) {
+		copymem(p_dst, &data[pos], to_read);
+	}
+
 	pos += p_length;
 
 	if (to_read <= 0)
 		return 0;
-	f->get_buffer(p_dst, to_read);
+
+	if (!data)
+		f->get_buffer(p_dst, to_read);
 
 	return to_read;
 }
 
+const uint8_t *FileAccessPack::get_buffer_view(int p_length) const {
+
+	if (!data || eof || p_length < 0 || pos + p_length > pf.size)
+		return NULL;
+
+	const uint8_t *view = &data[pos];
+	pos += p_length;
+	return view;
+}
+
 void FileAccessPack::set_endian_swap(bool p_swap) {
 	FileAccess::set_endian_swap(p_swap);
-	f->set_endian_swap(p_swap);
+	if (f)
+		f->set_endian_swap(p_swap);
 }
 
 Error FileAccessPack::get_error() const {
@@ -319,16 +613,22 @@ bool FileAccessPack::file_exists(const String &p_name) {
 	return false;
 }
 
-FileAccessPack::FileAccessPack(const String &p_path, const PackedData::PackedFile &p_file) :
+FileAccessPack::FileAccessPack(const String &p_path, const PackedData::PackedFile &p_file, const uint8_t *p_data) :
 		pf(p_file),
-		f(FileAccess::open(pf.pack, FileAccess::READ)) {
+		f(NULL),
+		data(p_data) {
+	pos = 0;
+	eof = false;
+
+	if (data)
+		return; // served from the mapped pack
+
+	f = FileAccess::open(pf.pack, FileAccess::READ);
 	if (!f) {
 		ERR_EXPLAIN("Can't open pack-referenced file: " + String(pf.pack));
 		ERR_FAIL_COND(!f);
 	}
 	f->seek(pf.offset);
-	pos = 0;
-	eof = false;
 }
 
 FileAccessPack::~FileAccessPack() {
@@ -336,21 +636,299 @@ FileAccessPack::~FileAccessPack() {
 		memdelete(f);
 }
 
+//////////////////////////////////////////////////////////////////
+
+Error FileAccessPackCompressed::open_stored(FileAccess *p_stored, uint64_t p_size) {
+
+	ERR_FAIL_COND_V(!p_stored, ERR_CANT_OPEN);
+
+	f = p_stored;
+	size = p_size;
+	pos = 0;
+	eof = false;
+	cached_block = -1;
+
+	cmode = Compression::Mode(f->get_32());
+	block_size = f->get_32();
+	block_count = f->get_32();
+
+	ERR_FAIL_COND_V(cmode > Compression::MODE_GZIP || block_size == 0 || block_size > 0x7FFFFFFF, ERR_FILE_CORRUPT);
+	ERR_FAIL_COND_V(block_count != (size + block_size - 1) / block_size, ERR_FILE_CORRUPT);
+
+	block_ends.resize(block_count);
+	uint64_t last = 0;
+	for (uint32_t i = 0; i < block_count; i++) {
+		block_ends.write[i] = f->get_64();
+		ERR_FAIL_COND_V(block_ends[i] < last, ERR_FILE_CORRUPT);
+		last = block_ends[i];
+	}
+
+	blocks_ofs = f->get_position();
+	ERR_FAIL_COND_V(blocks_ofs + last > f->get_len(), ERR_FILE_CORRUPT);
+
+	return OK;
+}
+
+void FileAccessPackCompressed::_decode_blocks(void *p_userdata, uint32_t p_from, uint32_t p_to) {
+
+	DecodeData *dd = (DecodeData *)p_userdata;
+	const FileAccessPackCompressed *fpc = dd->file;
+
+	for (uint32_t i = p_from; i < p_to; i++) {
+
+		uint32_t block = dd->first_block + i;
+		uint64_t block_start = uint64_t(block) * fpc->block_size;
+		int len = fpc->_get_block_end(block) - block_start;
+
+		uint64_t src_start = block ? fpc->block_ends[block - 1] : 0;
+		int src_len = fpc->block_ends[block] - src_start;
+
+		const uint8_t *src = &dd->src[src_start - dd->src_ofs];
+		uint8_t *dst = &dd->dst[uint64_t(i) * fpc->block_size];
+
+		if (src_len == len) {
+			copymem(dst, src, len); // did not compress, stored as is
+		} else if (Compression::decompress(dst, len, src, src_len, fpc->cmode) != len) {
+			atomic_increment(&dd->errors);
+		}
+	}
+}
+
+bool FileAccessPackCompressed::_read_blocks(uint32_t p_from, uint32_t p_to, uint8_t *p_dst) const {
+
+	uint64_t src_from = p_from ? block_ends[p_from - 1] : 0;
+	int src_len = block_ends[p_to - 1] - src_from;
+
+	f->seek(blocks_ofs + src_from);
+
+	// Mapped packs are decoded in place, otherwise all the stored blocks
+	// are read in one go first.
+	Vector<uint8_t> buffer;
+	const uint8_t *src = f->get_buffer_view(src_len);
+	if (!src) {
+		buffer.resize(src_len);
+		if (f->get_buffer(buffer.ptrw(), src_len) != src_len)
+			return false;
+		src = buffer.ptr();
+	}
+
+	DecodeData dd;
+	dd.file = this;
+	dd.src = src;
+	dd.src_ofs = src_from;
+	dd.dst = p_dst;
+	dd.first_block = p_from;
+	dd.errors = 0;
+
+	if (p_to - p_from > 1) {
+		WorkerThreadPool::get_singleton()->parallel_for(p_to - p_from, 1, _decode_blocks, &dd);
+	} else {
+		_decode_blocks(&dd, 0, 1);
+	}
+
+	return dd.errors == 0;
+}
+
+bool FileAccessPackCompressed::_cache_block(uint32_t p_block) const {
+
+	if (cached_block == int(p_block))
+		return true;
+
+	cache.resize(block_size);
+	cached_block = -1;
+	ERR_FAIL_COND_V(!_read_blocks(p_block, p_block + 1, cache.ptrw()), false);
+	cached_block = p_block;
+	return true;
+}
+
+Error FileAccessPackCompressed::_open(const String &p_path, int p_mode_flags) {
+
+	ERR_FAIL_V(ERR_UNAVAILABLE);
+	return ERR_UNAVAILABLE;
+}
+
+void FileAccessPackCompressed::close() {
+
+	if (f) {
+		memdelete(f);
+		f = NULL;
+	}
+}
+
+bool FileAccessPackCompressed::is_open() const {
+
+	return f != NULL;
+}
+
+void FileAccessPackCompressed::seek(size_t p_position) {
+
+	eof = p_position > size;
+	pos = p_position;
+}
+
+void FileAccessPackCompressed::seek_end(int64_t p_position) {
+
+	seek(size + p_position);
+}
+
+size_t FileAccessPackCompressed::get_position() const {
+
+	return pos;
+}
+
+size_t FileAccessPackCompressed::get_len() const {
+
+	return size;
+}
+
+bool FileAccessPackCompressed::eof_reached() const {
+
+	return eof;
+}
+
+uint8_t FileAccessPackCompressed::get_8() const {
+
+	if (pos >= size) {
+		eof = true;
+		return 0;
+	}
+
+	uint32_t block = pos / block_size;
+	if (!_cache_block(block)) {
+		eof = true;
+		return 0;
+	}
+
+	return cache[pos++ - uint64_t(block) * block_size];
+}
+
+int FileAccessPackCompressed::get_buffer(uint8_t *p_dst, int p_length) const {
+
+	if (eof)
+		return 0;
+
+	int64_t to_read = p_length;
+	if (to_read + pos > size) {
+		eof = true;
+		to_read = int64_t(size) - int64_t(pos);
+	}
+
+	if (to_read <= 0)
+		return 0;
+
+	uint64_t end = pos + to_read;
+	uint8_t *dst = p_dst;
+
+	while (pos < end) {
+
+		uint32_t block = pos / block_size;
+		uint64_t block_start = uint64_t(block) * block_size;
+
+		if (pos == block_start && _get_block_end(block) <= end) {
+
+			// whole blocks are decoded straight into the destination,
+			// in parallel when there are several
+			uint32_t last = block + 1;
+			while (last < block_count && _get_block_end(last) <= end) {
+				last++;
+			}
+
+			if (!_read_blocks(block, last, dst)) {
+				eof = true;
+				ERR_EXPLAIN("Corrupt compressed file in pack");
+				ERR_FAIL_V(dst - p_dst);
+			}
+
+			uint64_t read = _get_block_end(last - 1) - pos;
+			dst += read;
+			pos += read;
+			continue;
+		}
+
+		if (!_cache_block(block)) {
+			eof = true;
+			return dst - p_dst;
+		}
+
+		uint64_t read = MIN(_get_block_end(block), end) - pos;
+		copymem(dst, &cache[pos - block_start], read);
+		dst += read;
+		pos += read;
+	}
+
+	return to_read;
+}
+
+Error FileAccessPackCompressed::get_error() const {
+
+	if (eof)
+		return ERR_FILE_EOF;
+	return OK;
+}
+
+void FileAccessPackCompressed::flush() {
+
+	ERR_FAIL();
+}
+
+void FileAccessPackCompressed::store_8(uint8_t p_dest) {
+
+	ERR_FAIL();
+}
+
+void FileAccessPackCompressed::store_buffer(const uint8_t *p_src, int p_length) {
+
+	ERR_FAIL();
+}
+
+bool FileAccessPackCompressed::file_exists(const String &p_name) {
+
+	return false;
+}
+
+FileAccessPackCompressed::FileAccessPackCompressed() {
+
+	f = NULL;
+	cmode = Compression::MODE_ZSTD;
+	size = 0;
+	block_size = 0;
+	block_count = 0;
+	blocks_ofs = 0;
+	pos = 0;
+	eof = false;
+	cached_block = -1;
+}
+
+FileAccessPackCompressed::~FileAccessPackCompressed() {
+
+	close();
+}
+
 //////////////////////////////////////////////////////////////////////////////////
 // DIR ACCESS
 //////////////////////////////////////////////////////////////////////////////////
 
+PackedData::PackedDir *DirAccessPack::_get_current() {
+
+	if (!current) {
+		current = PackedData::get_singleton()->_get_root();
+	}
+	return current;
+}
+
 Error DirAccessPack::list_dir_begin() {
 
 	list_dirs.clear();
 	list_files.clear();
 
-	for (Map<String, PackedData::PackedDir *>::Element *E = current->subdirs.front(); E; E = E->next()) {
+	PackedData::PackedDir *pd = _get_current();
+
+	for (Map<String, PackedData::PackedDir *>::Element *E = pd->subdirs.front(); E; E = E->next()) {
 
 		list_dirs.push_back(E->key());
 	}
 
-	for (Set<String>::Element *E = current->files.front(); E; E = E->next()) {
+	for (Set<String>::Element *E = pd->files.front(); E; E = E->next()) {
 
 		list_files.push_back(E->get());
 	}
@@ -420,9 +998,9 @@ Error DirAccessPack::change_dir(String p_dir) {
 	PackedData::PackedDir *pd;
 
 	if (absolute)
-		pd = PackedData::get_singleton()->root;
+		pd = PackedData::get_singleton()->_get_root();
 	else
-		pd = current;
+		pd = _get_current();
 
 	for (int i = 0; i < paths.size(); i++) {
 
@@ -450,8 +1028,8 @@ Error DirAccessPack::change_dir(String p_dir) {
 
 String DirAccessPack::get_current_dir() {
 
-	PackedData::PackedDir *pd = current;
-	String p = current->name;
+	PackedData::PackedDir *pd = _get_current();
+	String p = pd->name;
 
 	while (pd->parent) {
 		pd = pd->parent;
@@ -463,12 +1041,12 @@ String DirAccessPack::get_current_dir() {
 
 bool DirAccessPack::file_exists(String p_file) {
 
-	return current->files.has(p_file);
+	return _get_current()->files.has(p_file);
 }
 
 bool DirAccessPack::dir_exists(String p_dir) {
 
-	return current->subdirs.has(p_dir);
+	return _get_current()->subdirs.has(p_dir);
 }
 
 Error DirAccessPack::make_dir(String p_dir) {
@@ -492,7 +1070,7 @@ size_t DirAccessPack::get_space_left() {
 
 DirAccessPack::DirAccessPack() {
 
-	current = PackedData::get_singleton()->root;
+	current = NULL; // the directory tree is built on first use
 	cdir = false;
 }
 
@@ -31,10 +31,12 @@
 #ifndef FILE_ACCESS_PACK_H
 #define FILE_ACCESS_PACK_H
 
+#include "core/io/compression.h"
 #include "core/list.h"
 #include "core/map.h"
 #include "core/os/dir_access.h"
 #include "core/os/file_access.h"
+#include "core/os/mutex.h"
 #include "core/print_string.h"
 
 class PackSource;
@@ -45,13 +47,20 @@ class PackedData {
 	friend class PackSource;
 
 public:
+	enum PackedFileFlags {
+		PACK_FILE_COMPRESSED = 1, // stored as independently compressed blocks, see FileAccessPackCompressed
+	};
+
 	struct PackedFile {
 
 		String pack;
 		uint64_t offset; //if offset is ZERO, the file was ERASED
 		uint64_t size;
+		uint64_t stored_size; // bytes in the pack, differs from size when compressed
+		uint32_t flags;
 		uint8_t md5[16];
 		PackSource *src;
+		uint32_t pack_order;
 	};
 
 private:
@@ -82,36 +91,72 @@ private:
 			a = b = 0;
 		};
 
-		PathMD5(const Vector<uint8_t> p_buf) {
-			a = *((uint64_t *)&p_buf[0]);
-			b = *((uint64_t *)&p_buf[8]);
+		PathMD5(const Vector<uint8_t> p_buf);
+	};
+
+public:
+	// Directory of a version 2 pack, searched in place (in the mapped pack
+	// or in a single buffer read from it) instead of being loaded into files.
+	struct PackIndex {
+
+		enum {
+			ENTRY_SIZE = 72 // path md5 (16), offset (8), size (8), md5 (16), path offset (4), path length (4), stored size (8), flags (4), reserved (4)
 		};
+
+		String pack;
+		PackSource *src;
+		uint32_t pack_order;
+
+		uint32_t file_count;
+		uint32_t bucket_bits;
+		const uint8_t *buckets; // (1 << bucket_bits) + 1 entry indices, by top bits of the path md5
+		const uint8_t *entries; // sorted by path md5
+		const uint8_t *paths;
+		uint32_t paths_size;
+		Vector<uint8_t> data; // holds the above when the pack is not memory mapped
+
+		bool dirs_added;
+
+		bool find(const PathMD5 &p_md5, PackedFile &r_file) const;
+		String get_path(uint32_t p_entry) const;
 	};
 
+private:
 	Map<PathMD5, PackedFile> files;
+	Vector<PackIndex *> indexes;
 
 	Vector<PackSource *> sources;
 
 	PackedDir *root;
+	Mutex *dirs_mutex; // DirAccessPack can be used from loader threads, see _get_root()
 	//Map<String,PackedDir*> dirs;
 
 	static PackedData *singleton;
 	bool disabled;
+	bool mmap_enabled;
+	uint32_t pack_order;
 
 	void _free_packed_dirs(PackedDir *p_dir);
+	void _add_to_dirs(const String &p_path);
+	PackedDir *_get_root();
+	bool _find_path(const String &p_path, PackedFile &r_file);
 
 public:
 	void add_pack_source(PackSource *p_source);
 	void add_path(const String &pkg_path, const String &path, uint64_t ofs, uint64_t size, const uint8_t *p_md5, PackSource *p_src); // for PackSource
+	void add_pack_index(PackIndex *p_index); // for PackSource, takes ownership
 
 	void set_disabled(bool p_disabled) { disabled = p_disabled; }
 	_FORCE_INLINE_ bool is_disabled() const { return disabled; }
 
+	void set_mmap_enabled(bool p_enabled) { mmap_enabled = p_enabled; }
+	_FORCE_INLINE_ bool is_mmap_enabled() const { return mmap_enabled; }
+
 	static PackedData *get_singleton() { return singleton; }
 	Error add_pack(const String &p_path);
 
-	_FORCE_INLINE_ FileAccess *try_open_path(const String &p_path);
-	_FORCE_INLINE_ bool has_path(const String &p_path);
+	FileAccess *try_open_path(const String &p_path);
+	bool has_path(const String &p_path);
 
 	PackedData();
 	~PackedData();
@@ -127,9 +172,22 @@ public:
 
 class PackedSourcePCK : public PackSource {
 
+	struct MappedPack {
+		FileAccess *f;
+		const uint8_t *data;
+		uint64_t size;
+	};
+
+	Map<String, MappedPack> mapped_packs;
+
+	bool _map_pack(const String &p_path, FileAccess *p_file);
+	FileAccess *_open_stored(const String &p_path, const PackedData::PackedFile &p_file);
+
 public:
 	virtual bool try_open_pack(const String &p_path);
 	virtual FileAccess *get_file(const String &p_path, PackedData::PackedFile *p_file);
+
+	~PackedSourcePCK();
 };
 
 class FileAccessPack : public FileAccess {
@@ -140,6 +198,7 @@ class FileAccessPack : public FileAccess {
 	mutable bool eof;
 
 	FileAccess *f;
+	const uint8_t *data; // file contents inside a memory mapped pack, reads go through f when NULL
 	virtual Error _open(const String &p_path, int p_mode_flags);
 	virtual uint64_t _get_modified_time(const String &p_file) { return 0; }
 
@@ -157,6 +216,7 @@ public:
 	virtual uint8_t get_8() const;
 
 	virtual int get_buffer(uint8_t *p_dst, int p_length) const;
+	virtual const uint8_t *get_buffer_view(int p_length) const;
 
 	virtual void set_endian_swap(bool p_swap);
 
@@ -169,30 +229,81 @@ public:
 
 	virtual bool file_exists(const String &p_name);
 
-	FileAccessPack(const String &p_path, const PackedData::PackedFile &p_file);
+	FileAccessPack(const String &p_path, const PackedData::PackedFile &p_file, const uint8_t *p_data = NULL);
 	~FileAccessPack();
 };
 
-FileAccess *PackedData::try_open_path(const String &p_path) {
+class FileAccessPackCompressed : public FileAccess {
+
+	FileAccess *f; // the stored blocks
+	Compression::Mode cmode;
+	uint64_t size;
+	uint32_t block_size;
+	uint32_t block_count;
+	uint64_t blocks_ofs;
+	Vector<uint64_t> block_ends; // end of each block's data, relative to blocks_ofs
+
+	mutable uint64_t pos;
+	mutable bool eof;
+	mutable int cached_block;
+	mutable Vector<uint8_t> cache;
+
+	struct DecodeData {
+		const FileAccessPackCompressed *file;
+		const uint8_t *src;
+		uint64_t src_ofs;
+		uint8_t *dst;
+		uint32_t first_block;
+		volatile uint32_t errors;
+	};
+
+	static void _decode_blocks(void *p_userdata, uint32_t p_from, uint32_t p_to);
+
+	_FORCE_INLINE_ uint64_t _get_block_end(uint32_t p_block) const { return MIN(uint64_t(p_block + 1) * block_size, size); }
+	bool _read_blocks(uint32_t p_from, uint32_t p_to, uint8_t *p_dst) const;
+	bool _cache_block(uint32_t p_block) const;
+
+	virtual Error _open(const String &p_path, int p_mode_flags);
+	virtual uint64_t _get_modified_time(const String &p_file) { return 0; }
 
-	PathMD5 pmd5(p_path.md5_buffer());
-	Map<PathMD5, PackedFile>::Element *E = files.find(pmd5);
-	if (!E)
-		return NULL; //not found
-	if (E->get().offset == 0)
-		return NULL; //was erased
+public:
+	enum {
+		BLOCK_SIZE = 256 * 1024, // used by PCKPacker, blocks this size are decoded in parallel on large reads
+	};
+
+	Error open_stored(FileAccess *p_stored, uint64_t p_size);
+
+	virtual void close();
+	virtual bool is_open() const;
 
-	return E->get().src->get_file(p_path, &E->get());
-}
+	virtual void seek(size_t p_position);
+	virtual void seek_end(int64_t p_position = 0);
+	virtual size_t get_position() const;
+	virtual size_t get_len() const;
 
-bool PackedData::has_path(const String &p_path) {
+	virtual bool eof_reached() const;
 
-	return files.has(PathMD5(p_path.md5_buffer()));
-}
+	virtual uint8_t get_8() const;
+
+	virtual int get_buffer(uint8_t *p_dst, int p_length) const;
+
+	virtual Error get_error() const;
+
+	virtual void flush();
+	virtual void store_8(uint8_t p_dest);
+
+	virtual void store_buffer(const uint8_t *p_src, int p_length);
+
+	virtual bool file_exists(const String &p_name);
+
+	FileAccessPackCompressed();
+	~FileAccessPackCompressed();
+};
 
 class DirAccessPack : public DirAccess {
 
 	PackedData::PackedDir *current;
+	PackedData::PackedDir *_get_current();
 
 	List<String> list_dirs;
 	List<String> list_files;
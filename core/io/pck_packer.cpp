@@ -30,6 +30,9 @@
 
 #include "pck_packer.h"
 
+#include "core/io/compression.h"
+#include "core/io/file_access_pack.h"
+#include "core/io/marshalls.h"
 #include "core/os/file_access.h"
 #include "core/version.h"
 
@@ -56,7 +59,7 @@ static void _pad(FileAccess *p_file, int p_bytes) {
 void PCKPacker::_bind_methods() {
 
 	ClassDB::bind_method(D_METHOD("pck_start", "pck_name", "alignment"), &PCKPacker::pck_start);
-	ClassDB::bind_method(D_METHOD("add_file", "pck_path", "source_path"), &PCKPacker::add_file);
+	ClassDB::bind_method(D_METHOD("add_file", "pck_path", "source_path", "compress"), &PCKPacker::add_file, DEFVAL(false));
 	ClassDB::bind_method(D_METHOD("flush", "verbose"), &PCKPacker::flush);
 };
 
@@ -71,7 +74,7 @@ Error PCKPacker::pck_start(const String &p_file, int p_alignment) {
 	alignment = p_alignment;
 
 	file->store_32(0x43504447); // MAGIC
-	file->store_32(1); // # version
+	file->store_32(2); // # version
 	file->store_32(VERSION_MAJOR); // # major
 	file->store_32(VERSION_MINOR); // # minor
 	file->store_32(0); // # revision
@@ -86,7 +89,7 @@ Error PCKPacker::pck_start(const String &p_file, int p_alignment) {
 	return OK;
 };
 
-Error PCKPacker::add_file(const String &p_file, const String &p_src) {
+Error PCKPacker::add_file(const String &p_file, const String &p_src, bool p_compress) {
 
 	FileAccess *f = FileAccess::open(p_src, FileAccess::READ);
 	if (!f) {
@@ -97,7 +100,7 @@ Error PCKPacker::add_file(const String &p_file, const String &p_src) {
 	pf.path = p_file;
 	pf.src_path = p_src;
 	pf.size = f->get_len();
-	pf.offset_offset = 0;
+	pf.compress = p_compress;
 
 	files.push_back(pf);
 
@@ -114,50 +117,45 @@ Error PCKPacker::flush(bool p_verbose) {
 		return ERR_INVALID_PARAMETER;
 	};
 
-	// write the index
+	// the index goes first, but stored sizes are only known once the
+	// files are written, so leave room for it and fill it in last
 
-	file->store_32(files.size());
+	Vector<IndexEntry> entries;
+	entries.resize(files.size());
 
 	for (int i = 0; i < files.size(); i++) {
 
-		file->store_pascal_string(files[i].path);
-		files.write[i].offset_offset = file->get_position();
-		file->store_64(0); // offset
-		file->store_64(files[i].size); // size
+		IndexEntry &e = entries.write[i];
+		e.path = files[i].path;
+		e.size = files[i].size;
+		e.offset = 0;
+		e.stored_size = 0;
+		e.flags = 0;
+		zeromem(e.md5, 16); // # empty md5
+	}
 
-		// # empty md5
-		file->store_32(0);
-		file->store_32(0);
-		file->store_32(0);
-		file->store_32(0);
-	};
-
-	uint64_t ofs = file->get_position();
-	ofs = _align(ofs, alignment);
+	uint64_t index_ofs = file->get_position();
+	uint64_t ofs = _align(index_ofs + get_index_size(entries), alignment);
 
-	_pad(file, ofs - file->get_position());
-
-	const uint32_t buf_max = 65536;
-	uint8_t *buf = memnew_arr(uint8_t, buf_max);
+	_pad(file, ofs - index_ofs);
 
 	int count = 0;
 	for (int i = 0; i < files.size(); i++) {
 
 		FileAccess *src = FileAccess::open(files[i].src_path, FileAccess::READ);
-		uint64_t to_write = files[i].size;
-		while (to_write > 0) {
+		if (!src) {
+			// an entry without its data would read whatever else is at its offset
+			file->close();
+			ERR_EXPLAIN("Can't open file to pack: " + files[i].src_path);
+			ERR_FAIL_V(ERR_FILE_CANT_OPEN);
+		}
 
-			int read = src->get_buffer(buf, MIN(to_write, buf_max));
-			file->store_buffer(buf, read);
-			to_write -= read;
-		};
+		IndexEntry &e = entries.write[i];
+		e.offset = ofs;
+		e.flags = store_file(file, src, files[i].size, files[i].compress, e.stored_size);
 
 		uint64_t pos = file->get_position();
-		file->seek(files[i].offset_offset); // go back to store the file's offset
-		file->store_64(ofs);
-		file->seek(pos);
-
-		ofs = _align(ofs + files[i].size, alignment);
+		ofs = _align(pos, alignment);
 		_pad(file, ofs - pos);
 
 		src->close();
@@ -174,12 +172,198 @@ Error PCKPacker::flush(bool p_verbose) {
 	if (p_verbose)
 		printf("\n");
 
+	file->seek(index_ofs);
+	store_index(file, entries);
+
 	file->close();
-	memdelete(buf);
 
 	return OK;
 };
 
+uint32_t PCKPacker::store_file(FileAccess *p_dst, FileAccess *p_src, uint64_t p_size, bool p_compress, uint64_t &r_stored_size) {
+
+	uint64_t src_start = p_src->get_position();
+
+	if (p_compress && p_size > 0) {
+
+		// Blocks are compressed independently, so readers can seek and
+		// decode them in parallel.
+		const uint32_t block_size = FileAccessPackCompressed::BLOCK_SIZE;
+		uint32_t block_count = (p_size + block_size - 1) / block_size;
+		uint64_t header_size = 4 + 4 + 4 + uint64_t(block_count) * 8;
+
+		Vector<uint8_t> src_buf;
+		src_buf.resize(block_size);
+		Vector<uint8_t> dst_buf;
+		dst_buf.resize(Compression::get_max_compressed_buffer_size(block_size, Compression::MODE_ZSTD));
+
+		// kept in memory until it is known to be smaller than the file,
+		// so nothing is written for files stored plain
+		Vector<uint8_t> blocks;
+		Vector<uint64_t> block_ends;
+		block_ends.resize(block_count);
+		uint64_t end = 0;
+		bool smaller = header_size < p_size;
+
+		for (uint32_t i = 0; i < block_count && smaller; i++) {
+
+			int len = MIN(uint64_t(block_size), p_size - uint64_t(i) * block_size);
+			p_src->get_buffer(src_buf.ptrw(), len);
+
+			int clen = Compression::compress(dst_buf.ptrw(), src_buf.ptr(), len, Compression::MODE_ZSTD);
+			const uint8_t *data = dst_buf.ptr();
+			if (clen <= 0 || clen >= len) {
+				data = src_buf.ptr(); // blocks that don't shrink are stored as is
+				clen = len;
+			}
+
+			if (header_size + end + clen >= p_size) {
+				smaller = false;
+				break;
+			}
+
+			blocks.resize(end + clen);
+			copymem(blocks.ptrw() + end, data, clen);
+			end += clen;
+			block_ends.write[i] = end;
+		}
+
+		if (smaller) {
+
+			p_dst->store_32(Compression::MODE_ZSTD);
+			p_dst->store_32(block_size);
+			p_dst->store_32(block_count);
+			for (uint32_t i = 0; i < block_count; i++) {
+				p_dst->store_64(block_ends[i]);
+			}
+			p_dst->store_buffer(blocks.ptr(), end);
+
+			r_stored_size = header_size + end;
+			return PackedData::PACK_FILE_COMPRESSED;
+		}
+
+		// not worth it, store it plain
+		p_src->seek(src_start);
+	}
+
+	const uint32_t buf_max = 65536;
+	uint8_t *buf = memnew_arr(uint8_t, buf_max);
+
+	uint64_t to_write = p_size;
+	while (to_write > 0) {
+
+		int read = p_src->get_buffer(buf, MIN(to_write, buf_max));
+		if (read <= 0)
+			break;
+		p_dst->store_buffer(buf, read);
+		to_write -= read;
+	};
+
+	memdelete_arr(buf);
+
+	r_stored_size = p_size;
+	return 0;
+}
+
+struct _PCKIndexSort {
+
+	uint64_t a;
+	uint64_t b;
+	int entry;
+
+	bool operator<(const _PCKIndexSort &p_other) const {
+
+		if (a == p_other.a) {
+			return b < p_other.b;
+		} else {
+			return a < p_other.a;
+		}
+	}
+};
+
+static uint32_t _get_index_bucket_bits(int p_count) {
+
+	// aim for a handful of entries per bucket
+	uint32_t bits = 0;
+	while ((1 << bits) < p_count / 4 && bits < 20) {
+		bits++;
+	}
+	return bits;
+}
+
+uint64_t PCKPacker::get_index_size(const Vector<IndexEntry> &p_entries) {
+
+	uint64_t paths_size = 0;
+	for (int i = 0; i < p_entries.size(); i++) {
+		paths_size += p_entries[i].path.utf8().length();
+	}
+
+	uint32_t bucket_bits = _get_index_bucket_bits(p_entries.size());
+
+	return 4 + 4 + ((uint64_t(1) << bucket_bits) + 1) * 4 + uint64_t(p_entries.size()) * PackedData::PackIndex::ENTRY_SIZE + 4 + paths_size;
+}
+
+void PCKPacker::store_index(FileAccess *p_file, const Vector<IndexEntry> &p_entries) {
+
+	int count = p_entries.size();
+	uint32_t bucket_bits = _get_index_bucket_bits(count);
+
+	Vector<_PCKIndexSort> sorted;
+	sorted.resize(count);
+
+	for (int i = 0; i < count; i++) {
+
+		Vector<uint8_t> md5 = p_entries[i].path.md5_buffer();
+		_PCKIndexSort &s = sorted.write[i];
+		s.a = decode_uint64(&md5[0]);
+		s.b = decode_uint64(&md5[8]);
+		s.entry = i;
+	}
+
+	sorted.sort();
+
+	p_file->store_32(count);
+	p_file->store_32(bucket_bits);
+
+	// first entry of each bucket, the last one is the entry count
+	int e = 0;
+	for (uint64_t bucket = 0; bucket <= (uint64_t(1) << bucket_bits); bucket++) {
+
+		while (e < count && (bucket_bits ? sorted[e].a >> (64 - bucket_bits) : 0) < bucket) {
+			e++;
+		}
+		p_file->store_32(e);
+	}
+
+	Vector<CharString> paths;
+	paths.resize(count);
+	uint32_t paths_size = 0;
+
+	for (int i = 0; i < count; i++) {
+
+		const IndexEntry &entry = p_entries[sorted[i].entry];
+		paths.write[i] = entry.path.utf8();
+
+		p_file->store_64(sorted[i].a);
+		p_file->store_64(sorted[i].b);
+		p_file->store_64(entry.offset);
+		p_file->store_64(entry.size);
+		p_file->store_buffer(entry.md5, 16);
+		p_file->store_32(paths_size);
+		p_file->store_32(paths[i].length());
+		p_file->store_64(entry.stored_size);
+		p_file->store_32(entry.flags);
+		p_file->store_32(0); // reserved
+
+		paths_size += paths[i].length();
+	}
+
+	p_file->store_32(paths_size);
+	for (int i = 0; i < count; i++) {
+		p_file->store_buffer((const uint8_t *)paths[i].get_data(), paths[i].length());
+	}
+}
+
 PCKPacker::PCKPacker() {
 
 	file = NULL;
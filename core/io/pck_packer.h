@@ -48,14 +48,33 @@ class PCKPacker : public Reference {
 
 		String path;
 		String src_path;
-		int size;
-		uint64_t offset_offset;
+		uint64_t size;
+		bool compress;
 	};
 	Vector<File> files;
 
 public:
+	struct IndexEntry {
+
+		String path;
+		uint64_t offset;
+		uint64_t size;
+		uint64_t stored_size;
+		uint32_t flags; // PackedData::PackedFileFlags
+		uint8_t md5[16];
+	};
+
+	// Version 2 pack directory: entries sorted by path hash, bucketed so
+	// PackedData can look them up without loading the whole directory.
+	static uint64_t get_index_size(const Vector<IndexEntry> &p_entries);
+	static void store_index(FileAccess *p_file, const Vector<IndexEntry> &p_entries);
+
+	// Copies p_size bytes from p_src to p_dst, as compressed blocks if
+	// p_compress is set and that saves space. Returns the entry flags.
+	static uint32_t store_file(FileAccess *p_dst, FileAccess *p_src, uint64_t p_size, bool p_compress, uint64_t &r_stored_size);
+
 	Error pck_start(const String &p_file, int p_alignment);
-	Error add_file(const String &p_file, const String &p_src);
+	Error add_file(const String &p_file, const String &p_src, bool p_compress = false);
 	Error flush(bool p_verbose = false);
 
 	PCKPacker();
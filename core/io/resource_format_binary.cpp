@@ -106,13 +106,18 @@ StringName ResourceInteractiveLoaderBinary::_get_string() {
 	uint32_t id = f->get_32();
 	if (id & 0x80000000) {
 		uint32_t len = id & 0x7FFFFFFF;
+		if (len == 0)
+			return StringName();
+		String s;
+		const uint8_t *view = f->get_buffer_view(len);
+		if (view) {
+			s.parse_utf8((const char *)view, len);
+			return s;
+		}
 		if (len > str_buf.size()) {
 			str_buf.resize(len);
 		}
-		if (len == 0)
-			return StringName();
 		f->get_buffer((uint8_t *)&str_buf[0], len);
-		String s;
 		s.parse_utf8(&str_buf[0]);
 		return s;
 	}
@@ -593,22 +598,35 @@ Error ResourceInteractiveLoaderBinary::parse_variant(Variant &r_v) {
 
 			} else {
 				//compressed
-				PoolVector<uint8_t> data;
-				data.resize(f->get_32());
-				PoolVector<uint8_t>::Write w = data.write();
-				f->get_buffer(w.ptr(), data.size());
-				w = PoolVector<uint8_t>::Write();
-
+				uint32_t datalen = f->get_32();
 				Ref<Image> image;
 
-				if (encoding == IMAGE_ENCODING_LOSSY && Image::lossy_unpacker) {
+				const uint8_t *view = f->get_buffer_view(datalen);
+				if (view) {
+					//decode in place, no need to copy the file data out first
+					if (encoding == IMAGE_ENCODING_LOSSY && Image::lossy_buffer_unpacker) {
 
-					image = Image::lossy_unpacker(data);
-				} else if (encoding == IMAGE_ENCODING_LOSSLESS && Image::lossless_unpacker) {
+						image = Image::lossy_buffer_unpacker(view, datalen);
+					} else if (encoding == IMAGE_ENCODING_LOSSLESS && Image::lossless_buffer_unpacker) {
+
+						image = Image::lossless_buffer_unpacker(view, datalen);
+					}
+				} else {
+					PoolVector<uint8_t> data;
+					data.resize(datalen);
+					PoolVector<uint8_t>::Write w = data.write();
+					f->get_buffer(w.ptr(), data.size());
+					w = PoolVector<uint8_t>::Write();
 
-					image = Image::lossless_unpacker(data);
+					if (encoding == IMAGE_ENCODING_LOSSY && Image::lossy_unpacker) {
+
+						image = Image::lossy_unpacker(data);
+					} else if (encoding == IMAGE_ENCODING_LOSSLESS && Image::lossless_unpacker) {
+
+						image = Image::lossless_unpacker(data);
+					}
 				}
-				_advance_padding(data.size());
+				_advance_padding(datalen);
 
 				r_v = image;
 			}
@@ -804,13 +822,18 @@ static String get_ustring(FileAccess *f) {
 String ResourceInteractiveLoaderBinary::get_unicode_string() {
 
 	int len = f->get_32();
+	if (len == 0)
+		return String();
+	String s;
+	const uint8_t *view = f->get_buffer_view(len);
+	if (view) {
+		s.parse_utf8((const char *)view, len);
+		return s;
+	}
 	if (len > str_buf.size()) {
 		str_buf.resize(len);
 	}
-	if (len == 0)
-		return String();
 	f->get_buffer((uint8_t *)&str_buf[0], len);
-	String s;
 	s.parse_utf8(&str_buf[0]);
 	return s;
 }
@@ -33,6 +33,7 @@
 #include "core/io/resource_import.h"
 #include "core/os/file_access.h"
 #include "core/os/os.h"
+#include "core/os/thread.h"
 #include "core/path_remap.h"
 #include "core/print_string.h"
 #include "core/project_settings.h"
@@ -204,6 +205,13 @@ RES ResourceLoader::load(const String &p_path, const String &p_type_hint, bool p
 	else
 		local_path = ProjectSettings::get_singleton()->localize_path(p_path);
 
+	if (!p_no_cache) {
+		// a threaded load of the same path is waited for (or done here) instead of loading twice
+		RES res;
+		if (_load_from_threaded(local_path, p_type_hint, res, r_error))
+			return res;
+	}
+
 	if (!p_no_cache) {
 		//lock first if possible
 		if (ResourceCache::lock) {
@@ -635,6 +643,619 @@ void ResourceLoader::clear_path_remaps() {
 	path_remaps.clear();
 }
 
+/* THREADED LOADING */
+
+struct ResourceLoader::ThreadedRequest {
+
+	enum State {
+		STATE_QUEUED,
+		STATE_WAITING, // for dependencies loading elsewhere
+		STATE_LOADING,
+		STATE_FINALIZING, // loaded, main thread work or dependencies left
+		STATE_DONE
+	};
+
+	struct Finalizer {
+		ThreadedFinalizeFunc func;
+		REF object;
+		Variant data;
+	};
+
+	String local_path;
+	String type_hint;
+	int priority;
+	uint64_t order;
+	bool main_thread; // its loader can't run on workers
+	bool dependencies_scanned;
+	bool in_finalize_queue;
+	State state;
+	Thread::ID loading_thread;
+	int user_count; // load_threaded_request() calls not matched by load_threaded_get() yet
+	int pending_dependencies;
+	Vector<ThreadedRequest *> dependencies;
+	Vector<ThreadedRequest *> users; // requests having this one as dependency
+	Vector<ThreadedRequest *> waiters; // users to queue again once this one is loaded
+	Vector<Finalizer> finalizers;
+	int finalized;
+	RES resource;
+	Error error;
+
+	ThreadedRequest() {
+		priority = 0;
+		order = 0;
+		main_thread = false;
+		dependencies_scanned = false;
+		in_finalize_queue = false;
+		state = STATE_QUEUED;
+		loading_thread = 0;
+		user_count = 0;
+		pending_dependencies = 0;
+		finalized = 0;
+		error = OK;
+	}
+};
+
+String ResourceLoader::_localize_path(const String &p_path) {
+
+	if (p_path.is_rel_path())
+		return "res://" + p_path;
+	return ProjectSettings::get_singleton()->localize_path(p_path);
+}
+
+bool ResourceLoader::_can_load_threaded(const String &p_local_path, const String &p_type_hint) {
+
+	// resources create textures and meshes while loading, which needs a thread safe visual server
+	if (OS::get_singleton()->get_render_thread_mode() == OS::RENDER_THREAD_UNSAFE)
+		return false;
+
+	String path = _path_remap(p_local_path);
+	for (int i = 0; i < loader_count; i++) {
+
+		if (loader[i]->recognize_path(path, p_type_hint))
+			return loader[i]->can_load_threaded(path);
+	}
+
+	return true;
+}
+
+ResourceLoader::ThreadedRequest *ResourceLoader::_request_threaded(const String &p_local_path, const String &p_type_hint, int p_priority) {
+
+	ThreadedRequest **rptr = threaded_requests.getptr(p_local_path);
+	if (rptr) {
+
+		ThreadedRequest *request = *rptr;
+		if (p_priority > request->priority) {
+			request->priority = p_priority;
+			if (request->state == ThreadedRequest::STATE_QUEUED) {
+				Vector<ThreadedRequest *> &queue = request->main_thread ? threaded_main_queue : threaded_queue;
+				queue.erase(request);
+				_queue_threaded(queue, request);
+			}
+		}
+		return request;
+	}
+
+	ThreadedRequest *request = memnew(ThreadedRequest);
+	request->local_path = p_local_path;
+	request->type_hint = p_type_hint;
+	request->priority = p_priority;
+	request->order = threaded_order++;
+	request->main_thread = !_can_load_threaded(p_local_path, p_type_hint);
+	threaded_requests[p_local_path] = request;
+
+	_schedule_threaded(request);
+	return request;
+}
+
+void ResourceLoader::_queue_threaded(Vector<ThreadedRequest *> &p_queue, ThreadedRequest *p_request) {
+
+	// sorted by priority, then oldest first, the next one is at the back
+	int pos = 0;
+	while (pos < p_queue.size() && (p_queue[pos]->priority < p_request->priority || (p_queue[pos]->priority == p_request->priority && p_queue[pos]->order > p_request->order))) {
+		pos++;
+	}
+	p_queue.insert(pos, p_request);
+}
+
+ResourceLoader::ThreadedRequest *ResourceLoader::_pop_threaded(Vector<ThreadedRequest *> &p_queue) {
+
+	if (p_queue.empty())
+		return NULL;
+
+	ThreadedRequest *request = p_queue[p_queue.size() - 1];
+	p_queue.resize(p_queue.size() - 1);
+	request->state = ThreadedRequest::STATE_LOADING;
+	request->loading_thread = Thread::get_caller_id();
+	return request;
+}
+
+void ResourceLoader::_schedule_threaded(ThreadedRequest *p_request) {
+
+	p_request->state = ThreadedRequest::STATE_QUEUED;
+
+	if (p_request->main_thread) {
+		_queue_threaded(threaded_main_queue, p_request);
+		return;
+	}
+
+	_queue_threaded(threaded_queue, p_request);
+
+	// Each queued request gets a task, which loads whatever is first in line
+	// when it runs. Without workers the main thread loads them.
+	WorkerThreadPool *pool = WorkerThreadPool::get_singleton();
+	if (threaded_finishing || pool->get_thread_count() == 0)
+		return;
+
+	WorkerThreadPool::GroupID pump = pool->group_create();
+	pool->group_add_task(pump, &ResourceLoader::_threaded_pump, NULL);
+	pool->group_submit(pump);
+	threaded_pumps.push_back(pump);
+}
+
+void ResourceLoader::_threaded_pump(void *p_userdata) {
+
+	_lock_threaded();
+	ThreadedRequest *request = _pop_threaded(threaded_queue);
+	_unlock_threaded();
+
+	if (request) {
+		_run_threaded(request);
+	}
+}
+
+void ResourceLoader::_run_threaded(ThreadedRequest *p_request) {
+
+	if (!p_request->dependencies_scanned) {
+
+		// Request the dependencies first, so they load in parallel rather than
+		// one after the other from inside this load.
+		List<String> dependencies;
+		get_dependencies(p_request->local_path, &dependencies);
+
+		_lock_threaded();
+		p_request->dependencies_scanned = true;
+
+		for (List<String>::Element *E = dependencies.front(); E; E = E->next()) {
+
+			String path = _localize_path(E->get());
+			if (path == p_request->local_path || ResourceCache::has(path))
+				continue;
+
+			ThreadedRequest *dependency = _request_threaded(path, "", p_request->priority);
+			if (dependency->state == ThreadedRequest::STATE_WAITING)
+				continue; // it may be waiting on this request, it gets loaded from it if needed
+
+			p_request->dependencies.push_back(dependency);
+			dependency->users.push_back(p_request);
+			if (dependency->state == ThreadedRequest::STATE_QUEUED || dependency->state == ThreadedRequest::STATE_LOADING) {
+				dependency->waiters.push_back(p_request);
+				p_request->pending_dependencies++;
+			}
+		}
+
+		if (p_request->pending_dependencies > 0) {
+			// queued again by the last dependency to load
+			p_request->state = ThreadedRequest::STATE_WAITING;
+			_unlock_threaded();
+			return;
+		}
+		_unlock_threaded();
+	}
+
+	ThreadedRequest *previous = threaded_current;
+	threaded_current = p_request;
+
+	Error err = OK;
+	RES res = load(p_request->local_path, p_request->type_hint, false, &err);
+
+	threaded_current = previous;
+
+	_lock_threaded();
+
+	p_request->resource = res;
+	p_request->error = res.is_valid() ? OK : (err != OK ? err : ERR_CANT_OPEN);
+	p_request->state = ThreadedRequest::STATE_FINALIZING;
+
+	for (int i = 0; i < p_request->waiters.size(); i++) {
+
+		ThreadedRequest *waiter = p_request->waiters[i];
+		waiter->pending_dependencies--;
+		if (waiter->pending_dependencies == 0 && waiter->state == ThreadedRequest::STATE_WAITING) {
+			_schedule_threaded(waiter);
+		}
+	}
+	p_request->waiters.clear();
+
+	_check_threaded_done(p_request);
+
+	_unlock_threaded();
+}
+
+bool ResourceLoader::_finalize_threaded_step(ThreadedRequest *p_request) {
+
+	// dependencies are finalized before the requests using them
+	for (int i = 0; i < p_request->dependencies.size(); i++) {
+
+		ThreadedRequest *dependency = p_request->dependencies[i];
+		if (dependency->state == ThreadedRequest::STATE_FINALIZING && _finalize_threaded_step(dependency))
+			return true;
+	}
+
+	if (p_request->state != ThreadedRequest::STATE_FINALIZING || p_request->finalized >= p_request->finalizers.size())
+		return false;
+
+	ThreadedRequest::Finalizer finalizer = p_request->finalizers[p_request->finalized++];
+
+	_unlock_threaded();
+	finalizer.func(finalizer.object, finalizer.data);
+	_lock_threaded();
+
+	_check_threaded_done(p_request);
+	return true;
+}
+
+void ResourceLoader::_check_threaded_done(ThreadedRequest *p_request) {
+
+	if (p_request->state != ThreadedRequest::STATE_FINALIZING)
+		return;
+
+	bool done = p_request->finalized == p_request->finalizers.size();
+	for (int i = 0; done && i < p_request->dependencies.size(); i++) {
+		done = p_request->dependencies[i]->state == ThreadedRequest::STATE_DONE;
+	}
+
+	if (!done) {
+		if (!p_request->in_finalize_queue) {
+			_queue_threaded(threaded_finalize_queue, p_request);
+			p_request->in_finalize_queue = true;
+		}
+		return;
+	}
+
+	p_request->state = ThreadedRequest::STATE_DONE;
+	p_request->finalizers.clear();
+	if (p_request->in_finalize_queue) {
+		threaded_finalize_queue.erase(p_request);
+		p_request->in_finalize_queue = false;
+	}
+
+	for (int i = 0; i < p_request->dependencies.size(); i++) {
+
+		ThreadedRequest *dependency = p_request->dependencies[i];
+		dependency->users.erase(p_request);
+		_free_threaded_if_unused(dependency);
+	}
+	p_request->dependencies.clear();
+
+	// the last user done frees this request, don't touch it after
+	Vector<ThreadedRequest *> users = p_request->users;
+	_free_threaded_if_unused(p_request);
+
+	for (int i = 0; i < users.size(); i++) {
+		_check_threaded_done(users[i]);
+	}
+}
+
+void ResourceLoader::_free_threaded_if_unused(ThreadedRequest *p_request) {
+
+	if (p_request->state != ThreadedRequest::STATE_DONE || p_request->user_count > 0 || !p_request->users.empty())
+		return;
+
+	threaded_requests.erase(p_request->local_path);
+	memdelete(p_request);
+}
+
+void ResourceLoader::_wait_threaded(ThreadedRequest *p_request) {
+
+	// Other threads only need the resource, the main thread also finalizes it.
+	// Either one helps with queued requests while waiting.
+	bool main_thread = Thread::get_caller_id() == Thread::get_main_id();
+	int spins = 0;
+
+	_lock_threaded();
+
+	while (p_request->state != ThreadedRequest::STATE_DONE && (main_thread || p_request->state != ThreadedRequest::STATE_FINALIZING)) {
+
+		if (main_thread && p_request->state == ThreadedRequest::STATE_FINALIZING && _finalize_threaded_step(p_request)) {
+			spins = 0;
+			continue;
+		}
+
+		ThreadedRequest *next = main_thread ? _pop_threaded(threaded_main_queue) : NULL;
+		if (!next) {
+			next = _pop_threaded(threaded_queue);
+		}
+
+		_unlock_threaded();
+
+		if (next) {
+			_run_threaded(next);
+			spins = 0;
+		} else if (spins < 1000) {
+			spins++;
+		} else {
+			OS::get_singleton()->delay_usec(1);
+		}
+
+		_lock_threaded();
+	}
+
+	_unlock_threaded();
+}
+
+bool ResourceLoader::_load_from_threaded(const String &p_local_path, const String &p_type_hint, RES &r_res, Error *r_error) {
+
+	bool main_thread = Thread::get_caller_id() == Thread::get_main_id();
+
+	_lock_threaded();
+
+	ThreadedRequest *request = NULL;
+	ThreadedRequest **rptr = threaded_requests.getptr(p_local_path);
+	if (rptr) {
+		request = *rptr;
+	} else if (threaded_current && !main_thread && !ResourceCache::has(p_local_path) && !_can_load_threaded(p_local_path, p_type_hint)) {
+		// loading for a threaded request, but this loader has to run on the main thread
+		request = _request_threaded(p_local_path, p_type_hint, threaded_current->priority);
+	}
+
+	if (!request || (request->state == ThreadedRequest::STATE_LOADING && request->loading_thread == Thread::get_caller_id())) {
+		// not loaded threaded, or this is the threaded load itself
+		_unlock_threaded();
+		return false;
+	}
+
+	request->user_count++; // keeps it around while waiting
+
+	if ((request->state == ThreadedRequest::STATE_QUEUED || request->state == ThreadedRequest::STATE_WAITING) && (main_thread || !request->main_thread)) {
+
+		// needed right now, load it here instead of waiting for its turn
+		if (request->state == ThreadedRequest::STATE_QUEUED) {
+			(request->main_thread ? threaded_main_queue : threaded_queue).erase(request);
+		}
+		request->state = ThreadedRequest::STATE_LOADING;
+		request->loading_thread = Thread::get_caller_id();
+		request->dependencies_scanned = true;
+
+		_unlock_threaded();
+		_run_threaded(request);
+	} else {
+		_unlock_threaded();
+	}
+
+	_wait_threaded(request);
+
+	_lock_threaded();
+	r_res = request->resource;
+	if (r_error)
+		*r_error = request->error;
+	request->user_count--;
+	_free_threaded_if_unused(request);
+	_unlock_threaded();
+
+	return true;
+}
+
+float ResourceLoader::_get_threaded_progress(const ThreadedRequest *p_request) {
+
+	if (p_request->state == ThreadedRequest::STATE_DONE)
+		return 1.0;
+
+	// loading and finalizing count for half each, averaged with the dependencies
+	float progress = 0.0;
+	if (p_request->state == ThreadedRequest::STATE_FINALIZING) {
+		progress = p_request->finalizers.empty() ? 1.0 : 0.5 + 0.5 * p_request->finalized / p_request->finalizers.size();
+	}
+
+	for (int i = 0; i < p_request->dependencies.size(); i++) {
+		progress += _get_threaded_progress(p_request->dependencies[i]);
+	}
+
+	return progress / (p_request->dependencies.size() + 1);
+}
+
+Error ResourceLoader::load_threaded_request(const String &p_path, const String &p_type_hint, int p_priority) {
+
+	String local_path = _localize_path(p_path);
+
+	_lock_threaded();
+	ThreadedRequest *request = _request_threaded(local_path, p_type_hint, p_priority);
+	request->user_count++;
+	_unlock_threaded();
+
+	return OK;
+}
+
+ResourceLoader::ThreadLoadStatus ResourceLoader::load_threaded_get_status(const String &p_path, float *r_progress) {
+
+	String local_path = _localize_path(p_path);
+
+	ThreadLoadStatus status = THREAD_LOAD_INVALID_RESOURCE;
+	float progress = 0.0;
+
+	_lock_threaded();
+
+	ThreadedRequest **rptr = threaded_requests.getptr(local_path);
+	if (rptr && (*rptr)->user_count > 0) {
+
+		ThreadedRequest *request = *rptr;
+		if (request->state != ThreadedRequest::STATE_DONE) {
+			status = THREAD_LOAD_IN_PROGRESS;
+		} else {
+			status = request->resource.is_valid() ? THREAD_LOAD_LOADED : THREAD_LOAD_FAILED;
+		}
+		progress = _get_threaded_progress(request);
+	}
+
+	_unlock_threaded();
+
+	if (r_progress)
+		*r_progress = progress;
+
+	return status;
+}
+
+RES ResourceLoader::load_threaded_get(const String &p_path, Error *r_error) {
+
+	String local_path = _localize_path(p_path);
+
+	_lock_threaded();
+	ThreadedRequest **rptr = threaded_requests.getptr(local_path);
+	ThreadedRequest *request = rptr && (*rptr)->user_count > 0 ? *rptr : NULL;
+	_unlock_threaded();
+
+	if (!request) {
+		if (r_error)
+			*r_error = ERR_INVALID_PARAMETER;
+		ERR_EXPLAIN("No threaded load was requested for: " + local_path);
+		ERR_FAIL_V(RES());
+	}
+
+	_wait_threaded(request);
+
+	_lock_threaded();
+	RES res = request->resource;
+	if (r_error)
+		*r_error = request->error;
+	request->user_count--;
+	_free_threaded_if_unused(request);
+	_unlock_threaded();
+
+	return res;
+}
+
+void ResourceLoader::add_threaded_finalizer(ThreadedFinalizeFunc p_func, const REF &p_object, const Variant &p_data) {
+
+	if (!is_loading_threaded()) {
+		p_func(p_object, p_data);
+		return;
+	}
+
+	ThreadedRequest::Finalizer finalizer;
+	finalizer.func = p_func;
+	finalizer.object = p_object;
+	finalizer.data = p_data;
+
+	_lock_threaded();
+	threaded_current->finalizers.push_back(finalizer);
+	_unlock_threaded();
+}
+
+bool ResourceLoader::is_loading_threaded() {
+
+	return threaded_current && Thread::get_caller_id() != Thread::get_main_id();
+}
+
+void ResourceLoader::finalize_threaded_loads(uint64_t p_budget_usec) {
+
+	uint64_t begin = OS::get_singleton()->get_ticks_usec();
+
+	_lock_threaded();
+
+	for (int i = threaded_pumps.size() - 1; i >= 0; i--) {
+
+		if (WorkerThreadPool::get_singleton()->group_is_done(threaded_pumps[i])) {
+			WorkerThreadPool::get_singleton()->group_wait(threaded_pumps[i]); // frees it
+			threaded_pumps.remove(i);
+		}
+	}
+
+	// At least one step per frame, so loading moves on even with a zero budget.
+	while (true) {
+
+		// requests close to completion first
+		bool worked = false;
+		for (int i = threaded_finalize_queue.size() - 1; i >= 0 && !worked; i--) {
+			worked = _finalize_threaded_step(threaded_finalize_queue[i]);
+		}
+
+		if (!worked) {
+
+			ThreadedRequest *next = _pop_threaded(threaded_main_queue);
+			if (!next && WorkerThreadPool::get_singleton()->get_thread_count() == 0) {
+				next = _pop_threaded(threaded_queue);
+			}
+
+			if (next) {
+				_unlock_threaded();
+				_run_threaded(next);
+				_lock_threaded();
+				worked = true;
+			}
+		}
+
+		if (!worked || OS::get_singleton()->get_ticks_usec() - begin >= p_budget_usec)
+			break;
+	}
+
+	_unlock_threaded();
+}
+
+void ResourceLoader::setup_threaded_loads() {
+
+	threaded_mutex = Mutex::create();
+}
+
+void ResourceLoader::finish_threaded_loads() {
+
+	// Nothing new starts. Requests still queued get loaded by whatever
+	// running load needs them.
+	_lock_threaded();
+	threaded_finishing = true;
+	threaded_queue.clear();
+	_unlock_threaded();
+
+	while (true) {
+
+		_lock_threaded();
+
+		if (threaded_pumps.empty()) {
+			_unlock_threaded();
+			break;
+		}
+
+		WorkerThreadPool::GroupID pump = threaded_pumps[threaded_pumps.size() - 1];
+		if (!WorkerThreadPool::get_singleton()->group_is_done(pump)) {
+
+			// the running load may be waiting for the main thread
+			ThreadedRequest *next = _pop_threaded(threaded_main_queue);
+			_unlock_threaded();
+
+			if (next) {
+				_run_threaded(next);
+			} else {
+				OS::get_singleton()->delay_usec(1);
+			}
+			continue;
+		}
+
+		threaded_pumps.resize(threaded_pumps.size() - 1);
+		_unlock_threaded();
+
+		WorkerThreadPool::get_singleton()->group_wait(pump);
+	}
+
+	_lock_threaded();
+
+	const String *K = NULL;
+	while ((K = threaded_requests.next(K))) {
+		memdelete(threaded_requests[*K]);
+	}
+	threaded_requests.clear();
+	threaded_main_queue.clear();
+	threaded_finalize_queue.clear();
+	threaded_finishing = false;
+
+	_unlock_threaded();
+}
+
+void ResourceLoader::cleanup_threaded_loads() {
+
+	if (threaded_mutex) {
+		memdelete(threaded_mutex);
+		threaded_mutex = NULL;
+	}
+}
+
 ResourceLoadErrorNotify ResourceLoader::err_notify = NULL;
 void *ResourceLoader::err_notify_ud = NULL;
 
@@ -647,3 +1268,13 @@ bool ResourceLoader::timestamp_on_load = false;
 SelfList<Resource>::List ResourceLoader::remapped_list;
 HashMap<String, Vector<String> > ResourceLoader::translation_remaps;
 HashMap<String, String> ResourceLoader::path_remaps;
+
+Mutex *ResourceLoader::threaded_mutex = NULL;
+HashMap<String, ResourceLoader::ThreadedRequest *> ResourceLoader::threaded_requests;
+Vector<ResourceLoader::ThreadedRequest *> ResourceLoader::threaded_queue;
+Vector<ResourceLoader::ThreadedRequest *> ResourceLoader::threaded_main_queue;
+Vector<ResourceLoader::ThreadedRequest *> ResourceLoader::threaded_finalize_queue;
+Vector<WorkerThreadPool::GroupID> ResourceLoader::threaded_pumps;
+uint64_t ResourceLoader::threaded_order = 0;
+bool ResourceLoader::threaded_finishing = false;
+_THREAD_LOCAL_PTR_(ResourceLoader::ThreadedRequest *) ResourceLoader::threaded_current = NULL;
@@ -31,6 +31,8 @@
 #ifndef RESOURCE_LOADER_H
 #define RESOURCE_LOADER_H
 
+#include "core/os/mutex.h"
+#include "core/os/worker_thread_pool.h"
 #include "core/resource.h"
 
 /**
@@ -70,6 +72,8 @@ public:
 	virtual Error rename_dependencies(const String &p_path, const Map<String, String> &p_map) { return OK; }
 	virtual bool is_import_valid(const String &p_path) const { return true; }
 	virtual int get_import_order(const String &p_path) const { return 0; }
+	// loaders touching state that isn't thread safe (script languages) return false, threaded loads run them on the main thread
+	virtual bool can_load_threaded(const String &p_path) const { return true; }
 
 	virtual ~ResourceFormatLoader() {}
 };
@@ -78,7 +82,17 @@ typedef void (*ResourceLoadErrorNotify)(void *p_ud, const String &p_text);
 typedef void (*DependencyErrorNotify)(void *p_ud, const String &p_loading, const String &p_which, const String &p_type);
 
 class ResourceLoader {
+public:
+	enum ThreadLoadStatus {
+		THREAD_LOAD_INVALID_RESOURCE,
+		THREAD_LOAD_IN_PROGRESS,
+		THREAD_LOAD_FAILED,
+		THREAD_LOAD_LOADED
+	};
+
+	typedef void (*ThreadedFinalizeFunc)(const REF &p_object, const Variant &p_data);
 
+private:
 	enum {
 		MAX_LOADERS = 64
 	};
@@ -104,6 +118,42 @@ class ResourceLoader {
 	//internal load function
 	static RES _load(const String &p_path, const String &p_original_path, const String &p_type_hint, bool p_no_cache, Error *r_error);
 
+	struct ThreadedRequest;
+
+	static Mutex *threaded_mutex;
+	static HashMap<String, ThreadedRequest *> threaded_requests;
+	static Vector<ThreadedRequest *> threaded_queue; // loaded on the worker pool
+	static Vector<ThreadedRequest *> threaded_main_queue; // loaded on the main thread
+	static Vector<ThreadedRequest *> threaded_finalize_queue;
+	static Vector<WorkerThreadPool::GroupID> threaded_pumps;
+	static uint64_t threaded_order;
+	static bool threaded_finishing;
+	static _THREAD_LOCAL_PTR_(ThreadedRequest *) threaded_current;
+
+	static _FORCE_INLINE_ void _lock_threaded() {
+		if (threaded_mutex)
+			threaded_mutex->lock();
+	}
+	static _FORCE_INLINE_ void _unlock_threaded() {
+		if (threaded_mutex)
+			threaded_mutex->unlock();
+	}
+
+	static String _localize_path(const String &p_path);
+	static bool _can_load_threaded(const String &p_local_path, const String &p_type_hint);
+	static ThreadedRequest *_request_threaded(const String &p_local_path, const String &p_type_hint, int p_priority);
+	static void _queue_threaded(Vector<ThreadedRequest *> &p_queue, ThreadedRequest *p_request);
+	static ThreadedRequest *_pop_threaded(Vector<ThreadedRequest *> &p_queue);
+	static void _schedule_threaded(ThreadedRequest *p_request);
+	static void _threaded_pump(void *p_userdata);
+	static void _run_threaded(ThreadedRequest *p_request);
+	static bool _finalize_threaded_step(ThreadedRequest *p_request);
+	static void _check_threaded_done(ThreadedRequest *p_request);
+	static void _free_threaded_if_unused(ThreadedRequest *p_request);
+	static void _wait_threaded(ThreadedRequest *p_request);
+	static bool _load_from_threaded(const String &p_local_path, const String &p_type_hint, RES &r_res, Error *r_error);
+	static float _get_threaded_progress(const ThreadedRequest *p_request);
+
 public:
 	static Ref<ResourceInteractiveLoader> load_interactive(const String &p_path, const String &p_type_hint = "", bool p_no_cache = false, Error *r_error = NULL);
 	static RES load(const String &p_path, const String &p_type_hint = "", bool p_no_cache = false, Error *r_error = NULL);
@@ -147,6 +197,29 @@ public:
 	static void reload_translation_remaps();
 	static void load_translation_remaps();
 	static void clear_translation_remaps();
+
+	/* THREADED LOADING */
+
+	// Requests are loaded on the worker pool by priority, with the dependencies
+	// reported by their loader requested alongside so they load in parallel.
+	// Work that needs the main thread (server uploads, see add_threaded_finalizer())
+	// runs in finalize_threaded_loads(), a request is loaded once all of it ran.
+	// Every request must be matched by a load_threaded_get() call.
+	static Error load_threaded_request(const String &p_path, const String &p_type_hint = "", int p_priority = 0);
+	static ThreadLoadStatus load_threaded_get_status(const String &p_path, float *r_progress = NULL);
+	static RES load_threaded_get(const String &p_path, Error *r_error = NULL);
+
+	// For loaders: while loading for a threaded request on a worker, p_func is queued
+	// for the main thread, otherwise it's called right away.
+	static void add_threaded_finalizer(ThreadedFinalizeFunc p_func, const REF &p_object, const Variant &p_data);
+	static bool is_loading_threaded();
+
+	// Called once per frame on the main thread.
+	static void finalize_threaded_loads(uint64_t p_budget_usec);
+
+	static void setup_threaded_loads();
+	static void finish_threaded_loads();
+	static void cleanup_threaded_loads();
 };
 
 #endif
@@ -0,0 +1,292 @@
+/*************************************************************************/
+/*  aabb_tree.cpp                                                        */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2018 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2018 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "aabb_tree.h"
+
+int AABBTree::_allocate_node() {
+
+	int idx;
+	if (free_node != NODE_NULL) {
+		idx = free_node;
+		free_node = nodes[idx].parent;
+	} else {
+		idx = nodes.size();
+		nodes.resize(idx + 1);
+	}
+
+	Node &n = nodes.write[idx];
+	n.parent = NODE_NULL;
+	n.children[0] = NODE_NULL;
+	n.children[1] = NODE_NULL;
+	n.height = 0;
+	n.element = 0;
+	n.refit = false;
+	return idx;
+}
+
+void AABBTree::_free_node(int p_node) {
+
+	Node &n = nodes.write[p_node];
+	n.height = -1;
+	n.parent = free_node;
+	free_node = p_node;
+}
+
+void AABBTree::_insert_leaf(int &r_root, int p_leaf) {
+
+	if (r_root == NODE_NULL) {
+		r_root = p_leaf;
+		nodes.write[r_root].parent = NODE_NULL;
+		return;
+	}
+
+	Node *n = nodes.ptrw();
+	const AABB leaf_aabb = n[p_leaf].aabb;
+
+	// find the best sibling, going down while it's cheaper than pairing with the current node
+	int index = r_root;
+	while (!n[index].is_leaf()) {
+
+		int child0 = n[index].children[0];
+		int child1 = n[index].children[1];
+
+		real_t area = _aabb_cost(n[index].aabb);
+		real_t combined_area = _aabb_cost(n[index].aabb.merge(leaf_aabb));
+
+		// cost of creating a new parent for this node and the new leaf
+		real_t cost = 2.0 * combined_area;
+		// minimum cost of pushing the leaf further down the tree
+		real_t inheritance_cost = 2.0 * (combined_area - area);
+
+		real_t cost0 = _aabb_cost(n[child0].aabb.merge(leaf_aabb)) + inheritance_cost;
+		if (!n[child0].is_leaf())
+			cost0 -= _aabb_cost(n[child0].aabb);
+
+		real_t cost1 = _aabb_cost(n[child1].aabb.merge(leaf_aabb)) + inheritance_cost;
+		if (!n[child1].is_leaf())
+			cost1 -= _aabb_cost(n[child1].aabb);
+
+		if (cost < cost0 && cost < cost1)
+			break;
+
+		index = cost0 < cost1 ? child0 : child1;
+	}
+
+	int sibling = index;
+
+	int old_parent = n[sibling].parent;
+	int new_parent = _allocate_node();
+	n = nodes.ptrw(); // may have been reallocated
+
+	n[new_parent].parent = old_parent;
+	n[new_parent].aabb = leaf_aabb.merge(n[sibling].aabb);
+	n[new_parent].height = n[sibling].height + 1;
+	n[new_parent].children[0] = sibling;
+	n[new_parent].children[1] = p_leaf;
+	n[sibling].parent = new_parent;
+	n[p_leaf].parent = new_parent;
+
+	if (old_parent != NODE_NULL) {
+		if (n[old_parent].children[0] == sibling) {
+			n[old_parent].children[0] = new_parent;
+		} else {
+			n[old_parent].children[1] = new_parent;
+		}
+	} else {
+		r_root = new_parent;
+	}
+
+	// refit and rebalance the ancestors
+	index = n[p_leaf].parent;
+	while (index != NODE_NULL) {
+
+		index = _balance(r_root, index);
+
+		int child0 = n[index].children[0];
+		int child1 = n[index].children[1];
+		n[index].height = 1 + MAX(n[child0].height, n[child1].height);
+		n[index].aabb = n[child0].aabb.merge(n[child1].aabb);
+
+		index = n[index].parent;
+	}
+}
+
+void AABBTree::_remove_leaf(int &r_root, int p_leaf) {
+
+	if (p_leaf == r_root) {
+		r_root = NODE_NULL;
+		return;
+	}
+
+	Node *n = nodes.ptrw();
+
+	int parent = n[p_leaf].parent;
+	int grand_parent = n[parent].parent;
+	int sibling = n[parent].children[0] == p_leaf ? n[parent].children[1] : n[parent].children[0];
+
+	if (grand_parent == NODE_NULL) {
+
+		r_root = sibling;
+		n[sibling].parent = NODE_NULL;
+		_free_node(parent);
+		return;
+	}
+
+	if (n[grand_parent].children[0] == parent) {
+		n[grand_parent].children[0] = sibling;
+	} else {
+		n[grand_parent].children[1] = sibling;
+	}
+	n[sibling].parent = grand_parent;
+	_free_node(parent);
+
+	int index = grand_parent;
+	while (index != NODE_NULL) {
+
+		index = _balance(r_root, index);
+
+		int child0 = n[index].children[0];
+		int child1 = n[index].children[1];
+		n[index].aabb = n[child0].aabb.merge(n[child1].aabb);
+		n[index].height = 1 + MAX(n[child0].height, n[child1].height);
+
+		index = n[index].parent;
+	}
+}
+
+// Rotates the taller child of p_node up if the node is unbalanced, returns the new root of the subtree.
+int AABBTree::_balance(int &r_root, int p_node) {
+
+	Node *n = nodes.ptrw();
+	Node &a = n[p_node];
+
+	if (a.is_leaf() || a.height < 2)
+		return p_node;
+
+	int ib = a.children[0];
+	int ic = a.children[1];
+	Node &b = n[ib];
+	Node &c = n[ic];
+
+	int balance = c.height - b.height;
+
+	if (balance > 1) {
+
+		// rotate c up
+		int i_f = c.children[0];
+		int i_g = c.children[1];
+		Node &f = n[i_f];
+		Node &g = n[i_g];
+
+		c.children[0] = p_node;
+		c.parent = a.parent;
+		a.parent = ic;
+
+		if (c.parent != NODE_NULL) {
+			if (n[c.parent].children[0] == p_node) {
+				n[c.parent].children[0] = ic;
+			} else {
+				n[c.parent].children[1] = ic;
+			}
+		} else {
+			r_root = ic;
+		}
+
+		if (f.height > g.height) {
+			c.children[1] = i_f;
+			a.children[1] = i_g;
+			g.parent = p_node;
+			a.aabb = b.aabb.merge(g.aabb);
+			c.aabb = a.aabb.merge(f.aabb);
+			a.height = 1 + MAX(b.height, g.height);
+			c.height = 1 + MAX(a.height, f.height);
+		} else {
+			c.children[1] = i_g;
+			a.children[1] = i_f;
+			f.parent = p_node;
+			a.aabb = b.aabb.merge(f.aabb);
+			c.aabb = a.aabb.merge(g.aabb);
+			a.height = 1 + MAX(b.height, f.height);
+			c.height = 1 + MAX(a.height, g.height);
+		}
+
+		return ic;
+	}
+
+	if (balance < -1) {
+
+		// rotate b up
+		int i_d = b.children[0];
+		int i_e = b.children[1];
+		Node &d = n[i_d];
+		Node &e = n[i_e];
+
+		b.children[0] = p_node;
+		b.parent = a.parent;
+		a.parent = ib;
+
+		if (b.parent != NODE_NULL) {
+			if (n[b.parent].children[0] == p_node) {
+				n[b.parent].children[0] = ib;
+			} else {
+				n[b.parent].children[1] = ib;
+			}
+		} else {
+			r_root = ib;
+		}
+
+		if (d.height > e.height) {
+			b.children[1] = i_d;
+			a.children[0] = i_e;
+			e.parent = p_node;
+			a.aabb = c.aabb.merge(e.aabb);
+			b.aabb = a.aabb.merge(d.aabb);
+			a.height = 1 + MAX(c.height, e.height);
+			b.height = 1 + MAX(a.height, d.height);
+		} else {
+			b.children[1] = i_e;
+			a.children[0] = i_d;
+			d.parent = p_node;
+			a.aabb = c.aabb.merge(d.aabb);
+			b.aabb = a.aabb.merge(e.aabb);
+			a.height = 1 + MAX(c.height, d.height);
+			b.height = 1 + MAX(a.height, e.height);
+		}
+
+		return ib;
+	}
+
+	return p_node;
+}
+
+AABBTree::AABBTree() {
+
+	free_node = NODE_NULL;
+}
@@ -0,0 +1,82 @@
+/*************************************************************************/
+/*  aabb_tree.h                                                          */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2018 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2018 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef AABB_TREE_H
+#define AABB_TREE_H
+
+#include "core/math/aabb.h"
+#include "core/vector.h"
+
+/**
+ * Node pool and the insert/remove logic of a dynamic AABB tree, shared by the
+ * broad phase and DynamicBVH.
+ *
+ * Leaves are inserted next to the sibling that is cheapest by the surface area
+ * heuristic, and ancestors are kept balanced with AVL-like rotations. Several
+ * trees can live in the same pool, each one is just the root index kept by the
+ * user, which also keeps the leaves in sync with its own elements.
+ */
+
+class AABBTree {
+protected:
+	enum {
+		NODE_NULL = -1
+	};
+
+	struct Node {
+
+		AABB aabb; // fattened for leaves
+		int parent; // next free node when free
+		int children[2];
+		int height; // 0 for leaves, -1 for free nodes
+		uint32_t element;
+		bool refit; // free for the user, cleared on allocation
+
+		_FORCE_INLINE_ bool is_leaf() const { return children[0] == NODE_NULL; }
+	};
+
+	Vector<Node> nodes;
+	int free_node;
+
+	_FORCE_INLINE_ static real_t _aabb_cost(const AABB &p_aabb) {
+		// half the surface area
+		return p_aabb.size.x * p_aabb.size.y + p_aabb.size.y * p_aabb.size.z + p_aabb.size.z * p_aabb.size.x;
+	}
+
+	int _allocate_node();
+	void _free_node(int p_node);
+	void _insert_leaf(int &r_root, int p_leaf);
+	void _remove_leaf(int &r_root, int p_leaf);
+	int _balance(int &r_root, int p_node);
+
+	AABBTree();
+};
+
+#endif // AABB_TREE_H
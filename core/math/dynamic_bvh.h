@@ -0,0 +1,941 @@
+/*************************************************************************/
+/*  dynamic_bvh.h                                                        */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2018 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2018 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef DYNAMIC_BVH_H
+#define DYNAMIC_BVH_H
+
+#include "core/hash_map.h"
+#include "core/math/aabb.h"
+#include "core/math/aabb_tree.h"
+#include "core/math/plane.h"
+#include "core/os/copymem.h"
+#include "core/os/worker_thread_pool.h"
+#include "core/sort.h"
+#include "core/vector.h"
+
+/**
+ * Dynamic bounding volume hierarchy with the same interface as Octree (pairing
+ * included), meant for scenes where many elements move every frame.
+ *
+ * Leaves store a fattened AABB. move() only records the new AABB, the tree and
+ * the pairs are brought up to date in one batch by update(), which must be
+ * called before culling. Leaves still inside their parent are refitted without
+ * touching the rest of the tree, leaves that moved a bit further are refitted
+ * too and their ancestors are refitted once per update no matter how many of
+ * their leaves moved. Only leaves that moved far are reinserted.
+ *
+ * Pairable and non pairable elements are kept in separate trees, so moving
+ * elements that are not pairable only search the (usually small) pairable one.
+ */
+
+typedef uint32_t BVHElementID;
+
+#define BVH_ELEMENT_INVALID_ID 0
+#define BVH_CULL_PARTS_MAX 64
+// Leaves are grown by this margin, so small motions don't change the tree.
+#define BVH_FAT_AABB_MARGIN 0.1
+// Leaves are also extended along the motion, so moving elements don't change the tree every frame.
+#define BVH_FAT_AABB_DISPLACEMENT_FACTOR 2.0
+// Refitting may grow the parent of a leaf up to this factor (in surface), otherwise the leaf is reinserted.
+#define BVH_REFIT_MAX_GROWTH 1.5
+
+template <class T>
+class DynamicBVH : private AABBTree {
+public:
+	typedef void *(*PairCallback)(void *, BVHElementID, T *, int, BVHElementID, T *, int);
+	typedef void (*UnpairCallback)(void *, BVHElementID, T *, int, BVHElementID, T *, int, void *);
+
+private:
+	enum {
+		TREE_NON_PAIRABLE = 0,
+		TREE_PAIRABLE = 1,
+		TREE_MAX = 2
+	};
+
+	struct Element {
+
+		T *userdata; // NULL if free
+		int subindex;
+		bool pairable;
+		uint32_t pairable_type;
+		uint32_t pairable_mask;
+		AABB aabb;
+		Vector3 displacement;
+		int leaf;
+		int tree;
+		bool queued;
+		Vector<BVHElementID> pairs;
+	};
+
+	struct _CullConvexPart {
+
+		int node;
+		T **results;
+		int result_count;
+		int result_capacity;
+	};
+
+	struct _CullConvexThreadedData {
+
+		const DynamicBVH *bvh;
+		const Plane *planes;
+		int plane_count;
+		int result_max;
+		uint32_t mask;
+		_CullConvexPart *parts;
+	};
+
+	struct _NodeHeightCompare {
+
+		const Node *nodes;
+		_FORCE_INLINE_ bool operator()(int p_a, int p_b) const { return nodes[p_a].height < nodes[p_b].height; }
+	};
+
+	int root[TREE_MAX];
+
+	Vector<Element> elements; // indexed by ID - 1
+	Vector<BVHElementID> free_elements;
+	Vector<BVHElementID> update_queue;
+	Vector<BVHElementID> refit_queue;
+	Vector<int> refit_nodes;
+
+	HashMap<uint64_t, void *> pair_map;
+	int pair_count;
+
+	PairCallback pair_callback;
+	UnpairCallback unpair_callback;
+	void *pair_callback_userdata;
+	void *unpair_callback_userdata;
+
+	_FORCE_INLINE_ static uint64_t _pair_key(BVHElementID p_a, BVHElementID p_b) {
+		return p_a < p_b ? (uint64_t(p_a) << 32) | p_b : (uint64_t(p_b) << 32) | p_a;
+	}
+
+	AABB _get_fat_aabb(const Element &p_element) const;
+	void _update_tree(BVHElementID p_id);
+
+	void _queue_update(BVHElementID p_id);
+	bool _test_pair(BVHElementID p_a, BVHElementID p_b) const;
+	void _pair(BVHElementID p_a, BVHElementID p_b);
+	void _unpair(BVHElementID p_a, BVHElementID p_b);
+	void _update_pairs(BVHElementID p_id, int *p_stack);
+
+	void _cull_convex_part(_CullConvexPart *p_part, const _CullConvexThreadedData *p_cull) const;
+	static void _cull_convex_part_func(void *p_userdata, uint32_t p_from, uint32_t p_to);
+
+public:
+	BVHElementID create(T *p_userdata, const AABB &p_aabb = AABB(), int p_subindex = 0, bool p_pairable = false, uint32_t p_pairable_type = 0, uint32_t p_pairable_mask = 1);
+	void move(BVHElementID p_id, const AABB &p_aabb);
+	void set_pairable(BVHElementID p_id, bool p_pairable = false, uint32_t p_pairable_type = 0, uint32_t p_pairable_mask = 1);
+	void erase(BVHElementID p_id);
+
+	// Applies all the changes since the last call to the tree, then pairs and unpairs.
+	void update();
+
+	bool is_pairable(BVHElementID p_id) const;
+	T *get(BVHElementID p_id) const;
+	int get_subindex(BVHElementID p_id) const;
+
+	// Culling doesn't modify the BVH, so several culls can run at the same time.
+	int cull_convex(const Vector<Plane> &p_convex, T **p_result_array, int p_result_max, uint32_t p_mask = 0xFFFFFFFF) const;
+	int cull_convex_threaded(const Vector<Plane> &p_convex, T **p_result_array, int p_result_max, uint32_t p_mask = 0xFFFFFFFF, int p_max_threads = -1) const;
+	int cull_aabb(const AABB &p_aabb, T **p_result_array, int p_result_max, int *p_subindex_array = NULL, uint32_t p_mask = 0xFFFFFFFF) const;
+	int cull_segment(const Vector3 &p_from, const Vector3 &p_to, T **p_result_array, int p_result_max, int *p_subindex_array = NULL, uint32_t p_mask = 0xFFFFFFFF) const;
+	int cull_point(const Vector3 &p_point, T **p_result_array, int p_result_max, int *p_subindex_array = NULL, uint32_t p_mask = 0xFFFFFFFF) const;
+
+	void set_pair_callback(PairCallback p_callback, void *p_userdata);
+	void set_unpair_callback(UnpairCallback p_callback, void *p_userdata);
+
+	int get_pair_count() const { return pair_count; }
+	int get_tree_height() const;
+
+	DynamicBVH();
+	~DynamicBVH();
+};
+
+/* TREE */
+
+template <class T>
+AABB DynamicBVH<T>::_get_fat_aabb(const Element &p_element) const {
+
+	AABB fat_aabb = p_element.aabb.grow(BVH_FAT_AABB_MARGIN);
+
+	Vector3 displacement = p_element.displacement * BVH_FAT_AABB_DISPLACEMENT_FACTOR;
+	for (int i = 0; i < 3; i++) {
+		if (displacement[i] < 0) {
+			fat_aabb.position[i] += displacement[i];
+			fat_aabb.size[i] -= displacement[i];
+		} else {
+			fat_aabb.size[i] += displacement[i];
+		}
+	}
+
+	return fat_aabb;
+}
+
+template <class T>
+void DynamicBVH<T>::_update_tree(BVHElementID p_id) {
+
+	Element &e = elements.write[p_id - 1];
+	int tree = e.pairable ? TREE_PAIRABLE : TREE_NON_PAIRABLE;
+
+	if (e.aabb.has_no_surface()) {
+
+		if (e.leaf != NODE_NULL) {
+			_remove_leaf(root[e.tree], e.leaf);
+			_free_node(e.leaf);
+			e.leaf = NODE_NULL;
+		}
+		return;
+	}
+
+	if (e.leaf == NODE_NULL) {
+
+		e.leaf = _allocate_node();
+		e.tree = tree;
+		nodes.write[e.leaf].element = p_id;
+		nodes.write[e.leaf].aabb = _get_fat_aabb(e);
+		_insert_leaf(root[e.tree], e.leaf);
+		return;
+	}
+
+	if (e.tree != tree) {
+
+		// pairable changed, move to the other tree
+		_remove_leaf(root[e.tree], e.leaf);
+		e.tree = tree;
+		nodes.write[e.leaf].aabb = _get_fat_aabb(e);
+		_insert_leaf(root[e.tree], e.leaf);
+		return;
+	}
+
+	const AABB &leaf_aabb = nodes[e.leaf].aabb;
+	AABB fat_aabb = _get_fat_aabb(e);
+
+	// still inside its fat AABB, and that one didn't grow too large
+	if (leaf_aabb.encloses(e.aabb) && fat_aabb.grow(BVH_FAT_AABB_MARGIN * 4.0).encloses(leaf_aabb))
+		return;
+
+	int parent = nodes[e.leaf].parent;
+
+	if (parent == NODE_NULL || nodes[parent].aabb.encloses(fat_aabb)) {
+		// nothing above the leaf changes
+		nodes.write[e.leaf].aabb = fat_aabb;
+		return;
+	}
+
+	const AABB &parent_aabb = nodes[parent].aabb;
+	if (_aabb_cost(parent_aabb.merge(fat_aabb)) <= _aabb_cost(parent_aabb) * BVH_REFIT_MAX_GROWTH) {
+		// close to where it was, refit once all reinsertions are done
+		refit_queue.push_back(p_id);
+		return;
+	}
+
+	_remove_leaf(root[e.tree], e.leaf);
+	nodes.write[e.leaf].aabb = fat_aabb;
+	_insert_leaf(root[e.tree], e.leaf);
+}
+
+/* PAIRS */
+
+template <class T>
+void DynamicBVH<T>::_queue_update(BVHElementID p_id) {
+
+	Element &e = elements.write[p_id - 1];
+	if (!e.queued) {
+		e.queued = true;
+		update_queue.push_back(p_id);
+	}
+}
+
+template <class T>
+bool DynamicBVH<T>::_test_pair(BVHElementID p_a, BVHElementID p_b) const {
+
+	const Element &a = elements[p_a - 1];
+	const Element &b = elements[p_b - 1];
+
+	// same rules as Octree
+	if (p_a == p_b || a.userdata == b.userdata)
+		return false;
+	if (!a.pairable && !b.pairable)
+		return false;
+	if (!(a.pairable_type & b.pairable_mask) && !(b.pairable_type & a.pairable_mask))
+		return false;
+	if (a.leaf == NODE_NULL || b.leaf == NODE_NULL)
+		return false;
+
+	return a.aabb.intersects_inclusive(b.aabb);
+}
+
+template <class T>
+void DynamicBVH<T>::_pair(BVHElementID p_a, BVHElementID p_b) {
+
+	if (p_a > p_b)
+		SWAP(p_a, p_b);
+
+	Element &a = elements.write[p_a - 1];
+	Element &b = elements.write[p_b - 1];
+
+	void *data = NULL;
+	if (pair_callback)
+		data = pair_callback(pair_callback_userdata, p_a, a.userdata, a.subindex, p_b, b.userdata, b.subindex);
+
+	pair_map.set(_pair_key(p_a, p_b), data);
+	a.pairs.push_back(p_b);
+	b.pairs.push_back(p_a);
+	pair_count++;
+}
+
+template <class T>
+void DynamicBVH<T>::_unpair(BVHElementID p_a, BVHElementID p_b) {
+
+	if (p_a > p_b)
+		SWAP(p_a, p_b);
+
+	uint64_t key = _pair_key(p_a, p_b);
+	void **data = pair_map.getptr(key);
+	ERR_FAIL_COND(!data);
+
+	Element &a = elements.write[p_a - 1];
+	Element &b = elements.write[p_b - 1];
+
+	if (unpair_callback)
+		unpair_callback(unpair_callback_userdata, p_a, a.userdata, a.subindex, p_b, b.userdata, b.subindex, *data);
+
+	pair_map.erase(key);
+	a.pairs.erase(p_b);
+	b.pairs.erase(p_a);
+	pair_count--;
+}
+
+template <class T>
+void DynamicBVH<T>::_update_pairs(BVHElementID p_id, int *p_stack) {
+
+	const Element &e = elements[p_id - 1];
+
+	for (int i = e.pairs.size() - 1; i >= 0; i--) {
+		if (!_test_pair(p_id, e.pairs[i]))
+			_unpair(p_id, e.pairs[i]);
+	}
+
+	if (e.leaf == NODE_NULL)
+		return;
+
+	// elements that are not pairable can only pair with pairable ones
+	const AABB aabb = e.aabb;
+	int first_tree = e.pairable ? TREE_NON_PAIRABLE : TREE_PAIRABLE;
+
+	for (int t = first_tree; t < TREE_MAX; t++) {
+
+		if (root[t] == NODE_NULL)
+			continue;
+
+		int stack_size = 0;
+		p_stack[stack_size++] = root[t];
+
+		while (stack_size) {
+
+			const Node &node = nodes[p_stack[--stack_size]];
+			if (!node.aabb.intersects_inclusive(aabb))
+				continue;
+
+			if (node.is_leaf()) {
+
+				if (_test_pair(p_id, node.element) && !pair_map.has(_pair_key(p_id, node.element)))
+					_pair(p_id, node.element);
+			} else {
+
+				p_stack[stack_size++] = node.children[0];
+				p_stack[stack_size++] = node.children[1];
+			}
+		}
+	}
+}
+
+template <class T>
+void DynamicBVH<T>::update() {
+
+	if (update_queue.empty())
+		return;
+
+	/* FIRST update the tree, reinsertions may change its shape */
+
+	for (int i = 0; i < update_queue.size(); i++) {
+
+		BVHElementID id = update_queue[i];
+		if (elements[id - 1].userdata) {
+			_update_tree(id);
+		}
+	}
+
+	/* THEN refit the leaves that stayed close, and their ancestors once */
+
+	if (refit_queue.size()) {
+
+		Node *n = nodes.ptrw();
+
+		for (int i = 0; i < refit_queue.size(); i++) {
+
+			const Element &e = elements[refit_queue[i] - 1];
+			n[e.leaf].aabb = _get_fat_aabb(e);
+
+			for (int index = n[e.leaf].parent; index != NODE_NULL && !n[index].refit; index = n[index].parent) {
+				n[index].refit = true;
+				refit_nodes.push_back(index);
+			}
+		}
+
+		// children are lower than their parents, so they are refitted first
+		SortArray<int, _NodeHeightCompare> sorter;
+		sorter.compare.nodes = n;
+		sorter.sort(refit_nodes.ptrw(), refit_nodes.size());
+
+		for (int i = 0; i < refit_nodes.size(); i++) {
+
+			Node &node = n[refit_nodes[i]];
+			node.aabb = n[node.children[0]].aabb.merge(n[node.children[1]].aabb);
+			node.refit = false;
+		}
+
+		refit_queue.resize(0);
+		refit_nodes.resize(0);
+	}
+
+	/* FINALLY pair and unpair, in one batch */
+
+	int height = 0;
+	for (int t = 0; t < TREE_MAX; t++) {
+		if (root[t] != NODE_NULL)
+			height = MAX(height, nodes[root[t]].height);
+	}
+	int *stack = (int *)alloca(sizeof(int) * (height + 2));
+
+	for (int i = 0; i < update_queue.size(); i++) {
+
+		BVHElementID id = update_queue[i];
+		Element &e = elements.write[id - 1];
+		if (!e.userdata || !e.queued)
+			continue;
+
+		e.queued = false;
+		e.displacement = Vector3();
+		_update_pairs(id, stack);
+	}
+
+	update_queue.resize(0);
+}
+
+/* PUBLIC */
+
+template <class T>
+BVHElementID DynamicBVH<T>::create(T *p_userdata, const AABB &p_aabb, int p_subindex, bool p_pairable, uint32_t p_pairable_type, uint32_t p_pairable_mask) {
+
+	ERR_FAIL_COND_V(p_userdata == NULL, BVH_ELEMENT_INVALID_ID);
+
+	BVHElementID id;
+	if (free_elements.size()) {
+		id = free_elements[free_elements.size() - 1];
+		free_elements.resize(free_elements.size() - 1);
+	} else {
+		elements.resize(elements.size() + 1);
+		id = elements.size();
+	}
+
+	Element &e = elements.write[id - 1];
+	e.userdata = p_userdata;
+	e.subindex = p_subindex;
+	e.pairable = p_pairable;
+	e.pairable_type = p_pairable_type;
+	e.pairable_mask = p_pairable_mask;
+	e.aabb = p_aabb;
+	e.displacement = Vector3();
+	e.leaf = NODE_NULL;
+	e.tree = TREE_NON_PAIRABLE;
+	e.queued = false;
+
+	_queue_update(id);
+
+	return id;
+}
+
+template <class T>
+void DynamicBVH<T>::move(BVHElementID p_id, const AABB &p_aabb) {
+
+	ERR_FAIL_INDEX(p_id - 1, (BVHElementID)elements.size());
+	Element &e = elements.write[p_id - 1];
+	ERR_FAIL_COND(!e.userdata);
+
+	if (e.leaf != NODE_NULL && !e.aabb.has_no_surface()) {
+		e.displacement = p_aabb.position - e.aabb.position;
+	}
+
+	e.aabb = p_aabb;
+	_queue_update(p_id);
+}
+
+template <class T>
+void DynamicBVH<T>::set_pairable(BVHElementID p_id, bool p_pairable, uint32_t p_pairable_type, uint32_t p_pairable_mask) {
+
+	ERR_FAIL_INDEX(p_id - 1, (BVHElementID)elements.size());
+	Element &e = elements.write[p_id - 1];
+	ERR_FAIL_COND(!e.userdata);
+
+	e.pairable = p_pairable;
+	e.pairable_type = p_pairable_type;
+	e.pairable_mask = p_pairable_mask;
+
+	// pairs that are no longer allowed go away now, new ones are found on update()
+	for (int i = e.pairs.size() - 1; i >= 0; i--) {
+		if (!_test_pair(p_id, e.pairs[i]))
+			_unpair(p_id, e.pairs[i]);
+	}
+
+	_queue_update(p_id);
+}
+
+template <class T>
+void DynamicBVH<T>::erase(BVHElementID p_id) {
+
+	ERR_FAIL_INDEX(p_id - 1, (BVHElementID)elements.size());
+	ERR_FAIL_COND(!elements[p_id - 1].userdata);
+
+	//unpair must be done immediately on removal to avoid potential invalid pointers
+	while (elements[p_id - 1].pairs.size()) {
+		const Vector<BVHElementID> &pairs = elements[p_id - 1].pairs;
+		_unpair(p_id, pairs[pairs.size() - 1]);
+	}
+
+	Element &e = elements.write[p_id - 1];
+	if (e.leaf != NODE_NULL) {
+		_remove_leaf(root[e.tree], e.leaf);
+		_free_node(e.leaf);
+	}
+
+	e.userdata = NULL;
+	e.leaf = NODE_NULL;
+	e.queued = false;
+	free_elements.push_back(p_id);
+}
+
+template <class T>
+bool DynamicBVH<T>::is_pairable(BVHElementID p_id) const {
+
+	ERR_FAIL_INDEX_V(p_id - 1, (BVHElementID)elements.size(), false);
+	ERR_FAIL_COND_V(!elements[p_id - 1].userdata, false);
+	return elements[p_id - 1].pairable;
+}
+
+template <class T>
+T *DynamicBVH<T>::get(BVHElementID p_id) const {
+
+	ERR_FAIL_INDEX_V(p_id - 1, (BVHElementID)elements.size(), NULL);
+	return elements[p_id - 1].userdata;
+}
+
+template <class T>
+int DynamicBVH<T>::get_subindex(BVHElementID p_id) const {
+
+	ERR_FAIL_INDEX_V(p_id - 1, (BVHElementID)elements.size(), -1);
+	ERR_FAIL_COND_V(!elements[p_id - 1].userdata, -1);
+	return elements[p_id - 1].subindex;
+}
+
+/* CULLING */
+
+template <class T>
+int DynamicBVH<T>::cull_convex(const Vector<Plane> &p_convex, T **p_result_array, int p_result_max, uint32_t p_mask) const {
+
+	const Plane *planes = &p_convex[0];
+	int plane_count = p_convex.size();
+	int result_count = 0;
+
+	const Node *n = nodes.ptr();
+	const Element *el = elements.ptr();
+
+	for (int t = 0; t < TREE_MAX; t++) {
+
+		if (root[t] == NODE_NULL)
+			continue;
+
+		int *stack = (int *)alloca(sizeof(int) * (n[root[t]].height + 2));
+		int stack_size = 0;
+		stack[stack_size++] = root[t];
+
+		while (stack_size) {
+
+			const Node &node = n[stack[--stack_size]];
+			if (!node.aabb.intersects_convex_shape(planes, plane_count))
+				continue;
+
+			if (node.is_leaf()) {
+
+				const Element &e = el[node.element - 1];
+				if (!(e.pairable_type & p_mask) || !e.aabb.intersects_convex_shape(planes, plane_count))
+					continue;
+
+				if (result_count == p_result_max)
+					return result_count; // pointless to continue
+
+				p_result_array[result_count++] = e.userdata;
+			} else {
+
+				stack[stack_size++] = node.children[0];
+				stack[stack_size++] = node.children[1];
+			}
+		}
+	}
+
+	return result_count;
+}
+
+template <class T>
+void DynamicBVH<T>::_cull_convex_part(_CullConvexPart *p_part, const _CullConvexThreadedData *p_cull) const {
+
+	const Node *n = nodes.ptr();
+	const Element *el = elements.ptr();
+
+	int *stack = (int *)alloca(sizeof(int) * (n[p_part->node].height + 2));
+	int stack_size = 0;
+	stack[stack_size++] = p_part->node;
+
+	while (stack_size) {
+
+		const Node &node = n[stack[--stack_size]];
+		if (!node.aabb.intersects_convex_shape(p_cull->planes, p_cull->plane_count))
+			continue;
+
+		if (node.is_leaf()) {
+
+			const Element &e = el[node.element - 1];
+			if (!(e.pairable_type & p_cull->mask) || !e.aabb.intersects_convex_shape(p_cull->planes, p_cull->plane_count))
+				continue;
+
+			if (p_part->result_count == p_part->result_capacity) {
+
+				if (p_part->result_capacity == p_cull->result_max)
+					return; // pointless to continue
+
+				p_part->result_capacity = MIN(MAX(p_part->result_capacity * 2, 64), p_cull->result_max);
+				p_part->results = (T **)memrealloc(p_part->results, sizeof(T *) * p_part->result_capacity);
+			}
+
+			p_part->results[p_part->result_count++] = e.userdata;
+		} else {
+
+			stack[stack_size++] = node.children[0];
+			stack[stack_size++] = node.children[1];
+		}
+	}
+}
+
+template <class T>
+void DynamicBVH<T>::_cull_convex_part_func(void *p_userdata, uint32_t p_from, uint32_t p_to) {
+
+	const _CullConvexThreadedData *cull = (const _CullConvexThreadedData *)p_userdata;
+
+	for (uint32_t i = p_from; i < p_to; i++) {
+		cull->bvh->_cull_convex_part(&cull->parts[i], cull);
+	}
+}
+
+template <class T>
+int DynamicBVH<T>::cull_convex_threaded(const Vector<Plane> &p_convex, T **p_result_array, int p_result_max, uint32_t p_mask, int p_max_threads) const {
+
+	if (p_result_max <= 0)
+		return 0;
+
+	const Plane *planes = &p_convex[0];
+	int plane_count = p_convex.size();
+	const Node *n = nodes.ptr();
+
+	_CullConvexPart parts[BVH_CULL_PARTS_MAX];
+	int part_count = 0;
+
+	for (int t = 0; t < TREE_MAX; t++) {
+		if (root[t] != NODE_NULL) {
+			parts[part_count++].node = root[t];
+		}
+	}
+
+	// Split breadth first, one tree level per pass: a visible node is replaced
+	// by its children, so parts end up as subtrees of similar height rather
+	// than one deep branch split to the bottom. Leaves belong to one node
+	// only, so parts never find the same element twice.
+	bool split = true;
+	while (split && part_count < BVH_CULL_PARTS_MAX) {
+
+		split = false;
+		int level_count = part_count;
+
+		for (int i = 0; i < level_count && part_count < BVH_CULL_PARTS_MAX; i++) {
+
+			if (parts[i].node == NODE_NULL)
+				continue;
+
+			const Node &node = n[parts[i].node];
+			if (node.is_leaf())
+				continue;
+
+			if (!node.aabb.intersects_convex_shape(planes, plane_count)) {
+				parts[i].node = NODE_NULL;
+				continue;
+			}
+
+			parts[i].node = node.children[0];
+			parts[part_count++].node = node.children[1];
+			split = true;
+		}
+	}
+
+	int used_parts = 0;
+	for (int i = 0; i < part_count; i++) {
+
+		if (parts[i].node == NODE_NULL)
+			continue;
+
+		_CullConvexPart &part = parts[used_parts++];
+		part.node = parts[i].node;
+		part.results = NULL;
+		part.result_count = 0;
+		part.result_capacity = 0;
+	}
+
+	_CullConvexThreadedData cdata;
+	cdata.bvh = this;
+	cdata.planes = planes;
+	cdata.plane_count = plane_count;
+	cdata.result_max = p_result_max;
+	cdata.mask = p_mask;
+	cdata.parts = parts;
+
+	if (WorkerThreadPool::get_singleton()) {
+		WorkerThreadPool::get_singleton()->parallel_for(used_parts, 1, _cull_convex_part_func, &cdata, p_max_threads);
+	} else {
+		_cull_convex_part_func(&cdata, 0, used_parts);
+	}
+
+	// Merge, every part has its own results so no locking was needed.
+	int result_count = 0;
+	for (int i = 0; i < used_parts; i++) {
+
+		int count = MIN(parts[i].result_count, p_result_max - result_count);
+		if (count > 0) {
+			copymem(&p_result_array[result_count], parts[i].results, sizeof(T *) * count);
+			result_count += count;
+		}
+
+		if (parts[i].results)
+			memfree(parts[i].results);
+	}
+
+	return result_count;
+}
+
+template <class T>
+int DynamicBVH<T>::cull_aabb(const AABB &p_aabb, T **p_result_array, int p_result_max, int *p_subindex_array, uint32_t p_mask) const {
+
+	int result_count = 0;
+
+	const Node *n = nodes.ptr();
+	const Element *el = elements.ptr();
+
+	for (int t = 0; t < TREE_MAX; t++) {
+
+		if (root[t] == NODE_NULL)
+			continue;
+
+		int *stack = (int *)alloca(sizeof(int) * (n[root[t]].height + 2));
+		int stack_size = 0;
+		stack[stack_size++] = root[t];
+
+		while (stack_size) {
+
+			const Node &node = n[stack[--stack_size]];
+			if (!node.aabb.intersects_inclusive(p_aabb))
+				continue;
+
+			if (node.is_leaf()) {
+
+				const Element &e = el[node.element - 1];
+				if (!(e.pairable_type & p_mask) || !p_aabb.intersects_inclusive(e.aabb))
+					continue;
+
+				if (result_count == p_result_max)
+					return result_count; // pointless to continue
+
+				if (p_subindex_array)
+					p_subindex_array[result_count] = e.subindex;
+				p_result_array[result_count++] = e.userdata;
+			} else {
+
+				stack[stack_size++] = node.children[0];
+				stack[stack_size++] = node.children[1];
+			}
+		}
+	}
+
+	return result_count;
+}
+
+template <class T>
+int DynamicBVH<T>::cull_segment(const Vector3 &p_from, const Vector3 &p_to, T **p_result_array, int p_result_max, int *p_subindex_array, uint32_t p_mask) const {
+
+	int result_count = 0;
+
+	const Node *n = nodes.ptr();
+	const Element *el = elements.ptr();
+
+	for (int t = 0; t < TREE_MAX; t++) {
+
+		if (root[t] == NODE_NULL)
+			continue;
+
+		int *stack = (int *)alloca(sizeof(int) * (n[root[t]].height + 2));
+		int stack_size = 0;
+		stack[stack_size++] = root[t];
+
+		while (stack_size) {
+
+			const Node &node = n[stack[--stack_size]];
+			if (!node.aabb.intersects_segment(p_from, p_to))
+				continue;
+
+			if (node.is_leaf()) {
+
+				const Element &e = el[node.element - 1];
+				if (!(e.pairable_type & p_mask) || !e.aabb.intersects_segment(p_from, p_to))
+					continue;
+
+				if (result_count == p_result_max)
+					return result_count; // pointless to continue
+
+				if (p_subindex_array)
+					p_subindex_array[result_count] = e.subindex;
+				p_result_array[result_count++] = e.userdata;
+			} else {
+
+				stack[stack_size++] = node.children[0];
+				stack[stack_size++] = node.children[1];
+			}
+		}
+	}
+
+	return result_count;
+}
+
+template <class T>
+int DynamicBVH<T>::cull_point(const Vector3 &p_point, T **p_result_array, int p_result_max, int *p_subindex_array, uint32_t p_mask) const {
+
+	int result_count = 0;
+
+	const Node *n = nodes.ptr();
+	const Element *el = elements.ptr();
+
+	for (int t = 0; t < TREE_MAX; t++) {
+
+		if (root[t] == NODE_NULL)
+			continue;
+
+		int *stack = (int *)alloca(sizeof(int) * (n[root[t]].height + 2));
+		int stack_size = 0;
+		stack[stack_size++] = root[t];
+
+		while (stack_size) {
+
+			const Node &node = n[stack[--stack_size]];
+			if (!node.aabb.has_point(p_point))
+				continue;
+
+			if (node.is_leaf()) {
+
+				const Element &e = el[node.element - 1];
+				if (!(e.pairable_type & p_mask) || !e.aabb.has_point(p_point))
+					continue;
+
+				if (result_count == p_result_max)
+					return result_count; // pointless to continue
+
+				if (p_subindex_array)
+					p_subindex_array[result_count] = e.subindex;
+				p_result_array[result_count++] = e.userdata;
+			} else {
+
+				stack[stack_size++] = node.children[0];
+				stack[stack_size++] = node.children[1];
+			}
+		}
+	}
+
+	return result_count;
+}
+
+template <class T>
+void DynamicBVH<T>::set_pair_callback(PairCallback p_callback, void *p_userdata) {
+
+	pair_callback = p_callback;
+	pair_callback_userdata = p_userdata;
+}
+
+template <class T>
+void DynamicBVH<T>::set_unpair_callback(UnpairCallback p_callback, void *p_userdata) {
+
+	unpair_callback = p_callback;
+	unpair_callback_userdata = p_userdata;
+}
+
+template <class T>
+int DynamicBVH<T>::get_tree_height() const {
+
+	int height = 0;
+	for (int t = 0; t < TREE_MAX; t++) {
+		if (root[t] != NODE_NULL)
+			height = MAX(height, nodes[root[t]].height);
+	}
+	return height;
+}
+
+template <class T>
+DynamicBVH<T>::DynamicBVH() {
+
+	for (int t = 0; t < TREE_MAX; t++) {
+		root[t] = NODE_NULL;
+	}
+	pair_count = 0;
+	pair_callback = NULL;
+	unpair_callback = NULL;
+	pair_callback_userdata = NULL;
+	unpair_callback_userdata = NULL;
+}
+
+template <class T>
+DynamicBVH<T>::~DynamicBVH() {
+}
+
+#endif // DYNAMIC_BVH_H
@@ -35,6 +35,7 @@
 #include "core/map.h"
 #include "core/math/aabb.h"
 #include "core/math/vector3.h"
+#include "core/os/worker_thread_pool.h"
 #include "core/print_string.h"
 #include "core/variant.h"
 
@@ -46,6 +47,7 @@ typedef uint32_t OctreeElementID;
 
 #define OCTREE_ELEMENT_INVALID_ID 0
 #define OCTREE_SIZE_LIMIT 1e15
+#define OCTREE_CULL_PARTS_MAX 64
 
 template <class T, bool use_pairs = false, class AL = DefaultAllocator>
 class Octree {
@@ -352,6 +354,30 @@ private:
 	};
 
 	void _cull_convex(Octant *p_octant, _CullConvexData *p_cull);
+
+	struct _CullConvexPart {
+
+		Octant *octant;
+		bool recurse; // when false, only the octant's own elements are culled, its children are other parts
+		T **results;
+		int result_count;
+		int result_capacity;
+	};
+
+	struct _CullConvexThreadedData {
+
+		const Octree *octree;
+		const Plane *planes;
+		int plane_count;
+		int result_max;
+		uint32_t mask;
+		_CullConvexPart *parts;
+	};
+
+	bool _cull_convex_is_first_owner(const Element *p_element, const Octant *p_octant, const Plane *p_planes, int p_plane_count) const;
+	bool _cull_convex_elements(const List<Element *, AL> &p_elements, const Octant *p_octant, const _CullConvexThreadedData *p_cull, _CullConvexPart *p_part) const;
+	bool _cull_convex_part(const Octant *p_octant, bool p_recurse, const _CullConvexThreadedData *p_cull, _CullConvexPart *p_part) const;
+	static void _cull_convex_part_func(void *p_userdata, uint32_t p_from, uint32_t p_to);
 	void _cull_aabb(Octant *p_octant, const AABB &p_aabb, T **p_result_array, int *p_result_idx, int p_result_max, int *p_subindex_array, uint32_t p_mask);
 	void _cull_segment(Octant *p_octant, const Vector3 &p_from, const Vector3 &p_to, T **p_result_array, int *p_result_idx, int p_result_max, int *p_subindex_array, uint32_t p_mask);
 	void _cull_point(Octant *p_octant, const Vector3 &p_point, T **p_result_array, int *p_result_idx, int p_result_max, int *p_subindex_array, uint32_t p_mask);
@@ -381,6 +407,9 @@ public:
 	int get_subindex(OctreeElementID p_id) const;
 
 	int cull_convex(const Vector<Plane> &p_convex, T **p_result_array, int p_result_max, uint32_t p_mask = 0xFFFFFFFF);
+	// Same as cull_convex(), but split over subtrees that are culled on the WorkerThreadPool.
+	// It doesn't modify the octree, so several of these can run at the same time.
+	int cull_convex_threaded(const Vector<Plane> &p_convex, T **p_result_array, int p_result_max, uint32_t p_mask = 0xFFFFFFFF, int p_max_threads = -1) const;
 	int cull_aabb(const AABB &p_aabb, T **p_result_array, int p_result_max, int *p_subindex_array = NULL, uint32_t p_mask = 0xFFFFFFFF);
 	int cull_segment(const Vector3 &p_from, const Vector3 &p_to, T **p_result_array, int p_result_max, int *p_subindex_array = NULL, uint32_t p_mask = 0xFFFFFFFF);
 
@@ -1072,6 +1101,102 @@ void Octree<T, use_pairs, AL>::_cull_convex(Octant *p_octant, _CullConvexData *p
 	}
 }
 
+template <class T, bool use_pairs, class AL>
+bool Octree<T, use_pairs, AL>::_cull_convex_is_first_owner(const Element *p_element, const Octant *p_octant, const Plane *p_planes, int p_plane_count) const {
+
+	// Elements in more than one octant are reported only from the first of
+	// them the cull enters, instead of marking them with the pass. An owner is
+	// entered when it and all its parents up to the common parent intersect
+	// the convex (the common parent is a parent of p_octant, so it's entered).
+
+	for (const typename List<typename Element::OctantOwner, AL>::Element *I = p_element->octant_owners.front(); I; I = I->next()) {
+
+		const Octant *o = I->get().octant;
+		if (o == p_octant)
+			return true;
+
+		bool entered = true;
+		for (; o && o != p_element->common_parent; o = o->parent) {
+
+			if (!o->aabb.intersects_convex_shape(p_planes, p_plane_count)) {
+				entered = false;
+				break;
+			}
+		}
+
+		if (entered)
+			return false;
+	}
+
+	return true;
+}
+
+template <class T, bool use_pairs, class AL>
+bool Octree<T, use_pairs, AL>::_cull_convex_elements(const List<Element *, AL> &p_elements, const Octant *p_octant, const _CullConvexThreadedData *p_cull, _CullConvexPart *p_part) const {
+
+	for (const typename List<Element *, AL>::Element *I = p_elements.front(); I; I = I->next()) {
+
+		const Element *e = I->get();
+
+		if (use_pairs && !(e->pairable_type & p_cull->mask))
+			continue;
+
+		if (e->octant_owners.size() > 1 && !_cull_convex_is_first_owner(e, p_octant, p_cull->planes, p_cull->plane_count))
+			continue;
+
+		if (!e->aabb.intersects_convex_shape(p_cull->planes, p_cull->plane_count))
+			continue;
+
+		if (p_part->result_count == p_part->result_capacity) {
+
+			if (p_part->result_capacity == p_cull->result_max)
+				return false; // pointless to continue
+
+			p_part->result_capacity = MIN(MAX(p_part->result_capacity * 2, 64), p_cull->result_max);
+			p_part->results = (T **)memrealloc(p_part->results, sizeof(T *) * p_part->result_capacity);
+		}
+
+		p_part->results[p_part->result_count++] = e->userdata;
+	}
+
+	return true;
+}
+
+template <class T, bool use_pairs, class AL>
+bool Octree<T, use_pairs, AL>::_cull_convex_part(const Octant *p_octant, bool p_recurse, const _CullConvexThreadedData *p_cull, _CullConvexPart *p_part) const {
+
+	if (!_cull_convex_elements(p_octant->elements, p_octant, p_cull, p_part))
+		return false;
+
+	if (use_pairs && !_cull_convex_elements(p_octant->pairable_elements, p_octant, p_cull, p_part))
+		return false;
+
+	if (!p_recurse)
+		return true;
+
+	for (int i = 0; i < 8; i++) {
+
+		if (p_octant->children[i] && p_octant->children[i]->aabb.intersects_convex_shape(p_cull->planes, p_cull->plane_count)) {
+			if (!_cull_convex_part(p_octant->children[i], true, p_cull, p_part))
+				return false;
+		}
+	}
+
+	return true;
+}
+
+template <class T, bool use_pairs, class AL>
+void Octree<T, use_pairs, AL>::_cull_convex_part_func(void *p_userdata, uint32_t p_from, uint32_t p_to) {
+
+	const _CullConvexThreadedData *cull = (const _CullConvexThreadedData *)p_userdata;
+
+	for (uint32_t i = p_from; i < p_to; i++) {
+
+		_CullConvexPart *part = &cull->parts[i];
+		cull->octree->_cull_convex_part(part->octant, part->recurse, cull, part);
+	}
+}
+
 template <class T, bool use_pairs, class AL>
 void Octree<T, use_pairs, AL>::_cull_aabb(Octant *p_octant, const AABB &p_aabb, T **p_result_array, int *p_result_idx, int p_result_max, int *p_subindex_array, uint32_t p_mask) {
 
@@ -1313,6 +1438,78 @@ int Octree<T, use_pairs, AL>::cull_convex(const Vector<Plane> &p_convex, T **p_r
 	return result_count;
 }
 
+template <class T, bool use_pairs, class AL>
+int Octree<T, use_pairs, AL>::cull_convex_threaded(const Vector<Plane> &p_convex, T **p_result_array, int p_result_max, uint32_t p_mask, int p_max_threads) const {
+
+	if (!root || p_result_max <= 0)
+		return 0;
+
+	_CullConvexPart parts[OCTREE_CULL_PARTS_MAX];
+	int part_count = 1;
+	parts[0].octant = root;
+	parts[0].recurse = true;
+
+	const Plane *planes = &p_convex[0];
+	int plane_count = p_convex.size();
+
+	// Split breadth first: an octant handing its visible children to new parts
+	// keeps only its own elements. The split doesn't depend on the thread
+	// count, so neither does the order of the results.
+	for (int i = 0; i < part_count; i++) {
+
+		const Octant *o = parts[i].octant;
+		if (o->children_count == 0 || part_count + o->children_count > OCTREE_CULL_PARTS_MAX)
+			continue;
+
+		parts[i].recurse = false;
+
+		for (int j = 0; j < 8; j++) {
+
+			if (o->children[j] && o->children[j]->aabb.intersects_convex_shape(planes, plane_count)) {
+				parts[part_count].octant = o->children[j];
+				parts[part_count].recurse = true;
+				part_count++;
+			}
+		}
+	}
+
+	for (int i = 0; i < part_count; i++) {
+		parts[i].results = NULL;
+		parts[i].result_count = 0;
+		parts[i].result_capacity = 0;
+	}
+
+	_CullConvexThreadedData cdata;
+	cdata.octree = this;
+	cdata.planes = planes;
+	cdata.plane_count = plane_count;
+	cdata.result_max = p_result_max;
+	cdata.mask = p_mask;
+	cdata.parts = parts;
+
+	if (WorkerThreadPool::get_singleton()) {
+		WorkerThreadPool::get_singleton()->parallel_for(part_count, 1, _cull_convex_part_func, &cdata, p_max_threads);
+	} else {
+		_cull_convex_part_func(&cdata, 0, part_count);
+	}
+
+	// Merge, every part has its own results so no locking was needed.
+	int result_count = 0;
+	for (int i = 0; i < part_count; i++) {
+
+		int count = MIN(parts[i].result_count, p_result_max - result_count);
+		if (count > 0) {
+			copymem(&p_result_array[result_count], parts[i].results, sizeof(T *) * count);
+			result_count += count;
+		}
+
+		if (parts[i].results)
+			memfree(parts[i].results);
+	}
+
+	return result_count;
+}
+
 template <class T, bool use_pairs, class AL>
 int Octree<T, use_pairs, AL>::cull_aabb(const AABB &p_aabb, T **p_result_array, int p_result_max, int *p_subindex_array, uint32_t p_mask) {
 
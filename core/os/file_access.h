@@ -110,6 +110,7 @@ public:
 	virtual real_t get_real() const;
 
 	virtual int get_buffer(uint8_t *p_dst, int p_length) const; ///< get an array of bytes
+	virtual const uint8_t *get_buffer_view(int p_length) const { return NULL; } ///< get the next p_length bytes in place, without copying. Valid until the file is closed, NULL if unsupported (use get_buffer then)
 	virtual String get_line() const;
 	virtual String get_token() const;
 	virtual Vector<String> get_csv_line(String delim = ",") const;
@@ -148,6 +149,8 @@ public:
 
 	virtual Error _chmod(const String &p_path, int p_mod) { return ERR_UNAVAILABLE; }
 
+	virtual const uint8_t *map_read_only(uint64_t &r_size) { return NULL; } ///< map the whole open file into memory for reading. Valid until the file is closed, NULL if unsupported
+
 	static FileAccess *create(AccessType p_access); /// Create a file access (for the current platform) this is the only portable way of accessing files.
 	static FileAccess *create_for_path(const String &p_path);
 	static FileAccess *open(const String &p_path, int p_mode_flags, Error *r_error = NULL); /// Create a file access (for the current platform) this is the only portable way of accessing files.
@@ -0,0 +1,477 @@
+/*************************************************************************/
+/*  worker_thread_pool.cpp                                               */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2018 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2018 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "worker_thread_pool.h"
+
+#include "core/os/os.h"
+#include "core/safe_refcount.h"
+
+WorkerThreadPool *WorkerThreadPool::singleton = NULL;
+
+WorkerThreadPool *WorkerThreadPool::get_singleton() {
+
+	return singleton;
+}
+
+/* TASK QUEUE */
+
+void WorkerThreadPool::TaskQueue::push_back(const Task &p_task) {
+
+	if (count == capacity) {
+		uint32_t new_capacity = capacity ? capacity * 2 : 64;
+		Task *new_tasks = (Task *)memalloc(sizeof(Task) * new_capacity);
+		for (uint32_t i = 0; i < count; i++) {
+			new_tasks[i] = tasks[(head + i) % capacity];
+		}
+		if (tasks) {
+			memfree(tasks);
+		}
+		tasks = new_tasks;
+		capacity = new_capacity;
+		head = 0;
+	}
+
+	tasks[(head + count) % capacity] = p_task;
+	count++;
+}
+
+bool WorkerThreadPool::TaskQueue::pop_back(Task &r_task) {
+
+	if (count == 0)
+		return false;
+
+	count--;
+	r_task = tasks[(head + count) % capacity];
+	return true;
+}
+
+bool WorkerThreadPool::TaskQueue::pop_front(Task &r_task) {
+
+	if (count == 0)
+		return false;
+
+	r_task = tasks[head];
+	head = (head + 1) % capacity;
+	count--;
+	return true;
+}
+
+/* WORKERS */
+
+void WorkerThreadPool::_thread_func(void *p_userdata) {
+
+	ThreadData *td = (ThreadData *)p_userdata;
+	WorkerThreadPool *pool = td->pool;
+
+	td->id = Thread::get_caller_id();
+	Thread::set_name("WorkerThreadPool " + itos(td->index));
+
+	while (true) {
+
+		pool->task_semaphore->wait();
+		if (pool->exit_threads)
+			break;
+
+		Task task;
+		while (pool->_pop_task(td->index, task)) {
+			pool->_run_task(task);
+		}
+	}
+}
+
+int WorkerThreadPool::_get_thread_index() const {
+
+	if (thread_count == 0)
+		return -1;
+
+	Thread::ID id = Thread::get_caller_id();
+	for (int i = 0; i < thread_count; i++) {
+		if (threads[i].id == id)
+			return i;
+	}
+
+	return -1;
+}
+
+void WorkerThreadPool::_push_tasks(const Task *p_tasks, int p_count) {
+
+	int index = _get_thread_index();
+	TaskQueue &queue = queues[index >= 0 ? index : thread_count];
+
+	queue.mutex->lock();
+	for (int i = 0; i < p_count; i++) {
+		queue.push_back(p_tasks[i]);
+	}
+	queue.mutex->unlock();
+
+	int wake = MIN(p_count, thread_count);
+	for (int i = 0; i < wake; i++) {
+		task_semaphore->post();
+	}
+}
+
+bool WorkerThreadPool::_pop_task(int p_thread_index, Task &r_task) {
+
+	// Own tasks first (most recently pushed, likely still in cache), then
+	// those submitted from outside the pool, then steal from the others.
+	if (p_thread_index >= 0) {
+		TaskQueue &own = queues[p_thread_index];
+		own.mutex->lock();
+		bool found = own.pop_back(r_task);
+		own.mutex->unlock();
+		if (found)
+			return true;
+	}
+
+	for (uint32_t i = 0; i < queue_count; i++) {
+
+		uint32_t index = (thread_count + i) % queue_count;
+		if ((int)index == p_thread_index)
+			continue;
+
+		TaskQueue &queue = queues[index];
+		if (queue.count == 0)
+			continue; //unlocked peek, it's fine to miss a task here
+
+		queue.mutex->lock();
+		bool found = queue.pop_front(r_task);
+		queue.mutex->unlock();
+		if (found)
+			return true;
+	}
+
+	return false;
+}
+
+void WorkerThreadPool::_run_task(const Task &p_task) {
+
+	p_task.func(p_task.userdata);
+
+	if (atomic_decrement(&p_task.group->pending_tasks) == 0) {
+		_group_done(p_task.group);
+	}
+}
+
+/* TASK GROUPS */
+
+void WorkerThreadPool::_group_release(Group *p_group) {
+
+	// Called with group_mutex held.
+	int count = p_group->tasks.size();
+	if (count == 0) {
+		_group_done(p_group);
+		return;
+	}
+
+	p_group->pending_tasks = count;
+	_push_tasks(p_group->tasks.ptr(), count);
+	p_group->tasks.clear();
+}
+
+void WorkerThreadPool::_group_done(Group *p_group) {
+
+	group_mutex->lock();
+
+	for (int i = 0; i < p_group->dependents.size(); i++) {
+		Group *dependent = p_group->dependents[i];
+		dependent->pending_dependencies--;
+		if (dependent->pending_dependencies == 0 && dependent->submitted) {
+			_group_release(dependent);
+		}
+	}
+	p_group->dependents.clear();
+
+	// Set last, a waiter may free the group as soon as it sees it done.
+	p_group->done = true;
+
+	group_mutex->unlock();
+}
+
+void WorkerThreadPool::_wait(Group *p_group) {
+
+	int index = _get_thread_index();
+	int spins = 0;
+
+	while (!p_group->done) {
+
+		Task task;
+		if (_pop_task(index, task)) {
+			_run_task(task);
+			spins = 0;
+		} else if (spins < 1000) {
+			spins++;
+		} else {
+			// Nothing left to help with, the remaining tasks are running elsewhere.
+			OS::get_singleton()->delay_usec(1);
+		}
+	}
+
+	// Make sure _group_done() has let go of the group.
+	group_mutex->lock();
+	group_mutex->unlock();
+}
+
+WorkerThreadPool::GroupID WorkerThreadPool::group_create() {
+
+	Group *group = memnew(Group);
+	group->pending_tasks = 0;
+	group->pending_dependencies = 0;
+	group->done = false;
+	group->submitted = false;
+	return group;
+}
+
+void WorkerThreadPool::group_add_task(GroupID p_group, TaskFunc p_func, void *p_userdata) {
+
+	ERR_FAIL_COND(!p_group);
+	ERR_FAIL_COND(p_group->submitted);
+
+	Task task;
+	task.func = p_func;
+	task.userdata = p_userdata;
+	task.group = p_group;
+	p_group->tasks.push_back(task);
+}
+
+void WorkerThreadPool::group_add_dependency(GroupID p_group, GroupID p_depends_on) {
+
+	ERR_FAIL_COND(!p_group || !p_depends_on);
+	ERR_FAIL_COND(p_group == p_depends_on);
+	ERR_FAIL_COND(p_group->submitted);
+
+	group_mutex->lock();
+	if (!p_depends_on->done) {
+		p_depends_on->dependents.push_back(p_group);
+		p_group->pending_dependencies++;
+	}
+	group_mutex->unlock();
+}
+
+void WorkerThreadPool::group_submit(GroupID p_group) {
+
+	ERR_FAIL_COND(!p_group);
+	ERR_FAIL_COND(p_group->submitted);
+
+	group_mutex->lock();
+	p_group->submitted = true;
+	if (p_group->pending_dependencies == 0) {
+		_group_release(p_group);
+	}
+	group_mutex->unlock();
+}
+
+bool WorkerThreadPool::group_is_done(GroupID p_group) const {
+
+	ERR_FAIL_COND_V(!p_group, true);
+	return p_group->done;
+}
+
+void WorkerThreadPool::group_wait(GroupID p_group) {
+
+	ERR_FAIL_COND(!p_group);
+	// not freed, it may still be listed as a dependent of another group
+	ERR_FAIL_COND(!p_group->submitted);
+
+	_wait(p_group);
+	memdelete(p_group);
+}
+
+/* PARALLEL FOR */
+
+void WorkerThreadPool::_parallel_for_func(void *p_userdata) {
+
+	ParallelFor *pf = (ParallelFor *)p_userdata;
+
+	while (true) {
+		uint32_t from = atomic_add(&pf->next, pf->grain) - pf->grain;
+		if (from >= pf->elements)
+			break;
+		uint32_t to = MIN(from + pf->grain, pf->elements);
+		pf->func(pf->userdata, from, to);
+	}
+}
+
+void WorkerThreadPool::parallel_for(uint32_t p_elements, uint32_t p_grain, RangeFunc p_func, void *p_userdata, int p_max_threads) {
+
+	if (p_elements == 0)
+		return;
+
+	if (p_grain == 0)
+		p_grain = 1;
+
+	uint32_t chunks = (p_elements - 1) / p_grain + 1;
+
+	if (thread_count == 0 || chunks == 1 || p_max_threads == 0 || p_max_threads == 1) {
+		for (uint32_t from = 0; from < p_elements; from += p_grain) {
+			p_func(p_userdata, from, MIN(from + p_grain, p_elements));
+		}
+		return;
+	}
+
+	ParallelFor pf;
+	pf.func = p_func;
+	pf.userdata = p_userdata;
+	pf.elements = p_elements;
+	pf.grain = p_grain;
+	pf.next = 0;
+
+	// The calling thread takes part too, so one runner less is needed.
+	int runners = MIN((uint32_t)thread_count, chunks - 1);
+	if (p_max_threads > 0) {
+		runners = MIN(runners, p_max_threads - 1);
+	}
+
+	Group group;
+	group.pending_tasks = runners;
+	group.pending_dependencies = 0;
+	group.done = false;
+	group.submitted = true;
+
+	Task task;
+	task.func = _parallel_for_func;
+	task.userdata = &pf;
+	task.group = &group;
+
+	Task *tasks = (Task *)alloca(sizeof(Task) * runners);
+	for (int i = 0; i < runners; i++) {
+		tasks[i] = task;
+	}
+	_push_tasks(tasks, runners);
+
+	_parallel_for_func(&pf);
+	_wait(&group);
+}
+
+/* SETUP */
+
+void WorkerThreadPool::_setup_queues(uint32_t p_count) {
+
+	for (uint32_t i = 0; i < queue_count; i++) {
+		memdelete(queues[i].mutex);
+		if (queues[i].tasks)
+			memfree(queues[i].tasks);
+	}
+	if (queues)
+		memdelete_arr(queues);
+
+	queues = NULL;
+	queue_count = p_count;
+	if (p_count == 0)
+		return;
+
+	queues = memnew_arr(TaskQueue, queue_count);
+	for (uint32_t i = 0; i < queue_count; i++) {
+		queues[i].mutex = Mutex::create();
+		queues[i].tasks = NULL;
+		queues[i].capacity = 0;
+		queues[i].head = 0;
+		queues[i].count = 0;
+	}
+}
+
+void WorkerThreadPool::init(int p_thread_count) {
+
+	finish();
+
+#ifdef NO_THREADS
+	p_thread_count = 0;
+#else
+	if (p_thread_count < 0) {
+		// Leave a core for the thread that dispatches the work.
+		p_thread_count = MAX(1, OS::get_singleton()->get_processor_count() - 1);
+	}
+#endif
+
+	if (p_thread_count == 0)
+		return;
+
+	thread_count = p_thread_count;
+	_setup_queues(thread_count + 1);
+
+	exit_threads = false;
+	threads = memnew_arr(ThreadData, thread_count);
+	for (int i = 0; i < thread_count; i++) {
+		threads[i].pool = this;
+		threads[i].id = 0;
+		threads[i].index = i;
+	}
+	for (int i = 0; i < thread_count; i++) {
+		threads[i].thread = Thread::create(_thread_func, &threads[i]);
+	}
+}
+
+void WorkerThreadPool::finish() {
+
+	if (!threads)
+		return;
+
+	exit_threads = true;
+	for (int i = 0; i < thread_count; i++) {
+		task_semaphore->post();
+	}
+	for (int i = 0; i < thread_count; i++) {
+		Thread::wait_to_finish(threads[i].thread);
+		memdelete(threads[i].thread);
+	}
+
+	memdelete_arr(threads);
+	threads = NULL;
+	thread_count = 0;
+
+	_setup_queues(1);
+}
+
+WorkerThreadPool::WorkerThreadPool() {
+
+	singleton = this;
+
+	threads = NULL;
+	thread_count = 0;
+	exit_threads = false;
+
+	// Until init() is called, work submitted to the pool runs on the caller.
+	queues = NULL;
+	queue_count = 0;
+	_setup_queues(1);
+
+	task_semaphore = Semaphore::create();
+	group_mutex = Mutex::create();
+}
+
+WorkerThreadPool::~WorkerThreadPool() {
+
+	finish();
+	_setup_queues(0);
+
+	memdelete(task_semaphore);
+	memdelete(group_mutex);
+
+	singleton = NULL;
+}
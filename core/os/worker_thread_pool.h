@@ -0,0 +1,186 @@
+/*************************************************************************/
+/*  worker_thread_pool.h                                                 */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2018 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2018 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef WORKER_THREAD_POOL_H
+#define WORKER_THREAD_POOL_H
+
+#include "core/os/mutex.h"
+#include "core/os/semaphore.h"
+#include "core/os/thread.h"
+#include "core/vector.h"
+
+/**
+ * Persistent, engine-wide pool of worker threads.
+ *
+ * Every worker owns a task deque: it pushes and pops from the back of its own
+ * deque and steals from the front of the others when it runs out of work.
+ * Threads that are not part of the pool submit work through a shared queue.
+ * Waiting on work (group_wait(), parallel_for()) never just blocks, the
+ * waiting thread runs pending tasks until the work it waits for is done, so
+ * nesting parallel work from inside a task is safe.
+ *
+ * When the engine is built with NO_THREADS, or the pool was initialized with
+ * zero threads, all work runs on the calling thread.
+ */
+
+class WorkerThreadPool {
+public:
+	typedef void (*TaskFunc)(void *p_userdata);
+	typedef void (*RangeFunc)(void *p_userdata, uint32_t p_from, uint32_t p_to);
+
+	struct Group;
+	typedef Group *GroupID;
+
+private:
+	struct Task {
+		TaskFunc func;
+		void *userdata;
+		Group *group;
+	};
+
+	struct TaskQueue {
+		Mutex *mutex;
+		Task *tasks;
+		uint32_t capacity;
+		uint32_t head;
+		uint32_t count;
+
+		void push_back(const Task &p_task);
+		bool pop_back(Task &r_task);
+		bool pop_front(Task &r_task);
+	};
+
+	struct ThreadData {
+		WorkerThreadPool *pool;
+		Thread *thread;
+		Thread::ID id;
+		int index;
+	};
+
+	struct ParallelFor {
+		RangeFunc func;
+		void *userdata;
+		uint32_t elements;
+		uint32_t grain;
+		volatile uint32_t next;
+	};
+
+	static WorkerThreadPool *singleton;
+
+	ThreadData *threads;
+	int thread_count;
+
+	// One deque per worker, plus a shared one (the last) for external threads.
+	TaskQueue *queues;
+	uint32_t queue_count;
+
+	Semaphore *task_semaphore;
+	Mutex *group_mutex;
+	volatile bool exit_threads;
+
+	static void _thread_func(void *p_userdata);
+	static void _parallel_for_func(void *p_userdata);
+
+	void _setup_queues(uint32_t p_count);
+	int _get_thread_index() const;
+	void _push_tasks(const Task *p_tasks, int p_count);
+	bool _pop_task(int p_thread_index, Task &r_task);
+	void _run_task(const Task &p_task);
+	void _group_release(Group *p_group);
+	void _group_done(Group *p_group);
+	void _wait(Group *p_group);
+
+public:
+	struct Group {
+		volatile uint32_t pending_tasks;
+		uint32_t pending_dependencies;
+		volatile bool done;
+		bool submitted;
+		Vector<Task> tasks;
+		Vector<Group *> dependents;
+	};
+
+	static WorkerThreadPool *get_singleton();
+
+	/* TASK GROUPS */
+
+	// A group collects tasks that are started together once it is submitted
+	// and all the groups it depends on are done. Every group must be waited
+	// on exactly once, which also frees it.
+	GroupID group_create();
+	void group_add_task(GroupID p_group, TaskFunc p_func, void *p_userdata);
+	void group_add_dependency(GroupID p_group, GroupID p_depends_on);
+	void group_submit(GroupID p_group);
+	bool group_is_done(GroupID p_group) const;
+	void group_wait(GroupID p_group);
+
+	/* PARALLEL FOR */
+
+	// Calls p_func over [0, p_elements) in chunks of at most p_grain elements,
+	// on the workers and the calling thread, and returns when all are done.
+	// p_max_threads limits how many threads (the caller included) take part,
+	// -1 uses all of them.
+	void parallel_for(uint32_t p_elements, uint32_t p_grain, RangeFunc p_func, void *p_userdata, int p_max_threads = -1);
+
+	template <class C, class U>
+	struct MethodRange {
+		C *instance;
+		void (C::*method)(uint32_t, U);
+		U userdata;
+
+		static void call(void *p_userdata, uint32_t p_from, uint32_t p_to) {
+			MethodRange *mr = (MethodRange *)p_userdata;
+			for (uint32_t i = p_from; i < p_to; i++) {
+				(mr->instance->*mr->method)(i, mr->userdata);
+			}
+		}
+	};
+
+	template <class C, class U>
+	void parallel_for(uint32_t p_elements, uint32_t p_grain, C *p_instance, void (C::*p_method)(uint32_t, U), U p_userdata, int p_max_threads = -1) {
+
+		MethodRange<C, U> mr;
+		mr.instance = p_instance;
+		mr.method = p_method;
+		mr.userdata = p_userdata;
+		parallel_for(p_elements, p_grain, &MethodRange<C, U>::call, &mr, p_max_threads);
+	}
+
+	int get_thread_count() const { return thread_count; }
+	bool is_worker_thread() const { return _get_thread_index() >= 0; }
+
+	void init(int p_thread_count = -1);
+	void finish();
+
+	WorkerThreadPool();
+	~WorkerThreadPool();
+};
+
+#endif // WORKER_THREAD_POOL_H
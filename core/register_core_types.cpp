@@ -58,6 +58,7 @@
 #include "core/math/triangle_mesh.h"
 #include "core/os/input.h"
 #include "core/os/main_loop.h"
+#include "core/os/worker_thread_pool.h"
 #include "core/packed_data_container.h"
 #include "core/path_remap.h"
 #include "core/project_settings.h"
@@ -81,6 +82,8 @@ static _JSON *_json = NULL;
 
 static IP *ip = NULL;
 
+static WorkerThreadPool *worker_thread_pool = NULL;
+
 static _Geometry *_geometry = NULL;
 
 extern Mutex *_global_mutex;
@@ -89,22 +92,29 @@ extern void register_global_constants();
 extern void unregister_global_constants();
 extern void register_variant_methods();
 extern void unregister_variant_methods();
+extern void register_variant_operators();
+extern void unregister_variant_operators();
 
 void register_core_types() {
 
 	ObjectDB::setup();
 	ResourceCache::setup();
+	ResourceLoader::setup_threaded_loads();
 	MemoryPool::setup();
 
 	_global_mutex = Mutex::create();
 
 	StringName::setup();
 
+	worker_thread_pool = memnew(WorkerThreadPool);
+
 	register_global_constants();
 	register_variant_methods();
 
 	CoreStringNames::create();
 
+	register_variant_operators();
+
 	resource_format_po = memnew(TranslationLoaderPO);
 	ResourceLoader::add_resource_format_loader(resource_format_po);
 
@@ -235,6 +245,8 @@ void register_core_singletons() {
 
 void unregister_core_types() {
 
+	memdelete(worker_thread_pool);
+
 	memdelete(_resource_loader);
 	memdelete(_resource_saver);
 	memdelete(_os);
@@ -261,10 +273,12 @@ void unregister_core_types() {
 
 	ObjectDB::cleanup();
 
+	unregister_variant_operators();
 	unregister_variant_methods();
 	unregister_global_constants();
 
 	ClassDB::cleanup();
+	ResourceLoader::cleanup_threaded_loads();
 	ResourceCache::clear();
 	CoreStringNames::free();
 	StringName::cleanup();
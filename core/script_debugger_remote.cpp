@@ -713,8 +713,15 @@ void ScriptDebuggerRemote::_poll_events() {
 
 		} else if (command == "start_profiling") {
 
-			for (int i = 0; i < ScriptServer::get_language_count(); i++) {
-				ScriptServer::get_language(i)->profiling_start();
+			// a sample interval selects the sampling profiler instead of instrumenting every call
+			uint32_t interval = cmd.size() > 2 ? int(cmd[2]) : 0;
+
+			if (interval) {
+				_start_sampling(interval);
+			} else {
+				for (int i = 0; i < ScriptServer::get_language_count(); i++) {
+					ScriptServer::get_language(i)->profiling_start();
+				}
 			}
 
 			max_frame_functions = cmd[1];
@@ -729,8 +736,13 @@ void ScriptDebuggerRemote::_poll_events() {
 
 		} else if (command == "stop_profiling") {
 
-			for (int i = 0; i < ScriptServer::get_language_count(); i++) {
-				ScriptServer::get_language(i)->profiling_stop();
+			if (sampling) {
+				_stop_sampling();
+				_send_profiling_samples();
+			} else {
+				for (int i = 0; i < ScriptServer::get_language_count(); i++) {
+					ScriptServer::get_language(i)->profiling_stop();
+				}
 			}
 			profiling = false;
 			_send_profiling_data(false);
@@ -840,6 +852,159 @@ void ScriptDebuggerRemote::_send_profiling_data(bool p_for_frame) {
 	}
 }
 
+void ScriptDebuggerRemote::_sampler_thread_func(void *p_ud) {
+
+	ScriptDebuggerRemote *sdr = (ScriptDebuggerRemote *)p_ud;
+
+	while (!sdr->sampler_exit) {
+		OS::get_singleton()->delay_usec(sdr->sample_interval);
+		sdr->_take_sample();
+	}
+}
+
+void ScriptDebuggerRemote::_take_sample() {
+
+	// The main thread is not stopped, the stack may change while it is read. An
+	// occasional torn sample is fine for statistics.
+	const void *frames[MAX_SAMPLE_DEPTH];
+
+	ProfileSample sample;
+	sample.zone = get_native_zone();
+	sample.language = -1;
+	sample.frame_count = 0;
+
+	for (int i = 0; i < ScriptServer::get_language_count(); i++) {
+
+		int count = ScriptServer::get_language(i)->profiling_sample_stack(frames, MAX_SAMPLE_DEPTH);
+		if (count > 0) {
+			sample.language = i;
+			sample.frame_count = count;
+			break;
+		}
+	}
+
+	sample_mutex->lock();
+	sample.frame_ofs = sample_frames.size();
+	sample_frames.resize(sample.frame_ofs + sample.frame_count);
+	for (int i = 0; i < sample.frame_count; i++) {
+		sample_frames.write[sample.frame_ofs + i] = frames[i];
+	}
+	samples.push_back(sample);
+	sample_mutex->unlock();
+}
+
+void ScriptDebuggerRemote::_start_sampling(uint32_t p_interval) {
+
+	_stop_sampling();
+
+	sampling = true;
+	sample_interval = p_interval;
+	sampler_exit = false;
+	sampler_thread = Thread::create(_sampler_thread_func, this);
+}
+
+void ScriptDebuggerRemote::_stop_sampling() {
+
+	if (!sampling)
+		return;
+
+	sampler_exit = true;
+	Thread::wait_to_finish(sampler_thread);
+	memdelete(sampler_thread);
+	sampler_thread = NULL;
+	sampling = false;
+}
+
+void ScriptDebuggerRemote::_send_profiling_samples() {
+
+	sample_mutex->lock();
+	Vector<ProfileSample> taken = samples;
+	Vector<const void *> frames = sample_frames;
+	samples.clear();
+	sample_frames.clear();
+	sample_mutex->unlock();
+
+	if (taken.empty())
+		return;
+
+	// Frames are resolved here, on the main thread, once per distinct frame and language.
+	Vector<StringName> names;
+	names.resize(frames.size());
+
+	for (int i = 0; i < ScriptServer::get_language_count(); i++) {
+
+		Map<const void *, int> frame_index;
+		Vector<const void *> unique;
+
+		for (int j = 0; j < taken.size(); j++) {
+
+			const ProfileSample &sample = taken[j];
+			if (sample.language != i)
+				continue;
+			for (int k = 0; k < sample.frame_count; k++) {
+				const void *frame = frames[sample.frame_ofs + k];
+				if (!frame_index.has(frame)) {
+					frame_index[frame] = unique.size();
+					unique.push_back(frame);
+				}
+			}
+		}
+
+		if (unique.empty())
+			continue;
+
+		Vector<StringName> signatures;
+		signatures.resize(unique.size());
+		ScriptServer::get_language(i)->profiling_get_frame_signatures(unique.ptr(), unique.size(), signatures.ptrw());
+
+		for (int j = 0; j < taken.size(); j++) {
+
+			const ProfileSample &sample = taken[j];
+			if (sample.language != i)
+				continue;
+			for (int k = 0; k < sample.frame_count; k++) {
+				int ofs = sample.frame_ofs + k;
+				names.write[ofs] = signatures[frame_index[frames[ofs]]];
+			}
+		}
+	}
+
+	// collapse into "root;...;leaf" stacks with their sample counts
+	Map<String, int> stacks;
+
+	for (int i = 0; i < taken.size(); i++) {
+
+		const ProfileSample &sample = taken[i];
+
+		String stack = sample.zone ? String(sample.zone) : String();
+		for (int j = 0; j < sample.frame_count; j++) {
+			StringName name = names[sample.frame_ofs + j];
+			if (stack != String())
+				stack += ";";
+			stack += name != StringName() ? String(name) : String("?");
+		}
+		if (stack == String())
+			stack = "(native)";
+
+		if (stacks.has(stack))
+			stacks[stack]++;
+		else
+			stacks[stack] = 1;
+	}
+
+	packet_peer_stream->put_var("profile_samples");
+	packet_peer_stream->put_var(3 + stacks.size() * 2);
+	packet_peer_stream->put_var(Engine::get_singleton()->get_frames_drawn());
+	packet_peer_stream->put_var(taken.size());
+	packet_peer_stream->put_var(stacks.size());
+
+	for (Map<String, int>::Element *E = stacks.front(); E; E = E->next()) {
+
+		packet_peer_stream->put_var(E->key());
+		packet_peer_stream->put_var(E->get());
+	}
+}
+
 void ScriptDebuggerRemote::idle_poll() {
 
 	// this function is called every frame, except when there is a debugger break (::debug() in this class)
@@ -880,6 +1045,10 @@ void ScriptDebuggerRemote::idle_poll() {
 			//send profiling info normally
 			_send_profiling_data(true);
 		}
+
+		if (sampling) {
+			_send_profiling_samples();
+		}
 	}
 
 	if (reload_all_scripts) {
@@ -1057,6 +1226,11 @@ ScriptDebuggerRemote::ScriptDebuggerRemote() :
 		profiling(false),
 		max_frame_functions(16),
 		skip_profile_frame(false),
+		sampling(false),
+		sample_interval(0),
+		sampler_exit(false),
+		sampler_thread(NULL),
+		sample_mutex(Mutex::create()),
 		reload_all_scripts(false),
 		tcp_client(Ref<StreamPeerTCP>(memnew(StreamPeerTCP))),
 		packet_peer_stream(Ref<PacketPeerStream>(memnew(PacketPeerStream))),
@@ -1097,5 +1271,7 @@ ScriptDebuggerRemote::~ScriptDebuggerRemote() {
 
 	remove_print_handler(&phl);
 	remove_error_handler(&eh);
+	_stop_sampling();
+	memdelete(sample_mutex);
 	memdelete(mutex);
 }
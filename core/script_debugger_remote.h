@@ -35,6 +35,7 @@
 #include "core/io/stream_peer_tcp.h"
 #include "core/list.h"
 #include "core/os/os.h"
+#include "core/os/thread.h"
 #include "core/script_language.h"
 
 class ScriptDebuggerRemote : public ScriptDebugger {
@@ -61,6 +62,27 @@ class ScriptDebuggerRemote : public ScriptDebugger {
 	bool profiling;
 	int max_frame_functions;
 	bool skip_profile_frame;
+
+	enum {
+		MAX_SAMPLE_DEPTH = 256
+	};
+
+	// One capture of the main thread, frames are stored in sample_frames.
+	struct ProfileSample {
+
+		const char *zone;
+		int language;
+		int frame_ofs;
+		int frame_count;
+	};
+
+	bool sampling;
+	uint32_t sample_interval; // usec
+	volatile bool sampler_exit;
+	Thread *sampler_thread;
+	Mutex *sample_mutex;
+	Vector<ProfileSample> samples;
+	Vector<const void *> sample_frames;
 	bool reload_all_scripts;
 
 	Ref<StreamPeerTCP> tcp_client;
@@ -126,6 +148,12 @@ class ScriptDebuggerRemote : public ScriptDebugger {
 
 	void _send_profiling_data(bool p_for_frame);
 
+	static void _sampler_thread_func(void *p_ud);
+	void _take_sample();
+	void _start_sampling(uint32_t p_interval);
+	void _stop_sampling();
+	void _send_profiling_samples();
+
 	struct FrameData {
 
 		StringName name;
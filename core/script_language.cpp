@@ -372,6 +372,7 @@ ScriptDebugger::ScriptDebugger() {
 	lines_left = -1;
 	depth = -1;
 	break_lang = NULL;
+	native_zone = NULL;
 }
 
 bool PlaceHolderScriptInstance::set(const StringName &p_name, const Variant &p_value) {
@@ -291,6 +291,7 @@ public:
 
 	virtual void reload_all_scripts() = 0;
 	virtual void reload_tool_script(const Ref<Script> &p_script, bool p_soft_reload) = 0;
+	virtual void prefetch_scripts(const Vector<String> &p_paths) {} // optional, get the scripts these resources use ready to load
 	/* LOADER FUNCTIONS */
 
 	virtual void get_recognized_extensions(List<String> *p_extensions) const = 0;
@@ -310,6 +311,11 @@ public:
 	virtual int profiling_get_accumulated_data(ProfilingInfo *p_info_arr, int p_info_max) = 0;
 	virtual int profiling_get_frame_data(ProfilingInfo *p_info_arr, int p_info_max) = 0;
 
+	// Sampling profiler support. The stack is read from the sampler thread while the main
+	// thread keeps running, so frames are opaque and only resolved later on the main thread.
+	virtual int profiling_sample_stack(const void **r_frames, int p_max) { return 0; } // root first
+	virtual void profiling_get_frame_signatures(const void *const *p_frames, int p_count, StringName *r_signatures) {} // empty if gone
+
 	virtual void *alloc_instance_binding_data(Object *p_object) { return NULL; } //optional, not used by all languages
 	virtual void free_instance_binding_data(void *p_data) {} //optional, not used by all languages
 	virtual void refcount_incremented_instance_binding(Object *p_object) {} //optional, not used by all languages
@@ -385,6 +391,8 @@ class ScriptDebugger {
 
 	ScriptLanguage *break_lang;
 
+	const char *volatile native_zone;
+
 public:
 	typedef void (*RequestSceneTreeMessageFunc)(void *);
 
@@ -448,6 +456,10 @@ public:
 	virtual void profiling_end() = 0;
 	virtual void profiling_set_frame_times(float p_frame_time, float p_idle_time, float p_physics_time, float p_physics_frame_time) = 0;
 
+	// server the main thread is currently in, reported by the sampling profiler
+	_FORCE_INLINE_ void set_native_zone(const char *p_zone) { native_zone = p_zone; }
+	_FORCE_INLINE_ const char *get_native_zone() const { return native_zone; }
+
 	ScriptDebugger();
 	virtual ~ScriptDebugger() { singleton = NULL; }
 };
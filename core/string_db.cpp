@@ -33,13 +33,16 @@
 #include "core/os/os.h"
 #include "core/print_string.h"
 
+#include <string.h>
+
 StaticCString StaticCString::create(const char *p_ptr) {
 	StaticCString scs;
 	scs.ptr = p_ptr;
 	return scs;
 }
 
-StringName::_Data *StringName::_table[STRING_TABLE_LEN];
+StringName::_Data *volatile StringName::_table[STRING_TABLE_LEN];
+StringName::_Shard StringName::_shards[STRING_SHARD_COUNT];
 
 StringName _scs_create(const char *p_chr) {
 
@@ -47,36 +50,43 @@ StringName _scs_create(const char *p_chr) {
 }
 
 bool StringName::configured = false;
-Mutex *StringName::lock = NULL;
 
 void StringName::setup() {
 
-	lock = Mutex::create();
-
 	ERR_FAIL_COND(configured);
 	for (int i = 0; i < STRING_TABLE_LEN; i++) {
 
 		_table[i] = NULL;
 	}
+	for (int i = 0; i < STRING_SHARD_COUNT; i++) {
+
+		_shards[i].lock = Mutex::create();
+		_shards[i].epoch = 0;
+		_shards[i].readers[0] = 0;
+		_shards[i].readers[1] = 0;
+		_shards[i].retired = NULL;
+		_shards[i].retired_grace = NULL;
+	}
 	configured = true;
 }
 
 void StringName::cleanup() {
 
-	lock->lock();
-
 	int lost_strings = 0;
 	for (int i = 0; i < STRING_TABLE_LEN; i++) {
 
 		while (_table[i]) {
 
 			_Data *d = _table[i];
-			lost_strings++;
-			if (OS::get_singleton()->is_stdout_verbose()) {
-				if (d->cname) {
-					print_line("Orphan StringName: " + String(d->cname));
-				} else {
-					print_line("Orphan StringName: " + String(d->name));
+			// static names are never released, they are not leaks
+			if (!d->is_static) {
+				lost_strings++;
+				if (OS::get_singleton()->is_stdout_verbose()) {
+					if (d->cname) {
+						print_line("Orphan StringName: " + String(d->cname));
+					} else {
+						print_line("Orphan StringName: " + String(d->name));
+					}
 				}
 			}
 
@@ -87,33 +97,200 @@ void StringName::cleanup() {
 	if (lost_strings) {
 		print_verbose("StringName: " + itos(lost_strings) + " unclaimed string names at exit.");
 	}
-	lock->unlock();
 
-	memdelete(lock);
+	for (int i = 0; i < STRING_SHARD_COUNT; i++) {
+
+		_Shard &shard = _shards[i];
+		_free_list(shard.retired);
+		_free_list(shard.retired_grace);
+		memdelete(shard.lock);
+		shard.lock = NULL;
+	}
+	configured = false;
 }
 
-void StringName::unref() {
+bool StringName::_name_equals(const _Data *p_data, const char *p_name) {
 
-	ERR_FAIL_COND(!configured);
+	if (p_data->cname)
+		return strcmp(p_data->cname, p_name) == 0;
+
+	return p_data->name == p_name;
+}
+
+bool StringName::_name_equals(const _Data *p_data, const CharType *p_name) {
+
+	if (p_data->cname) {
+
+		const char *c = p_data->cname;
+		while (*c && CharType((uint8_t)*c) == *p_name) {
+			c++;
+			p_name++;
+		}
+		return *c == 0 && *p_name == 0;
+	}
+
+	return p_data->name == p_name;
+}
+
+bool StringName::_name_equals(const _Data *p_data, const String &p_name) {
+
+	if (p_data->cname)
+		return p_name == p_data->cname;
+
+	return p_data->name == p_name;
+}
+
+template <class T>
+StringName::_Data *StringName::_lookup(uint32_t p_hash, const T &p_name) {
+
+	uint32_t idx = p_hash & STRING_TABLE_MASK;
+	_Shard &shard = _shards[idx & STRING_SHARD_MASK];
+
+	// The increment is a full barrier, nothing reached from here on is freed until
+	// the matching decrement. It must be counted in the epoch it reads the chains in,
+	// if a writer flipped it meanwhile this retries in the new one.
+	volatile uint32_t *readers;
+	while (true) {
+		uint32_t epoch = shard.epoch;
+		readers = &shard.readers[epoch & 1];
+		atomic_increment(readers);
+		if (shard.epoch == epoch)
+			break;
+		atomic_decrement(readers);
+	}
+
+	_Data *data = _table[idx];
+
+	while (data) {
+
+		// compare hash first, skip entries whose last reference is being dropped
+		if (data->hash == p_hash && _name_equals(data, p_name) && (data->is_static || data->refcount.ref()))
+			break;
+		data = data->next;
+	}
+
+	atomic_decrement(readers);
+
+	return data;
+}
+
+template <class T>
+StringName::_Data *StringName::_insert(uint32_t p_hash, const T &p_name, const char *p_cname) {
+
+	uint32_t idx = p_hash & STRING_TABLE_MASK;
+	_Shard &shard = _shards[idx & STRING_SHARD_MASK];
+
+	shard.lock->lock();
 
-	if (_data && _data->refcount.unref()) {
+	// another thread may have added it since the lookup
+	_Data *data = _table[idx];
 
-		lock->lock();
+	while (data) {
 
-		if (_data->prev) {
-			_data->prev->next = _data->next;
+		if (data->hash == p_hash && _name_equals(data, p_name) && (data->is_static || data->refcount.ref()))
+			break;
+		data = data->next;
+	}
+
+	if (!data) {
+
+		data = memnew(_Data);
+		if (p_cname) {
+			data->cname = p_cname;
 		} else {
-			if (_table[_data->idx] != _data) {
-				ERR_PRINT("BUG!");
-			}
-			_table[_data->idx] = _data->next;
+			data->name = p_name;
 		}
+		data->refcount.init();
+		data->hash = p_hash;
+		data->idx = idx;
+		data->is_static = p_cname ? 1 : 0;
+		data->next = _table[idx];
+		data->prev = NULL;
+		if (_table[idx])
+			_table[idx]->prev = data;
+
+		// The locked add is a full barrier, lookups can't see the entry half initialized.
+		atomic_add(&shard.epoch, 0);
+		_table[idx] = data;
+	}
+
+	_free_retired(shard);
+
+	shard.lock->unlock();
+
+	return data;
+}
+
+void StringName::_remove(_Data *p_data) {
+
+	_Shard &shard = _shards[p_data->idx & STRING_SHARD_MASK];
 
-		if (_data->next) {
-			_data->next->prev = _data->prev;
+	shard.lock->lock();
+
+	if (p_data->prev) {
+		p_data->prev->next = p_data->next;
+	} else {
+		if (_table[p_data->idx] != p_data) {
+			ERR_PRINT("BUG!");
 		}
-		memdelete(_data);
-		lock->unlock();
+		_table[p_data->idx] = p_data->next;
+	}
+
+	if (p_data->next) {
+		p_data->next->prev = p_data->prev;
+	}
+
+	// Lookups may still be walking through it, so next is left intact and the entry
+	// is only freed after a grace period.
+	p_data->prev = shard.retired;
+	shard.retired = p_data;
+	_free_retired(shard);
+
+	shard.lock->unlock();
+}
+
+void StringName::_free_list(_Data *p_list) {
+
+	while (p_list) {
+		_Data *d = p_list;
+		p_list = d->prev;
+		memdelete(d);
+	}
+}
+
+void StringName::_free_retired(_Shard &p_shard) {
+
+	// Entries waiting for a grace period were unlinked before the epoch flipped. Lookups
+	// counted in the current epoch saw the flip, so they can't reach them, only those of
+	// the previous epoch can. The locked add is a full barrier.
+	if (p_shard.retired_grace && atomic_add(&p_shard.readers[(p_shard.epoch & 1) ^ 1], 0) == 0) {
+		_free_list(p_shard.retired_grace);
+		p_shard.retired_grace = NULL;
+	}
+
+	if (p_shard.retired_grace || !p_shard.retired)
+		return;
+
+	// start a grace period for what was retired since the last flip, the increment
+	// orders it after the unlinks
+	p_shard.retired_grace = p_shard.retired;
+	p_shard.retired = NULL;
+	atomic_increment(&p_shard.epoch);
+
+	// usually no lookup was in flight, no need to wait for the next write
+	if (atomic_add(&p_shard.readers[(p_shard.epoch & 1) ^ 1], 0) == 0) {
+		_free_list(p_shard.retired_grace);
+		p_shard.retired_grace = NULL;
+	}
+}
+
+void StringName::unref() {
+
+	ERR_FAIL_COND(!configured);
+
+	if (_data && !_data->is_static && _data->refcount.unref()) {
+
+		_remove(_data);
 	}
 
 	_data = NULL;
@@ -126,7 +303,7 @@ bool StringName::operator==(const String &p_name) const {
 		return (p_name.length() == 0);
 	}
 
-	return (_data->get_name() == p_name);
+	return _name_equals(_data, p_name);
 }
 
 bool StringName::operator==(const char *p_name) const {
@@ -136,7 +313,7 @@ bool StringName::operator==(const char *p_name) const {
 		return (p_name[0] == 0);
 	}
 
-	return (_data->get_name() == p_name);
+	return _name_equals(_data, p_name);
 }
 
 bool StringName::operator!=(const String &p_name) const {
@@ -158,7 +335,7 @@ void StringName::operator=(const StringName &p_name) {
 
 	unref();
 
-	if (p_name._data && p_name._data->refcount.ref()) {
+	if (p_name._data && (p_name._data->is_static || p_name._data->refcount.ref())) {
 
 		_data = p_name._data;
 	}
@@ -170,7 +347,7 @@ StringName::StringName(const StringName &p_name) {
 
 	ERR_FAIL_COND(!configured);
 
-	if (p_name._data && p_name._data->refcount.ref()) {
+	if (p_name._data && (p_name._data->is_static || p_name._data->refcount.ref())) {
 		_data = p_name._data;
 	}
 }
@@ -184,44 +361,12 @@ StringName::StringName(const char *p_name) {
 	if (!p_name || p_name[0] == 0)
 		return; //empty, ignore
 
-	lock->lock();
-
 	uint32_t hash = String::hash(p_name);
 
-	uint32_t idx = hash & STRING_TABLE_MASK;
-
-	_data = _table[idx];
-
-	while (_data) {
-
-		// compare hash first
-		if (_data->hash == hash && _data->get_name() == p_name)
-			break;
-		_data = _data->next;
-	}
-
-	if (_data) {
-		if (_data->refcount.ref()) {
-			// exists
-			lock->unlock();
-			return;
-		} else {
-		}
+	_data = _lookup(hash, p_name);
+	if (!_data) {
+		_data = _insert(hash, p_name, NULL);
 	}
-
-	_data = memnew(_Data);
-	_data->name = p_name;
-	_data->refcount.init();
-	_data->hash = hash;
-	_data->idx = idx;
-	_data->cname = NULL;
-	_data->next = _table[idx];
-	_data->prev = NULL;
-	if (_table[idx])
-		_table[idx]->prev = _data;
-	_table[idx] = _data;
-
-	lock->unlock();
 }
 
 StringName::StringName(const StaticCString &p_static_string) {
@@ -232,44 +377,19 @@ StringName::StringName(const StaticCString &p_static_string) {
 
 	ERR_FAIL_COND(!p_static_string.ptr || !p_static_string.ptr[0]);
 
-	lock->lock();
-
 	uint32_t hash = String::hash(p_static_string.ptr);
 
-	uint32_t idx = hash & STRING_TABLE_MASK;
-
-	_data = _table[idx];
-
-	while (_data) {
-
-		// compare hash first
-		if (_data->hash == hash && _data->get_name() == p_static_string.ptr)
-			break;
-		_data = _data->next;
+	_data = _lookup(hash, p_static_string.ptr);
+	if (!_data) {
+		_data = _insert(hash, p_static_string.ptr, p_static_string.ptr);
 	}
 
-	if (_data) {
-		if (_data->refcount.ref()) {
-			// exists
-			lock->unlock();
-			return;
-		} else {
-		}
+	// Engine constant names are pinned for the whole run: the reference just taken is
+	// never given back, and copies skip the refcount from now on. Others may be reading
+	// the flag while the entry gets pinned.
+	if (!_data->is_static) {
+		atomic_exchange_if_greater(&_data->is_static, 1U);
 	}
-
-	_data = memnew(_Data);
-
-	_data->refcount.init();
-	_data->hash = hash;
-	_data->idx = idx;
-	_data->cname = p_static_string.ptr;
-	_data->next = _table[idx];
-	_data->prev = NULL;
-	if (_table[idx])
-		_table[idx]->prev = _data;
-	_table[idx] = _data;
-
-	lock->unlock();
 }
 
 StringName::StringName(const String &p_name) {
@@ -281,43 +401,12 @@ StringName::StringName(const String &p_name) {
 	if (p_name == String())
 		return;
 
-	lock->lock();
-
 	uint32_t hash = p_name.hash();
 
-	uint32_t idx = hash & STRING_TABLE_MASK;
-
-	_data = _table[idx];
-
-	while (_data) {
-
-		if (_data->hash == hash && _data->get_name() == p_name)
-			break;
-		_data = _data->next;
-	}
-
-	if (_data) {
-		if (_data->refcount.ref()) {
-			// exists
-			lock->unlock();
-			return;
-		} else {
-		}
+	_data = _lookup(hash, p_name);
+	if (!_data) {
+		_data = _insert(hash, p_name, NULL);
 	}
-
-	_data = memnew(_Data);
-	_data->name = p_name;
-	_data->refcount.init();
-	_data->hash = hash;
-	_data->idx = idx;
-	_data->cname = NULL;
-	_data->next = _table[idx];
-	_data->prev = NULL;
-	if (_table[idx])
-		_table[idx]->prev = _data;
-	_table[idx] = _data;
-
-	lock->unlock();
 }
 
 StringName StringName::search(const char *p_name) {
@@ -328,29 +417,12 @@ StringName StringName::search(const char *p_name) {
 	if (!p_name[0])
 		return StringName();
 
-	lock->lock();
-
-	uint32_t hash = String::hash(p_name);
-
-	uint32_t idx = hash & STRING_TABLE_MASK;
-
-	_Data *_data = _table[idx];
-
-	while (_data) {
-
-		// compare hash first
-		if (_data->hash == hash && _data->get_name() == p_name)
-			break;
-		_data = _data->next;
-	}
-
-	if (_data && _data->refcount.ref()) {
-		lock->unlock();
+	_Data *_data = _lookup(String::hash(p_name), p_name);
 
+	if (_data) {
 		return StringName(_data);
 	}
 
-	lock->unlock();
 	return StringName(); //does not exist
 }
 
@@ -362,56 +434,24 @@ StringName StringName::search(const CharType *p_name) {
 	if (!p_name[0])
 		return StringName();
 
-	lock->lock();
-
-	uint32_t hash = String::hash(p_name);
-
-	uint32_t idx = hash & STRING_TABLE_MASK;
+	_Data *_data = _lookup(String::hash(p_name), p_name);
 
-	_Data *_data = _table[idx];
-
-	while (_data) {
-
-		// compare hash first
-		if (_data->hash == hash && _data->get_name() == p_name)
-			break;
-		_data = _data->next;
-	}
-
-	if (_data && _data->refcount.ref()) {
-		lock->unlock();
+	if (_data) {
 		return StringName(_data);
 	}
 
-	lock->unlock();
 	return StringName(); //does not exist
 }
 StringName StringName::search(const String &p_name) {
 
 	ERR_FAIL_COND_V(p_name == "", StringName());
 
-	lock->lock();
-
-	uint32_t hash = p_name.hash();
-
-	uint32_t idx = hash & STRING_TABLE_MASK;
+	_Data *_data = _lookup(p_name.hash(), p_name);
 
-	_Data *_data = _table[idx];
-
-	while (_data) {
-
-		// compare hash first
-		if (_data->hash == hash && p_name == _data->get_name())
-			break;
-		_data = _data->next;
-	}
-
-	if (_data && _data->refcount.ref()) {
-		lock->unlock();
+	if (_data) {
 		return StringName(_data);
 	}
 
-	lock->unlock();
 	return StringName(); //does not exist
 }
 
@@ -422,5 +462,8 @@ StringName::StringName() {
 
 StringName::~StringName() {
 
-	unref();
+	// names kept in statics may outlive the table, there is nothing left to release then
+	if (configured) {
+		unref();
+	}
 }
@@ -48,9 +48,12 @@ class StringName {
 
 	enum {
 
-		STRING_TABLE_BITS = 12,
+		STRING_TABLE_BITS = 14,
 		STRING_TABLE_LEN = 1 << STRING_TABLE_BITS,
-		STRING_TABLE_MASK = STRING_TABLE_LEN - 1
+		STRING_TABLE_MASK = STRING_TABLE_LEN - 1,
+		STRING_SHARD_BITS = 6,
+		STRING_SHARD_COUNT = 1 << STRING_SHARD_BITS,
+		STRING_SHARD_MASK = STRING_SHARD_COUNT - 1
 	};
 
 	struct _Data {
@@ -61,17 +64,47 @@ class StringName {
 		String get_name() const { return cname ? String(cname) : name; }
 		int idx;
 		uint32_t hash;
-		_Data *prev;
-		_Data *next;
+		volatile uint32_t is_static; // created from a StaticCString, lives until cleanup. Read without locks, only set atomically
+		_Data *prev; // only touched with the shard lock held, links the retired list once unlinked
+		_Data *volatile next;
 		_Data() {
 			cname = NULL;
 			next = prev = NULL;
 			idx = 0;
 			hash = 0;
+			is_static = false;
 		}
 	};
 
-	static _Data *_table[STRING_TABLE_LEN];
+	// Buckets are split in shards (by the low bits of the bucket index), each with its own
+	// writer lock. Lookups never take it: they announce themselves in the reader count of
+	// the current epoch of the shard, walk the chain and try to grab a reference.
+	// Unlinked entries are retired, and writers flip the epoch to start a grace period for
+	// them: they are freed once the previous epoch has no readers left, which only takes
+	// the lookups already in flight, however busy the shard is.
+	// Aligned to a cache line, so lookups bumping the reader count of one shard don't
+	// invalidate the others.
+	struct _CACHE_ALIGNED_ _Shard {
+		Mutex *lock;
+		_Data *retired; // unlinked since the last epoch flip
+		_Data *retired_grace; // unlinked before it, waiting for the previous epoch to drain
+		volatile uint32_t epoch;
+		volatile uint32_t readers[2]; // by epoch parity
+	};
+
+	static _Data *volatile _table[STRING_TABLE_LEN];
+	static _Shard _shards[STRING_SHARD_COUNT];
+
+	static bool _name_equals(const _Data *p_data, const char *p_name);
+	static bool _name_equals(const _Data *p_data, const CharType *p_name);
+	static bool _name_equals(const _Data *p_data, const String &p_name);
+	template <class T>
+	static _Data *_lookup(uint32_t p_hash, const T &p_name);
+	template <class T>
+	static _Data *_insert(uint32_t p_hash, const T &p_name, const char *p_cname);
+	static void _remove(_Data *p_data);
+	static void _free_list(_Data *p_list);
+	static void _free_retired(_Shard &p_shard);
 
 	_Data *_data;
 
@@ -85,7 +118,6 @@ class StringName {
 	friend void register_core_types();
 	friend void unregister_core_types();
 
-	static Mutex *lock;
 	static void setup();
 	static void cleanup();
 	static bool configured;
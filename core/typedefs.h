@@ -70,6 +70,26 @@
 
 #endif
 
+//aligns a type to a cache line, so data written by different threads doesn't share one
+#if defined(__GNUC__)
+#define _CACHE_ALIGNED_ __attribute__((aligned(64)))
+#elif defined(_MSC_VER)
+#define _CACHE_ALIGNED_ __declspec(align(64))
+#else
+#define _CACHE_ALIGNED_
+#endif
+
+//thread local storage, only for plain data (pointers, integers), as not every
+//toolchain runs constructors and destructors of thread locals properly
+//(named apart from the mono module's _THREAD_LOCAL_, which handles any type)
+#if defined(NO_THREADS)
+#define _THREAD_LOCAL_PTR_(m_t) m_t
+#elif defined(_MSC_VER)
+#define _THREAD_LOCAL_PTR_(m_t) __declspec(thread) m_t
+#else
+#define _THREAD_LOCAL_PTR_(m_t) __thread m_t
+#endif
+
 //custom, gcc-safe offsetof, because gcc complains a lot.
 template <class T>
 T *_nullptr() {
@@ -117,6 +117,8 @@ public:
 
 private:
 	friend struct _VariantCall;
+	friend struct _VariantOps;
+	friend struct VariantInternal;
 	// Variant takes 20 bytes when real_t is float, and 36 if double
 	// it only allocates extra memory for aabb/matrix.
 
@@ -330,6 +332,11 @@ public:
 
 	static String get_operator_name(Operator p_op);
 	static void evaluate(const Operator &p_op, const Variant &p_a, const Variant &p_b, Variant &r_ret, bool &r_valid);
+
+	// Evaluators for operand types that can't produce an error, NULL for other combinations.
+	// The operands must be of the types it was looked up with, r_ret may alias them.
+	typedef void (*ValidatedOperatorEvaluator)(const Variant *p_a, const Variant *p_b, Variant *r_ret);
+	static ValidatedOperatorEvaluator get_validated_operator_evaluator(Operator p_op, Type p_type_a, Type p_type_b);
 	static _FORCE_INLINE_ Variant evaluate(const Operator &p_op, const Variant &p_a, const Variant &p_b) {
 
 		bool valid = true;
@@ -376,6 +383,13 @@ public:
 	void set_named(const StringName &p_index, const Variant &p_value, bool *r_valid = NULL);
 	Variant get_named(const StringName &p_index, bool *r_valid = NULL) const;
 
+	// Accessors for the named members of builtin types (x, origin...), NULL when the type has no such member.
+	// The base must be of the type they were looked up with, setters return false if the value type doesn't fit.
+	typedef void (*ValidatedGetter)(const Variant *p_base, Variant *r_ret);
+	typedef bool (*ValidatedSetter)(Variant *p_base, const Variant *p_value);
+	static ValidatedGetter get_member_validated_getter(Type p_type, const StringName &p_member);
+	static ValidatedSetter get_member_validated_setter(Type p_type, const StringName &p_member);
+
 	void set(const Variant &p_index, const Variant &p_value, bool *r_valid = NULL);
 	Variant get(const Variant &p_index, bool *r_valid = NULL) const;
 	bool in(const Variant &p_index, bool *r_valid = NULL) const;
@@ -436,6 +450,117 @@ struct VariantComparator {
 	static _FORCE_INLINE_ bool compare(const Variant &p_lhs, const Variant &p_rhs) { return p_lhs.hash_compare(p_rhs); }
 };
 
+// Unchecked access to the value of variants whose type was already checked,
+// for hot paths such as type specialized script opcodes.
+struct VariantInternal {
+
+	static _FORCE_INLINE_ bool *get_bool(Variant *v) { return &v->_data._bool; }
+	static _FORCE_INLINE_ int64_t *get_int(Variant *v) { return &v->_data._int; }
+	static _FORCE_INLINE_ double *get_real(Variant *v) { return &v->_data._real; }
+	static _FORCE_INLINE_ Vector2 *get_vector2(Variant *v) { return reinterpret_cast<Vector2 *>(v->_data._mem); }
+	static _FORCE_INLINE_ Vector3 *get_vector3(Variant *v) { return reinterpret_cast<Vector3 *>(v->_data._mem); }
+	static _FORCE_INLINE_ Rect2 *get_rect2(Variant *v) { return reinterpret_cast<Rect2 *>(v->_data._mem); }
+	static _FORCE_INLINE_ Transform2D *get_transform2d(Variant *v) { return v->_data._transform2d; }
+	static _FORCE_INLINE_ Plane *get_plane(Variant *v) { return reinterpret_cast<Plane *>(v->_data._mem); }
+	static _FORCE_INLINE_ Quat *get_quat(Variant *v) { return reinterpret_cast<Quat *>(v->_data._mem); }
+	static _FORCE_INLINE_ ::AABB *get_aabb(Variant *v) { return v->_data._aabb; }
+	static _FORCE_INLINE_ Basis *get_basis(Variant *v) { return v->_data._basis; }
+	static _FORCE_INLINE_ Transform *get_transform(Variant *v) { return v->_data._transform; }
+	static _FORCE_INLINE_ Color *get_color(Variant *v) { return reinterpret_cast<Color *>(v->_data._mem); }
+	static _FORCE_INLINE_ String *get_string(Variant *v) { return reinterpret_cast<String *>(v->_data._mem); }
+	static _FORCE_INLINE_ Array *get_array(Variant *v) { return reinterpret_cast<Array *>(v->_data._mem); }
+
+	static _FORCE_INLINE_ const bool *get_bool(const Variant *v) { return &v->_data._bool; }
+	static _FORCE_INLINE_ const int64_t *get_int(const Variant *v) { return &v->_data._int; }
+	static _FORCE_INLINE_ const double *get_real(const Variant *v) { return &v->_data._real; }
+	static _FORCE_INLINE_ const Vector2 *get_vector2(const Variant *v) { return reinterpret_cast<const Vector2 *>(v->_data._mem); }
+	static _FORCE_INLINE_ const Vector3 *get_vector3(const Variant *v) { return reinterpret_cast<const Vector3 *>(v->_data._mem); }
+	static _FORCE_INLINE_ const Rect2 *get_rect2(const Variant *v) { return reinterpret_cast<const Rect2 *>(v->_data._mem); }
+	static _FORCE_INLINE_ const Transform2D *get_transform2d(const Variant *v) { return v->_data._transform2d; }
+	static _FORCE_INLINE_ const Plane *get_plane(const Variant *v) { return reinterpret_cast<const Plane *>(v->_data._mem); }
+	static _FORCE_INLINE_ const Quat *get_quat(const Variant *v) { return reinterpret_cast<const Quat *>(v->_data._mem); }
+	static _FORCE_INLINE_ const ::AABB *get_aabb(const Variant *v) { return v->_data._aabb; }
+	static _FORCE_INLINE_ const Basis *get_basis(const Variant *v) { return v->_data._basis; }
+	static _FORCE_INLINE_ const Transform *get_transform(const Variant *v) { return v->_data._transform; }
+	static _FORCE_INLINE_ const Color *get_color(const Variant *v) { return reinterpret_cast<const Color *>(v->_data._mem); }
+	static _FORCE_INLINE_ const String *get_string(const Variant *v) { return reinterpret_cast<const String *>(v->_data._mem); }
+	static _FORCE_INLINE_ const Array *get_array(const Variant *v) { return reinterpret_cast<const Array *>(v->_data._mem); }
+	static _FORCE_INLINE_ Object *get_object(const Variant *v) { return v->_get_obj().obj; }
+
+	// Where the value lives, in the layout PtrToArg expects for ptrcall.
+	static _FORCE_INLINE_ const void *get_opaque_pointer(const Variant *v) {
+		switch (v->type) {
+			case Variant::NIL: return NULL;
+			case Variant::BOOL: return &v->_data._bool;
+			case Variant::INT: return &v->_data._int;
+			case Variant::REAL: return &v->_data._real;
+			case Variant::TRANSFORM2D: return v->_data._transform2d;
+			case Variant::AABB: return v->_data._aabb;
+			case Variant::BASIS: return v->_data._basis;
+			case Variant::TRANSFORM: return v->_data._transform;
+			case Variant::OBJECT: return v->_get_obj().obj;
+			default: return v->_data._mem;
+		}
+	}
+
+	// Setters only change the type when needed, avoiding a full assignment.
+	static _FORCE_INLINE_ void set_bool(Variant *v, bool p_value) {
+		_set_type(v, Variant::BOOL);
+		v->_data._bool = p_value;
+	}
+	static _FORCE_INLINE_ void set_int(Variant *v, int64_t p_value) {
+		_set_type(v, Variant::INT);
+		v->_data._int = p_value;
+	}
+	static _FORCE_INLINE_ void set_real(Variant *v, double p_value) {
+		_set_type(v, Variant::REAL);
+		v->_data._real = p_value;
+	}
+	static _FORCE_INLINE_ void set_vector2(Variant *v, const Vector2 &p_value) {
+		_set_type(v, Variant::VECTOR2);
+		*reinterpret_cast<Vector2 *>(v->_data._mem) = p_value;
+	}
+	static _FORCE_INLINE_ void set_vector3(Variant *v, const Vector3 &p_value) {
+		_set_type(v, Variant::VECTOR3);
+		*reinterpret_cast<Vector3 *>(v->_data._mem) = p_value;
+	}
+
+	static _FORCE_INLINE_ void set_color(Variant *v, const Color &p_value) {
+		_set_type(v, Variant::COLOR);
+		*reinterpret_cast<Color *>(v->_data._mem) = p_value;
+	}
+
+	static _FORCE_INLINE_ void clear(Variant *v) {
+		if (v->type != Variant::NIL)
+			v->clear();
+	}
+
+	// Relocates a value into uninitialized memory, leaving the source null.
+	static _FORCE_INLINE_ void move(Variant *p_to, Variant *p_from) {
+		memcpy((void *)p_to, (const void *)p_from, sizeof(Variant));
+		p_from->type = Variant::NIL;
+	}
+
+	// Shares a value into uninitialized memory without taking a reference.
+	// The source must outlive the borrow, which has to be dropped with release_borrowed().
+	static _FORCE_INLINE_ void borrow(Variant *p_to, const Variant *p_from) {
+		memcpy((void *)p_to, (const void *)p_from, sizeof(Variant));
+	}
+
+	static _FORCE_INLINE_ void release_borrowed(Variant *v) {
+		v->type = Variant::NIL;
+	}
+
+private:
+	// only valid for types stored in place without a constructor
+	static _FORCE_INLINE_ void _set_type(Variant *v, Variant::Type p_type) {
+		if (v->type != p_type) {
+			v->clear();
+			v->type = p_type;
+		}
+	}
+};
+
 Variant::ObjData &Variant::_get_obj() {
 
 	return *reinterpret_cast<ObjData *>(&_data._mem[0]);
@@ -388,9 +388,168 @@ bool Variant::booleanize() const {
 		_RETURN(sum);                                                                                      \
 	}
 
+// Typed access used by the operator and member tables, the types are checked when looking them up.
+
+template <class T>
+struct _VariantGet;
+
+template <>
+struct _VariantGet<bool> {
+	static _FORCE_INLINE_ bool get(const Variant *v) { return *VariantInternal::get_bool(v); }
+};
+template <>
+struct _VariantGet<int64_t> {
+	static _FORCE_INLINE_ int64_t get(const Variant *v) { return *VariantInternal::get_int(v); }
+};
+template <>
+struct _VariantGet<double> {
+	static _FORCE_INLINE_ double get(const Variant *v) { return *VariantInternal::get_real(v); }
+};
+template <>
+struct _VariantGet<Vector2> {
+	static _FORCE_INLINE_ const Vector2 &get(const Variant *v) { return *VariantInternal::get_vector2(v); }
+};
+template <>
+struct _VariantGet<Vector3> {
+	static _FORCE_INLINE_ const Vector3 &get(const Variant *v) { return *VariantInternal::get_vector3(v); }
+};
+template <>
+struct _VariantGet<Color> {
+	static _FORCE_INLINE_ const Color &get(const Variant *v) { return *VariantInternal::get_color(v); }
+};
+template <>
+struct _VariantGet<String> {
+	static _FORCE_INLINE_ const String &get(const Variant *v) { return *VariantInternal::get_string(v); }
+};
+
+// the value is always computed before it's stored, so the result can be one of the operands
+template <class T>
+struct _VariantSet {
+	static _FORCE_INLINE_ void set(Variant *v, const T &p_value) { *v = p_value; }
+};
+
+template <>
+struct _VariantSet<bool> {
+	static _FORCE_INLINE_ void set(Variant *v, bool p_value) { VariantInternal::set_bool(v, p_value); }
+};
+template <>
+struct _VariantSet<int64_t> {
+	static _FORCE_INLINE_ void set(Variant *v, int64_t p_value) { VariantInternal::set_int(v, p_value); }
+};
+template <>
+struct _VariantSet<double> {
+	static _FORCE_INLINE_ void set(Variant *v, double p_value) { VariantInternal::set_real(v, p_value); }
+};
+template <>
+struct _VariantSet<Vector2> {
+	static _FORCE_INLINE_ void set(Variant *v, Vector2 p_value) { VariantInternal::set_vector2(v, p_value); }
+};
+template <>
+struct _VariantSet<Vector3> {
+	static _FORCE_INLINE_ void set(Variant *v, Vector3 p_value) { VariantInternal::set_vector3(v, p_value); }
+};
+template <>
+struct _VariantSet<Color> {
+	static _FORCE_INLINE_ void set(Variant *v, Color p_value) { VariantInternal::set_color(v, p_value); }
+};
+
+#define VARIANT_BINARY_EVALUATOR(m_name, m_expr)                                      \
+	template <class R, class A, class B>                                              \
+	struct _VariantEvaluator##m_name {                                                \
+		static void evaluate(const Variant *p_a, const Variant *p_b, Variant *r_ret) { \
+			const A &a = _VariantGet<A>::get(p_a);                                    \
+			const B &b = _VariantGet<B>::get(p_b);                                    \
+			_VariantSet<R>::set(r_ret, m_expr);                                       \
+		}                                                                             \
+	};
+
+#define VARIANT_UNARY_EVALUATOR(m_name, m_expr)                                       \
+	template <class R, class A>                                                       \
+	struct _VariantEvaluator##m_name {                                                \
+		static void evaluate(const Variant *p_a, const Variant *p_b, Variant *r_ret) { \
+			const A &a = _VariantGet<A>::get(p_a);                                    \
+			_VariantSet<R>::set(r_ret, m_expr);                                       \
+		}                                                                             \
+	};
+
+// same expressions as the cases in Variant::evaluate(), greater is done as a reversed less like there
+VARIANT_BINARY_EVALUATOR(Equal, a == b)
+VARIANT_BINARY_EVALUATOR(NotEqual, a != b)
+VARIANT_BINARY_EVALUATOR(Less, a < b)
+VARIANT_BINARY_EVALUATOR(LessEqual, a <= b)
+VARIANT_BINARY_EVALUATOR(Greater, b < a)
+VARIANT_BINARY_EVALUATOR(GreaterEqual, b <= a)
+VARIANT_BINARY_EVALUATOR(Add, a + b)
+VARIANT_BINARY_EVALUATOR(Subtract, a - b)
+VARIANT_BINARY_EVALUATOR(Multiply, a * b)
+VARIANT_BINARY_EVALUATOR(Divide, a / b)
+VARIANT_BINARY_EVALUATOR(Module, a % b)
+VARIANT_BINARY_EVALUATOR(ShiftLeft, a << b)
+VARIANT_BINARY_EVALUATOR(ShiftRight, a >> b)
+VARIANT_BINARY_EVALUATOR(BitAnd, a & b)
+VARIANT_BINARY_EVALUATOR(BitOr, a | b)
+VARIANT_BINARY_EVALUATOR(BitXor, a ^ b)
+VARIANT_BINARY_EVALUATOR(And, a && b)
+VARIANT_BINARY_EVALUATOR(Or, a || b)
+VARIANT_BINARY_EVALUATOR(Xor, (a || b) && !(a && b))
+VARIANT_UNARY_EVALUATOR(Negate, -a)
+VARIANT_UNARY_EVALUATOR(Positive, a)
+VARIANT_UNARY_EVALUATOR(BitNegate, ~a)
+VARIANT_UNARY_EVALUATOR(Not, !a)
+
+struct _VariantOps {
+
+	struct Member {
+
+		Variant::ValidatedGetter getter;
+		Variant::ValidatedSetter setter;
+	};
+
+	typedef HashMap<StringName, Member> MemberMap;
+
+	static Variant::ValidatedOperatorEvaluator operator_evaluators[Variant::OP_MAX][Variant::VARIANT_MAX][Variant::VARIANT_MAX];
+	static MemberMap *members; // indexed by type
+
+	static void add_evaluator(Variant::Operator p_op, Variant::Type p_type_a, Variant::Type p_type_b, Variant::ValidatedOperatorEvaluator p_evaluator) {
+		operator_evaluators[p_op][p_type_a][p_type_b] = p_evaluator;
+	}
+
+	// unary operators ignore the second operand, so any type goes there
+	static void add_unary_evaluator(Variant::Operator p_op, Variant::Type p_type, Variant::ValidatedOperatorEvaluator p_evaluator) {
+		for (int i = 0; i < Variant::VARIANT_MAX; i++) {
+			operator_evaluators[p_op][p_type][i] = p_evaluator;
+		}
+	}
+
+	static void add_member(Variant::Type p_type, const StringName &p_name, Variant::ValidatedGetter p_getter, Variant::ValidatedSetter p_setter) {
+		Member member;
+		member.getter = p_getter;
+		member.setter = p_setter;
+		members[p_type][p_name] = member;
+	}
+};
+
+Variant::ValidatedOperatorEvaluator _VariantOps::operator_evaluators[Variant::OP_MAX][Variant::VARIANT_MAX][Variant::VARIANT_MAX] = {};
+_VariantOps::MemberMap *_VariantOps::members = NULL;
+
+Variant::ValidatedOperatorEvaluator Variant::get_validated_operator_evaluator(Operator p_op, Type p_type_a, Type p_type_b) {
+
+	ERR_FAIL_INDEX_V(p_op, OP_MAX, NULL);
+	ERR_FAIL_INDEX_V(p_type_a, VARIANT_MAX, NULL);
+	ERR_FAIL_INDEX_V(p_type_b, VARIANT_MAX, NULL);
+	return _VariantOps::operator_evaluators[p_op][p_type_a][p_type_b];
+}
+
 void Variant::evaluate(const Operator &p_op, const Variant &p_a,
 		const Variant &p_b, Variant &r_ret, bool &r_valid) {
 
+	ValidatedOperatorEvaluator evaluator = _VariantOps::operator_evaluators[p_op][p_a.type][p_b.type];
+	if (evaluator) {
+		r_valid = true;
+		evaluator(&p_a, &p_b, &r_ret);
+		return;
+	}
+
 	CASES(math);
 	r_valid = true;
 
@@ -1219,291 +1378,138 @@ void Variant::evaluate(const Operator &p_op, const Variant &p_a,
 	}
 }
 
-void Variant::set_named(const StringName &p_index, const Variant &p_value, bool *r_valid) {
-
-	bool valid = false;
-	switch (type) {
-		case VECTOR2: {
-			if (p_value.type == Variant::INT) {
-				Vector2 *v = reinterpret_cast<Vector2 *>(_data._mem);
-				if (p_index == CoreStringNames::singleton->x) {
-					v->x = p_value._data._int;
-					valid = true;
-				} else if (p_index == CoreStringNames::singleton->y) {
-					v->y = p_value._data._int;
-					valid = true;
-				}
-			} else if (p_value.type == Variant::REAL) {
-				Vector2 *v = reinterpret_cast<Vector2 *>(_data._mem);
-				if (p_index == CoreStringNames::singleton->x) {
-					v->x = p_value._data._real;
-					valid = true;
-				} else if (p_index == CoreStringNames::singleton->y) {
-					v->y = p_value._data._real;
-					valid = true;
-				}
-			}
-
-		} break;
-		case RECT2: {
-
-			if (p_value.type == Variant::VECTOR2) {
-				Rect2 *v = reinterpret_cast<Rect2 *>(_data._mem);
-				//scalar name
-				if (p_index == CoreStringNames::singleton->position) {
-					v->position = *reinterpret_cast<const Vector2 *>(p_value._data._mem);
-					valid = true;
-				} else if (p_index == CoreStringNames::singleton->size) {
-					v->size = *reinterpret_cast<const Vector2 *>(p_value._data._mem);
-					valid = true;
-				} else if (p_index == CoreStringNames::singleton->end) {
-					v->size = *reinterpret_cast<const Vector2 *>(p_value._data._mem) - v->position;
-					valid = true;
-				}
-			}
-		} break;
-		case TRANSFORM2D: {
-
-			if (p_value.type == Variant::VECTOR2) {
-				Transform2D *v = _data._transform2d;
-				if (p_index == CoreStringNames::singleton->x) {
-					v->elements[0] = *reinterpret_cast<const Vector2 *>(p_value._data._mem);
-					valid = true;
-				} else if (p_index == CoreStringNames::singleton->y) {
-					v->elements[1] = *reinterpret_cast<const Vector2 *>(p_value._data._mem);
-					valid = true;
-				} else if (p_index == CoreStringNames::singleton->origin) {
-					v->elements[2] = *reinterpret_cast<const Vector2 *>(p_value._data._mem);
-					valid = true;
-				}
-			}
-
-		} break;
-		case VECTOR3: {
-
-			if (p_value.type == Variant::INT) {
-				Vector3 *v = reinterpret_cast<Vector3 *>(_data._mem);
-				if (p_index == CoreStringNames::singleton->x) {
-					v->x = p_value._data._int;
-					valid = true;
-				} else if (p_index == CoreStringNames::singleton->y) {
-					v->y = p_value._data._int;
-					valid = true;
-				} else if (p_index == CoreStringNames::singleton->z) {
-					v->z = p_value._data._int;
-					valid = true;
-				}
-			} else if (p_value.type == Variant::REAL) {
-				Vector3 *v = reinterpret_cast<Vector3 *>(_data._mem);
-				if (p_index == CoreStringNames::singleton->x) {
-					v->x = p_value._data._real;
-					valid = true;
-				} else if (p_index == CoreStringNames::singleton->y) {
-					v->y = p_value._data._real;
-					valid = true;
-				} else if (p_index == CoreStringNames::singleton->z) {
-					v->z = p_value._data._real;
-					valid = true;
-				}
-			}
-
-		} break;
-		case PLANE: {
+// Accessors for the members handled in set_named() and get_named(), numbers take ints and floats alike.
 
-			if (p_value.type == Variant::INT) {
-				Plane *v = reinterpret_cast<Plane *>(_data._mem);
-				if (p_index == CoreStringNames::singleton->x) {
-					v->normal.x = p_value._data._int;
-					valid = true;
-				} else if (p_index == CoreStringNames::singleton->y) {
-					v->normal.y = p_value._data._int;
-					valid = true;
-				} else if (p_index == CoreStringNames::singleton->z) {
-					v->normal.z = p_value._data._int;
-					valid = true;
-				} else if (p_index == CoreStringNames::singleton->d) {
-					v->d = p_value._data._int;
-					valid = true;
-				}
-			} else if (p_value.type == Variant::REAL) {
-				Plane *v = reinterpret_cast<Plane *>(_data._mem);
-				if (p_index == CoreStringNames::singleton->x) {
-					v->normal.x = p_value._data._real;
-					valid = true;
-				} else if (p_index == CoreStringNames::singleton->y) {
-					v->normal.y = p_value._data._real;
-					valid = true;
-				} else if (p_index == CoreStringNames::singleton->z) {
-					v->normal.z = p_value._data._real;
-					valid = true;
-				} else if (p_index == CoreStringNames::singleton->d) {
-					v->d = p_value._data._real;
-					valid = true;
-				}
+static _FORCE_INLINE_ bool _get_member_number(const Variant *p_value, double &r_number) {
 
-			} else if (p_value.type == Variant::VECTOR3) {
-				Plane *v = reinterpret_cast<Plane *>(_data._mem);
-				if (p_index == CoreStringNames::singleton->normal) {
-					v->normal = *reinterpret_cast<const Vector3 *>(p_value._data._mem);
-					valid = true;
-				}
-			}
+	if (p_value->get_type() == Variant::REAL) {
+		r_number = *VariantInternal::get_real(p_value);
+	} else if (p_value->get_type() == Variant::INT) {
+		r_number = *VariantInternal::get_int(p_value);
+	} else {
+		return false;
+	}
+	return true;
+}
 
-		} break;
-		case QUAT: {
+#define VARIANT_MEMBER_NUMBER_EX(m_base_get, m_type, m_name, m_ret_type, m_get_expr, m_set_stmt) \
+	struct _VariantMember_##m_base_get##_##m_name {                                             \
+		static void get(const Variant *p_base, Variant *r_ret) {                                \
+			const m_type *v = VariantInternal::m_base_get(p_base);                              \
+			m_ret_type value = m_get_expr;                                                      \
+			_VariantSet<m_ret_type>::set(r_ret, value);                                         \
+		}                                                                                       \
+		static bool set(Variant *p_base, const Variant *p_value) {                              \
+			double number;                                                                      \
+			if (!_get_member_number(p_value, number))                                           \
+				return false;                                                                   \
+			m_type *v = VariantInternal::m_base_get(p_base);                                    \
+			m_set_stmt;                                                                         \
+			return true;                                                                        \
+		}                                                                                       \
+	};
 
-			if (p_value.type == Variant::INT) {
-				Quat *v = reinterpret_cast<Quat *>(_data._mem);
-				if (p_index == CoreStringNames::singleton->x) {
-					v->x = p_value._data._int;
-					valid = true;
-				} else if (p_index == CoreStringNames::singleton->y) {
-					v->y = p_value._data._int;
-					valid = true;
-				} else if (p_index == CoreStringNames::singleton->z) {
-					v->z = p_value._data._int;
-					valid = true;
-				} else if (p_index == CoreStringNames::singleton->w) {
-					v->w = p_value._data._int;
-					valid = true;
-				}
-			} else if (p_value.type == Variant::REAL) {
-				Quat *v = reinterpret_cast<Quat *>(_data._mem);
-				if (p_index == CoreStringNames::singleton->x) {
-					v->x = p_value._data._real;
-					valid = true;
-				} else if (p_index == CoreStringNames::singleton->y) {
-					v->y = p_value._data._real;
-					valid = true;
-				} else if (p_index == CoreStringNames::singleton->z) {
-					v->z = p_value._data._real;
-					valid = true;
-				} else if (p_index == CoreStringNames::singleton->w) {
-					v->w = p_value._data._real;
-					valid = true;
-				}
-			}
+#define VARIANT_MEMBER_NUMBER(m_base_get, m_type, m_name, m_field) \
+	VARIANT_MEMBER_NUMBER_EX(m_base_get, m_type, m_name, double, v->m_field, v->m_field = number)
+
+#define VARIANT_MEMBER_VALUE(m_base_get, m_type, m_name, m_value_type, m_value_vtype, m_value_get, m_get_expr, m_set_stmt) \
+	struct _VariantMember_##m_base_get##_##m_name {                                                                       \
+		static void get(const Variant *p_base, Variant *r_ret) {                                                          \
+			const m_type *v = VariantInternal::m_base_get(p_base);                                                        \
+			m_value_type value = m_get_expr;                                                                              \
+			_VariantSet<m_value_type>::set(r_ret, value);                                                                 \
+		}                                                                                                                 \
+		static bool set(Variant *p_base, const Variant *p_value) {                                                        \
+			if (p_value->get_type() != Variant::m_value_vtype)                                                            \
+				return false;                                                                                             \
+			const m_value_type &value = *VariantInternal::m_value_get(p_value);                                           \
+			m_type *v = VariantInternal::m_base_get(p_base);                                                              \
+			m_set_stmt;                                                                                                   \
+			return true;                                                                                                  \
+		}                                                                                                                 \
+	};
 
-		} break; // 10
-		case AABB: {
+VARIANT_MEMBER_NUMBER(get_vector2, Vector2, x, x)
+VARIANT_MEMBER_NUMBER(get_vector2, Vector2, y, y)
+
+VARIANT_MEMBER_VALUE(get_rect2, Rect2, position, Vector2, VECTOR2, get_vector2, v->position, v->position = value)
+VARIANT_MEMBER_VALUE(get_rect2, Rect2, size, Vector2, VECTOR2, get_vector2, v->size, v->size = value)
+VARIANT_MEMBER_VALUE(get_rect2, Rect2, end, Vector2, VECTOR2, get_vector2, v->size + v->position, v->size = value - v->position)
+
+VARIANT_MEMBER_VALUE(get_transform2d, Transform2D, x, Vector2, VECTOR2, get_vector2, v->elements[0], v->elements[0] = value)
+VARIANT_MEMBER_VALUE(get_transform2d, Transform2D, y, Vector2, VECTOR2, get_vector2, v->elements[1], v->elements[1] = value)
+VARIANT_MEMBER_VALUE(get_transform2d, Transform2D, origin, Vector2, VECTOR2, get_vector2, v->elements[2], v->elements[2] = value)
+
+VARIANT_MEMBER_NUMBER(get_vector3, Vector3, x, x)
+VARIANT_MEMBER_NUMBER(get_vector3, Vector3, y, y)
+VARIANT_MEMBER_NUMBER(get_vector3, Vector3, z, z)
+
+VARIANT_MEMBER_NUMBER(get_plane, Plane, x, normal.x)
+VARIANT_MEMBER_NUMBER(get_plane, Plane, y, normal.y)
+VARIANT_MEMBER_NUMBER(get_plane, Plane, z, normal.z)
+VARIANT_MEMBER_NUMBER(get_plane, Plane, d, d)
+VARIANT_MEMBER_VALUE(get_plane, Plane, normal, Vector3, VECTOR3, get_vector3, v->normal, v->normal = value)
+
+VARIANT_MEMBER_NUMBER(get_quat, Quat, x, x)
+VARIANT_MEMBER_NUMBER(get_quat, Quat, y, y)
+VARIANT_MEMBER_NUMBER(get_quat, Quat, z, z)
+VARIANT_MEMBER_NUMBER(get_quat, Quat, w, w)
+
+VARIANT_MEMBER_VALUE(get_aabb, ::AABB, position, Vector3, VECTOR3, get_vector3, v->position, v->position = value)
+VARIANT_MEMBER_VALUE(get_aabb, ::AABB, size, Vector3, VECTOR3, get_vector3, v->size, v->size = value)
+VARIANT_MEMBER_VALUE(get_aabb, ::AABB, end, Vector3, VECTOR3, get_vector3, v->size + v->position, v->size = value - v->position)
+
+VARIANT_MEMBER_VALUE(get_basis, Basis, x, Vector3, VECTOR3, get_vector3, v->get_axis(0), v->set_axis(0, value))
+VARIANT_MEMBER_VALUE(get_basis, Basis, y, Vector3, VECTOR3, get_vector3, v->get_axis(1), v->set_axis(1, value))
+VARIANT_MEMBER_VALUE(get_basis, Basis, z, Vector3, VECTOR3, get_vector3, v->get_axis(2), v->set_axis(2, value))
+
+VARIANT_MEMBER_VALUE(get_transform, Transform, basis, Basis, BASIS, get_basis, v->basis, v->basis = value)
+VARIANT_MEMBER_VALUE(get_transform, Transform, origin, Vector3, VECTOR3, get_vector3, v->origin, v->origin = value)
+
+VARIANT_MEMBER_NUMBER(get_color, Color, r, r)
+VARIANT_MEMBER_NUMBER(get_color, Color, g, g)
+VARIANT_MEMBER_NUMBER(get_color, Color, b, b)
+VARIANT_MEMBER_NUMBER(get_color, Color, a, a)
+VARIANT_MEMBER_NUMBER_EX(get_color, Color, r8, int64_t, int(Math::round(v->r * 255.0)), v->r = number / 255.0)
+VARIANT_MEMBER_NUMBER_EX(get_color, Color, g8, int64_t, int(Math::round(v->g * 255.0)), v->g = number / 255.0)
+VARIANT_MEMBER_NUMBER_EX(get_color, Color, b8, int64_t, int(Math::round(v->b * 255.0)), v->b = number / 255.0)
+VARIANT_MEMBER_NUMBER_EX(get_color, Color, a8, int64_t, int(Math::round(v->a * 255.0)), v->a = number / 255.0)
+VARIANT_MEMBER_NUMBER_EX(get_color, Color, h, double, v->get_h(), v->set_hsv(number, v->get_s(), v->get_v(), v->a))
+VARIANT_MEMBER_NUMBER_EX(get_color, Color, s, double, v->get_s(), v->set_hsv(v->get_h(), number, v->get_v(), v->a))
+VARIANT_MEMBER_NUMBER_EX(get_color, Color, v, double, v->get_v(), v->set_hsv(v->get_h(), v->get_s(), number, v->a))
+
+Variant::ValidatedGetter Variant::get_member_validated_getter(Type p_type, const StringName &p_member) {
+
+	ERR_FAIL_INDEX_V(p_type, VARIANT_MAX, NULL);
+	const _VariantOps::Member *member = _VariantOps::members[p_type].getptr(p_member);
+	return member ? member->getter : NULL;
+}
 
-			if (p_value.type == Variant::VECTOR3) {
-				::AABB *v = _data._aabb;
-				//scalar name
-				if (p_index == CoreStringNames::singleton->position) {
-					v->position = *reinterpret_cast<const Vector3 *>(p_value._data._mem);
-					valid = true;
-				} else if (p_index == CoreStringNames::singleton->size) {
-					v->size = *reinterpret_cast<const Vector3 *>(p_value._data._mem);
-					valid = true;
-				} else if (p_index == CoreStringNames::singleton->end) {
-					v->size = *reinterpret_cast<const Vector3 *>(p_value._data._mem) - v->position;
-					valid = true;
-				}
-			}
-		} break;
-		case BASIS: {
+Variant::ValidatedSetter Variant::get_member_validated_setter(Type p_type, const StringName &p_member) {
 
-			if (p_value.type == Variant::VECTOR3) {
-				Basis *v = _data._basis;
-				//scalar name
-				if (p_index == CoreStringNames::singleton->x) {
-					v->set_axis(0, *reinterpret_cast<const Vector3 *>(p_value._data._mem));
-					valid = true;
-				} else if (p_index == CoreStringNames::singleton->y) {
-					v->set_axis(1, *reinterpret_cast<const Vector3 *>(p_value._data._mem));
-					valid = true;
-				} else if (p_index == CoreStringNames::singleton->z) {
-					v->set_axis(2, *reinterpret_cast<const Vector3 *>(p_value._data._mem));
-					valid = true;
-				}
-			}
-		} break;
-		case TRANSFORM: {
+	ERR_FAIL_INDEX_V(p_type, VARIANT_MAX, NULL);
+	const _VariantOps::Member *member = _VariantOps::members[p_type].getptr(p_member);
+	return member ? member->setter : NULL;
+}
 
-			if (p_value.type == Variant::BASIS && p_index == CoreStringNames::singleton->basis) {
-				_data._transform->basis = *p_value._data._basis;
-				valid = true;
-			} else if (p_value.type == Variant::VECTOR3 && p_index == CoreStringNames::singleton->origin) {
-				_data._transform->origin = *reinterpret_cast<const Vector3 *>(p_value._data._mem);
-				valid = true;
-			}
+void Variant::set_named(const StringName &p_index, const Variant &p_value, bool *r_valid) {
 
-		} break;
+	bool valid = false;
+	switch (type) {
+		case VECTOR2:
+		case RECT2:
+		case TRANSFORM2D:
+		case VECTOR3:
+		case PLANE:
+		case QUAT:
+		case AABB:
+		case BASIS:
+		case TRANSFORM:
 		case COLOR: {
 
-			if (p_value.type == Variant::INT) {
-				Color *v = reinterpret_cast<Color *>(_data._mem);
-				if (p_index == CoreStringNames::singleton->r) {
-					v->r = p_value._data._int;
-					valid = true;
-				} else if (p_index == CoreStringNames::singleton->g) {
-					v->g = p_value._data._int;
-					valid = true;
-				} else if (p_index == CoreStringNames::singleton->b) {
-					v->b = p_value._data._int;
-					valid = true;
-				} else if (p_index == CoreStringNames::singleton->a) {
-					v->a = p_value._data._int;
-					valid = true;
-				} else if (p_index == CoreStringNames::singleton->r8) {
-					v->r = p_value._data._int / 255.0;
-					valid = true;
-				} else if (p_index == CoreStringNames::singleton->g8) {
-					v->g = p_value._data._int / 255.0;
-					valid = true;
-				} else if (p_index == CoreStringNames::singleton->b8) {
-					v->b = p_value._data._int / 255.0;
-					valid = true;
-				} else if (p_index == CoreStringNames::singleton->a8) {
-					v->a = p_value._data._int / 255.0;
-					valid = true;
-				} else if (p_index == CoreStringNames::singleton->h) {
-					v->set_hsv(p_value._data._int, v->get_s(), v->get_v(), v->a);
-					valid = true;
-				} else if (p_index == CoreStringNames::singleton->s) {
-					v->set_hsv(v->get_h(), p_value._data._int, v->get_v(), v->a);
-					valid = true;
-				} else if (p_index == CoreStringNames::singleton->v) {
-					v->set_hsv(v->get_h(), v->get_v(), p_value._data._int, v->a);
-					valid = true;
-				}
-			} else if (p_value.type == Variant::REAL) {
-				Color *v = reinterpret_cast<Color *>(_data._mem);
-				if (p_index == CoreStringNames::singleton->r) {
-					v->r = p_value._data._real;
-					valid = true;
-				} else if (p_index == CoreStringNames::singleton->g) {
-					v->g = p_value._data._real;
-					valid = true;
-				} else if (p_index == CoreStringNames::singleton->b) {
-					v->b = p_value._data._real;
-					valid = true;
-				} else if (p_index == CoreStringNames::singleton->a) {
-					v->a = p_value._data._real;
-					valid = true;
-				} else if (p_index == CoreStringNames::singleton->r8) {
-					v->r = p_value._data._real / 255.0;
-					valid = true;
-				} else if (p_index == CoreStringNames::singleton->g8) {
-					v->g = p_value._data._real / 255.0;
-					valid = true;
-				} else if (p_index == CoreStringNames::singleton->b8) {
-					v->b = p_value._data._real / 255.0;
-					valid = true;
-				} else if (p_index == CoreStringNames::singleton->a8) {
-					v->a = p_value._data._real / 255.0;
-					valid = true;
-				} else if (p_index == CoreStringNames::singleton->h) {
-					v->set_hsv(p_value._data._real, v->get_s(), v->get_v(), v->a);
-					valid = true;
-				} else if (p_index == CoreStringNames::singleton->s) {
-					v->set_hsv(v->get_h(), p_value._data._real, v->get_v(), v->a);
-					valid = true;
-				} else if (p_index == CoreStringNames::singleton->v) {
-					v->set_hsv(v->get_h(), v->get_s(), p_value._data._real, v->a);
-					valid = true;
-				}
+			const _VariantOps::Member *member = _VariantOps::members[type].getptr(p_index);
+			if (member) {
+				valid = member->setter(this, &p_value);
 			}
 		} break;
 		case OBJECT: {
@@ -1535,140 +1541,22 @@ Variant Variant::get_named(const StringName &p_index, bool *r_valid) const {
 		*r_valid = true;
 	}
 	switch (type) {
-		case VECTOR2: {
-			const Vector2 *v = reinterpret_cast<const Vector2 *>(_data._mem);
-			if (p_index == CoreStringNames::singleton->x) {
-				return v->x;
-			} else if (p_index == CoreStringNames::singleton->y) {
-				return v->y;
-			}
-
-		} break;
-		case RECT2: {
-
-			const Rect2 *v = reinterpret_cast<const Rect2 *>(_data._mem);
-			//scalar name
-			if (p_index == CoreStringNames::singleton->position) {
-				return v->position;
-			} else if (p_index == CoreStringNames::singleton->size) {
-				return v->size;
-			} else if (p_index == CoreStringNames::singleton->end) {
-				return v->size + v->position;
-			}
-		} break;
-		case TRANSFORM2D: {
-
-			const Transform2D *v = _data._transform2d;
-			if (p_index == CoreStringNames::singleton->x) {
-				return v->elements[0];
-			} else if (p_index == CoreStringNames::singleton->y) {
-				return v->elements[1];
-			} else if (p_index == CoreStringNames::singleton->origin) {
-				return v->elements[2];
-			}
-
-		} break;
-		case VECTOR3: {
-
-			const Vector3 *v = reinterpret_cast<const Vector3 *>(_data._mem);
-			if (p_index == CoreStringNames::singleton->x) {
-				return v->x;
-			} else if (p_index == CoreStringNames::singleton->y) {
-				return v->y;
-			} else if (p_index == CoreStringNames::singleton->z) {
-				return v->z;
-			}
-
-		} break;
-		case PLANE: {
-
-			const Plane *v = reinterpret_cast<const Plane *>(_data._mem);
-			if (p_index == CoreStringNames::singleton->x) {
-				return v->normal.x;
-			} else if (p_index == CoreStringNames::singleton->y) {
-				return v->normal.y;
-			} else if (p_index == CoreStringNames::singleton->z) {
-				return v->normal.z;
-			} else if (p_index == CoreStringNames::singleton->d) {
-				return v->d;
-			} else if (p_index == CoreStringNames::singleton->normal) {
-				return v->normal;
-			}
-
-		} break;
-		case QUAT: {
-
-			const Quat *v = reinterpret_cast<const Quat *>(_data._mem);
-			if (p_index == CoreStringNames::singleton->x) {
-				return v->x;
-			} else if (p_index == CoreStringNames::singleton->y) {
-				return v->y;
-			} else if (p_index == CoreStringNames::singleton->z) {
-				return v->z;
-			} else if (p_index == CoreStringNames::singleton->w) {
-				return v->w;
-			}
-
-		} break; // 10
-		case AABB: {
-
-			const ::AABB *v = _data._aabb;
-			//scalar name
-			if (p_index == CoreStringNames::singleton->position) {
-				return v->position;
-			} else if (p_index == CoreStringNames::singleton->size) {
-				return v->size;
-			} else if (p_index == CoreStringNames::singleton->end) {
-				return v->size + v->position;
-			}
-		} break;
-		case BASIS: {
-
-			const Basis *v = _data._basis;
-			//scalar name
-			if (p_index == CoreStringNames::singleton->x) {
-				return v->get_axis(0);
-			} else if (p_index == CoreStringNames::singleton->y) {
-				return v->get_axis(1);
-			} else if (p_index == CoreStringNames::singleton->z) {
-				return v->get_axis(2);
-			}
-
-		} break;
-		case TRANSFORM: {
-
-			if (p_index == CoreStringNames::singleton->basis) {
-				return _data._transform->basis;
-			} else if (p_index == CoreStringNames::singleton->origin) {
-				return _data._transform->origin;
-			}
-
-		} break;
+		case VECTOR2:
+		case RECT2:
+		case TRANSFORM2D:
+		case VECTOR3:
+		case PLANE:
+		case QUAT:
+		case AABB:
+		case BASIS:
+		case TRANSFORM:
 		case COLOR: {
 
-			const Color *v = reinterpret_cast<const Color *>(_data._mem);
-			if (p_index == CoreStringNames::singleton->r) {
-				return v->r;
-			} else if (p_index == CoreStringNames::singleton->g) {
-				return v->g;
-			} else if (p_index == CoreStringNames::singleton->b) {
-				return v->b;
-			} else if (p_index == CoreStringNames::singleton->a) {
-				return v->a;
-			} else if (p_index == CoreStringNames::singleton->r8) {
-				return int(Math::round(v->r * 255.0));
-			} else if (p_index == CoreStringNames::singleton->g8) {
-				return int(Math::round(v->g * 255.0));
-			} else if (p_index == CoreStringNames::singleton->b8) {
-				return int(Math::round(v->b * 255.0));
-			} else if (p_index == CoreStringNames::singleton->a8) {
-				return int(Math::round(v->a * 255.0));
-			} else if (p_index == CoreStringNames::singleton->h) {
-				return v->get_h();
-			} else if (p_index == CoreStringNames::singleton->s) {
-				return v->get_s();
-			} else if (p_index == CoreStringNames::singleton->v) {
-				return v->get_v();
+			const _VariantOps::Member *member = _VariantOps::members[type].getptr(p_index);
+			if (member) {
+				Variant ret;
+				member->getter(this, &ret);
+				return ret;
 			}
 		} break;
 		case OBJECT: {
@@ -1703,6 +1591,158 @@ Variant Variant::get_named(const StringName &p_index, bool *r_valid) const {
 	return Variant();
 }
 
+void register_variant_operators() {
+
+#define ADD_EVALUATOR(m_op, m_evaluator, m_ret, m_type_a, m_a, m_type_b, m_b) \
+	_VariantOps::add_evaluator(Variant::m_op, Variant::m_type_a, Variant::m_type_b, _VariantEvaluator##m_evaluator<m_ret, m_a, m_b>::evaluate);
+#define ADD_UNARY_EVALUATOR(m_op, m_evaluator, m_ret, m_type_a, m_a) \
+	_VariantOps::add_unary_evaluator(Variant::m_op, Variant::m_type_a, _VariantEvaluator##m_evaluator<m_ret, m_a>::evaluate);
+
+#define ADD_COMPARISONS(m_type_a, m_a, m_type_b, m_b)                                 \
+	ADD_EVALUATOR(OP_EQUAL, Equal, bool, m_type_a, m_a, m_type_b, m_b)               \
+	ADD_EVALUATOR(OP_NOT_EQUAL, NotEqual, bool, m_type_a, m_a, m_type_b, m_b)        \
+	ADD_EVALUATOR(OP_LESS, Less, bool, m_type_a, m_a, m_type_b, m_b)                 \
+	ADD_EVALUATOR(OP_LESS_EQUAL, LessEqual, bool, m_type_a, m_a, m_type_b, m_b)      \
+	ADD_EVALUATOR(OP_GREATER, Greater, bool, m_type_a, m_a, m_type_b, m_b)           \
+	ADD_EVALUATOR(OP_GREATER_EQUAL, GreaterEqual, bool, m_type_a, m_a, m_type_b, m_b)
+
+#define ADD_ARITHMETIC(m_ret, m_type_a, m_a, m_type_b, m_b)                  \
+	ADD_EVALUATOR(OP_ADD, Add, m_ret, m_type_a, m_a, m_type_b, m_b)           \
+	ADD_EVALUATOR(OP_SUBTRACT, Subtract, m_ret, m_type_a, m_a, m_type_b, m_b) \
+	ADD_EVALUATOR(OP_MULTIPLY, Multiply, m_ret, m_type_a, m_a, m_type_b, m_b)
+
+	ADD_COMPARISONS(INT, int64_t, INT, int64_t);
+	ADD_COMPARISONS(INT, int64_t, REAL, double);
+	ADD_COMPARISONS(REAL, double, INT, int64_t);
+	ADD_COMPARISONS(REAL, double, REAL, double);
+	ADD_COMPARISONS(VECTOR2, Vector2, VECTOR2, Vector2);
+	ADD_COMPARISONS(VECTOR3, Vector3, VECTOR3, Vector3);
+	ADD_COMPARISONS(STRING, String, STRING, String);
+	ADD_EVALUATOR(OP_EQUAL, Equal, bool, BOOL, bool, BOOL, bool);
+	ADD_EVALUATOR(OP_NOT_EQUAL, NotEqual, bool, BOOL, bool, BOOL, bool);
+	ADD_EVALUATOR(OP_EQUAL, Equal, bool, COLOR, Color, COLOR, Color);
+	ADD_EVALUATOR(OP_NOT_EQUAL, NotEqual, bool, COLOR, Color, COLOR, Color);
+
+	ADD_ARITHMETIC(int64_t, INT, int64_t, INT, int64_t);
+	ADD_ARITHMETIC(double, INT, int64_t, REAL, double);
+	ADD_ARITHMETIC(double, REAL, double, INT, int64_t);
+	ADD_ARITHMETIC(double, REAL, double, REAL, double);
+	ADD_ARITHMETIC(Vector2, VECTOR2, Vector2, VECTOR2, Vector2);
+	ADD_ARITHMETIC(Vector3, VECTOR3, Vector3, VECTOR3, Vector3);
+	ADD_ARITHMETIC(Color, COLOR, Color, COLOR, Color);
+	ADD_EVALUATOR(OP_ADD, Add, String, STRING, String, STRING, String);
+
+#ifndef DEBUG_ENABLED
+	// debug builds report divisions by zero, those go through Variant::evaluate()
+	ADD_EVALUATOR(OP_DIVIDE, Divide, int64_t, INT, int64_t, INT, int64_t);
+	ADD_EVALUATOR(OP_DIVIDE, Divide, double, INT, int64_t, REAL, double);
+	ADD_EVALUATOR(OP_DIVIDE, Divide, double, REAL, double, INT, int64_t);
+	ADD_EVALUATOR(OP_DIVIDE, Divide, double, REAL, double, REAL, double);
+	ADD_EVALUATOR(OP_MODULE, Module, int64_t, INT, int64_t, INT, int64_t);
+#endif
+	ADD_EVALUATOR(OP_DIVIDE, Divide, Vector2, VECTOR2, Vector2, VECTOR2, Vector2);
+	ADD_EVALUATOR(OP_DIVIDE, Divide, Vector3, VECTOR3, Vector3, VECTOR3, Vector3);
+	ADD_EVALUATOR(OP_DIVIDE, Divide, Color, COLOR, Color, COLOR, Color);
+
+	// vectors scaled by numbers
+	ADD_EVALUATOR(OP_MULTIPLY, Multiply, Vector2, VECTOR2, Vector2, INT, int64_t);
+	ADD_EVALUATOR(OP_MULTIPLY, Multiply, Vector2, VECTOR2, Vector2, REAL, double);
+	ADD_EVALUATOR(OP_MULTIPLY, Multiply, Vector2, INT, int64_t, VECTOR2, Vector2);
+	ADD_EVALUATOR(OP_MULTIPLY, Multiply, Vector2, REAL, double, VECTOR2, Vector2);
+	ADD_EVALUATOR(OP_DIVIDE, Divide, Vector2, VECTOR2, Vector2, INT, int64_t);
+	ADD_EVALUATOR(OP_DIVIDE, Divide, Vector2, VECTOR2, Vector2, REAL, double);
+	ADD_EVALUATOR(OP_MULTIPLY, Multiply, Vector3, VECTOR3, Vector3, INT, int64_t);
+	ADD_EVALUATOR(OP_MULTIPLY, Multiply, Vector3, VECTOR3, Vector3, REAL, double);
+	ADD_EVALUATOR(OP_MULTIPLY, Multiply, Vector3, INT, int64_t, VECTOR3, Vector3);
+	ADD_EVALUATOR(OP_MULTIPLY, Multiply, Vector3, REAL, double, VECTOR3, Vector3);
+	ADD_EVALUATOR(OP_DIVIDE, Divide, Vector3, VECTOR3, Vector3, INT, int64_t);
+	ADD_EVALUATOR(OP_DIVIDE, Divide, Vector3, VECTOR3, Vector3, REAL, double);
+	ADD_EVALUATOR(OP_MULTIPLY, Multiply, Color, COLOR, Color, INT, int64_t);
+	ADD_EVALUATOR(OP_MULTIPLY, Multiply, Color, COLOR, Color, REAL, double);
+	ADD_EVALUATOR(OP_DIVIDE, Divide, Color, COLOR, Color, INT, int64_t);
+	ADD_EVALUATOR(OP_DIVIDE, Divide, Color, COLOR, Color, REAL, double);
+
+	ADD_EVALUATOR(OP_SHIFT_LEFT, ShiftLeft, int64_t, INT, int64_t, INT, int64_t);
+	ADD_EVALUATOR(OP_SHIFT_RIGHT, ShiftRight, int64_t, INT, int64_t, INT, int64_t);
+	ADD_EVALUATOR(OP_BIT_AND, BitAnd, int64_t, INT, int64_t, INT, int64_t);
+	ADD_EVALUATOR(OP_BIT_OR, BitOr, int64_t, INT, int64_t, INT, int64_t);
+	ADD_EVALUATOR(OP_BIT_XOR, BitXor, int64_t, INT, int64_t, INT, int64_t);
+	ADD_UNARY_EVALUATOR(OP_BIT_NEGATE, BitNegate, int64_t, INT, int64_t);
+
+	ADD_EVALUATOR(OP_AND, And, bool, BOOL, bool, BOOL, bool);
+	ADD_EVALUATOR(OP_OR, Or, bool, BOOL, bool, BOOL, bool);
+	ADD_EVALUATOR(OP_XOR, Xor, bool, BOOL, bool, BOOL, bool);
+	ADD_UNARY_EVALUATOR(OP_NOT, Not, bool, BOOL, bool);
+
+	ADD_UNARY_EVALUATOR(OP_NEGATE, Negate, int64_t, INT, int64_t);
+	ADD_UNARY_EVALUATOR(OP_NEGATE, Negate, double, REAL, double);
+	ADD_UNARY_EVALUATOR(OP_NEGATE, Negate, Vector2, VECTOR2, Vector2);
+	ADD_UNARY_EVALUATOR(OP_NEGATE, Negate, Vector3, VECTOR3, Vector3);
+	ADD_UNARY_EVALUATOR(OP_NEGATE, Negate, Color, COLOR, Color);
+	ADD_UNARY_EVALUATOR(OP_POSITIVE, Positive, int64_t, INT, int64_t);
+	ADD_UNARY_EVALUATOR(OP_POSITIVE, Positive, double, REAL, double);
+	ADD_UNARY_EVALUATOR(OP_POSITIVE, Positive, Vector2, VECTOR2, Vector2);
+	ADD_UNARY_EVALUATOR(OP_POSITIVE, Positive, Vector3, VECTOR3, Vector3);
+
+#undef ADD_ARITHMETIC
+#undef ADD_COMPARISONS
+#undef ADD_UNARY_EVALUATOR
+#undef ADD_EVALUATOR
+
+	_VariantOps::members = memnew_arr(_VariantOps::MemberMap, Variant::VARIANT_MAX);
+
+#define ADD_MEMBER(m_type, m_base_get, m_name) \
+	_VariantOps::add_member(Variant::m_type, CoreStringNames::get_singleton()->m_name, _VariantMember_##m_base_get##_##m_name::get, _VariantMember_##m_base_get##_##m_name::set);
+
+	ADD_MEMBER(VECTOR2, get_vector2, x);
+	ADD_MEMBER(VECTOR2, get_vector2, y);
+	ADD_MEMBER(RECT2, get_rect2, position);
+	ADD_MEMBER(RECT2, get_rect2, size);
+	ADD_MEMBER(RECT2, get_rect2, end);
+	ADD_MEMBER(TRANSFORM2D, get_transform2d, x);
+	ADD_MEMBER(TRANSFORM2D, get_transform2d, y);
+	ADD_MEMBER(TRANSFORM2D, get_transform2d, origin);
+	ADD_MEMBER(VECTOR3, get_vector3, x);
+	ADD_MEMBER(VECTOR3, get_vector3, y);
+	ADD_MEMBER(VECTOR3, get_vector3, z);
+	ADD_MEMBER(PLANE, get_plane, x);
+	ADD_MEMBER(PLANE, get_plane, y);
+	ADD_MEMBER(PLANE, get_plane, z);
+	ADD_MEMBER(PLANE, get_plane, d);
+	ADD_MEMBER(PLANE, get_plane, normal);
+	ADD_MEMBER(QUAT, get_quat, x);
+	ADD_MEMBER(QUAT, get_quat, y);
+	ADD_MEMBER(QUAT, get_quat, z);
+	ADD_MEMBER(QUAT, get_quat, w);
+	ADD_MEMBER(AABB, get_aabb, position);
+	ADD_MEMBER(AABB, get_aabb, size);
+	ADD_MEMBER(AABB, get_aabb, end);
+	ADD_MEMBER(BASIS, get_basis, x);
+	ADD_MEMBER(BASIS, get_basis, y);
+	ADD_MEMBER(BASIS, get_basis, z);
+	ADD_MEMBER(TRANSFORM, get_transform, basis);
+	ADD_MEMBER(TRANSFORM, get_transform, origin);
+	ADD_MEMBER(COLOR, get_color, r);
+	ADD_MEMBER(COLOR, get_color, g);
+	ADD_MEMBER(COLOR, get_color, b);
+	ADD_MEMBER(COLOR, get_color, a);
+	ADD_MEMBER(COLOR, get_color, r8);
+	ADD_MEMBER(COLOR, get_color, g8);
+	ADD_MEMBER(COLOR, get_color, b8);
+	ADD_MEMBER(COLOR, get_color, a8);
+	ADD_MEMBER(COLOR, get_color, h);
+	ADD_MEMBER(COLOR, get_color, s);
+	ADD_MEMBER(COLOR, get_color, v);
+
+#undef ADD_MEMBER
+}
+
+void unregister_variant_operators() {
+
+	memdelete_arr(_VariantOps::members);
+	_VariantOps::members = NULL;
+}
+
 #define DEFAULT_OP_ARRAY_CMD(m_name, m_type, skip_test, cmd)                             \
 	case m_name: {                                                                       \
 		skip_test;                                                                       \
@@ -251,13 +251,17 @@ static Ref<Image> _load_mem_png(const uint8_t *p_png, int p_size) {
 	return img;
 }
 
+static Ref<Image> _lossless_unpack_png_buffer(const uint8_t *p_data, int p_size) {
+
+	ERR_FAIL_COND_V(p_size < 4, Ref<Image>());
+	ERR_FAIL_COND_V(p_data[0] != 'P' || p_data[1] != 'N' || p_data[2] != 'G' || p_data[3] != ' ', Ref<Image>());
+	return _load_mem_png(&p_data[4], p_size - 4);
+}
+
 static Ref<Image> _lossless_unpack_png(const PoolVector<uint8_t> &p_data) {
 
-	int len = p_data.size();
-	ERR_FAIL_COND_V(len < 4, Ref<Image>());
 	PoolVector<uint8_t>::Read r = p_data.read();
-	ERR_FAIL_COND_V(r[0] != 'P' || r[1] != 'N' || r[2] != 'G' || r[3] != ' ', Ref<Image>());
-	return _load_mem_png(&r[4], len - 4);
+	return _lossless_unpack_png_buffer(r.ptr(), p_data.size());
 }
 
 static void _write_png_data(png_structp png_ptr, png_bytep data, png_size_t p_length) {
@@ -388,5 +392,6 @@ ImageLoaderPNG::ImageLoaderPNG() {
 
 	Image::_png_mem_loader_func = _load_mem_png;
 	Image::lossless_unpacker = _lossless_unpack_png;
+	Image::lossless_buffer_unpacker = _lossless_unpack_png_buffer;
 	Image::lossless_packer = _lossless_pack_png;
 }
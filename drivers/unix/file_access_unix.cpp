@@ -39,6 +39,7 @@
 #include <sys/types.h>
 
 #if defined(UNIX_ENABLED)
+#include <sys/mman.h>
 #include <unistd.h>
 #endif
 
@@ -64,8 +65,20 @@ void FileAccessUnix::check_errors() const {
 	}
 }
 
+void FileAccessUnix::_unmap() {
+
+#if defined(UNIX_ENABLED)
+	if (mapped) {
+		munmap(mapped, mapped_size);
+	}
+#endif
+	mapped = NULL;
+	mapped_size = 0;
+}
+
 Error FileAccessUnix::_open(const String &p_path, int p_mode_flags) {
 
+	_unmap();
 	if (f)
 		fclose(f);
 	f = NULL;
@@ -126,6 +139,7 @@ void FileAccessUnix::close() {
 	if (!f)
 		return;
 
+	_unmap();
 	fclose(f);
 	f = NULL;
 
@@ -302,6 +316,37 @@ Error FileAccessUnix::_chmod(const String &p_path, int p_mod) {
 	return FAILED;
 }
 
+const uint8_t *FileAccessUnix::map_read_only(uint64_t &r_size) {
+
+	ERR_FAIL_COND_V(!f, NULL);
+
+#if defined(UNIX_ENABLED)
+	if (!mapped) {
+
+		if (flags != READ)
+			return NULL;
+
+		struct stat st;
+		if (fstat(fileno(f), &st) != 0 || st.st_size <= 0 || uint64_t(size_t(st.st_size)) != uint64_t(st.st_size))
+			return NULL;
+
+		// Read-only shared mapping, pages are backed by the page cache so
+		// reads through it don't go through stdio buffers first.
+		void *ptr = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fileno(f), 0);
+		if (ptr == MAP_FAILED)
+			return NULL;
+
+		mapped = (uint8_t *)ptr;
+		mapped_size = st.st_size;
+	}
+
+	r_size = mapped_size;
+	return mapped;
+#else
+	return NULL;
+#endif
+}
+
 FileAccess *FileAccessUnix::create_libc() {
 
 	return memnew(FileAccessUnix);
@@ -313,6 +358,8 @@ FileAccessUnix::FileAccessUnix() {
 
 	f = NULL;
 	flags = 0;
+	mapped = NULL;
+	mapped_size = 0;
 	last_error = OK;
 }
 
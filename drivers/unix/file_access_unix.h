@@ -48,7 +48,10 @@ class FileAccessUnix : public FileAccess {
 
 	FILE *f;
 	int flags;
+	uint8_t *mapped;
+	uint64_t mapped_size;
 	void check_errors() const;
+	void _unmap();
 	mutable Error last_error;
 	String save_path;
 	String path;
@@ -88,6 +91,8 @@ public:
 
 	virtual Error _chmod(const String &p_path, int p_mod);
 
+	virtual const uint8_t *map_read_only(uint64_t &r_size);
+
 	FileAccessUnix();
 	virtual ~FileAccessUnix();
 };
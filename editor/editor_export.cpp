@@ -31,6 +31,8 @@
 #include "editor_export.h"
 
 #include "core/io/config_file.h"
+#include "core/io/file_access_memory.h"
+#include "core/io/pck_packer.h"
 #include "core/io/resource_loader.h"
 #include "core/io/resource_saver.h"
 #include "core/io/zip_io.h"
@@ -282,8 +284,11 @@ Error EditorExportPlatform::_save_pack_file(void *p_userdata, const String &p_pa
 	sd.ofs = pd->f->get_position();
 	sd.size = p_data.size();
 
-	pd->f->store_buffer(p_data.ptr(), p_data.size());
-	int pad = _get_pad(PCK_PADDING, sd.size);
+	FileAccessMemory src;
+	src.open_custom(p_data.ptr(), p_data.size());
+	sd.flags = PCKPacker::store_file(pd->f, &src, sd.size, pd->compress, sd.stored_size);
+
+	int pad = _get_pad(PCK_PADDING, sd.stored_size);
 	for (int i = 0; i < pad; i++) {
 		pd->f->store_8(0);
 	}
@@ -821,6 +826,7 @@ Error EditorExportPlatform::save_pack(const Ref<EditorExportPreset> &p_preset, c
 	pd.ep = &ep;
 	pd.f = ftmp;
 	pd.so_files = p_so_files;
+	pd.compress = GLOBAL_GET("editor/compress_pck_files_on_export");
 
 	Error err = export_project_files(p_preset, _save_pack_file, &pd, _add_shared_object);
 
@@ -834,7 +840,7 @@ Error EditorExportPlatform::save_pack(const Ref<EditorExportPreset> &p_preset, c
 	FileAccess *f = FileAccess::open(p_path, FileAccess::WRITE);
 	ERR_FAIL_COND_V(!f, ERR_CANT_CREATE)
 	f->store_32(0x43504447); //GDPK
-	f->store_32(1); //pack version
+	f->store_32(2); //pack version
 	f->store_32(VERSION_MAJOR);
 	f->store_32(VERSION_MINOR);
 	f->store_32(0); //hmph
@@ -843,39 +849,28 @@ Error EditorExportPlatform::save_pack(const Ref<EditorExportPreset> &p_preset, c
 		f->store_32(0);
 	}
 
-	f->store_32(pd.file_ofs.size()); //amount of files
-
-	size_t header_size = f->get_position();
-
-	//precalculate header size
+	Vector<PCKPacker::IndexEntry> entries;
+	entries.resize(pd.file_ofs.size());
 
 	for (int i = 0; i < pd.file_ofs.size(); i++) {
-		header_size += 4; // size of path string (32 bits is enough)
-		uint32_t string_len = pd.file_ofs[i].path_utf8.length();
-		header_size += string_len + _get_pad(4, string_len); ///size of path string
-		header_size += 8; // offset to file _with_ header size included
-		header_size += 8; // size of file
-		header_size += 16; // md5
+
+		PCKPacker::IndexEntry &e = entries.write[i];
+		e.path.parse_utf8(pd.file_ofs[i].path_utf8.get_data());
+		e.size = pd.file_ofs[i].size; // pay attention here, this is where file is
+		e.stored_size = pd.file_ofs[i].stored_size;
+		e.flags = pd.file_ofs[i].flags;
+		copymem(e.md5, pd.file_ofs[i].md5.ptr(), 16); //also save md5 for file
 	}
 
+	size_t header_size = f->get_position() + PCKPacker::get_index_size(entries);
 	size_t header_padding = _get_pad(PCK_PADDING, header_size);
 
 	for (int i = 0; i < pd.file_ofs.size(); i++) {
-
-		uint32_t string_len = pd.file_ofs[i].path_utf8.length();
-		uint32_t pad = _get_pad(4, string_len);
-		;
-		f->store_32(string_len + pad);
-		f->store_buffer((const uint8_t *)pd.file_ofs[i].path_utf8.get_data(), string_len);
-		for (uint32_t j = 0; j < pad; j++) {
-			f->store_8(0);
-		}
-
-		f->store_64(pd.file_ofs[i].ofs + header_padding + header_size);
-		f->store_64(pd.file_ofs[i].size); // pay attention here, this is where file is
-		f->store_buffer(pd.file_ofs[i].md5.ptr(), 16); //also save md5 for file
+		entries.write[i].offset = pd.file_ofs[i].ofs + header_padding + header_size; // offset to file _with_ header size included
 	}
 
+	PCKPacker::store_index(f, entries);
+
 	for (uint32_t j = 0; j < header_padding; j++) {
 		f->store_8(0);
 	}
@@ -1237,6 +1232,8 @@ EditorExport::EditorExport() {
 	save_timer->connect("timeout", this, "_save");
 	block_save = false;
 
+	GLOBAL_DEF("editor/compress_pck_files_on_export", false);
+
 	singleton = this;
 }
 
@@ -144,6 +144,8 @@ private:
 
 		uint64_t ofs;
 		uint64_t size;
+		uint64_t stored_size;
+		uint32_t flags;
 		Vector<uint8_t> md5;
 		CharString path_utf8;
 
@@ -158,6 +160,7 @@ private:
 		Vector<SavedData> file_ofs;
 		EditorProgress *ep;
 		Vector<SharedObject> *so_files;
+		bool compress;
 	};
 
 	struct ZipData {
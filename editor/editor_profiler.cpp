@@ -30,6 +30,7 @@
 
 #include "editor_profiler.h"
 
+#include "core/os/file_access.h"
 #include "core/os/os.h"
 #include "editor_scale.h"
 #include "editor_settings.h"
@@ -80,6 +81,99 @@ void EditorProfiler::add_frame_metric(const Metric &p_metric, bool p_final) {
 	}
 }
 
+void EditorProfiler::add_samples(const Map<String, int> &p_stacks, int p_count) {
+
+	for (const Map<String, int>::Element *E = p_stacks.front(); E; E = E->next()) {
+
+		Map<String, int>::Element *F = sample_stacks.find(E->key());
+		if (F)
+			F->get() += E->get();
+		else
+			sample_stacks[E->key()] = E->get();
+	}
+	sample_count += p_count;
+
+	if (sample_delay->is_stopped()) {
+		sample_delay->set_wait_time(0.5);
+		sample_delay->start();
+	}
+}
+
+bool EditorProfiler::is_sampling() const {
+
+	return sampling->is_pressed();
+}
+
+void EditorProfiler::_update_samples() {
+
+	sample_tree->clear();
+	TreeItem *root = sample_tree->create_item();
+
+	if (sample_count == 0)
+		return;
+
+	// merge the stacks into a call tree, each item counts the samples of the stacks passing through it
+	Map<String, TreeItem *> items;
+	Map<TreeItem *, int> counts;
+
+	for (Map<String, int>::Element *E = sample_stacks.front(); E; E = E->next()) {
+
+		Vector<String> frames = E->key().split(";");
+		String path;
+		TreeItem *parent = root;
+
+		for (int i = 0; i < frames.size(); i++) {
+
+			path += ";" + frames[i];
+
+			Map<String, TreeItem *>::Element *F = items.find(path);
+			TreeItem *item;
+			if (F) {
+				item = F->get();
+			} else {
+				item = sample_tree->create_item(parent);
+				Vector<String> strings = frames[i].split("::");
+				if (strings.size() == 3) {
+					item->set_text(0, strings[2] + " (" + strings[0].get_file() + ":" + strings[1] + ")");
+					item->set_tooltip(0, strings[0] + ":" + strings[1]);
+				} else {
+					item->set_text(0, frames[i]);
+				}
+				items[path] = item;
+				counts[item] = 0;
+			}
+
+			counts[item] += E->get();
+			parent = item;
+		}
+	}
+
+	for (Map<TreeItem *, int>::Element *E = counts.front(); E; E = E->next()) {
+
+		E->key()->set_text(1, itos(E->get()));
+		E->key()->set_text(2, String::num(E->get() * 100.0 / sample_count, 1) + "%");
+	}
+}
+
+void EditorProfiler::_export_samples_pressed() {
+
+	export_dialog->popup_centered_ratio();
+}
+
+void EditorProfiler::_export_samples(const String &p_path) {
+
+	// the collapsed stack format read by flame graph tools, one "stack count" per line
+	FileAccess *f = FileAccess::open(p_path, FileAccess::WRITE);
+	ERR_FAIL_COND(!f);
+
+	for (Map<String, int>::Element *E = sample_stacks.front(); E; E = E->next()) {
+		f->store_line(E->key() + " " + itos(E->get()));
+	}
+
+	f->close();
+	memdelete(f);
+}
+
 void EditorProfiler::clear() {
 
 	int metric_size = EditorSettings::get_singleton()->get("debugger/profiler_frame_history_size");
@@ -100,6 +194,10 @@ void EditorProfiler::clear() {
 	updating_frame = false;
 	hover_metric = -1;
 	seeking = false;
+
+	sample_stacks.clear();
+	sample_count = 0;
+	sample_tree->clear();
 }
 
 static String _get_percent_txt(float p_value, float p_total) {
@@ -429,6 +527,9 @@ void EditorProfiler::_activate_pressed() {
 		activate->set_icon(get_icon("Play", "EditorIcons"));
 		activate->set_text(TTR("Start"));
 	}
+	sampling->set_disabled(activate->is_pressed());
+	if (activate->is_pressed() && is_sampling())
+		sample_tree->show();
 	emit_signal("enable_profiling", activate->is_pressed());
 }
 
@@ -610,6 +711,9 @@ void EditorProfiler::_bind_methods() {
 	ClassDB::bind_method(D_METHOD("_graph_tex_mouse_exit"), &EditorProfiler::_graph_tex_mouse_exit);
 	ClassDB::bind_method(D_METHOD("_cursor_metric_changed"), &EditorProfiler::_cursor_metric_changed);
 	ClassDB::bind_method(D_METHOD("_combo_changed"), &EditorProfiler::_combo_changed);
+	ClassDB::bind_method(D_METHOD("_update_samples"), &EditorProfiler::_update_samples);
+	ClassDB::bind_method(D_METHOD("_export_samples_pressed"), &EditorProfiler::_export_samples_pressed);
+	ClassDB::bind_method(D_METHOD("_export_samples"), &EditorProfiler::_export_samples);
 
 	ClassDB::bind_method(D_METHOD("_item_edited"), &EditorProfiler::_item_edited);
 	ADD_SIGNAL(MethodInfo("enable_profiling", PropertyInfo(Variant::BOOL, "enable")));
@@ -640,6 +744,16 @@ EditorProfiler::EditorProfiler() {
 	clear_button->connect("pressed", this, "_clear_pressed");
 	hb->add_child(clear_button);
 
+	sampling = memnew(CheckBox);
+	sampling->set_text(TTR("Sample"));
+	sampling->set_tooltip(TTR("Periodically sample the script call stack instead of timing every call."));
+	hb->add_child(sampling);
+
+	export_samples = memnew(Button);
+	export_samples->set_text(TTR("Export Samples"));
+	export_samples->connect("pressed", this, "_export_samples_pressed");
+	hb->add_child(export_samples);
+
 	hb->add_child(memnew(Label(TTR("Measure:"))));
 
 	display_mode = memnew(OptionButton);
@@ -704,6 +818,31 @@ EditorProfiler::EditorProfiler() {
 	h_split->add_child(graph);
 	graph->set_h_size_flags(SIZE_EXPAND_FILL);
 
+	sample_tree = memnew(Tree);
+	sample_tree->set_v_size_flags(SIZE_EXPAND_FILL);
+	sample_tree->set_hide_root(true);
+	sample_tree->set_columns(3);
+	sample_tree->set_column_titles_visible(true);
+	sample_tree->set_column_title(0, TTR("Stack"));
+	sample_tree->set_column_expand(0, true);
+	sample_tree->set_column_title(1, TTR("Samples"));
+	sample_tree->set_column_expand(1, false);
+	sample_tree->set_column_min_width(1, 80 * EDSCALE);
+	sample_tree->set_column_title(2, TTR("%"));
+	sample_tree->set_column_expand(2, false);
+	sample_tree->set_column_min_width(2, 60 * EDSCALE);
+	sample_tree->hide();
+	add_child(sample_tree);
+
+	export_dialog = memnew(EditorFileDialog);
+	export_dialog->set_access(EditorFileDialog::ACCESS_FILESYSTEM);
+	export_dialog->set_mode(EditorFileDialog::MODE_SAVE_FILE);
+	export_dialog->add_filter("*.txt ; " + TTR("Collapsed Stacks"));
+	export_dialog->connect("file_selected", this, "_export_samples");
+	add_child(export_dialog);
+
+	sample_count = 0;
+
 	int metric_size = CLAMP(int(EDITOR_DEF("debugger/profiler_frame_history_size", 600)), 60, 1024);
 	frame_metrics.resize(metric_size);
 	last_metric = -1;
@@ -711,6 +850,7 @@ EditorProfiler::EditorProfiler() {
 	hover_metric = -1;
 
 	EDITOR_DEF("debugger/profiler_frame_max_functions", 64);
+	EDITOR_DEF("debugger/profiler_sample_interval_usec", 1000);
 
 	//display_mode=DISPLAY_FRAME_TIME;
 
@@ -726,6 +866,11 @@ EditorProfiler::EditorProfiler() {
 	add_child(plot_delay);
 	plot_delay->connect("timeout", this, "_update_plot");
 
+	sample_delay = memnew(Timer);
+	sample_delay->set_one_shot(true);
+	add_child(sample_delay);
+	sample_delay->connect("timeout", this, "_update_samples");
+
 	plot_sigs.insert("physics_frame_time");
 	plot_sigs.insert("category_frame_time");
 
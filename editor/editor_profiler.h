@@ -31,8 +31,10 @@
 #ifndef EDITORPROFILER_H
 #define EDITORPROFILER_H
 
+#include "editor/editor_file_dialog.h"
 #include "scene/gui/box_container.h"
 #include "scene/gui/button.h"
+#include "scene/gui/check_box.h"
 #include "scene/gui/label.h"
 #include "scene/gui/option_button.h"
 #include "scene/gui/spin_box.h"
@@ -131,7 +133,19 @@ private:
 	Timer *frame_delay;
 	Timer *plot_delay;
 
+	// sampling mode, stacks are "root;...;leaf" with the number of samples seen
+	CheckBox *sampling;
+	Button *export_samples;
+	EditorFileDialog *export_dialog;
+	Tree *sample_tree;
+	Timer *sample_delay;
+	Map<String, int> sample_stacks;
+	int sample_count;
+
 	void _update_frame();
+	void _update_samples();
+	void _export_samples_pressed();
+	void _export_samples(const String &p_path);
 
 	void _activate_pressed();
 	void _clear_pressed();
@@ -162,6 +176,8 @@ protected:
 
 public:
 	void add_frame_metric(const Metric &p_metric, bool p_final = false);
+	void add_samples(const Map<String, int> &p_stacks, int p_count);
+	bool is_sampling() const;
 	void set_enabled(bool p_enable);
 	bool is_profiling();
 	bool is_seeking() { return seeking; }
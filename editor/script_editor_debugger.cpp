@@ -891,6 +891,20 @@ void ScriptEditorDebugger::_parse_message(const String &p_msg, const Array &p_da
 		else
 			profiler->add_frame_metric(metric, true);
 
+	} else if (p_msg == "profile_samples") {
+
+		int sample_count = p_data[1];
+		int stack_count = p_data[2];
+
+		Map<String, int> stacks;
+		int idx = 3;
+		for (int i = 0; i < stack_count; i++) {
+			String stack = p_data[idx++];
+			stacks[stack] = p_data[idx++];
+		}
+
+		profiler->add_samples(stacks, sample_count);
+
 	} else if (p_msg == "kill_me") {
 
 		editor->call_deferred("stop_child_process");
@@ -1313,6 +1327,10 @@ void ScriptEditorDebugger::_profiler_activate(bool p_enable) {
 		int max_funcs = EditorSettings::get_singleton()->get("debugger/profiler_frame_max_functions");
 		max_funcs = CLAMP(max_funcs, 16, 512);
 		msg.push_back(max_funcs);
+		if (profiler->is_sampling()) {
+			int interval = EditorSettings::get_singleton()->get("debugger/profiler_sample_interval_usec");
+			msg.push_back(CLAMP(interval, 100, 100000));
+		}
 		ppeer->put_var(msg);
 		print_verbose("Starting profiling.");
 
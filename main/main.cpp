@@ -42,6 +42,7 @@
 #include "core/message_queue.h"
 #include "core/os/dir_access.h"
 #include "core/os/os.h"
+#include "core/os/worker_thread_pool.h"
 #include "core/project_settings.h"
 #include "core/register_core_types.h"
 #include "core/script_debugger_local.h"
@@ -144,6 +145,7 @@ static int frame_delay = 0;
 static bool disable_render_loop = false;
 static int fixed_fps = -1;
 static bool print_fps = false;
+static uint64_t threaded_load_budget_usec = 2000;
 
 /* Helper methods */
 
@@ -740,6 +742,13 @@ Error Main::setup(const char *execpath, int argc, char *argv[], bool p_second_ph
 	GLOBAL_DEF("network/limits/debugger_stdout/max_messages_per_frame", 10);
 	GLOBAL_DEF("network/limits/debugger_stdout/max_errors_per_frame", 10);
 
+	GLOBAL_DEF_RST("threading/worker_pool/max_threads", -1);
+	ProjectSettings::get_singleton()->set_custom_property_info("threading/worker_pool/max_threads", PropertyInfo(Variant::INT, "threading/worker_pool/max_threads", PROPERTY_HINT_RANGE, "-1,256,1"));
+	WorkerThreadPool::get_singleton()->init(GLOBAL_GET("threading/worker_pool/max_threads"));
+
+	threaded_load_budget_usec = GLOBAL_DEF("threading/resource_loader/finalize_budget_usec", 2000);
+	ProjectSettings::get_singleton()->set_custom_property_info("threading/resource_loader/finalize_budget_usec", PropertyInfo(Variant::INT, "threading/resource_loader/finalize_budget_usec", PROPERTY_HINT_RANGE, "0,100000,100"));
+
 	if (debug_mode == "remote") {
 
 		ScriptDebuggerRemote *sdr = memnew(ScriptDebuggerRemote);
@@ -1484,6 +1493,8 @@ bool Main::start() {
 				List<PropertyInfo> props;
 				ProjectSettings::get_singleton()->get_property_list(&props);
 
+				Vector<String> startup_paths;
+
 				//first pass, add the constants so they exist before any script is loaded
 				for (List<PropertyInfo>::Element *E = props.front(); E; E = E->next()) {
 
@@ -1495,6 +1506,7 @@ bool Main::start() {
 					bool global_var = false;
 					if (path.begins_with("*")) {
 						global_var = true;
+						path = path.substr(1, path.length() - 1);
 					}
 
 					if (global_var) {
@@ -1502,6 +1514,15 @@ bool Main::start() {
 							ScriptServer::get_language(i)->add_global_constant(name, Variant());
 						}
 					}
+					startup_paths.push_back(path);
+				}
+
+				if (game_path != "") {
+					startup_paths.push_back(ProjectSettings::get_singleton()->localize_path(game_path.replace("\\", "/")));
+				}
+
+				for (int i = 0; i < ScriptServer::get_language_count(); i++) {
+					ScriptServer::get_language(i)->prefetch_scripts(startup_paths);
 				}
 
 				//second pass, load into global constants
@@ -1773,6 +1794,13 @@ bool Main::force_redraw_requested = false;
 static uint64_t physics_process_max = 0;
 static uint64_t idle_process_max = 0;
 
+// Tells a sampling profiler which server the main thread is blocked in.
+static _FORCE_INLINE_ void _set_native_zone(const char *p_zone) {
+
+	if (script_debugger)
+		script_debugger->set_native_zone(p_zone);
+}
+
 bool Main::iteration() {
 
 	uint64_t ticks = OS::get_singleton()->get_ticks_usec();
@@ -1814,11 +1842,14 @@ bool Main::iteration() {
 
 		uint64_t physics_begin = OS::get_singleton()->get_ticks_usec();
 
+		_set_native_zone("PhysicsServer::flush_queries");
 		PhysicsServer::get_singleton()->sync();
 		PhysicsServer::get_singleton()->flush_queries();
 
+		_set_native_zone("Physics2DServer::flush_queries");
 		Physics2DServer::get_singleton()->sync();
 		Physics2DServer::get_singleton()->flush_queries();
+		_set_native_zone(NULL);
 
 		if (OS::get_singleton()->get_main_loop()->iteration(frame_slice * time_scale)) {
 			exit = true;
@@ -1827,10 +1858,13 @@ bool Main::iteration() {
 
 		message_queue->flush();
 
+		_set_native_zone("PhysicsServer::step");
 		PhysicsServer::get_singleton()->step(frame_slice * time_scale);
 
+		_set_native_zone("Physics2DServer::step");
 		Physics2DServer::get_singleton()->end_sync();
 		Physics2DServer::get_singleton()->step(frame_slice * time_scale);
+		_set_native_zone(NULL);
 
 		message_queue->flush();
 
@@ -1843,11 +1877,17 @@ bool Main::iteration() {
 
 	uint64_t idle_begin = OS::get_singleton()->get_ticks_usec();
 
+	_set_native_zone("ResourceLoader::finalize_threaded_loads");
+	ResourceLoader::finalize_threaded_loads(threaded_load_budget_usec);
+	_set_native_zone(NULL);
+
 	OS::get_singleton()->get_main_loop()->idle(step * time_scale);
 	message_queue->flush();
 
+	_set_native_zone("VisualServer::sync");
 	VisualServer::get_singleton()->sync(); //sync if still drawing from previous frames.
 
+	_set_native_zone("VisualServer::draw");
 	if (OS::get_singleton()->can_draw() && !disable_render_loop) {
 
 		if ((!force_redraw_requested) && OS::get_singleton()->is_in_low_processor_usage_mode()) {
@@ -1862,6 +1902,8 @@ bool Main::iteration() {
 		}
 	}
 
+	_set_native_zone(NULL);
+
 	idle_process_ticks = OS::get_singleton()->get_ticks_usec() - idle_begin;
 	idle_process_max = MAX(idle_process_ticks, idle_process_max);
 	uint64_t frame_time = OS::get_singleton()->get_ticks_usec() - ticks;
@@ -1961,6 +2003,8 @@ void Main::cleanup() {
 		memdelete(script_debugger);
 	}
 
+	ResourceLoader::finish_threaded_loads();
+
 	OS::get_singleton()->delete_main_loop();
 
 	OS::get_singleton()->_cmdline.clear();
@@ -72,6 +72,11 @@ void Performance::_bind_methods() {
 	BIND_ENUM_CONSTANT(PHYSICS_3D_COLLISION_PAIRS);
 	BIND_ENUM_CONSTANT(PHYSICS_3D_ISLAND_COUNT);
 	BIND_ENUM_CONSTANT(AUDIO_OUTPUT_LATENCY);
+	BIND_ENUM_CONSTANT(PHYSICS_3D_ISLAND_SOLVE_TIME);
+	BIND_ENUM_CONSTANT(RENDER_COMMAND_QUEUE_DEPTH);
+	BIND_ENUM_CONSTANT(RENDER_COMMAND_QUEUE_STALL_TIME);
+	BIND_ENUM_CONSTANT(PHYSICS_2D_COMMAND_QUEUE_DEPTH);
+	BIND_ENUM_CONSTANT(PHYSICS_2D_COMMAND_QUEUE_STALL_TIME);
 
 	BIND_ENUM_CONSTANT(MONITOR_MAX);
 }
@@ -109,6 +114,11 @@ String Performance::get_monitor_name(Monitor p_monitor) const {
 		"physics_3d/collision_pairs",
 		"physics_3d/islands",
 		"audio/output_latency",
+		"physics_3d/island_solve_time",
+		"raster/command_queue_depth",
+		"raster/command_queue_stall_time",
+		"physics_2d/command_queue_depth",
+		"physics_2d/command_queue_stall_time",
 
 	};
 
@@ -153,6 +163,11 @@ float Performance::get_monitor(Monitor p_monitor) const {
 		case PHYSICS_3D_COLLISION_PAIRS: return PhysicsServer::get_singleton()->get_process_info(PhysicsServer::INFO_COLLISION_PAIRS);
 		case PHYSICS_3D_ISLAND_COUNT: return PhysicsServer::get_singleton()->get_process_info(PhysicsServer::INFO_ISLAND_COUNT);
 		case AUDIO_OUTPUT_LATENCY: return AudioServer::get_singleton()->get_output_latency();
+		case PHYSICS_3D_ISLAND_SOLVE_TIME: return USEC_TO_SEC(PhysicsServer::get_singleton()->get_process_info(PhysicsServer::INFO_ISLAND_SOLVE_TIME));
+		case RENDER_COMMAND_QUEUE_DEPTH: return VS::get_singleton()->get_render_info(VS::INFO_COMMAND_QUEUE_DEPTH);
+		case RENDER_COMMAND_QUEUE_STALL_TIME: return USEC_TO_SEC(VS::get_singleton()->get_render_info(VS::INFO_COMMAND_QUEUE_STALL_TIME));
+		case PHYSICS_2D_COMMAND_QUEUE_DEPTH: return Physics2DServer::get_singleton()->get_process_info(Physics2DServer::INFO_COMMAND_QUEUE_DEPTH);
+		case PHYSICS_2D_COMMAND_QUEUE_STALL_TIME: return USEC_TO_SEC(Physics2DServer::get_singleton()->get_process_info(Physics2DServer::INFO_COMMAND_QUEUE_STALL_TIME));
 
 		default: {}
 	}
@@ -193,6 +208,11 @@ Performance::MonitorType Performance::get_monitor_type(Monitor p_monitor) const
 		MONITOR_TYPE_QUANTITY,
 		MONITOR_TYPE_QUANTITY,
 		MONITOR_TYPE_TIME,
+		MONITOR_TYPE_TIME,
+		MONITOR_TYPE_QUANTITY,
+		MONITOR_TYPE_TIME,
+		MONITOR_TYPE_QUANTITY,
+		MONITOR_TYPE_TIME,
 
 	};
 
@@ -78,6 +78,11 @@ public:
 		PHYSICS_3D_ISLAND_COUNT,
 		//physics
 		AUDIO_OUTPUT_LATENCY,
+		PHYSICS_3D_ISLAND_SOLVE_TIME,
+		RENDER_COMMAND_QUEUE_DEPTH,
+		RENDER_COMMAND_QUEUE_STALL_TIME,
+		PHYSICS_2D_COMMAND_QUEUE_DEPTH,
+		PHYSICS_2D_COMMAND_QUEUE_STALL_TIME,
 		MONITOR_MAX
 	};
 
@@ -577,6 +577,49 @@ static void _disassemble_class(const Ref<GDScript> &p_class, const Vector<String
 					txt += DADDR(3);
 					incr += 5;
 
+				} break;
+				case GDScriptFunction::OPCODE_OPERATOR_INT:
+				case GDScriptFunction::OPCODE_OPERATOR_REAL:
+				case GDScriptFunction::OPCODE_OPERATOR_VECTOR2:
+				case GDScriptFunction::OPCODE_OPERATOR_VECTOR3: {
+
+					static const char *type_names[] = { "int", "real", "vector2", "vector3" };
+
+					int op = code[ip + 1];
+					txt += "op_" + String(type_names[code[ip] - GDScriptFunction::OPCODE_OPERATOR_INT]) + " ";
+
+					String opname = Variant::get_operator_name(Variant::Operator(op));
+
+					txt += DADDR(4);
+					txt += " = ";
+					txt += DADDR(2);
+					txt += " " + opname + " ";
+					txt += DADDR(3);
+					incr += 5;
+
+				} break;
+				case GDScriptFunction::OPCODE_SET_ARRAY: {
+
+					txt += "set_array ";
+					txt += DADDR(1);
+					txt += "[";
+					txt += DADDR(2);
+					txt += "]=";
+					txt += DADDR(3);
+					incr += 4;
+
+				} break;
+				case GDScriptFunction::OPCODE_GET_ARRAY: {
+
+					txt += " get_array ";
+					txt += DADDR(3);
+					txt += "=";
+					txt += DADDR(1);
+					txt += "[";
+					txt += DADDR(2);
+					txt += "]";
+					incr += 4;
+
 				} break;
 				case GDScriptFunction::OPCODE_SET: {
 
@@ -730,6 +773,18 @@ static void _disassemble_class(const Ref<GDScript> &p_class, const Vector<String
 
 				} break;
 
+				case GDScriptFunction::OPCODE_CALL_PTRCALL: {
+
+					txt += " ptrcall " + itos(code[ip + 1]);
+					incr += 2;
+
+				} break;
+				case GDScriptFunction::OPCODE_INLINE_CACHE: {
+
+					txt += " cache " + itos(code[ip + 1]);
+					incr += 2;
+
+				} break;
 				case GDScriptFunction::OPCODE_CALL:
 				case GDScriptFunction::OPCODE_CALL_RETURN: {
 
@@ -869,6 +924,18 @@ static void _disassemble_class(const Ref<GDScript> &p_class, const Vector<String
 					txt += " for-loop " + DADDR(4) + " in " + DADDR(2) + " counter " + DADDR(1) + " end " + itos(code[ip + 3]);
 					incr += 5;
 
+				} break;
+				case GDScriptFunction::OPCODE_ITERATE_BEGIN_RANGE: {
+
+					txt += " for-init-range " + DADDR(4) + " in " + DADDR(2) + " counter " + DADDR(1) + " end " + itos(code[ip + 3]);
+					incr += 5;
+
+				} break;
+				case GDScriptFunction::OPCODE_ITERATE_RANGE: {
+
+					txt += " for-loop-range " + DADDR(4) + " in " + DADDR(2) + " counter " + DADDR(1) + " end " + itos(code[ip + 3]);
+					incr += 5;
+
 				} break;
 				case GDScriptFunction::OPCODE_LINE: {
 
@@ -906,8 +973,633 @@ static void _disassemble_class(const Ref<GDScript> &p_class, const Vector<String
 	}
 }
 
+// Each pair runs the same loop, once without type hints (generic opcodes and
+// calls) and once with them, so the compiler can emit the typed versions.
+static const char *_benchmark_code =
+		"extends Reference\n"
+		"\n"
+		"static func int_untyped(n):\n"
+		"	var s = 0\n"
+		"	for i in n:\n"
+		"		s = s + i * 3 - i % 7\n"
+		"	return s\n"
+		"\n"
+		"static func int_typed(n: int) -> int:\n"
+		"	var s: int = 0\n"
+		"	for i in range(n):\n"
+		"		s = s + i * 3 - i % 7\n"
+		"	return s\n"
+		"\n"
+		"static func float_untyped(n):\n"
+		"	var s = 0.0\n"
+		"	var x = 0.5\n"
+		"	for i in n:\n"
+		"		s = s + x * 1.5 - s / 3.0\n"
+		"		x = x + 0.25\n"
+		"	return s\n"
+		"\n"
+		"static func float_typed(n: int) -> float:\n"
+		"	var s: float = 0.0\n"
+		"	var x: float = 0.5\n"
+		"	for i in range(n):\n"
+		"		s = s + x * 1.5 - s / 3.0\n"
+		"		x = x + 0.25\n"
+		"	return s\n"
+		"\n"
+		"static func vector2_untyped(n):\n"
+		"	var p = Vector2()\n"
+		"	var v = Vector2(1.5, -0.5)\n"
+		"	for i in n:\n"
+		"		p = (p - v) * 0.5 + v\n"
+		"		v = -v\n"
+		"	return p\n"
+		"\n"
+		"static func vector2_typed(n: int) -> Vector2:\n"
+		"	var p: Vector2 = Vector2()\n"
+		"	var v: Vector2 = Vector2(1.5, -0.5)\n"
+		"	for i in range(n):\n"
+		"		p = (p - v) * 0.5 + v\n"
+		"		v = -v\n"
+		"	return p\n"
+		"\n"
+		"static func vector3_untyped(n):\n"
+		"	var p = Vector3()\n"
+		"	var v = Vector3(1.5, -0.5, 0.25)\n"
+		"	for i in n:\n"
+		"		p = (p - v) * 0.5 + v\n"
+		"		v = -v\n"
+		"	return p\n"
+		"\n"
+		"static func vector3_typed(n: int) -> Vector3:\n"
+		"	var p: Vector3 = Vector3()\n"
+		"	var v: Vector3 = Vector3(1.5, -0.5, 0.25)\n"
+		"	for i in range(n):\n"
+		"		p = (p - v) * 0.5 + v\n"
+		"		v = -v\n"
+		"	return p\n"
+		"\n"
+		"static func array_untyped(n):\n"
+		"	var a = []\n"
+		"	a.resize(64)\n"
+		"	for i in 64:\n"
+		"		a[i] = i\n"
+		"	var s = 0\n"
+		"	for i in n:\n"
+		"		var j = i % 64\n"
+		"		a[j] = a[j - 1] + 1\n"
+		"		s = s + a[j]\n"
+		"	return s\n"
+		"\n"
+		"static func array_typed(n: int) -> int:\n"
+		"	var a: Array = []\n"
+		"	a.resize(64)\n"
+		"	for i in range(64):\n"
+		"		a[i] = i\n"
+		"	var s: int = 0\n"
+		"	for i in range(n):\n"
+		"		var j: int = i % 64\n"
+		"		a[j] = a[j - 1] + 1\n"
+		"		s = s + a[j]\n"
+		"	return s\n"
+		"\n"
+		"static func native_call_untyped(n):\n"
+		"	var o = Reference.new()\n"
+		"	var s = 0\n"
+		"	for i in n:\n"
+		"		o.set_block_signals(i % 3 == 0)\n"
+		"		if o.is_blocking_signals():\n"
+		"			s = s + 1\n"
+		"	return s\n"
+		"\n"
+		"static func native_call_typed(n: int) -> int:\n"
+		"	var o: Reference = Reference.new()\n"
+		"	var s: int = 0\n"
+		"	for i in range(n):\n"
+		"		o.set_block_signals(i % 3 == 0)\n"
+		"		if o.is_blocking_signals():\n"
+		"			s = s + 1\n"
+		"	return s\n"
+		"\n"
+		"class Counter:\n"
+		"	var value = 0\n"
+		"	func add(n):\n"
+		"		value = value + n\n"
+		"		return value\n"
+		"\n"
+		"static func script_access_untyped(n):\n"
+		"	var c = Counter.new()\n"
+		"	var s = 0\n"
+		"	for i in n:\n"
+		"		c.value = c.value - s % 5\n"
+		"		s = c.add(i % 3)\n"
+		"	return s\n"
+		"\n"
+		"static func script_access_typed(n: int) -> int:\n"
+		"	var c: Counter = Counter.new()\n"
+		"	var s: int = 0\n"
+		"	for i in range(n):\n"
+		"		c.value = c.value - s % 5\n"
+		"		s = c.add(i % 3)\n"
+		"	return s\n";
+
+// Small functions called in a loop, so the time goes into entering and
+// leaving them rather than into their bodies.
+static const char *_call_benchmark_code =
+		"extends Reference\n"
+		"\n"
+		"class Getter:\n"
+		"	var value = 1\n"
+		"	func get_value():\n"
+		"		return value\n"
+		"\n"
+		"static func empty():\n"
+		"	pass\n"
+		"\n"
+		"static func mix(a, b, t):\n"
+		"	return a + (b - a) * t\n"
+		"\n"
+		"static func locals(a):\n"
+		"	var x = a + 1\n"
+		"	var y = x * 2\n"
+		"	var z = [x, y]\n"
+		"	return z[1] - z[0]\n"
+		"\n"
+		"static func depth(n):\n"
+		"	return 0 if n == 0 else depth(n - 1) + 1\n"
+		"\n"
+		"static func element(a, i):\n"
+		"	return a[i % a.size()]\n"
+		"\n"
+		"static func element_x(p, i):\n"
+		"	return p[i % p.size()].x\n"
+		"\n"
+		"static func append_to(a, v):\n"
+		"	a.append(v)\n"
+		"\n"
+		"static func empty_calls(n):\n"
+		"	for i in n:\n"
+		"		empty()\n"
+		"	return n\n"
+		"\n"
+		"static func argument_calls(n):\n"
+		"	var s = 0.0\n"
+		"	for i in n:\n"
+		"		s = mix(s, i, 0.5)\n"
+		"	return s\n"
+		"\n"
+		"static func local_calls(n):\n"
+		"	var s = 0\n"
+		"	for i in n:\n"
+		"		s += locals(i)\n"
+		"	return s\n"
+		"\n"
+		"static func getter_calls(n):\n"
+		"	var o = Getter.new()\n"
+		"	var s = 0\n"
+		"	for i in n:\n"
+		"		s += o.get_value()\n"
+		"	return s\n"
+		"\n"
+		"static func recursive_calls(n):\n"
+		"	var s = 0\n"
+		"	for i in n / 100:\n"
+		"		s += depth(99)\n"
+		"	return s\n"
+		"\n"
+		"static func array_calls(n):\n"
+		"	var a = range(1000)\n"
+		"	var s = 0\n"
+		"	for i in n:\n"
+		"		s += element(a, i)\n"
+		"	return s\n"
+		"\n"
+		"static func pool_array_calls(n):\n"
+		"	var p = PoolVector3Array()\n"
+		"	for i in 1000:\n"
+		"		p.push_back(Vector3(i, 0, 0))\n"
+		"	var s = 0.0\n"
+		"	for i in n:\n"
+		"		s += element_x(p, i)\n"
+		"	return s\n"
+		"\n"
+		"static func modified_array_calls(n):\n"
+		"	var a = []\n"
+		"	for i in n:\n"
+		"		append_to(a, i)\n"
+		"	return a.size()\n";
+
+static MainLoop *test_benchmark() {
+
+	const int iterations = 1000000;
+	const char *names[] = { "int", "float", "vector2", "vector3", "array", "native_call", "script_access", NULL };
+
+	Ref<GDScript> script;
+	script.instance();
+	script->set_source_code(_benchmark_code);
+	Error err = script->reload();
+	if (err != OK) {
+		ERR_EXPLAIN("Benchmark script failed to compile.");
+		ERR_FAIL_V(NULL);
+	}
+
+	Object *obj = script.ptr(); // static functions are called on the script itself
+	Variant arg = iterations;
+	const Variant *args[1] = { &arg };
+
+	print_line("GDScript typed code benchmark, " + itos(iterations) + " iterations:");
+
+	for (int i = 0; names[i]; i++) {
+
+		uint64_t times[2];
+		Variant results[2];
+
+		for (int j = 0; j < 2; j++) {
+
+			StringName func = String(names[i]) + (j == 0 ? "_untyped" : "_typed");
+
+			Variant::CallError ce;
+			uint64_t begin = OS::get_singleton()->get_ticks_usec();
+			results[j] = obj->call(func, args, 1, ce);
+			times[j] = OS::get_singleton()->get_ticks_usec() - begin;
+
+			if (ce.error != Variant::CallError::CALL_OK) {
+				ERR_EXPLAIN("Benchmark function failed: " + String(func));
+				ERR_FAIL_V(NULL);
+			}
+		}
+
+		print_line("\t" + String(names[i]) + ": untyped " + itos(times[0]) + " usec, typed " + itos(times[1]) + " usec, speedup " + rtos(times[0] / (double)MAX(times[1], 1)) + "x");
+
+		if (results[0] != results[1]) {
+			ERR_PRINTS("\tResults differ: " + String(results[0]) + " != " + String(results[1]));
+		}
+	}
+
+	const char *call_names[] = { "empty", "argument", "local", "getter", "recursive", "array", "pool_array", "modified_array", NULL };
+
+	Ref<GDScript> call_script;
+	call_script.instance();
+	call_script->set_source_code(_call_benchmark_code);
+	err = call_script->reload();
+	if (err != OK) {
+		ERR_EXPLAIN("Call benchmark script failed to compile.");
+		ERR_FAIL_V(NULL);
+	}
+
+	obj = call_script.ptr();
+
+	print_line("GDScript call overhead benchmark, " + itos(iterations) + " calls:");
+
+	for (int i = 0; call_names[i]; i++) {
+
+		StringName func = String(call_names[i]) + "_calls";
+
+		Variant::CallError ce;
+		uint64_t begin = OS::get_singleton()->get_ticks_usec();
+		obj->call(func, args, 1, ce);
+		uint64_t time = OS::get_singleton()->get_ticks_usec() - begin;
+
+		if (ce.error != Variant::CallError::CALL_OK) {
+			ERR_EXPLAIN("Benchmark function failed: " + String(func));
+			ERR_FAIL_V(NULL);
+		}
+
+		print_line("\t" + String(call_names[i]) + ": " + itos(time) + " usec, " + rtos(time * 1000.0 / iterations) + " nsec per call");
+	}
+
+	return NULL;
+}
+
+// Each function covers code the optimizer rewrites: folded constants, jumps
+// on constant conditions, dead code, loops and moves out of temporaries.
+static const char *_optimizer_code =
+		"extends Reference\n"
+		"\n"
+		"const A = 3\n"
+		"const B = A * 4 + 1\n"
+		"const NAME = \"opt\"\n"
+		"const ITEMS = [1, 2, 3]\n"
+		"\n"
+		"class Inner:\n"
+		"	const C = 100\n"
+		"	var value = C + A\n"
+		"	func get_value(n = C * 2):\n"
+		"		return value + n\n"
+		"\n"
+		"static func fold_operators():\n"
+		"	var x = A * 2 + B - (A % 2) * 7\n"
+		"	var s = NAME + \"_\" + str(A) + str(B / 2.0)\n"
+		"	var v = Vector2(A, B) * 2 - Vector2(1, 1)\n"
+		"	return [x, s, v, -A, not (A > B), A == 3 and B != 0]\n"
+		"\n"
+		"static func fold_builtins():\n"
+		"	var f = sqrt(A * A + 16.0) + abs(-B) + floor(A / 2.0) + max(A, B)\n"
+		"	return [f, len(NAME), int(B / 2), str(A).length(), Color(A / 10.0, 0.5, 1.0), char(65 + A)]\n"
+		"\n"
+		"static func constant_branches():\n"
+		"	var r = []\n"
+		"	if A > 2:\n"
+		"		r.append(\"a\")\n"
+		"	else:\n"
+		"		r.append(\"b\")\n"
+		"	if A > B:\n"
+		"		r.append(\"c\")\n"
+		"	elif B > 10:\n"
+		"		r.append(\"d\")\n"
+		"	while false:\n"
+		"		r.append(\"e\")\n"
+		"	r.append(\"f\" if A == 3 else \"g\")\n"
+		"	return r\n"
+		"\n"
+		"static func unreachable(n):\n"
+		"	if n > 0:\n"
+		"		return \"positive\"\n"
+		"	else:\n"
+		"		return \"other\"\n"
+		"	return \"never\"\n"
+		"\n"
+		"static func loops(n):\n"
+		"	var s = 0\n"
+		"	for i in range(n):\n"
+		"		if i % A == 0:\n"
+		"			continue\n"
+		"		s = s + i * B\n"
+		"		if s > 1000:\n"
+		"			break\n"
+		"	var j = 0\n"
+		"	while j < n:\n"
+		"		j += 1\n"
+		"		if j == A:\n"
+		"			continue\n"
+		"		s -= j\n"
+		"	for k in ITEMS:\n"
+		"		s += k * A\n"
+		"	return s\n"
+		"\n"
+		"static func temporaries(n):\n"
+		"	var a = [n, n + 1, n * 2]\n"
+		"	var d = {\"k\": a[1], A: a[0] * A}\n"
+		"	var t = a[0] + a[1] if n > 0 else a[2] - a[1]\n"
+		"	var u = d[\"k\"] - d[A] + len(a)\n"
+		"	a[0] = a[0] + a[2]\n"
+		"	t = t + u\n"
+		"	u = t - u\n"
+		"	return [a, d, t, u, Vector3(t, u, n).length()]\n"
+		"\n"
+		"static func matching(n):\n"
+		"	var r = []\n"
+		"	for i in range(n):\n"
+		"		match i % 4:\n"
+		"			0:\n"
+		"				r.append(\"zero\")\n"
+		"			A:\n"
+		"				r.append(\"three\")\n"
+		"			_:\n"
+		"				r.append(i)\n"
+		"	return r\n"
+		"\n"
+		"static func defaults(a, b = A * 2, c = NAME + str(B)):\n"
+		"	return [a, b, c]\n"
+		"\n"
+		"static func inner_class():\n"
+		"	var i = Inner.new()\n"
+		"	return [i.get_value(), i.get_value(1), Inner.C, defaults(1), defaults(1, 2), defaults(1, 2, 3)]\n"
+		"\n"
+		"static func counter(n):\n"
+		"	var s = 0\n"
+		"	for i in range(n):\n"
+		"		s += i * A + yield()\n"
+		"	return s\n"
+		"\n"
+		"static func yields():\n"
+		"	var r = []\n"
+		"	var state = counter(4)\n"
+		"	while typeof(state) == TYPE_OBJECT:\n"
+		"		state = state.resume(B)\n"
+		"		r.append(typeof(state))\n"
+		"	r.append(state)\n"
+		"	return r\n";
+
+static Ref<GDScript> _compile_script(const String &p_code, bool p_optimize) {
+
+	GDScriptParser parser;
+	Error err = parser.parse(p_code);
+	if (err) {
+		ERR_EXPLAIN("Parse Error: " + itos(parser.get_error_line()) + ":" + itos(parser.get_error_column()) + ":" + parser.get_error());
+		ERR_FAIL_V(Ref<GDScript>());
+	}
+
+	Ref<GDScript> script;
+	script.instance();
+
+	GDScriptCompiler compiler;
+	compiler.set_optimize(p_optimize);
+	err = compiler.compile(&parser, script.ptr());
+	if (err) {
+		ERR_EXPLAIN("Compile Error: " + itos(compiler.get_error_line()) + ":" + itos(compiler.get_error_column()) + ":" + compiler.get_error());
+		ERR_FAIL_V(Ref<GDScript>());
+	}
+
+	return script;
+}
+
+static int _get_code_size(const Ref<GDScript> &p_script) {
+
+	int size = 0;
+	for (const Map<StringName, GDScriptFunction *>::Element *E = p_script->get_member_functions().front(); E; E = E->next()) {
+		size += E->get()->get_code_size();
+	}
+	for (const Map<StringName, Ref<GDScript> >::Element *E = p_script->get_subclasses().front(); E; E = E->next()) {
+		size += _get_code_size(E->get());
+	}
+	return size;
+}
+
+static MainLoop *test_optimizer() {
+
+	const char *names[] = { "fold_operators", "fold_builtins", "constant_branches", "unreachable", "loops", "temporaries", "matching", "inner_class", "yields", NULL };
+
+	Ref<GDScript> scripts[2] = { _compile_script(_optimizer_code, false), _compile_script(_optimizer_code, true) };
+	ERR_FAIL_COND_V(scripts[0].is_null() || scripts[1].is_null(), NULL);
+
+	print_line("GDScript optimizer, code size: " + itos(_get_code_size(scripts[0])) + " words unoptimized, " + itos(_get_code_size(scripts[1])) + " optimized");
+
+	bool failed = false;
+
+	for (int i = 0; names[i]; i++) {
+
+		// functions taking an argument run with a few values, to go through every branch
+		int arg_count = scripts[0]->get_member_functions()[names[i]]->get_argument_count();
+		int runs = arg_count ? 3 : 1;
+
+		for (int j = 0; j < runs; j++) {
+
+			Variant arg = j * 4 - 1;
+			const Variant *args[1] = { &arg };
+			Variant results[2];
+
+			for (int k = 0; k < 2; k++) {
+
+				Object *obj = scripts[k].ptr(); // static functions are called on the script itself
+				Variant::CallError ce;
+				results[k] = obj->call(names[i], args, arg_count, ce);
+				if (ce.error != Variant::CallError::CALL_OK) {
+					ERR_PRINTS("\t" + String(names[i]) + ": call failed.");
+					failed = true;
+				}
+			}
+
+			// compare the printed values, so containers are compared by content
+			String texts[2] = { results[0].get_construct_string(), results[1].get_construct_string() };
+			if (texts[0] != texts[1]) {
+				ERR_PRINTS("\t" + String(names[i]) + ": results differ: " + texts[0] + " != " + texts[1]);
+				failed = true;
+			} else {
+				print_line("\t" + String(names[i]) + ": " + texts[1]);
+			}
+		}
+	}
+
+	print_line(failed ? "Optimizer test failed." : "Optimizer test passed.");
+
+	return NULL;
+}
+
+// Arguments passed by value must not change for the caller, whether the callee
+// borrows them or copies them because it writes to them.
+static const char *_arguments_code =
+		"extends Reference\n"
+		"\n"
+		"static func read_pool_vector3(p):\n"
+		"	return p.size()\n"
+		"\n"
+		"static func modify_pool_vector3(p):\n"
+		"	p[0] = Vector3(9, 9, 9)\n"
+		"	p.append(Vector3(4, 5, 6))\n"
+		"	return p.size()\n"
+		"\n"
+		"static func forward_pool_vector3(p):\n"
+		"	return modify_pool_vector3(p)\n"
+		"\n"
+		"static func read_bytes(b):\n"
+		"	return b[0] + b[1]\n"
+		"\n"
+		"static func modify_bytes(b):\n"
+		"	b.resize(1)\n"
+		"	b[0] = 255\n"
+		"	return b.size()\n"
+		"\n"
+		"static func assign_bytes(b):\n"
+		"	b = PoolByteArray([7, 7, 7])\n"
+		"	return b.size()\n"
+		"\n"
+		"static func forward_bytes(b):\n"
+		"	return modify_bytes(b) + assign_bytes(b)\n"
+		"\n"
+		"static func read_vector2(v):\n"
+		"	return v.x + v.y\n"
+		"\n"
+		"static func modify_vector2(v):\n"
+		"	v.x = 100\n"
+		"	v += Vector2(1, 1)\n"
+		"	return v\n"
+		"\n"
+		"static func forward_vector2(v):\n"
+		"	return modify_vector2(v)\n"
+		"\n"
+		"static func keeps_pool_vector3():\n"
+		"	var p = PoolVector3Array([Vector3(1, 2, 3)])\n"
+		"	var sizes = [read_pool_vector3(p), modify_pool_vector3(p), forward_pool_vector3(p)]\n"
+		"	return sizes == [1, 2, 2] and p.size() == 1 and p[0] == Vector3(1, 2, 3)\n"
+		"\n"
+		"static func keeps_bytes():\n"
+		"	var b = PoolByteArray([1, 2, 3])\n"
+		"	var sizes = [read_bytes(b), modify_bytes(b), assign_bytes(b), forward_bytes(b)]\n"
+		"	return sizes == [3, 1, 3, 4] and b.size() == 3 and b[0] == 1 and b[2] == 3\n"
+		"\n"
+		"static func keeps_vector2():\n"
+		"	var v = Vector2(1, 2)\n"
+		"	var results = [read_vector2(v), modify_vector2(v), forward_vector2(v)]\n"
+		"	return results == [3.0, Vector2(101, 3), Vector2(101, 3)] and v == Vector2(1, 2)\n";
+
+static MainLoop *test_arguments() {
+
+	struct Borrow {
+		const char *function;
+		Variant value;
+		bool borrowed;
+	};
+
+	PoolVector3Array pool_vector3;
+	PoolByteArray bytes;
+
+	// Reading and forwarding functions borrow, the ones writing their argument copy it.
+	const Borrow borrows[] = {
+		{ "read_pool_vector3", pool_vector3, true },
+		{ "forward_pool_vector3", pool_vector3, true },
+		{ "modify_pool_vector3", pool_vector3, false },
+		{ "read_bytes", bytes, true },
+		{ "forward_bytes", bytes, true },
+		{ "modify_bytes", bytes, false },
+		{ "assign_bytes", bytes, false },
+		{ "read_vector2", Vector2(), true },
+		{ "forward_vector2", Vector2(), true },
+		{ "modify_vector2", Vector2(), false },
+		{ NULL, Variant(), false },
+	};
+
+	const char *names[] = { "keeps_pool_vector3", "keeps_bytes", "keeps_vector2", NULL };
+
+	Ref<GDScript> scripts[2] = { _compile_script(_arguments_code, false), _compile_script(_arguments_code, true) };
+	ERR_FAIL_COND_V(scripts[0].is_null() || scripts[1].is_null(), NULL);
+
+	bool failed = false;
+
+	for (int i = 0; i < 2; i++) {
+
+		const Map<StringName, GDScriptFunction *> &functions = scripts[i]->get_member_functions();
+		String suffix = i ? " (optimized)" : "";
+
+		for (int j = 0; borrows[j].function; j++) {
+
+			bool borrowed = functions[borrows[j].function]->can_borrow_argument(0, borrows[j].value);
+			if (borrowed != borrows[j].borrowed) {
+				ERR_PRINTS("\t" + String(borrows[j].function) + suffix + ": argument " + (borrowed ? "borrowed" : "copied") + ", expected the opposite.");
+				failed = true;
+			}
+		}
+
+		for (int j = 0; names[j]; j++) {
+
+			Object *obj = scripts[i].ptr(); // static functions are called on the script itself
+			Variant::CallError ce;
+			Variant result = obj->call(names[j], NULL, 0, ce);
+			if (ce.error != Variant::CallError::CALL_OK || result != Variant(true)) {
+				ERR_PRINTS("\t" + String(names[j]) + suffix + ": caller's value changed.");
+				failed = true;
+			}
+		}
+	}
+
+	print_line(failed ? "Argument test failed." : "Argument test passed.");
+
+	return NULL;
+}
+
 MainLoop *test(TestType p_type) {
 
+	if (p_type == TEST_BENCHMARK) {
+		return test_benchmark();
+	}
+
+	if (p_type == TEST_OPTIMIZER) {
+		return test_optimizer();
+	}
+
+	if (p_type == TEST_ARGUMENTS) {
+		return test_arguments();
+	}
+
 	List<String> cmdlargs = OS::get_singleton()->get_cmdline_args();
 
 	if (cmdlargs.empty()) {
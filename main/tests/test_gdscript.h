@@ -40,6 +40,9 @@ enum TestType {
 	TEST_PARSER,
 	TEST_COMPILER,
 	TEST_BYTECODE,
+	TEST_BENCHMARK,
+	TEST_OPTIMIZER,
+	TEST_ARGUMENTS,
 };
 
 MainLoop *test(TestType p_type);
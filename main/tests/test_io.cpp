@@ -30,17 +30,21 @@
 
 #include "test_io.h"
 
-#ifdef MINIZIP_ENABLED
-
+#include "core/image.h"
+#include "core/io/file_access_pack.h"
+#include "core/io/pck_packer.h"
 #include "core/io/resource_loader.h"
 #include "core/io/resource_saver.h"
 #include "core/os/dir_access.h"
 #include "core/os/main_loop.h"
 #include "core/os/os.h"
+#include "core/os/worker_thread_pool.h"
 #include "core/print_string.h"
 #include "core/project_settings.h"
 #include "scene/resources/texture.h"
 
+#ifdef MINIZIP_ENABLED
+
 #include "core/io/file_access_memory.h"
 
 namespace TestIO {
@@ -131,3 +135,591 @@ MainLoop *test() {
 }
 } // namespace TestIO
 #endif
+
+namespace TestIO {
+
+static uint64_t _pack_read_files(const Vector<String> &p_paths, bool p_view, uint64_t &r_checksum) {
+
+	Vector<uint8_t> buffer;
+	r_checksum = 0;
+
+	uint64_t begin = OS::get_singleton()->get_ticks_usec();
+
+	for (int i = 0; i < p_paths.size(); i++) {
+
+		FileAccess *f = FileAccess::open(p_paths[i], FileAccess::READ);
+		ERR_CONTINUE(!f);
+
+		int len = f->get_len();
+		const uint8_t *data = p_view ? f->get_buffer_view(len) : NULL;
+		if (!data) {
+			buffer.resize(len);
+			f->get_buffer(buffer.ptrw(), len);
+			data = buffer.ptr();
+		}
+
+		// touch every page so mapped reads are actually paid for
+		for (int j = 0; j < len; j += 4096) {
+			r_checksum += data[j];
+		}
+
+		memdelete(f);
+	}
+
+	return OS::get_singleton()->get_ticks_usec() - begin;
+}
+
+static uint64_t _pack_load_resources(const Vector<String> &p_paths) {
+
+	uint64_t begin = OS::get_singleton()->get_ticks_usec();
+
+	for (int i = 0; i < p_paths.size(); i++) {
+
+		RES res = ResourceLoader::load(p_paths[i], "", true);
+		ERR_CONTINUE(res.is_null());
+	}
+
+	return OS::get_singleton()->get_ticks_usec() - begin;
+}
+
+MainLoop *test_pack() {
+
+	// Builds a pack of image resources (64 MB unless a size in MB is given as
+	// the last argument) and times reading and loading everything in it, with
+	// and without the pack memory mapped. The pack was just written, so these
+	// are warm page cache numbers.
+
+	List<String> cmdlargs = OS::get_singleton()->get_cmdline_args();
+	int pack_mb = 64;
+	if (cmdlargs.size() && cmdlargs.back()->get().to_int() > 0) {
+		pack_mb = cmdlargs.back()->get().to_int();
+	}
+
+	PackedData *packed_data = PackedData::get_singleton();
+	ERR_FAIL_COND_V(!packed_data || packed_data->is_disabled(), NULL);
+
+	DirAccess *da = DirAccess::create(DirAccess::ACCESS_FILESYSTEM);
+	String dir = OS::get_singleton()->get_user_data_dir().plus_file("pack_benchmark");
+	da->make_dir_recursive(dir);
+
+	const int image_size = 2048; // RGBA8, 16 MB each
+	int image_count = MAX(pack_mb / 16, 1);
+
+	PoolVector<uint8_t> pixels;
+	pixels.resize(image_size * image_size * 4);
+	{
+		PoolVector<uint8_t>::Write w = pixels.write();
+		for (int i = 0; i < pixels.size(); i++) {
+			w[i] = Math::rand() & 0xFF;
+		}
+	}
+
+	Ref<Image> image;
+	image.instance();
+	image->create(image_size, image_size, false, Image::FORMAT_RGBA8, pixels);
+
+	print_line("Writing " + itos(image_count) + " images to " + dir + ".pck");
+
+	Ref<PCKPacker> packer;
+	packer.instance();
+	packer->pck_start(dir + ".pck", 4096);
+
+	Vector<String> paths;
+	Vector<String> sources;
+
+	for (int i = 0; i < image_count; i++) {
+
+		String src = dir.plus_file("image_" + itos(i) + ".res");
+		if (ResourceSaver::save(src, image) != OK) {
+			ERR_PRINTS("Can't save " + src);
+			break;
+		}
+
+		String path = "res://pack_benchmark/image_" + itos(i) + ".res";
+		packer->add_file(path, src);
+		paths.push_back(path);
+		sources.push_back(src);
+	}
+
+	Error err = sources.size() == image_count ? packer->flush() : FAILED;
+	packer.unref();
+	image.unref();
+
+	for (int i = 0; i < sources.size(); i++) {
+		da->remove(sources[i]);
+	}
+	da->remove(dir);
+
+	packed_data->set_mmap_enabled(true);
+	uint64_t begin = OS::get_singleton()->get_ticks_usec();
+	if (err != OK || packed_data->add_pack(dir + ".pck") != OK) {
+		da->remove(dir + ".pck");
+		memdelete(da);
+		ERR_FAIL_V(NULL);
+	}
+	print_line("add_pack:\t\t" + rtos((OS::get_singleton()->get_ticks_usec() - begin) / 1000.0) + " msec");
+
+	uint64_t checksum = 0;
+	uint64_t checksum_mapped = 0;
+
+	// one pass to make sure the pack is resident before timing anything
+	_pack_read_files(paths, false, checksum);
+
+	packed_data->set_mmap_enabled(false);
+	print_line("get_buffer, file:\t" + rtos(_pack_read_files(paths, false, checksum) / 1000.0) + " msec");
+	print_line("load, file:\t\t" + rtos(_pack_load_resources(paths) / 1000.0) + " msec");
+
+	packed_data->set_mmap_enabled(true);
+	print_line("get_buffer, mapped:\t" + rtos(_pack_read_files(paths, false, checksum_mapped) / 1000.0) + " msec");
+	if (checksum != checksum_mapped) {
+		ERR_PRINT("Mapped reads differ from file reads");
+	}
+	print_line("get_buffer_view, mapped:\t" + rtos(_pack_read_files(paths, true, checksum_mapped) / 1000.0) + " msec");
+	if (checksum != checksum_mapped) {
+		ERR_PRINT("Mapped views differ from file reads");
+	}
+	print_line("load, mapped:\t\t" + rtos(_pack_load_resources(paths) / 1000.0) + " msec");
+
+	// the pack stays mapped until exit, unlinking it is fine
+	da->remove(dir + ".pck");
+	memdelete(da);
+
+	return NULL;
+}
+
+static bool _pack_verify_file(const String &p_path, const Vector<uint8_t> &p_source) {
+
+	FileAccess *f = FileAccess::open(p_path, FileAccess::READ);
+	if (!f) {
+		ERR_PRINTS("Can't open from pack: " + p_path);
+		return false;
+	}
+
+	bool ok = f->get_len() == (size_t)p_source.size();
+	Vector<uint8_t> data;
+	data.resize(p_source.size());
+
+	// whole file at once
+	if (ok) {
+		ok = f->get_buffer(data.ptrw(), data.size()) == data.size();
+		ok = ok && memcmp(data.ptr(), p_source.ptr(), data.size()) == 0;
+	}
+
+	// starting in the middle of the second block, up to the end
+	int mid = MIN(FileAccessPackCompressed::BLOCK_SIZE + FileAccessPackCompressed::BLOCK_SIZE / 2 + 3, p_source.size());
+	if (ok) {
+		f->seek(mid);
+		int len = p_source.size() - mid;
+		ok = f->get_buffer(data.ptrw(), len) == len;
+		ok = ok && memcmp(data.ptr(), p_source.ptr() + mid, len) == 0;
+	}
+
+	// byte by byte, which goes through the block cache
+	if (ok) {
+		f->seek(0);
+		for (int i = 0; i < p_source.size() && ok; i++) {
+			ok = f->get_8() == p_source[i];
+		}
+	}
+
+	memdelete(f);
+
+	if (!ok) {
+		ERR_PRINTS("Packed file differs from its source: " + p_path);
+	}
+	return ok;
+}
+
+MainLoop *test_pack_verify() {
+
+	// Packs a compressible and an incompressible file with compression
+	// requested, and checks what reads back through the pack.
+
+	PackedData *packed_data = PackedData::get_singleton();
+	ERR_FAIL_COND_V(!packed_data || packed_data->is_disabled(), NULL);
+
+	DirAccess *da = DirAccess::create(DirAccess::ACCESS_FILESYSTEM);
+	String dir = OS::get_singleton()->get_user_data_dir().plus_file("pack_verify");
+	da->make_dir_recursive(dir);
+
+	const int block_size = FileAccessPackCompressed::BLOCK_SIZE;
+
+	Vector<String> names;
+	Vector<Vector<uint8_t> > sources;
+
+	Vector<uint8_t> compressible;
+	compressible.resize(block_size * 3 + 12345);
+	for (int i = 0; i < compressible.size(); i++) {
+		compressible.write[i] = (i / 64) & 0x7;
+	}
+	names.push_back("compressible.bin");
+	sources.push_back(compressible);
+
+	Vector<uint8_t> incompressible;
+	incompressible.resize(block_size + 777);
+	for (int i = 0; i < incompressible.size(); i++) {
+		incompressible.write[i] = Math::rand() & 0xFF;
+	}
+	names.push_back("incompressible.bin");
+	sources.push_back(incompressible);
+
+	Ref<PCKPacker> packer;
+	packer.instance();
+	ERR_FAIL_COND_V(packer->pck_start(dir + ".pck", 16) != OK, NULL);
+
+	uint64_t source_size = 0;
+	for (int i = 0; i < names.size(); i++) {
+
+		String src = dir.plus_file(names[i]);
+		FileAccess *f = FileAccess::open(src, FileAccess::WRITE);
+		ERR_FAIL_COND_V(!f, NULL);
+		f->store_buffer(sources[i].ptr(), sources[i].size());
+		memdelete(f);
+
+		packer->add_file("res://pack_verify/" + names[i], src, true);
+		source_size += sources[i].size();
+	}
+
+	bool failed = packer->flush() != OK;
+	packer.unref();
+
+	for (int i = 0; i < names.size(); i++) {
+		da->remove(dir.plus_file(names[i]));
+	}
+	da->remove(dir);
+
+	// only the compressible file can have shrunk
+	FileAccess *pck = FileAccess::open(dir + ".pck", FileAccess::READ);
+	if (!pck || pck->get_len() >= source_size) {
+		ERR_PRINT("Compression didn't shrink the pack.");
+		failed = true;
+	}
+	if (pck) {
+		memdelete(pck);
+	}
+
+	if (!failed && packed_data->add_pack(dir + ".pck") != OK) {
+		ERR_PRINT("add_pack failed.");
+		failed = true;
+	}
+
+	for (int i = 0; i < names.size() && !failed; i++) {
+
+		packed_data->set_mmap_enabled(false);
+		failed = !_pack_verify_file("res://pack_verify/" + names[i], sources[i]);
+
+		if (!failed) {
+			packed_data->set_mmap_enabled(true);
+			failed = !_pack_verify_file("res://pack_verify/" + names[i], sources[i]);
+		}
+	}
+
+	da->remove(dir + ".pck");
+	memdelete(da);
+
+	print_line(failed ? "Pack verify test failed." : "Pack verify test passed.");
+
+	return NULL;
+}
+
+static Error _pack_index_build(const String &p_pack, const String &p_dir, const Map<String, String> &p_files) {
+
+	Ref<PCKPacker> packer;
+	packer.instance();
+	Error err = packer->pck_start(p_pack, 16);
+	ERR_FAIL_COND_V(err != OK, err);
+
+	Vector<String> sources;
+	for (const Map<String, String>::Element *E = p_files.front(); E; E = E->next()) {
+
+		String src = p_dir.plus_file("source_" + itos(sources.size()) + ".txt");
+		FileAccess *f = FileAccess::open(src, FileAccess::WRITE);
+		ERR_FAIL_COND_V(!f, ERR_CANT_CREATE);
+		f->store_string(E->get());
+		memdelete(f);
+
+		packer->add_file(E->key(), src);
+		sources.push_back(src);
+	}
+
+	err = packer->flush();
+
+	DirAccess *da = DirAccess::create(DirAccess::ACCESS_FILESYSTEM);
+	for (int i = 0; i < sources.size(); i++) {
+		da->remove(sources[i]);
+	}
+	memdelete(da);
+
+	return err;
+}
+
+static String _pack_index_read(const String &p_path) {
+
+	FileAccess *f = FileAccess::open(p_path, FileAccess::READ);
+	if (!f) {
+		return String();
+	}
+	String text = f->get_line();
+	memdelete(f);
+	return text;
+}
+
+MainLoop *test_pack_index() {
+
+	// Looks files up in version 2 pack indexes, checks that a pack added
+	// later overrides an earlier one, and lists the resulting directories.
+
+	PackedData *packed_data = PackedData::get_singleton();
+	ERR_FAIL_COND_V(!packed_data || packed_data->is_disabled(), NULL);
+
+	DirAccess *da = DirAccess::create(DirAccess::ACCESS_FILESYSTEM);
+	String dir = OS::get_singleton()->get_user_data_dir().plus_file("pack_index");
+	da->make_dir_recursive(dir);
+
+	// enough files to spread over several buckets
+	const int file_count = 300;
+
+	Map<String, String> first;
+	for (int i = 0; i < file_count; i++) {
+		first["res://pack_index/a/file_" + itos(i) + ".txt"] = "a" + itos(i);
+	}
+	first["res://pack_index/shared.txt"] = "first";
+
+	Map<String, String> second;
+	second["res://pack_index/shared.txt"] = "second";
+	second["res://pack_index/b/only_b.txt"] = "b";
+
+	bool failed = false;
+	if (_pack_index_build(dir.plus_file("first.pck"), dir, first) != OK || _pack_index_build(dir.plus_file("second.pck"), dir, second) != OK) {
+		ERR_PRINT("Couldn't build the packs.");
+		failed = true;
+	}
+
+	if (!failed && (packed_data->add_pack(dir.plus_file("first.pck")) != OK || packed_data->add_pack(dir.plus_file("second.pck")) != OK)) {
+		ERR_PRINT("add_pack failed.");
+		failed = true;
+	}
+
+	if (!failed) {
+
+		for (int i = 0; i < file_count; i++) {
+			String path = "res://pack_index/a/file_" + itos(i) + ".txt";
+			if (!packed_data->has_path(path) || _pack_index_read(path) != "a" + itos(i)) {
+				ERR_PRINTS("Pack index lookup failed: " + path);
+				failed = true;
+				break;
+			}
+		}
+
+		if (packed_data->has_path("res://pack_index/a/file_" + itos(file_count) + ".txt") || packed_data->has_path("res://pack_index/missing.txt") || packed_data->has_path("res://pack_index/a")) {
+			ERR_PRINT("Pack index found a path that isn't packed.");
+			failed = true;
+		}
+
+		if (_pack_index_read("res://pack_index/shared.txt") != "second") {
+			ERR_PRINT("The pack added last doesn't override the first.");
+			failed = true;
+		}
+		if (_pack_index_read("res://pack_index/b/only_b.txt") != "b") {
+			ERR_PRINT("File only in the second pack not found.");
+			failed = true;
+		}
+	}
+
+	if (!failed) {
+
+		DirAccessPack *dap = memnew(DirAccessPack);
+
+		Set<String> dirs;
+		Set<String> files;
+		if (dap->change_dir("res://pack_index") == OK) {
+			dap->list_dir_begin();
+			String entry;
+			while ((entry = dap->get_next()) != "") {
+				if (dap->current_is_dir()) {
+					dirs.insert(entry);
+				} else {
+					files.insert(entry);
+				}
+			}
+			dap->list_dir_end();
+		}
+		if (dirs.size() != 2 || !dirs.has("a") || !dirs.has("b") || files.size() != 1 || !files.has("shared.txt")) {
+			ERR_PRINT("Pack directory listed wrong.");
+			failed = true;
+		}
+
+		int listed_files = 0;
+		int listed_dirs = 0;
+		if (dap->change_dir("a") == OK) {
+			dap->list_dir_begin();
+			while (dap->get_next() != "") {
+				if (dap->current_is_dir()) {
+					listed_dirs++;
+				} else {
+					listed_files++;
+				}
+			}
+			dap->list_dir_end();
+		}
+		if (listed_files != file_count || listed_dirs != 0 || !dap->file_exists("file_0.txt")) {
+			ERR_PRINT("Pack subdirectory listed wrong.");
+			failed = true;
+		}
+
+		memdelete(dap);
+	}
+
+	// the packs may stay mapped until exit, unlinking them is fine
+	da->remove(dir.plus_file("first.pck"));
+	da->remove(dir.plus_file("second.pck"));
+	da->remove(dir);
+	memdelete(da);
+
+	print_line(failed ? "Pack index test failed." : "Pack index test passed.");
+
+	return NULL;
+}
+
+static bool _threaded_wait(const Vector<String> &p_paths, bool p_finalize, uint64_t p_timeout_usec) {
+
+	uint64_t begin = OS::get_singleton()->get_ticks_usec();
+
+	while (true) {
+
+		bool loaded = true;
+		for (int i = 0; i < p_paths.size(); i++) {
+
+			ResourceLoader::ThreadLoadStatus status = ResourceLoader::load_threaded_get_status(p_paths[i]);
+			if (status == ResourceLoader::THREAD_LOAD_IN_PROGRESS) {
+				loaded = false;
+			} else if (status != ResourceLoader::THREAD_LOAD_LOADED) {
+				ERR_PRINTS("Threaded load failed: " + p_paths[i]);
+				return false;
+			}
+		}
+
+		if (loaded)
+			return true;
+
+		if (OS::get_singleton()->get_ticks_usec() - begin > p_timeout_usec)
+			return false;
+
+		// what the main loop does each frame
+		if (p_finalize) {
+			ResourceLoader::finalize_threaded_loads(1000);
+		}
+		OS::get_singleton()->delay_usec(1000);
+	}
+}
+
+MainLoop *test_threaded_load() {
+
+	// Loads an image resource, done on a worker, and a stream texture, whose
+	// upload is left to finalize_threaded_loads() on the main thread.
+
+	const int size = 16;
+	String dir = "res://threaded_load_test";
+
+	DirAccess *da = DirAccess::create(DirAccess::ACCESS_RESOURCES);
+	da->make_dir_recursive(dir);
+
+	PoolVector<uint8_t> pixels;
+	pixels.resize(size * size * 4);
+	{
+		PoolVector<uint8_t>::Write w = pixels.write();
+		for (int i = 0; i < pixels.size(); i++) {
+			w[i] = i & 0xFF;
+		}
+	}
+
+	Ref<Image> image;
+	image.instance();
+	image->create(size, size, false, Image::FORMAT_RGBA8, pixels);
+
+	String image_path = dir.plus_file("image.res");
+	ERR_FAIL_COND_V(ResourceSaver::save(image_path, image) != OK, NULL);
+
+	// uncompressed, no mipmaps
+	String texture_path = dir.plus_file("texture.stex");
+	FileAccess *f = FileAccess::open(texture_path, FileAccess::WRITE);
+	ERR_FAIL_COND_V(!f, NULL);
+	f->store_buffer((const uint8_t *)"GDST", 4);
+	f->store_32(size);
+	f->store_32(size);
+	f->store_32(0);
+	f->store_32(Image::FORMAT_RGBA8);
+	{
+		PoolVector<uint8_t>::Read r = pixels.read();
+		f->store_buffer(r.ptr(), pixels.size());
+	}
+	memdelete(f);
+
+	Vector<String> paths;
+	paths.push_back(image_path);
+	paths.push_back(texture_path);
+
+	bool failed = false;
+
+	for (int i = 0; i < paths.size(); i++) {
+		if (ResourceLoader::load_threaded_request(paths[i]) != OK) {
+			ERR_PRINTS("Request failed: " + paths[i]);
+			failed = true;
+		}
+	}
+
+	if (!failed && WorkerThreadPool::get_singleton()->get_thread_count() > 0) {
+
+		// Without a frame, the image loads but the texture waits for its upload.
+		Vector<String> image_only;
+		image_only.push_back(image_path);
+		if (!_threaded_wait(image_only, false, 10000000)) {
+			ERR_PRINT("Image didn't load on a worker.");
+			failed = true;
+		}
+
+		OS::get_singleton()->delay_usec(100000);
+		if (ResourceLoader::load_threaded_get_status(texture_path) != ResourceLoader::THREAD_LOAD_IN_PROGRESS) {
+			ERR_PRINT("Texture counted as loaded before finalize_threaded_loads() uploaded it.");
+			failed = true;
+		}
+	}
+
+	if (!failed && !_threaded_wait(paths, true, 10000000)) {
+		ERR_PRINT("Threaded loads didn't finish.");
+		failed = true;
+	}
+
+	Ref<Image> loaded_image = ResourceLoader::load_threaded_get(image_path);
+	Ref<StreamTexture> loaded_texture = ResourceLoader::load_threaded_get(texture_path);
+
+	if (loaded_image.is_null() || loaded_image->get_width() != size || Variant(loaded_image->get_data()) != Variant(pixels)) {
+		ERR_PRINT("Image loaded wrong.");
+		failed = true;
+	}
+	if (loaded_texture.is_null() || loaded_texture->get_width() != size || loaded_texture->get_height() != size) {
+		ERR_PRINT("Texture loaded wrong.");
+		failed = true;
+	}
+
+	// every request was matched by a get, nothing is left behind
+	for (int i = 0; i < paths.size(); i++) {
+		if (ResourceLoader::load_threaded_get_status(paths[i]) != ResourceLoader::THREAD_LOAD_INVALID_RESOURCE) {
+			ERR_PRINTS("Request still tracked after load_threaded_get(): " + paths[i]);
+			failed = true;
+		}
+	}
+
+	loaded_image.unref();
+	loaded_texture.unref();
+
+	da->remove(image_path);
+	da->remove(texture_path);
+	da->remove(dir);
+	memdelete(da);
+
+	print_line(failed ? "Threaded load test failed." : "Threaded load test passed.");
+
+	return NULL;
+}
+} // namespace TestIO
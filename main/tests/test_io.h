@@ -40,6 +40,10 @@
 namespace TestIO {
 
 MainLoop *test();
+MainLoop *test_pack();
+MainLoop *test_pack_verify();
+MainLoop *test_pack_index();
+MainLoop *test_threaded_load();
 }
 
 #endif
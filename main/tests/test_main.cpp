@@ -46,26 +46,43 @@
 #include "test_render.h"
 #include "test_shader_lang.h"
 #include "test_string.h"
+#include "test_variant.h"
+#include "test_worker_thread_pool.h"
 
 const char **tests_get_names() {
 
 	static const char *test_names[] = {
 		"string",
+		"string_name",
 		"math",
 		"physics",
+		"physics_narrowphase",
+		"physics_broadphase",
 		"physics_2d",
+		"physics_2d_broadphase",
 		"render",
+		"render_cull",
+		"render_bvh",
 		"oa_hash_map",
 		"gui",
 		"io",
+		"io_pack",
+		"io_pack_verify",
+		"io_pack_index",
+		"io_threaded",
 		"shaderlang",
 		"gd_tokenizer",
 		"gd_parser",
 		"gd_compiler",
 		"gd_bytecode",
+		"gd_benchmark",
+		"gd_optimizer",
+		"gd_arguments",
 		"image",
 		"ordered_hash_map",
 		"astar",
+		"worker_thread_pool",
+		"variant",
 		NULL
 	};
 
@@ -79,6 +96,11 @@ MainLoop *test_main(String p_test, const List<String> &p_args) {
 		return TestString::test();
 	}
 
+	if (p_test == "string_name") {
+
+		return TestString::test_string_name();
+	}
+
 	if (p_test == "math") {
 
 		return TestMath::test();
@@ -89,16 +111,41 @@ MainLoop *test_main(String p_test, const List<String> &p_args) {
 		return TestPhysics::test();
 	}
 
+	if (p_test == "physics_narrowphase") {
+
+		return TestPhysics::test_narrowphase();
+	}
+
+	if (p_test == "physics_broadphase") {
+
+		return TestPhysics::test_broadphase();
+	}
+
 	if (p_test == "physics_2d") {
 
 		return TestPhysics2D::test();
 	}
 
+	if (p_test == "physics_2d_broadphase") {
+
+		return TestPhysics2D::test_broadphase();
+	}
+
 	if (p_test == "render") {
 
 		return TestRender::test();
 	}
 
+	if (p_test == "render_cull") {
+
+		return TestRender::test_cull();
+	}
+
+	if (p_test == "render_bvh") {
+
+		return TestRender::test_bvh();
+	}
+
 	if (p_test == "oa_hash_map") {
 
 		return TestOAHashMap::test();
@@ -116,6 +163,26 @@ MainLoop *test_main(String p_test, const List<String> &p_args) {
 		return TestIO::test();
 	}
 
+	if (p_test == "io_pack") {
+
+		return TestIO::test_pack();
+	}
+
+	if (p_test == "io_pack_verify") {
+
+		return TestIO::test_pack_verify();
+	}
+
+	if (p_test == "io_pack_index") {
+
+		return TestIO::test_pack_index();
+	}
+
+	if (p_test == "io_threaded") {
+
+		return TestIO::test_threaded_load();
+	}
+
 	if (p_test == "shaderlang") {
 
 		return TestShaderLang::test();
@@ -141,6 +208,21 @@ MainLoop *test_main(String p_test, const List<String> &p_args) {
 		return TestGDScript::test(TestGDScript::TEST_BYTECODE);
 	}
 
+	if (p_test == "gd_benchmark") {
+
+		return TestGDScript::test(TestGDScript::TEST_BENCHMARK);
+	}
+
+	if (p_test == "gd_optimizer") {
+
+		return TestGDScript::test(TestGDScript::TEST_OPTIMIZER);
+	}
+
+	if (p_test == "gd_arguments") {
+
+		return TestGDScript::test(TestGDScript::TEST_ARGUMENTS);
+	}
+
 	if (p_test == "image") {
 
 		return TestImage::test();
@@ -156,6 +238,16 @@ MainLoop *test_main(String p_test, const List<String> &p_args) {
 		return TestAStar::test();
 	}
 
+	if (p_test == "worker_thread_pool") {
+
+		return TestWorkerThreadPool::test();
+	}
+
+	if (p_test == "variant") {
+
+		return TestVariant::test();
+	}
+
 	return NULL;
 }
 
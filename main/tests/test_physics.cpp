@@ -36,6 +36,14 @@
 #include "core/os/main_loop.h"
 #include "core/os/os.h"
 #include "core/print_string.h"
+#include "core/set.h"
+#include "servers/physics/broad_phase_aabb_tree.h"
+#include "servers/physics/broad_phase_basic.h"
+#include "servers/physics/broad_phase_octree.h"
+#include "servers/physics/collision_object_sw.h"
+#include "servers/physics/collision_solver_sw.h"
+#include "servers/physics/shape_sw.h"
+#include "servers/physics/vertex_scan_sw.h"
 #include "servers/physics_server.h"
 #include "servers/visual_server.h"
 
@@ -436,4 +444,400 @@ MainLoop *test() {
 
 	return memnew(TestPhysicsMainLoop);
 }
+
+/* Narrow phase: compares the SIMD vertex scans against the scalar reference */
+struct NarrowphasePair {
+	ShapeSW *shape_A;
+	Transform xform_A;
+	ShapeSW *shape_B;
+	Transform xform_B;
+};
+
+struct NarrowphaseResult {
+	bool collided;
+	Vector<Vector3> contacts;
+};
+
+static void _narrowphase_contact(const Vector3 &p_point_A, const Vector3 &p_point_B, void *p_userdata) {
+
+	NarrowphaseResult *res = (NarrowphaseResult *)p_userdata;
+	res->contacts.push_back(p_point_A);
+	res->contacts.push_back(p_point_B);
+}
+
+static Vector3 _random_unit_vector() {
+
+	Vector3 v;
+	do {
+		v = Vector3(Math::random(-1.0, 1.0), Math::random(-1.0, 1.0), Math::random(-1.0, 1.0));
+	} while (v.length_squared() < 0.01 || v.length_squared() > 1.0);
+	return v.normalized();
+}
+
+static Transform _random_transform(real_t p_distance) {
+
+	return Transform(Basis(_random_unit_vector(), Math::random(0.0, Math_PI * 2.0)), _random_unit_vector() * Math::random(0.0, p_distance));
+}
+
+static ShapeSW *_random_convex(int p_points) {
+
+	PoolVector<Vector3> points;
+	points.resize(p_points);
+	{
+		PoolVector<Vector3>::Write w = points.write();
+		for (int i = 0; i < p_points; i++) {
+			w[i] = _random_unit_vector() * Math::random(0.8, 1.0);
+		}
+	}
+
+	ConvexPolygonShapeSW *shape = memnew(ConvexPolygonShapeSW);
+	shape->set_data(points);
+	return shape;
+}
+
+static void _solve_pairs(const Vector<NarrowphasePair> &p_pairs, Vector<NarrowphaseResult> &r_results) {
+
+	r_results.resize(p_pairs.size());
+	for (int i = 0; i < p_pairs.size(); i++) {
+
+		const NarrowphasePair &pair = p_pairs[i];
+		NarrowphaseResult &res = r_results.write[i];
+		res.contacts.clear();
+		res.collided = CollisionSolverSW::solve_static(pair.shape_A, pair.xform_A, pair.shape_B, pair.xform_B, _narrowphase_contact, &res);
+	}
+}
+
+bool test_vertex_scan() {
+
+	if (!VertexScanSW::has_simd()) {
+		OS::get_singleton()->print("\tno SIMD path in this build, skipping\n");
+		return true;
+	}
+
+	Vector<Vector3> vertices;
+	vertices.resize(64);
+	bool ok = true;
+
+	for (int i = 0; i < 10000; i++) {
+
+		int count = 1 + i % vertices.size();
+		for (int j = 0; j < count; j++) {
+			// Duplicate some vertices to exercise ties.
+			vertices.write[j] = (j > 0 && j % 5 == 0) ? vertices[j / 2] : _random_unit_vector() * Math::random(0.0, 10.0);
+		}
+		Vector3 axis = _random_unit_vector();
+
+		real_t min_ref, max_ref, min_simd, max_simd;
+		VertexScanSW::project_range_scalar(vertices.ptr(), count, axis, min_ref, max_ref);
+		VertexScanSW::project_range(vertices.ptr(), count, axis, min_simd, max_simd);
+
+		ok = ok && min_ref == min_simd && max_ref == max_simd;
+		ok = ok && VertexScanSW::get_support_scalar(vertices.ptr(), count, axis) == VertexScanSW::get_support(vertices.ptr(), count, axis);
+	}
+
+	return ok;
+}
+
+bool test_narrowphase_batch() {
+
+	const int pair_count = 4000;
+	const real_t tolerance = 0.001;
+
+	Vector<ShapeSW *> shapes;
+	Vector<NarrowphasePair> pairs;
+
+	BoxShapeSW *box = memnew(BoxShapeSW);
+	box->set_data(Vector3(0.6, 0.4, 0.8));
+	shapes.push_back(box);
+
+	CapsuleShapeSW *capsule = memnew(CapsuleShapeSW);
+	Dictionary capsule_data;
+	capsule_data["radius"] = 0.4;
+	capsule_data["height"] = 1.0;
+	capsule->set_data(capsule_data);
+	shapes.push_back(capsule);
+
+	for (int i = 0; i < 32; i++) {
+		shapes.push_back(_random_convex(8 + i * 2));
+	}
+
+	for (int i = 0; i < pair_count; i++) {
+
+		NarrowphasePair pair;
+		pair.shape_A = shapes[2 + Math::rand() % (shapes.size() - 2)];
+		pair.shape_B = shapes[Math::rand() % shapes.size()];
+		pair.xform_A = _random_transform(0.5);
+		pair.xform_B = _random_transform(2.0);
+		pairs.push_back(pair);
+	}
+
+	Vector<NarrowphaseResult> results_ref, results_simd;
+
+	VertexScanSW::set_simd_enabled(false);
+	uint64_t from = OS::get_singleton()->get_ticks_usec();
+	_solve_pairs(pairs, results_ref);
+	uint64_t ref_usec = OS::get_singleton()->get_ticks_usec() - from;
+
+	VertexScanSW::set_simd_enabled(true);
+	from = OS::get_singleton()->get_ticks_usec();
+	_solve_pairs(pairs, results_simd);
+	uint64_t simd_usec = OS::get_singleton()->get_ticks_usec() - from;
+
+	int collisions = 0;
+	int mismatches = 0;
+	for (int i = 0; i < pair_count; i++) {
+
+		const NarrowphaseResult &a = results_ref[i];
+		const NarrowphaseResult &b = results_simd[i];
+
+		bool same = a.collided == b.collided && a.contacts.size() == b.contacts.size();
+		for (int j = 0; same && j < a.contacts.size(); j++) {
+			same = a.contacts[j].distance_to(b.contacts[j]) < tolerance;
+		}
+
+		if (a.collided)
+			collisions++;
+		if (!same)
+			mismatches++;
+	}
+
+	for (int i = 0; i < shapes.size(); i++) {
+		memdelete(shapes[i]);
+	}
+
+	OS::get_singleton()->print("\t%i pairs, %i colliding, %i mismatches\n", pair_count, collisions, mismatches);
+	OS::get_singleton()->print("\tscalar: %.3f msec\n", ref_usec / 1000.0);
+	OS::get_singleton()->print("\t%s: %.3f msec\n", VertexScanSW::has_simd() ? "simd" : "simd (unavailable, scalar)", simd_usec / 1000.0);
+
+	// Both paths evaluate the same dot products in the same order and break
+	// ties alike (see VertexScanSW), so every pair must agree. The contact
+	// tolerance only absorbs compilers fusing the scalar multiply-adds.
+	return mismatches == 0;
+}
+
+/* Broad phase: checks pairs and culling, and compares throughput of the implementations */
+
+class BroadphaseTestObject : public CollisionObjectSW {
+public:
+	int index;
+
+	virtual void _shapes_changed() {}
+	virtual void set_space(SpaceSW *p_space) {}
+
+	BroadphaseTestObject() :
+			CollisionObjectSW(TYPE_BODY) {
+		index = 0;
+	}
+};
+
+struct BroadphasePairs {
+	Set<uint64_t> pairs;
+};
+
+static uint64_t _broadphase_pair_key(CollisionObjectSW *p_a, CollisionObjectSW *p_b) {
+
+	uint64_t a = static_cast<BroadphaseTestObject *>(p_a)->index;
+	uint64_t b = static_cast<BroadphaseTestObject *>(p_b)->index;
+	return a < b ? (a << 32) | b : (b << 32) | a;
+}
+
+static void *_broadphase_pair(CollisionObjectSW *p_a, int p_subindex_A, CollisionObjectSW *p_b, int p_subindex_B, void *p_userdata) {
+
+	BroadphasePairs *bp = (BroadphasePairs *)p_userdata;
+	bp->pairs.insert(_broadphase_pair_key(p_a, p_b));
+	return NULL;
+}
+
+static void _broadphase_unpair(CollisionObjectSW *p_a, int p_subindex_A, CollisionObjectSW *p_b, int p_subindex_B, void *p_data, void *p_userdata) {
+
+	BroadphasePairs *bp = (BroadphasePairs *)p_userdata;
+	bp->pairs.erase(_broadphase_pair_key(p_a, p_b));
+}
+
+static bool _test_broadphase(const String &p_name, BroadPhaseSW *p_broadphase) {
+
+	const int object_count = 1000;
+	const int frames = 20;
+	const real_t world_size = 50.0;
+
+	// same scene for every implementation
+	Math::seed(1234);
+
+	Vector<BroadphaseTestObject *> objects;
+	Vector<AABB> aabbs;
+	Vector<Vector3> velocities;
+	Vector<bool> statics;
+	Vector<BroadPhaseSW::ID> ids;
+
+	for (int i = 0; i < object_count; i++) {
+
+		BroadphaseTestObject *obj = memnew(BroadphaseTestObject);
+		obj->index = i;
+		objects.push_back(obj);
+
+		real_t extent = (i % 10 == 0) ? 8.0 : Math::random(0.5, 1.5);
+		Vector3 pos(Math::random(0.0, world_size), Math::random(0.0, world_size), Math::random(0.0, world_size));
+		aabbs.push_back(AABB(pos - Vector3(extent, extent, extent), Vector3(extent, extent, extent) * 2.0));
+		velocities.push_back(_random_unit_vector() * Math::random(0.0, 0.5));
+		statics.push_back(i % 5 == 0);
+	}
+
+	BroadphasePairs pairs;
+	p_broadphase->set_pair_callback(_broadphase_pair, &pairs);
+	p_broadphase->set_unpair_callback(_broadphase_unpair, &pairs);
+
+	uint64_t from = OS::get_singleton()->get_ticks_usec();
+	for (int i = 0; i < object_count; i++) {
+
+		BroadPhaseSW::ID id = p_broadphase->create(objects[i]);
+		p_broadphase->set_static(id, statics[i]);
+		p_broadphase->move(id, aabbs[i]);
+		ids.push_back(id);
+	}
+	p_broadphase->update();
+	uint64_t insert_usec = OS::get_singleton()->get_ticks_usec() - from;
+
+	from = OS::get_singleton()->get_ticks_usec();
+	for (int f = 0; f < frames; f++) {
+
+		for (int i = 0; i < object_count; i++) {
+
+			if (statics[i])
+				continue;
+
+			AABB &aabb = aabbs.write[i];
+			aabb.position += velocities[i];
+			for (int j = 0; j < 3; j++) {
+				if (aabb.position[j] < 0 || aabb.position[j] > world_size)
+					velocities.write[i][j] = -velocities[i][j];
+			}
+			p_broadphase->move(ids[i], aabb);
+		}
+		p_broadphase->update();
+	}
+	uint64_t step_usec = OS::get_singleton()->get_ticks_usec() - from;
+
+	bool ok = true;
+
+	// every overlapping pair must be reported, implementations may report more
+	int overlapping = 0;
+	for (int i = 0; i < object_count; i++) {
+		for (int j = i + 1; j < object_count; j++) {
+
+			if ((statics[i] && statics[j]) || !aabbs[i].intersects(aabbs[j]))
+				continue;
+
+			overlapping++;
+			if (!pairs.pairs.has((uint64_t(i) << 32) | j))
+				ok = false;
+		}
+	}
+
+	CollisionObjectSW *results[object_count];
+	int subindices[object_count];
+	for (int i = 0; i < 100; i++) {
+
+		Vector3 pos(Math::random(0.0, world_size), Math::random(0.0, world_size), Math::random(0.0, world_size));
+		AABB query(pos, Vector3(5, 5, 5));
+		Vector3 to = pos + _random_unit_vector() * 20.0;
+
+		int expected_aabb = 0;
+		int expected_segment = 0;
+		int expected_point = 0;
+		for (int j = 0; j < object_count; j++) {
+
+			if (aabbs[j].intersects(query))
+				expected_aabb++;
+			if (aabbs[j].intersects_segment(pos, to))
+				expected_segment++;
+			if (aabbs[j].has_point(pos))
+				expected_point++;
+		}
+
+		ok = ok && p_broadphase->cull_aabb(query, results, object_count, subindices) == expected_aabb;
+		ok = ok && p_broadphase->cull_segment(pos, to, results, object_count, subindices) == expected_segment;
+		ok = ok && p_broadphase->cull_point(pos, results, object_count, subindices) == expected_point;
+	}
+
+	int reported = pairs.pairs.size();
+
+	from = OS::get_singleton()->get_ticks_usec();
+	for (int i = 0; i < object_count; i++) {
+		p_broadphase->remove(ids[i]);
+	}
+	uint64_t remove_usec = OS::get_singleton()->get_ticks_usec() - from;
+
+	// removing must release every pair right away
+	ok = ok && pairs.pairs.size() == 0;
+
+	for (int i = 0; i < object_count; i++) {
+		memdelete(objects[i]);
+	}
+	memdelete(p_broadphase);
+
+	OS::get_singleton()->print("\t%s: insert %.3f msec, move+update %.3f msec/frame, remove %.3f msec, %i pairs (%i overlapping)\n", p_name.utf8().get_data(), insert_usec / 1000.0, step_usec / 1000.0 / frames, remove_usec / 1000.0, reported, overlapping);
+
+	return ok;
+}
+
+bool test_broadphase_octree() {
+
+	return _test_broadphase("octree", BroadPhaseOctree::_create());
+}
+
+bool test_broadphase_aabb_tree() {
+
+	return _test_broadphase("aabb tree", BroadPhaseAABBTree::_create());
+}
+
+bool test_broadphase_basic() {
+
+	return _test_broadphase("basic", BroadPhaseBasic::_create());
+}
+
+typedef bool (*TestFunc)(void);
+
+static MainLoop *_run_tests(TestFunc *p_funcs) {
+
+	int count = 0;
+	int passed = 0;
+
+	while (true) {
+		if (!p_funcs[count])
+			break;
+		bool pass = p_funcs[count]();
+		if (pass)
+			passed++;
+		OS::get_singleton()->print("\t%s\n", pass ? "PASS" : "FAILED");
+
+		count++;
+	}
+	OS::get_singleton()->print("\n");
+	OS::get_singleton()->print("Passed %i of %i tests\n", passed, count);
+	return NULL;
+}
+
+TestFunc narrowphase_test_funcs[] = {
+	test_vertex_scan,
+	test_narrowphase_batch,
+	NULL
+};
+
+TestFunc broadphase_test_funcs[] = {
+	test_broadphase_octree,
+	test_broadphase_aabb_tree,
+	test_broadphase_basic,
+	NULL
+};
+
+MainLoop *test_narrowphase() {
+
+	return _run_tests(narrowphase_test_funcs);
+}
+
+MainLoop *test_broadphase() {
+
+	return _run_tests(broadphase_test_funcs);
+}
+
 } // namespace TestPhysics
@@ -40,6 +40,8 @@
 namespace TestPhysics {
 
 MainLoop *test();
+MainLoop *test_narrowphase();
+MainLoop *test_broadphase();
 }
 
 #endif
@@ -34,7 +34,11 @@
 #include "core/os/main_loop.h"
 #include "core/os/os.h"
 #include "core/print_string.h"
+#include "core/set.h"
 #include "scene/resources/texture.h"
+#include "servers/physics_2d/broad_phase_2d_basic.h"
+#include "servers/physics_2d/broad_phase_2d_hash_grid.h"
+#include "servers/physics_2d/collision_object_2d_sw.h"
 #include "servers/physics_2d_server.h"
 #include "servers/visual_server.h"
 
@@ -432,4 +436,222 @@ MainLoop *test() {
 
 	return memnew(TestPhysics2DMainLoop);
 }
+
+/* Broad phase stress test: objects of wildly different sizes moving around */
+
+class BroadphaseTestObject2D : public CollisionObject2DSW {
+public:
+	int index;
+
+	virtual void _shapes_changed() {}
+	virtual void set_space(Space2DSW *p_space) {}
+
+	BroadphaseTestObject2D() :
+			CollisionObject2DSW(TYPE_BODY) {
+		index = 0;
+	}
+};
+
+static uint64_t _broadphase_pair_key(CollisionObject2DSW *p_a, CollisionObject2DSW *p_b) {
+
+	uint64_t a = static_cast<BroadphaseTestObject2D *>(p_a)->index;
+	uint64_t b = static_cast<BroadphaseTestObject2D *>(p_b)->index;
+	return a < b ? (a << 32) | b : (b << 32) | a;
+}
+
+static void *_broadphase_pair(CollisionObject2DSW *p_a, int p_subindex_A, CollisionObject2DSW *p_b, int p_subindex_B, void *p_userdata) {
+
+	Set<uint64_t> *pairs = (Set<uint64_t> *)p_userdata;
+	pairs->insert(_broadphase_pair_key(p_a, p_b));
+	return NULL;
+}
+
+static void _broadphase_unpair(CollisionObject2DSW *p_a, int p_subindex_A, CollisionObject2DSW *p_b, int p_subindex_B, void *p_data, void *p_userdata) {
+
+	Set<uint64_t> *pairs = (Set<uint64_t> *)p_userdata;
+	pairs->erase(_broadphase_pair_key(p_a, p_b));
+}
+
+static bool _check_broadphase_pairs(const Set<uint64_t> &p_pairs, const Vector<Rect2> &p_rects, const Vector<bool> &p_statics) {
+
+	int overlapping = 0;
+	for (int i = 0; i < p_rects.size(); i++) {
+		for (int j = i + 1; j < p_rects.size(); j++) {
+
+			if ((p_statics[i] && p_statics[j]) || !p_rects[i].intersects(p_rects[j]))
+				continue;
+
+			overlapping++;
+			if (!p_pairs.has((uint64_t(i) << 32) | j))
+				return false;
+		}
+	}
+
+	return overlapping == p_pairs.size();
+}
+
+static bool _test_broadphase(const String &p_name, BroadPhase2DSW *p_broadphase) {
+
+	const int object_count = 2000;
+	const int frames = 10;
+	const real_t world_size = 20000.0;
+
+	// same scene for every implementation
+	Math::seed(1234);
+
+	Vector<BroadphaseTestObject2D *> objects;
+	Vector<Rect2> rects;
+	Vector<Vector2> velocities;
+	Vector<bool> statics;
+	Vector<BroadPhase2DSW::ID> ids;
+
+	for (int i = 0; i < object_count; i++) {
+
+		BroadphaseTestObject2D *obj = memnew(BroadphaseTestObject2D);
+		obj->index = i;
+		objects.push_back(obj);
+
+		Vector2 size;
+		bool is_static = false;
+		if (i % 100 == 0) {
+			// huge areas and world boundaries
+			size = Vector2(Math::random(5000.0, 40000.0), Math::random(5000.0, 40000.0));
+		} else if (i % 10 == 0) {
+			// big areas
+			size = Vector2(Math::random(500.0, 3000.0), Math::random(500.0, 3000.0));
+		} else if (i % 4 == 0) {
+			// tiles
+			size = Vector2(64, 64);
+			is_static = true;
+		} else {
+			size = Vector2(Math::random(8.0, 64.0), Math::random(8.0, 64.0));
+		}
+
+		rects.push_back(Rect2(Vector2(Math::random(0.0, world_size), Math::random(0.0, world_size)) - size * 0.5, size));
+		velocities.push_back(Vector2(Math::random(-1.0, 1.0), Math::random(-1.0, 1.0)) * (is_static ? 0 : 40));
+		statics.push_back(is_static);
+	}
+
+	Set<uint64_t> pairs;
+	p_broadphase->set_pair_callback(_broadphase_pair, &pairs);
+	p_broadphase->set_unpair_callback(_broadphase_unpair, &pairs);
+
+	uint64_t from = OS::get_singleton()->get_ticks_usec();
+	for (int i = 0; i < object_count; i++) {
+
+		BroadPhase2DSW::ID id = p_broadphase->create(objects[i]);
+		p_broadphase->set_static(id, statics[i]);
+		p_broadphase->move(id, rects[i]);
+		ids.push_back(id);
+	}
+	p_broadphase->update();
+	uint64_t insert_usec = OS::get_singleton()->get_ticks_usec() - from;
+
+	bool ok = _check_broadphase_pairs(pairs, rects, statics);
+
+	uint64_t step_usec = 0;
+	for (int f = 0; f < frames; f++) {
+
+		from = OS::get_singleton()->get_ticks_usec();
+		for (int i = 0; i < object_count; i++) {
+
+			if (statics[i])
+				continue;
+
+			Rect2 &rect = rects.write[i];
+			rect.position += velocities[i];
+			if (rect.position.x < 0 || rect.position.x > world_size)
+				velocities.write[i].x = -velocities[i].x;
+			if (rect.position.y < 0 || rect.position.y > world_size)
+				velocities.write[i].y = -velocities[i].y;
+			p_broadphase->move(ids[i], rect);
+		}
+		p_broadphase->update();
+		step_usec += OS::get_singleton()->get_ticks_usec() - from;
+
+		if (f == frames / 2)
+			ok = ok && _check_broadphase_pairs(pairs, rects, statics);
+	}
+
+	ok = ok && _check_broadphase_pairs(pairs, rects, statics);
+
+	CollisionObject2DSW *results[object_count];
+	int subindices[object_count];
+	for (int i = 0; i < 100; i++) {
+
+		Vector2 pos(Math::random(0.0, world_size), Math::random(0.0, world_size));
+		Rect2 query(pos, Vector2(Math::random(10.0, 2000.0), Math::random(10.0, 2000.0)));
+		Vector2 to = pos + Vector2(Math::random(-3000.0, 3000.0), Math::random(-3000.0, 3000.0));
+
+		int expected_aabb = 0;
+		int expected_segment = 0;
+		for (int j = 0; j < object_count; j++) {
+
+			if (rects[j].intersects(query))
+				expected_aabb++;
+			if (rects[j].intersects_segment(pos, to))
+				expected_segment++;
+		}
+
+		ok = ok && p_broadphase->cull_aabb(query, results, object_count, subindices) == expected_aabb;
+		ok = ok && p_broadphase->cull_segment(pos, to, results, object_count, subindices) == expected_segment;
+	}
+
+	int reported = pairs.size();
+
+	for (int i = 0; i < object_count; i++) {
+		p_broadphase->remove(ids[i]);
+	}
+
+	// removing must release every pair
+	ok = ok && pairs.size() == 0;
+
+	for (int i = 0; i < object_count; i++) {
+		memdelete(objects[i]);
+	}
+	memdelete(p_broadphase);
+
+	OS::get_singleton()->print("\t%s: insert %.3f msec, move+update %.3f msec/frame, %i pairs\n", p_name.utf8().get_data(), insert_usec / 1000.0, step_usec / 1000.0 / frames, reported);
+
+	return ok;
+}
+
+bool test_broadphase_hash_grid() {
+
+	return _test_broadphase("hash grid", BroadPhase2DHashGrid::_create());
+}
+
+bool test_broadphase_basic() {
+
+	return _test_broadphase("basic", BroadPhase2DBasic::_create());
+}
+
+typedef bool (*TestFunc)(void);
+
+TestFunc broadphase_test_funcs[] = {
+	test_broadphase_hash_grid,
+	test_broadphase_basic,
+	NULL
+};
+
+MainLoop *test_broadphase() {
+
+	int count = 0;
+	int passed = 0;
+
+	while (true) {
+		if (!broadphase_test_funcs[count])
+			break;
+		bool pass = broadphase_test_funcs[count]();
+		if (pass)
+			passed++;
+		OS::get_singleton()->print("\t%s\n", pass ? "PASS" : "FAILED");
+
+		count++;
+	}
+	OS::get_singleton()->print("\n");
+	OS::get_singleton()->print("Passed %i of %i tests\n", passed, count);
+	return NULL;
+}
+
 } // namespace TestPhysics2D
@@ -30,12 +30,17 @@
 
 #include "test_render.h"
 
+#include "core/math/camera_matrix.h"
+#include "core/math/dynamic_bvh.h"
 #include "core/math/math_funcs.h"
+#include "core/math/octree.h"
 #include "core/math/quick_hull.h"
 #include "core/os/keyboard.h"
 #include "core/os/main_loop.h"
 #include "core/os/os.h"
+#include "core/os/worker_thread_pool.h"
 #include "core/print_string.h"
+#include "core/set.h"
 #include "servers/visual_server.h"
 
 #define OBJECT_COUNT 50
@@ -242,4 +247,437 @@ MainLoop *test() {
 
 	return memnew(TestMainLoop);
 }
+
+/* CULL BENCHMARK */
+
+// Culls a scene the way VisualServerScene does (camera frustum plus cube map
+// shadow passes of omni lights), without a rasterizer, so only cull time is
+// measured. Every cull is also checked against brute force.
+
+struct CullTestInstance {
+
+	AABB aabb;
+	bool pairable;
+};
+
+struct CullTestPass {
+
+	Vector<Plane> planes;
+	uint32_t mask;
+	Vector<CullTestInstance *> result;
+	int result_count;
+};
+
+typedef Octree<CullTestInstance, true> CullTestOctree;
+
+struct CullTestData {
+
+	CullTestOctree *octree;
+	CullTestPass *passes;
+	int max_threads;
+};
+
+static void _cull_test_pass(void *p_userdata, uint32_t p_from, uint32_t p_to) {
+
+	CullTestData *cd = (CullTestData *)p_userdata;
+
+	for (uint32_t i = p_from; i < p_to; i++) {
+
+		CullTestPass &pass = cd->passes[i];
+		pass.result_count = cd->octree->cull_convex_threaded(pass.planes, pass.result.ptrw(), pass.result.size(), pass.mask, cd->max_threads);
+	}
+}
+
+static bool _check_cull(const CullTestPass &p_pass, Set<CullTestInstance *> &r_found) {
+
+	// octants are tested too, so a culler may drop some instances that only
+	// pass the (conservative) AABB test, but never report one that doesn't
+	r_found.clear();
+	for (int i = 0; i < p_pass.result_count; i++) {
+
+		CullTestInstance *instance = p_pass.result[i];
+		if (r_found.has(instance))
+			return false; // reported twice
+		if (!(p_pass.mask & (instance->pairable ? 2 : 1)))
+			return false;
+		if (!instance->aabb.intersects_convex_shape(&p_pass.planes[0], p_pass.planes.size()))
+			return false;
+
+		r_found.insert(instance);
+	}
+
+	return true;
+}
+
+MainLoop *test_cull() {
+
+	const int instance_count = 50000;
+	const int light_count = 8;
+	const int frames = 10;
+	const real_t world_size = 1000.0;
+
+	Math::seed(1234);
+
+	CullTestOctree octree;
+	Vector<CullTestInstance *> instances;
+	Vector<OctreeElementID> ids;
+
+	for (int i = 0; i < instance_count; i++) {
+
+		CullTestInstance *instance = memnew(CullTestInstance);
+		// mostly props, some buildings and a few pairable (light like) volumes
+		real_t extent = (i % 100 == 0) ? Math::random(20.0, 60.0) : ((i % 10 == 0) ? Math::random(4.0, 10.0) : Math::random(0.2, 2.0));
+		Vector3 pos(Math::random(0.0, world_size), Math::random(0.0, 50.0), Math::random(0.0, world_size));
+		instance->aabb = AABB(pos - Vector3(extent, extent, extent), Vector3(extent, extent, extent) * 2.0);
+		instance->pairable = i % 500 == 0;
+		instances.push_back(instance);
+		ids.push_back(octree.create(instance, instance->aabb, 0, instance->pairable, instance->pairable ? 2 : 1, 1));
+	}
+
+	Vector<CullTestPass> passes;
+	Vector<Set<CullTestInstance *> > serial_results;
+
+	CameraMatrix camera;
+	camera.set_perspective(70, 16.0 / 9.0, 0.05, 500);
+
+	CameraMatrix cube;
+	cube.set_perspective(90, 1, 0.01, 40);
+
+	static const Vector3 view_normals[6] = { Vector3(-1, 0, 0), Vector3(+1, 0, 0), Vector3(0, -1, 0), Vector3(0, +1, 0), Vector3(0, 0, -1), Vector3(0, 0, +1) };
+	static const Vector3 view_up[6] = { Vector3(0, -1, 0), Vector3(0, -1, 0), Vector3(0, 0, -1), Vector3(0, 0, +1), Vector3(0, -1, 0), Vector3(0, -1, 0) };
+
+	for (int i = 0; i < 1 + light_count * 6; i++) {
+
+		CullTestPass pass;
+		pass.mask = i == 0 ? 0xFFFFFFFF : 1;
+		pass.result.resize(instance_count);
+		pass.result_count = 0;
+		passes.push_back(pass);
+	}
+	serial_results.resize(passes.size());
+
+	uint64_t serial_usec = 0;
+	uint64_t threaded_usec = 0;
+	int culled = 0;
+	bool ok = true;
+
+	for (int f = 0; f < frames; f++) {
+
+		Vector3 eye(world_size * 0.5 + f * 10.0, 20.0, world_size * 0.5);
+		Transform camera_xform;
+		camera_xform.set_look_at(eye, eye + Vector3(Math::cos(f * 0.6), -0.1, Math::sin(f * 0.6)), Vector3(0, 1, 0));
+		passes.write[0].planes = camera.get_projection_planes(camera_xform);
+
+		for (int i = 0; i < light_count; i++) {
+
+			Vector3 light_pos = eye + Vector3(Math::random(-100.0, 100.0), Math::random(0.0, 20.0), Math::random(-100.0, 100.0));
+			for (int j = 0; j < 6; j++) {
+				Transform xform = Transform(Basis(), light_pos) * Transform().looking_at(view_normals[j], view_up[j]);
+				passes.write[1 + i * 6 + j].planes = cube.get_projection_planes(xform);
+			}
+		}
+
+		// move some instances around, so octants change between frames
+		for (int i = 0; i < instance_count; i += 50) {
+
+			instances[i]->aabb.position += Vector3(Math::random(-5.0, 5.0), 0, Math::random(-5.0, 5.0));
+			octree.move(ids[i], instances[i]->aabb);
+		}
+
+		uint64_t from = OS::get_singleton()->get_ticks_usec();
+		for (int i = 0; i < passes.size(); i++) {
+
+			CullTestPass &pass = passes.write[i];
+			pass.result_count = octree.cull_convex(pass.planes, pass.result.ptrw(), pass.result.size(), pass.mask);
+		}
+		serial_usec += OS::get_singleton()->get_ticks_usec() - from;
+
+		for (int i = 0; i < passes.size(); i++) {
+			ok = ok && _check_cull(passes[i], serial_results.write[i]);
+		}
+
+		CullTestData cd;
+		cd.octree = &octree;
+		cd.passes = passes.ptrw();
+		cd.max_threads = -1;
+
+		// passes are culled concurrently, and each of them is split over octants
+		from = OS::get_singleton()->get_ticks_usec();
+		WorkerThreadPool::get_singleton()->parallel_for(passes.size(), 1, _cull_test_pass, &cd);
+		threaded_usec += OS::get_singleton()->get_ticks_usec() - from;
+
+		// same octants are entered, so exactly the same instances must be found
+		for (int i = 0; i < passes.size(); i++) {
+
+			Set<CullTestInstance *> found;
+			ok = ok && _check_cull(passes[i], found) && found.size() == serial_results[i].size();
+			for (Set<CullTestInstance *>::Element *E = found.front(); ok && E; E = E->next()) {
+				ok = serial_results[i].has(E->get());
+			}
+			culled += passes[i].result_count;
+		}
+	}
+
+	for (int i = 0; i < instance_count; i++) {
+
+		octree.erase(ids[i]);
+		memdelete(instances[i]);
+	}
+
+	OS::get_singleton()->print("\t%i instances, %i passes/frame, %i culled/frame, %i workers\n", instance_count, passes.size(), culled / frames, WorkerThreadPool::get_singleton()->get_thread_count());
+	OS::get_singleton()->print("\tserial: %.3f msec/frame\n", serial_usec / 1000.0 / frames);
+	OS::get_singleton()->print("\tthreaded: %.3f msec/frame\n", threaded_usec / 1000.0 / frames);
+	OS::get_singleton()->print("\t%s\n", ok ? "PASS" : "FAILED");
+
+	return NULL;
+}
+
+/* BVH BENCHMARK */
+
+// Moves thousands of instances per frame (crowds, projectiles) with some
+// pairable light like volumes around, comparing the octree against the
+// dynamic BVH. Pairs reported through the callbacks and culls of both are
+// checked against brute force every frame.
+
+struct BVHTestInstance {
+
+	AABB aabb;
+	Vector3 velocity;
+	bool pairable;
+	uint32_t pairable_type;
+	uint32_t pairable_mask;
+	int index;
+};
+
+struct BVHTestPairs {
+
+	Set<uint64_t> pairs;
+	bool ok;
+};
+
+typedef Octree<BVHTestInstance, true> BVHTestOctree;
+typedef DynamicBVH<BVHTestInstance> BVHTestBVH;
+
+static uint64_t _bvh_test_pair_key(const BVHTestInstance *p_A, const BVHTestInstance *p_B) {
+
+	return p_A->index < p_B->index ? (uint64_t(p_A->index) << 32) | p_B->index : (uint64_t(p_B->index) << 32) | p_A->index;
+}
+
+static void *_bvh_test_pair(void *p_self, uint32_t, BVHTestInstance *p_A, int, uint32_t, BVHTestInstance *p_B, int) {
+
+	BVHTestPairs *self = (BVHTestPairs *)p_self;
+	uint64_t key = _bvh_test_pair_key(p_A, p_B);
+	if (self->pairs.has(key))
+		self->ok = false; // paired twice
+	self->pairs.insert(key);
+	return NULL;
+}
+
+static void _bvh_test_unpair(void *p_self, uint32_t, BVHTestInstance *p_A, int, uint32_t, BVHTestInstance *p_B, int, void *) {
+
+	BVHTestPairs *self = (BVHTestPairs *)p_self;
+	uint64_t key = _bvh_test_pair_key(p_A, p_B);
+	if (!self->pairs.has(key))
+		self->ok = false; // never paired
+	self->pairs.erase(key);
+}
+
+static void _bvh_test_update(BVHTestOctree &p_octree) {
+	// octree changes are immediate
+}
+
+static void _bvh_test_update(BVHTestBVH &p_bvh) {
+
+	p_bvh.update();
+}
+
+template <class I>
+static uint64_t _bvh_test_move(I &p_index, const Vector<BVHTestInstance *> &p_instances, const Vector<uint32_t> &p_ids, int p_moving, int p_toggle) {
+
+	uint64_t from = OS::get_singleton()->get_ticks_usec();
+
+	for (int i = 0; i < p_moving; i++) {
+		p_index.move(p_ids[i], p_instances[i]->aabb);
+	}
+
+	// lights being hidden and shown, like instance_set_visible() does
+	BVHTestInstance *light = p_instances[p_toggle];
+	p_index.set_pairable(p_ids[p_toggle], light->pairable, light->pairable_type, light->pairable_mask);
+
+	_bvh_test_update(p_index);
+
+	return OS::get_singleton()->get_ticks_usec() - from;
+}
+
+static bool _bvh_test_check_cull(const Vector<BVHTestInstance *> &p_instances, const Vector<Plane> &p_planes, BVHTestInstance **p_result, int p_result_count, bool p_exact) {
+
+	Set<BVHTestInstance *> found;
+	for (int i = 0; i < p_result_count; i++) {
+
+		if (found.has(p_result[i]))
+			return false; // reported twice
+		if (!p_result[i]->aabb.intersects_convex_shape(&p_planes[0], p_planes.size()))
+			return false;
+		found.insert(p_result[i]);
+	}
+
+	if (!p_exact)
+		return true; // octants are tested too, see _check_cull()
+
+	// leaves are inside their ancestors, so nothing can be missed
+	int expected = 0;
+	for (int i = 0; i < p_instances.size(); i++) {
+		if (p_instances[i]->aabb.intersects_convex_shape(&p_planes[0], p_planes.size()))
+			expected++;
+	}
+
+	return expected == p_result_count;
+}
+
+MainLoop *test_bvh() {
+
+	const int instance_count = 20000;
+	const int moving_count = 5000;
+	const int light_count = 200;
+	const int frames = 20;
+	const real_t world_size = 500.0;
+
+	Math::seed(4321);
+
+	BVHTestPairs octree_pairs;
+	octree_pairs.ok = true;
+	BVHTestPairs bvh_pairs;
+	bvh_pairs.ok = true;
+
+	BVHTestOctree octree;
+	octree.set_pair_callback(_bvh_test_pair, &octree_pairs);
+	octree.set_unpair_callback(_bvh_test_unpair, &octree_pairs);
+
+	BVHTestBVH bvh;
+	bvh.set_pair_callback(_bvh_test_pair, &bvh_pairs);
+	bvh.set_unpair_callback(_bvh_test_unpair, &bvh_pairs);
+
+	// moving instances come first, lights last
+	Vector<BVHTestInstance *> instances;
+	Vector<uint32_t> octree_ids;
+	Vector<uint32_t> bvh_ids;
+
+	for (int i = 0; i < instance_count; i++) {
+
+		BVHTestInstance *instance = memnew(BVHTestInstance);
+		bool light = i >= instance_count - light_count;
+		real_t extent = light ? Math::random(5.0, 20.0) : Math::random(0.2, 1.5);
+		Vector3 pos(Math::random(0.0, world_size), Math::random(0.0, 20.0), Math::random(0.0, world_size));
+		instance->aabb = AABB(pos - Vector3(extent, extent, extent), Vector3(extent, extent, extent) * 2.0);
+		instance->velocity = i < moving_count ? Vector3(Math::random(-2.0, 2.0), Math::random(-0.2, 0.2), Math::random(-2.0, 2.0)) : Vector3();
+		instance->pairable = light;
+		instance->pairable_type = light ? 2 : 1;
+		instance->pairable_mask = light ? 1 : 0;
+		instance->index = i;
+		instances.push_back(instance);
+
+		octree_ids.push_back(octree.create(instance, instance->aabb, 0, instance->pairable, instance->pairable_type, instance->pairable_mask));
+		bvh_ids.push_back(bvh.create(instance, instance->aabb, 0, instance->pairable, instance->pairable_type, instance->pairable_mask));
+	}
+
+	uint64_t from = OS::get_singleton()->get_ticks_usec();
+	bvh.update();
+	uint64_t bvh_build_usec = OS::get_singleton()->get_ticks_usec() - from;
+
+	CameraMatrix camera;
+	camera.set_perspective(70, 16.0 / 9.0, 0.05, 200);
+
+	Vector<BVHTestInstance *> result;
+	result.resize(instance_count);
+
+	uint64_t octree_move_usec = 0;
+	uint64_t bvh_move_usec = 0;
+	uint64_t octree_cull_usec = 0;
+	uint64_t bvh_cull_usec = 0;
+	int pairs = 0;
+	bool ok = true;
+
+	for (int f = 0; f < frames; f++) {
+
+		for (int i = 0; i < moving_count; i++) {
+
+			BVHTestInstance *instance = instances[i];
+			instance->aabb.position += instance->velocity;
+			// bounce off the edges of the world
+			for (int j = 0; j < 3; j++) {
+				real_t limit = j == 1 ? 20.0 : world_size;
+				if (instance->aabb.position[j] < 0 || instance->aabb.position[j] > limit) {
+					instance->velocity[j] = -instance->velocity[j];
+				}
+			}
+		}
+
+		int toggle = instance_count - light_count + (f * 7) % light_count;
+		BVHTestInstance *light = instances[toggle];
+		light->pairable_mask = light->pairable_mask ? 0 : 1;
+
+		octree_move_usec += _bvh_test_move(octree, instances, octree_ids, moving_count, toggle);
+		bvh_move_usec += _bvh_test_move(bvh, instances, bvh_ids, moving_count, toggle);
+
+		// brute force pairs, same rules as the octree
+		Set<uint64_t> expected;
+		for (int i = instance_count - light_count; i < instance_count; i++) {
+
+			const BVHTestInstance *a = instances[i];
+			for (int j = 0; j < instance_count; j++) {
+
+				const BVHTestInstance *b = instances[j];
+				if (j == i || (b->pairable && j < i))
+					continue; // each pair of lights once
+				if (!(a->pairable_type & b->pairable_mask) && !(b->pairable_type & a->pairable_mask))
+					continue;
+				if (a->aabb.intersects_inclusive(b->aabb))
+					expected.insert(_bvh_test_pair_key(a, b));
+			}
+		}
+
+		ok = ok && octree_pairs.ok && bvh_pairs.ok;
+		ok = ok && octree_pairs.pairs.size() == expected.size() && bvh_pairs.pairs.size() == expected.size();
+		for (Set<uint64_t>::Element *E = expected.front(); ok && E; E = E->next()) {
+			ok = octree_pairs.pairs.has(E->get()) && bvh_pairs.pairs.has(E->get());
+		}
+		pairs += expected.size();
+
+		Vector3 eye(world_size * 0.5, 10.0, world_size * 0.5);
+		Transform camera_xform;
+		camera_xform.set_look_at(eye, eye + Vector3(Math::cos(f * 0.3), -0.1, Math::sin(f * 0.3)), Vector3(0, 1, 0));
+		Vector<Plane> planes = camera.get_projection_planes(camera_xform);
+
+		from = OS::get_singleton()->get_ticks_usec();
+		int count = octree.cull_convex(planes, result.ptrw(), result.size());
+		octree_cull_usec += OS::get_singleton()->get_ticks_usec() - from;
+		ok = ok && _bvh_test_check_cull(instances, planes, result.ptrw(), count, false);
+
+		from = OS::get_singleton()->get_ticks_usec();
+		count = bvh.cull_convex(planes, result.ptrw(), result.size());
+		bvh_cull_usec += OS::get_singleton()->get_ticks_usec() - from;
+		ok = ok && _bvh_test_check_cull(instances, planes, result.ptrw(), count, true);
+
+		count = bvh.cull_convex_threaded(planes, result.ptrw(), result.size());
+		ok = ok && _bvh_test_check_cull(instances, planes, result.ptrw(), count, true);
+	}
+
+	int bvh_height = bvh.get_tree_height();
+
+	for (int i = 0; i < instance_count; i++) {
+
+		octree.erase(octree_ids[i]);
+		bvh.erase(bvh_ids[i]);
+		memdelete(instances[i]);
+	}
+
+	ok = ok && octree_pairs.ok && bvh_pairs.ok && octree_pairs.pairs.size() == 0 && bvh_pairs.pairs.size() == 0;
+
+	OS::get_singleton()->print("\t%i instances, %i moving/frame, %i pairs/frame, BVH height %i, built in %.3f msec\n", instance_count, moving_count, pairs / frames, bvh_height, bvh_build_usec / 1000.0);
+	OS::get_singleton()->print("\toctree: move %.3f msec/frame, cull %.3f msec/frame\n", octree_move_usec / 1000.0 / frames, octree_cull_usec / 1000.0 / frames);
+	OS::get_singleton()->print("\tbvh: move %.3f msec/frame, cull %.3f msec/frame\n", bvh_move_usec / 1000.0 / frames, bvh_cull_usec / 1000.0 / frames);
+	OS::get_singleton()->print("\t%s\n", ok ? "PASS" : "FAILED");
+
+	return NULL;
+}
 } // namespace TestRender
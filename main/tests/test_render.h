@@ -40,6 +40,8 @@
 namespace TestRender {
 
 MainLoop *test();
+MainLoop *test_cull();
+MainLoop *test_bvh();
 }
 
 #endif
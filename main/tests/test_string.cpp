@@ -33,6 +33,9 @@
 //#include "core/math/math_funcs.h"
 #include "core/io/ip_address.h"
 #include "core/os/os.h"
+#include "core/os/thread.h"
+#include "core/safe_refcount.h"
+#include "core/string_db.h"
 #include <stdio.h>
 
 #include "test_string.h"
@@ -920,4 +923,157 @@ MainLoop *test() {
 
 	return NULL;
 }
+
+/* STRINGNAME TABLE */
+
+enum StringNameMode {
+	STRING_NAME_LOOKUP, // names that already exist
+	STRING_NAME_INSERT, // names unique to each thread, added and released every round
+	STRING_NAME_CHURN, // names shared by all threads that nobody else keeps alive
+};
+
+struct StringNameShared {
+	StringNameMode mode;
+	int rounds;
+	Vector<StringName> existing;
+	volatile uint32_t errors;
+};
+
+struct StringNameThread {
+	StringNameShared *shared;
+	Vector<String> names;
+};
+
+static void string_name_thread_func(void *p_userdata) {
+
+	StringNameThread *td = (StringNameThread *)p_userdata;
+	StringNameShared *sd = td->shared;
+	int count = td->names.size();
+
+	Vector<StringName> created;
+	created.resize(count);
+
+	for (int r = 0; r < sd->rounds; r++) {
+
+		switch (sd->mode) {
+
+			case STRING_NAME_LOOKUP: {
+
+				for (int i = 0; i < count; i++) {
+					if (StringName(td->names[i]) != sd->existing[i]) {
+						atomic_increment(&sd->errors);
+					}
+				}
+			} break;
+			case STRING_NAME_INSERT: {
+
+				for (int i = 0; i < count; i++) {
+					created.write[i] = StringName(td->names[i]);
+				}
+				for (int i = 0; i < count; i++) {
+					if (StringName(td->names[i]) != created[i]) {
+						atomic_increment(&sd->errors);
+					}
+				}
+				for (int i = 0; i < count; i++) {
+					created.write[i] = StringName();
+				}
+			} break;
+			case STRING_NAME_CHURN: {
+
+				for (int i = 0; i < count; i++) {
+					StringName sn = td->names[i];
+					if (StringName(td->names[i]) != sn || sn != td->names[i]) {
+						atomic_increment(&sd->errors);
+					}
+				}
+			} break;
+		}
+	}
+}
+
+static bool string_name_run(StringNameMode p_mode, int p_threads) {
+
+	static const char *mode_names[] = { "lookup", "insert", "churn" };
+	const int count = 4096;
+
+	StringNameShared sd;
+	sd.mode = p_mode;
+	sd.rounds = p_mode == STRING_NAME_LOOKUP ? 64 : 16;
+	sd.errors = 0;
+
+	Vector<StringNameThread> td;
+	td.resize(p_threads);
+	for (int t = 0; t < p_threads; t++) {
+
+		td.write[t].shared = &sd;
+		td.write[t].names.resize(count);
+		for (int i = 0; i < count; i++) {
+			String prefix = String("string_name_") + mode_names[p_mode] + "_";
+			if (p_mode == STRING_NAME_INSERT) {
+				prefix += itos(t) + "_";
+			}
+			td.write[t].names.write[i] = prefix + itos(i);
+		}
+	}
+
+	if (p_mode == STRING_NAME_LOOKUP) {
+		sd.existing.resize(count);
+		for (int i = 0; i < count; i++) {
+			sd.existing.write[i] = StringName(td[0].names[i]);
+		}
+	}
+
+	Vector<Thread *> threads;
+	threads.resize(p_threads);
+
+	uint64_t from = OS::get_singleton()->get_ticks_usec();
+	for (int t = 0; t < p_threads; t++) {
+		threads.write[t] = Thread::create(string_name_thread_func, &td.write[t]);
+	}
+	for (int t = 0; t < p_threads; t++) {
+		Thread::wait_to_finish(threads[t]);
+		memdelete(threads[t]);
+	}
+	uint64_t usec = MAX(OS::get_singleton()->get_ticks_usec() - from, (uint64_t)1);
+
+	uint64_t names = uint64_t(p_threads) * sd.rounds * count * (p_mode == STRING_NAME_LOOKUP ? 1 : 2);
+	OS::get_singleton()->print("\t%s, %i threads: %.1f ns/name, %.2f M names/s\n", mode_names[p_mode], p_threads, usec * 1000.0 / names, double(names) / usec);
+
+	return sd.errors == 0;
+}
+
+MainLoop *test_string_name() {
+
+	// Creates StringNames from several threads at once (the processor count,
+	// unless a thread count is given as the last argument) and compares the
+	// throughput against a single thread. Lookups of existing names should
+	// scale with the thread count.
+
+	List<String> cmdlargs = OS::get_singleton()->get_cmdline_args();
+	int thread_count = OS::get_singleton()->get_processor_count();
+	if (cmdlargs.size() && cmdlargs.back()->get().to_int() > 0) {
+		thread_count = cmdlargs.back()->get().to_int();
+	}
+
+	int count = 0;
+	int passed = 0;
+
+	for (int mode = STRING_NAME_LOOKUP; mode <= STRING_NAME_CHURN; mode++) {
+
+		bool pass = string_name_run(StringNameMode(mode), 1);
+		pass = string_name_run(StringNameMode(mode), thread_count) && pass;
+		if (pass)
+			passed++;
+		OS::get_singleton()->print("\t%s\n", pass ? "PASS" : "FAILED");
+
+		count++;
+	}
+
+	OS::get_singleton()->print("\n");
+	OS::get_singleton()->print("Passed %i of %i tests\n", passed, count);
+
+	return NULL;
+}
+
 } // namespace TestString
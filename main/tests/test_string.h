@@ -37,6 +37,7 @@
 namespace TestString {
 
 MainLoop *test();
+MainLoop *test_string_name();
 }
 
 #endif
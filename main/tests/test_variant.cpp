@@ -0,0 +1,256 @@
+/*************************************************************************/
+/*  test_variant.cpp                                                     */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2018 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2018 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+
+#include "test_variant.h"
+
+#include "core/core_string_names.h"
+#include "core/os/os.h"
+#include "core/variant.h"
+
+namespace TestVariant {
+
+// Compares with the types' own operators, Variant's == goes through the
+// evaluator table being tested.
+static bool same_value(const Variant &p_a, const Variant &p_b) {
+
+	if (p_a.get_type() != p_b.get_type()) {
+		return false;
+	}
+
+	switch (p_a.get_type()) {
+		case Variant::NIL: return true;
+		case Variant::BOOL: return bool(p_a) == bool(p_b);
+		case Variant::INT: return int64_t(p_a) == int64_t(p_b);
+		case Variant::REAL: return double(p_a) == double(p_b);
+		case Variant::STRING: return String(p_a) == String(p_b);
+		case Variant::VECTOR2: return Vector2(p_a) == Vector2(p_b);
+		case Variant::VECTOR3: return Vector3(p_a) == Vector3(p_b);
+		case Variant::COLOR: return Color(p_a) == Color(p_b);
+		default: {
+			ERR_EXPLAIN("No comparison for " + Variant::get_type_name(p_a.get_type()));
+			ERR_FAIL_V(false);
+		}
+	}
+}
+
+static bool check_evaluator(Variant::Operator p_op, const Variant &p_a, const Variant &p_b, const Variant &p_expected) {
+
+	Variant::ValidatedOperatorEvaluator evaluator = Variant::get_validated_operator_evaluator(p_op, p_a.get_type(), p_b.get_type());
+	if (!evaluator) {
+		OS::get_singleton()->print("\tno evaluator for %s %s %s\n", Variant::get_type_name(p_a.get_type()).utf8().get_data(), Variant::get_operator_name(p_op).utf8().get_data(), Variant::get_type_name(p_b.get_type()).utf8().get_data());
+		return false;
+	}
+
+	Variant ret;
+	evaluator(&p_a, &p_b, &ret);
+
+	if (!same_value(ret, p_expected)) {
+		OS::get_singleton()->print("\t%s %s %s gave %s\n", p_a.operator String().utf8().get_data(), Variant::get_operator_name(p_op).utf8().get_data(), p_b.operator String().utf8().get_data(), ret.operator String().utf8().get_data());
+		return false;
+	}
+	return true;
+}
+
+bool test_operator_evaluators() {
+
+	bool ok = true;
+
+	ok = ok && check_evaluator(Variant::OP_ADD, 2, 3, 5);
+	ok = ok && check_evaluator(Variant::OP_ADD, 2, 0.5, 2.5);
+	ok = ok && check_evaluator(Variant::OP_SUBTRACT, 0.5, 2, -1.5);
+	ok = ok && check_evaluator(Variant::OP_MULTIPLY, 4, 5, 20);
+	ok = ok && check_evaluator(Variant::OP_LESS, 1.5, 2, true);
+	ok = ok && check_evaluator(Variant::OP_GREATER_EQUAL, 2, 2, true);
+	ok = ok && check_evaluator(Variant::OP_GREATER, Vector2(1, 2), Vector2(1, 3), false);
+	ok = ok && check_evaluator(Variant::OP_MULTIPLY, Vector2(1, 2), 2, Vector2(2, 4));
+	ok = ok && check_evaluator(Variant::OP_MULTIPLY, 2.0, Vector3(1, 2, 3), Vector3(2, 4, 6));
+	ok = ok && check_evaluator(Variant::OP_DIVIDE, Vector3(2, 4, 6), Vector3(2, 2, 2), Vector3(1, 2, 3));
+	ok = ok && check_evaluator(Variant::OP_ADD, Color(0.5, 0, 0), Color(0, 0.5, 0), Color(0.5, 0.5, 0, 2));
+	ok = ok && check_evaluator(Variant::OP_ADD, "Go", "dot", "Godot");
+	ok = ok && check_evaluator(Variant::OP_LESS, "a", "b", true);
+	ok = ok && check_evaluator(Variant::OP_XOR, true, false, true);
+	ok = ok && check_evaluator(Variant::OP_NOT, true, Variant(), false);
+	ok = ok && check_evaluator(Variant::OP_NEGATE, Vector2(1, 2), Variant(), Vector2(-1, -2));
+	ok = ok && check_evaluator(Variant::OP_BIT_NEGATE, 0, Variant(), -1);
+	ok = ok && check_evaluator(Variant::OP_SHIFT_LEFT, 1, 4, 16);
+
+	// the result can be stored in one of the operands
+	Variant a = "Go";
+	Variant b = "dot";
+	Variant::get_validated_operator_evaluator(Variant::OP_ADD, a.get_type(), b.get_type())(&a, &b, &a);
+	ok = ok && same_value(a, "Godot");
+
+	Variant v = Vector2(1, 2);
+	Variant s = 0.5;
+	Variant::get_validated_operator_evaluator(Variant::OP_MULTIPLY, s.get_type(), v.get_type())(&s, &v, &v);
+	ok = ok && same_value(v, Vector2(0.5, 1));
+
+	// anything that can fail or needs more checks isn't in the table
+	ok = ok && !Variant::get_validated_operator_evaluator(Variant::OP_ADD, Variant::INT, Variant::NIL);
+	ok = ok && !Variant::get_validated_operator_evaluator(Variant::OP_MODULE, Variant::STRING, Variant::ARRAY);
+	ok = ok && !Variant::get_validated_operator_evaluator(Variant::OP_EQUAL, Variant::OBJECT, Variant::OBJECT);
+#ifdef DEBUG_ENABLED
+	ok = ok && !Variant::get_validated_operator_evaluator(Variant::OP_DIVIDE, Variant::INT, Variant::INT);
+#endif
+
+	return ok;
+}
+
+bool test_member_accessors() {
+
+	const CoreStringNames *names = CoreStringNames::get_singleton();
+	bool ok = true;
+
+	Variant vec = Vector2(3, 4);
+	Variant ret;
+	Variant::ValidatedGetter getter = Variant::get_member_validated_getter(Variant::VECTOR2, names->y);
+	ok = ok && getter;
+	if (getter) {
+		getter(&vec, &ret);
+		ok = ok && ret.get_type() == Variant::REAL && ret == Variant(4.0);
+	}
+
+	// a getter may write over its own base
+	Variant xform = Transform2D(0, Vector2(5, 6));
+	Variant::get_member_validated_getter(Variant::TRANSFORM2D, names->origin)(&xform, &xform);
+	ok = ok && xform == Variant(Vector2(5, 6));
+
+	Variant color = Color(0, 0, 0);
+	Variant::ValidatedSetter setter = Variant::get_member_validated_setter(Variant::COLOR, names->g8);
+	ok = ok && setter;
+	if (setter) {
+		Variant value = 255;
+		ok = ok && setter(&color, &value);
+		Variant wrong = "255";
+		ok = ok && !setter(&color, &wrong);
+		ok = ok && color == Variant(Color(0, 1, 0));
+	}
+
+	Variant rect = Rect2(1, 1, 1, 1);
+	bool valid;
+	rect.set_named(names->end, Vector2(4, 5), &valid);
+	ok = ok && valid && rect.get_named(names->size, &valid) == Variant(Vector2(3, 4)) && valid;
+	rect.get_named(names->origin, &valid);
+	ok = ok && !valid;
+
+	ok = ok && !Variant::get_member_validated_getter(Variant::VECTOR2, names->z);
+	ok = ok && !Variant::get_member_validated_setter(Variant::OBJECT, names->x);
+
+	return ok;
+}
+
+/* BENCHMARK */
+
+bool test_benchmark() {
+
+	const int iterations = 1000000;
+	const CoreStringNames *names = CoreStringNames::get_singleton();
+
+	Variant a = Vector2(1, 2);
+	Variant b = 0.5;
+	Variant ret;
+	bool valid;
+
+	uint64_t from = OS::get_singleton()->get_ticks_usec();
+	for (int i = 0; i < iterations; i++) {
+		Variant::evaluate(Variant::OP_MULTIPLY, a, b, ret, valid);
+	}
+	uint64_t evaluate_usec = OS::get_singleton()->get_ticks_usec() - from;
+
+	// what the script VMs do, the evaluator is looked up once the operand types are known
+	Variant::ValidatedOperatorEvaluator evaluator = Variant::get_validated_operator_evaluator(Variant::OP_MULTIPLY, a.get_type(), b.get_type());
+	from = OS::get_singleton()->get_ticks_usec();
+	for (int i = 0; i < iterations; i++) {
+		evaluator(&a, &b, &ret);
+	}
+	uint64_t evaluator_usec = OS::get_singleton()->get_ticks_usec() - from;
+
+	// the string keyed path that used to compare member names
+	Variant index = "x";
+	from = OS::get_singleton()->get_ticks_usec();
+	for (int i = 0; i < iterations; i++) {
+		ret = a.get(index, &valid);
+	}
+	uint64_t get_usec = OS::get_singleton()->get_ticks_usec() - from;
+
+	from = OS::get_singleton()->get_ticks_usec();
+	for (int i = 0; i < iterations; i++) {
+		ret = a.get_named(names->x, &valid);
+	}
+	uint64_t get_named_usec = OS::get_singleton()->get_ticks_usec() - from;
+
+	Variant::ValidatedGetter getter = Variant::get_member_validated_getter(a.get_type(), names->x);
+	from = OS::get_singleton()->get_ticks_usec();
+	for (int i = 0; i < iterations; i++) {
+		getter(&a, &ret);
+	}
+	uint64_t getter_usec = OS::get_singleton()->get_ticks_usec() - from;
+
+	OS::get_singleton()->print("\t%i iterations, Vector2 * float:\n", iterations);
+	OS::get_singleton()->print("\tVariant::evaluate(): %.2f nsec/op\n", double(evaluate_usec) * 1000.0 / iterations);
+	OS::get_singleton()->print("\tvalidated evaluator: %.2f nsec/op\n", double(evaluator_usec) * 1000.0 / iterations);
+	OS::get_singleton()->print("\tVector2.x:\n");
+	OS::get_singleton()->print("\tVariant::get(): %.2f nsec/op\n", double(get_usec) * 1000.0 / iterations);
+	OS::get_singleton()->print("\tVariant::get_named(): %.2f nsec/op\n", double(get_named_usec) * 1000.0 / iterations);
+	OS::get_singleton()->print("\tvalidated getter: %.2f nsec/op\n", double(getter_usec) * 1000.0 / iterations);
+
+	return true;
+}
+
+typedef bool (*TestFunc)(void);
+
+TestFunc test_funcs[] = {
+	test_operator_evaluators,
+	test_member_accessors,
+	test_benchmark,
+	NULL
+};
+
+MainLoop *test() {
+	int count = 0;
+	int passed = 0;
+
+	while (true) {
+		if (!test_funcs[count])
+			break;
+		bool pass = test_funcs[count]();
+		if (pass)
+			passed++;
+		OS::get_singleton()->print("\t%s\n", pass ? "PASS" : "FAILED");
+
+		count++;
+	}
+	OS::get_singleton()->print("\n");
+	OS::get_singleton()->print("Passed %i of %i tests\n", passed, count);
+	return NULL;
+}
+
+} // namespace TestVariant
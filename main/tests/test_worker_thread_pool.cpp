@@ -0,0 +1,247 @@
+/*************************************************************************/
+/*  test_worker_thread_pool.cpp                                          */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2018 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2018 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "test_worker_thread_pool.h"
+
+#include "core/os/os.h"
+#include "core/os/thread.h"
+#include "core/os/worker_thread_pool.h"
+#include "core/safe_refcount.h"
+
+namespace TestWorkerThreadPool {
+
+struct RangeData {
+	uint32_t *values;
+	volatile uint32_t calls;
+};
+
+static void range_func(void *p_userdata, uint32_t p_from, uint32_t p_to) {
+
+	RangeData *rd = (RangeData *)p_userdata;
+	for (uint32_t i = p_from; i < p_to; i++) {
+		rd->values[i]++;
+	}
+	atomic_increment(&rd->calls);
+}
+
+bool test_parallel_for() {
+
+	const uint32_t elements = 100000;
+	Vector<uint32_t> values;
+	values.resize(elements);
+	for (uint32_t i = 0; i < elements; i++) {
+		values.write[i] = 0;
+	}
+
+	RangeData rd;
+	rd.values = values.ptrw();
+	rd.calls = 0;
+	WorkerThreadPool::get_singleton()->parallel_for(elements, 64, range_func, &rd);
+
+	bool ok = rd.calls == (elements + 63) / 64;
+	for (uint32_t i = 0; i < elements; i++) {
+		ok = ok && values[i] == 1;
+	}
+	return ok;
+}
+
+struct NestedData {
+	volatile uint32_t count;
+};
+
+static void nested_inner_func(void *p_userdata, uint32_t p_from, uint32_t p_to) {
+
+	NestedData *nd = (NestedData *)p_userdata;
+	atomic_add(&nd->count, p_to - p_from);
+}
+
+static void nested_outer_func(void *p_userdata, uint32_t p_from, uint32_t p_to) {
+
+	for (uint32_t i = p_from; i < p_to; i++) {
+		WorkerThreadPool::get_singleton()->parallel_for(100, 10, nested_inner_func, p_userdata);
+	}
+}
+
+bool test_nested_parallel_for() {
+
+	NestedData nd;
+	nd.count = 0;
+	WorkerThreadPool::get_singleton()->parallel_for(100, 1, nested_outer_func, &nd);
+	return nd.count == 100 * 100;
+}
+
+struct OrderData {
+	volatile uint32_t stage;
+	volatile uint32_t errors;
+	volatile uint32_t done_first;
+};
+
+static void first_stage_func(void *p_userdata) {
+
+	OrderData *od = (OrderData *)p_userdata;
+	OS::get_singleton()->delay_usec(100);
+	atomic_increment(&od->done_first);
+}
+
+static void second_stage_func(void *p_userdata) {
+
+	OrderData *od = (OrderData *)p_userdata;
+	if (od->done_first != 16) {
+		atomic_increment(&od->errors);
+	}
+	atomic_increment(&od->stage);
+}
+
+bool test_group_dependencies() {
+
+	WorkerThreadPool *pool = WorkerThreadPool::get_singleton();
+
+	OrderData od;
+	od.stage = 0;
+	od.errors = 0;
+	od.done_first = 0;
+
+	WorkerThreadPool::GroupID first = pool->group_create();
+	WorkerThreadPool::GroupID second = pool->group_create();
+	for (int i = 0; i < 16; i++) {
+		pool->group_add_task(first, first_stage_func, &od);
+		pool->group_add_task(second, second_stage_func, &od);
+	}
+	pool->group_add_dependency(second, first);
+
+	// Submit the dependent group first, it must not start early.
+	pool->group_submit(second);
+	pool->group_submit(first);
+
+	pool->group_wait(second);
+	pool->group_wait(first);
+
+	return od.errors == 0 && od.stage == 16;
+}
+
+/* DISPATCH BENCHMARK */
+
+// Per-call thread spawning, as thread_process_array() used to do it.
+struct SpawnData {
+	RangeData *rd;
+	uint32_t elements;
+	volatile uint32_t index;
+};
+
+static void spawn_thread_func(void *p_userdata) {
+
+	SpawnData *sd = (SpawnData *)p_userdata;
+	while (true) {
+		uint32_t index = atomic_increment(&sd->index);
+		if (index >= sd->elements)
+			break;
+		range_func(sd->rd, index, index + 1);
+	}
+}
+
+static void spawn_dispatch(RangeData *p_rd, uint32_t p_elements) {
+
+	SpawnData sd;
+	sd.rd = p_rd;
+	sd.elements = p_elements;
+	sd.index = 0;
+	range_func(p_rd, 0, 1);
+
+	Vector<Thread *> threads;
+	threads.resize(OS::get_singleton()->get_processor_count());
+	for (int i = 0; i < threads.size(); i++) {
+		threads.write[i] = Thread::create(spawn_thread_func, &sd);
+	}
+	for (int i = 0; i < threads.size(); i++) {
+		Thread::wait_to_finish(threads[i]);
+		memdelete(threads[i]);
+	}
+}
+
+bool test_dispatch_latency() {
+
+	const int iterations = 200;
+	const uint32_t elements = 256;
+
+	Vector<uint32_t> values;
+	values.resize(elements);
+	RangeData rd;
+	rd.values = values.ptrw();
+	rd.calls = 0;
+
+	uint64_t from = OS::get_singleton()->get_ticks_usec();
+	for (int i = 0; i < iterations; i++) {
+		spawn_dispatch(&rd, elements);
+	}
+	uint64_t spawn_usec = OS::get_singleton()->get_ticks_usec() - from;
+
+	from = OS::get_singleton()->get_ticks_usec();
+	for (int i = 0; i < iterations; i++) {
+		WorkerThreadPool::get_singleton()->parallel_for(elements, 1, range_func, &rd);
+	}
+	uint64_t pool_usec = OS::get_singleton()->get_ticks_usec() - from;
+
+	OS::get_singleton()->print("\tworkers: %i\n", WorkerThreadPool::get_singleton()->get_thread_count());
+	OS::get_singleton()->print("\tspawn threads per call: %.2f usec/dispatch\n", double(spawn_usec) / iterations);
+	OS::get_singleton()->print("\tworker pool: %.2f usec/dispatch\n", double(pool_usec) / iterations);
+
+	return true;
+}
+
+typedef bool (*TestFunc)(void);
+
+TestFunc test_funcs[] = {
+	test_parallel_for,
+	test_nested_parallel_for,
+	test_group_dependencies,
+	test_dispatch_latency,
+	NULL
+};
+
+MainLoop *test() {
+	int count = 0;
+	int passed = 0;
+
+	while (true) {
+		if (!test_funcs[count])
+			break;
+		bool pass = test_funcs[count]();
+		if (pass)
+			passed++;
+		OS::get_singleton()->print("\t%s\n", pass ? "PASS" : "FAILED");
+
+		count++;
+	}
+	OS::get_singleton()->print("\n");
+	OS::get_singleton()->print("Passed %i of %i tests\n", passed, count);
+	return NULL;
+}
+
+} // namespace TestWorkerThreadPool
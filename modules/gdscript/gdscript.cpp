@@ -36,7 +36,9 @@
 #include "core/os/file_access.h"
 #include "core/os/os.h"
 #include "core/project_settings.h"
+#include "gdscript_bytecode_cache.h"
 #include "gdscript_compiler.h"
+#include "gdscript_prefetcher.h"
 
 ///////////////////////////
 
@@ -554,20 +556,42 @@ Error GDScript::reload(bool p_keep_state) {
 	}
 
 	valid = false;
+	GDScriptParser *prefetched = NULL;
+	GDScriptTokenizerRecorded *tokens = GDScriptLanguage::singleton->prefetcher->take(path, source, &prefetched);
+	if (prefetched) {
+		Error err = prefetched->finish_recorded();
+		memdelete(tokens);
+		err = _compile_parsed(*prefetched, err, p_keep_state);
+		memdelete(prefetched);
+		return err;
+	}
+
 	GDScriptParser parser;
-	Error err = parser.parse(source, basedir, false, path);
-	if (err) {
+	Error err;
+	if (tokens) {
+		err = parser.parse_recorded(tokens, basedir, path);
+		memdelete(tokens);
+	} else {
+		err = parser.parse(source, basedir, false, path);
+	}
+
+	return _compile_parsed(parser, err, p_keep_state);
+}
+
+Error GDScript::_compile_parsed(GDScriptParser &p_parser, Error p_parse_error, bool p_keep_state) {
+
+	if (p_parse_error) {
 		if (ScriptDebugger::get_singleton()) {
-			GDScriptLanguage::get_singleton()->debug_break_parse(get_path(), parser.get_error_line(), "Parser Error: " + parser.get_error());
+			GDScriptLanguage::get_singleton()->debug_break_parse(get_path(), p_parser.get_error_line(), "Parser Error: " + p_parser.get_error());
 		}
-		_err_print_error("GDScript::reload", path.empty() ? "built-in" : (const char *)path.utf8().get_data(), parser.get_error_line(), ("Parse Error: " + parser.get_error()).utf8().get_data(), ERR_HANDLER_SCRIPT);
+		_err_print_error("GDScript::reload", path.empty() ? "built-in" : (const char *)path.utf8().get_data(), p_parser.get_error_line(), ("Parse Error: " + p_parser.get_error()).utf8().get_data(), ERR_HANDLER_SCRIPT);
 		ERR_FAIL_V(ERR_PARSE_ERROR);
 	}
 
-	bool can_run = ScriptServer::is_scripting_enabled() || parser.is_tool_script();
+	bool can_run = ScriptServer::is_scripting_enabled() || p_parser.is_tool_script();
 
 	GDScriptCompiler compiler;
-	err = compiler.compile(&parser, this, p_keep_state);
+	Error err = compiler.compile(&p_parser, this, p_keep_state);
 
 	if (err) {
 
@@ -581,8 +605,12 @@ Error GDScript::reload(bool p_keep_state) {
 			return err;
 		}
 	}
+
+	if (GDScriptBytecodeCache::get_singleton()->is_enabled()) {
+		GDScriptBytecodeCache::get_singleton()->save(this, source.md5_text(), p_parser.get_dependencies());
+	}
 #if DEBUG_ENABLED
-	for (const List<GDScriptWarning>::Element *E = parser.get_warnings().front(); E; E = E->next()) {
+	for (const List<GDScriptWarning>::Element *E = p_parser.get_warnings().front(); E; E = E->next()) {
 		const GDScriptWarning &warning = E->get();
 		if (ScriptDebugger::get_singleton()) {
 			Vector<ScriptLanguage::StackInfo> si;
@@ -713,6 +741,16 @@ Vector<uint8_t> GDScript::get_as_byte_code() const {
 
 Error GDScript::load_byte_code(const String &p_path) {
 
+	GDScriptBytecodeCache *cache = GDScriptBytecodeCache::get_singleton();
+	String source_key;
+	if (cache->is_enabled()) {
+		source_key = FileAccess::get_md5(p_path);
+		path = p_path;
+		if (cache->load(this, source_key)) {
+			return OK;
+		}
+	}
+
 	Vector<uint8_t> bytecode;
 
 	if (p_path.ends_with("gde")) {
@@ -776,6 +814,10 @@ Error GDScript::load_byte_code(const String &p_path) {
 		ERR_FAIL_V(ERR_COMPILATION_FAILED);
 	}
 
+	if (source_key != String()) {
+		cache->save(this, source_key, parser.get_dependencies());
+	}
+
 	valid = true;
 
 	for (Map<StringName, Ref<GDScript> >::Element *E = subclasses.front(); E; E = E->next()) {
@@ -907,6 +949,9 @@ GDScript::GDScript() :
 }
 
 GDScript::~GDScript() {
+	// the address may be reused by another script
+	GDScriptLanguage::get_singleton()->invalidate_inline_caches();
+
 	for (Map<StringName, GDScriptFunction *>::Element *E = member_functions.front(); E; E = E->next()) {
 		memdelete(E->get());
 	}
@@ -1404,6 +1449,13 @@ Error GDScriptLanguage::execute_file(const String &p_path) {
 	return OK;
 }
 void GDScriptLanguage::finish() {
+
+	GDScriptFunction::free_thread_stack();
+}
+
+void GDScriptLanguage::thread_exit() {
+
+	GDScriptFunction::free_thread_stack();
 }
 
 void GDScriptLanguage::profiling_start() {
@@ -1511,6 +1563,51 @@ int GDScriptLanguage::profiling_get_frame_data(ProfilingInfo *p_info_arr, int p_
 	return current;
 }
 
+int GDScriptLanguage::profiling_sample_stack(const void **r_frames, int p_max) {
+
+	int count = 0;
+
+#ifdef DEBUG_ENABLED
+	// Called from the sampler thread without locking, the main thread may be
+	// entering or leaving functions meanwhile. Frames are only compared later.
+	int pos = MIN(_debug_call_stack_pos, _debug_max_call_stack);
+	count = MIN(pos, p_max);
+	for (int i = 0; i < count; i++) {
+		r_frames[i] = _call_stack[i].function;
+	}
+#endif
+
+	return count;
+}
+
+void GDScriptLanguage::profiling_get_frame_signatures(const void *const *p_frames, int p_count, StringName *r_signatures) {
+
+#ifdef DEBUG_ENABLED
+	Map<const void *, int> frame_index;
+	for (int i = 0; i < p_count; i++) {
+		frame_index[p_frames[i]] = i;
+	}
+
+	if (lock) {
+		lock->lock();
+	}
+
+	// only functions still in the list are resolved, freed ones stay empty
+	SelfList<GDScriptFunction> *elem = function_list.first();
+	while (elem) {
+		Map<const void *, int>::Element *E = frame_index.find(elem->self());
+		if (E)
+			r_signatures[E->get()] = elem->self()->profile.signature;
+		elem = elem->next();
+	}
+
+	if (lock) {
+		lock->unlock();
+	}
+
+#endif
+}
+
 struct GDScriptDepSort {
 
 	//must support sorting so inheritance works properly (parent must be reloaded first)
@@ -1690,10 +1787,20 @@ void GDScriptLanguage::reload_tool_script(const Ref<Script> &p_script, bool p_so
 #endif
 }
 
+void GDScriptLanguage::prefetch_scripts(const Vector<String> &p_paths) {
+
+	prefetcher->prefetch(p_paths);
+}
+
 void GDScriptLanguage::frame() {
 
 	calls = 0;
 
+	if (prefetcher->is_enabled()) {
+		// whatever startup didn't load is not going to be
+		prefetcher->clear();
+	}
+
 #ifdef DEBUG_ENABLED
 	if (profiling) {
 		if (lock) {
@@ -2057,11 +2164,16 @@ GDScriptLanguage::GDScriptLanguage() {
 
 #ifdef NO_THREADS
 	lock = NULL;
+	inline_cache_lock = NULL;
 #else
 	lock = Mutex::create();
+	inline_cache_lock = Mutex::create();
 #endif
 	profiling = false;
 	script_frame_time = 0;
+	inline_cache_version = 0;
+	bytecode_cache = memnew(GDScriptBytecodeCache);
+	prefetcher = memnew(GDScriptPrefetcher);
 
 	_debug_call_stack_pos = 0;
 	int dmcs = GLOBAL_DEF("debug/settings/gdscript/max_call_stack", 1024);
@@ -2094,9 +2206,15 @@ GDScriptLanguage::~GDScriptLanguage() {
 		memdelete(lock);
 		lock = NULL;
 	}
+	if (inline_cache_lock) {
+		memdelete(inline_cache_lock);
+		inline_cache_lock = NULL;
+	}
 	if (_call_stack) {
 		memdelete_arr(_call_stack);
 	}
+	memdelete(bytecode_cache);
+	memdelete(prefetcher);
 	singleton = NULL;
 }
 
@@ -2125,7 +2243,10 @@ RES ResourceFormatLoaderGDScript::load(const String &p_path, const String &p_ori
 		script->set_script_path(p_original_path); // script needs this.
 		script->set_path(p_original_path);
 
-		script->reload();
+		GDScriptBytecodeCache *cache = GDScriptBytecodeCache::get_singleton();
+		if (!cache->is_enabled() || !cache->load(script, script->get_source_code().md5_text())) {
+			script->reload();
+		}
 	}
 	if (r_error)
 		*r_error = OK;
@@ -36,6 +36,10 @@
 #include "core/script_language.h"
 #include "gdscript_function.h"
 
+class GDScriptBytecodeCache;
+class GDScriptParser;
+class GDScriptPrefetcher;
+
 class GDScriptNativeClass : public Reference {
 
 	GDCLASS(GDScriptNativeClass, Reference);
@@ -72,6 +76,7 @@ class GDScript : public Script {
 	friend class GDScriptCompiler;
 	friend class GDScriptFunctions;
 	friend class GDScriptLanguage;
+	friend class GDScriptBytecodeCache;
 
 	Variant _static_ref; //used for static call
 	Ref<GDScriptNativeClass> native;
@@ -115,6 +120,7 @@ class GDScript : public Script {
 	GDScriptInstance *_create_instance(const Variant **p_args, int p_argcount, Object *p_owner, bool p_isref, Variant::CallError &r_error);
 
 	void _set_subclass_path(Ref<GDScript> &p_sc, const String &p_path);
+	Error _compile_parsed(GDScriptParser &p_parser, Error p_parse_error, bool p_keep_state);
 
 #ifdef TOOLS_ENABLED
 	Set<PlaceHolderScriptInstance *> placeholders;
@@ -343,8 +349,13 @@ class GDScriptLanguage : public ScriptLanguage {
 	friend class GDScriptFunction;
 
 	SelfList<GDScriptFunction>::List function_list;
+
+	GDScriptBytecodeCache *bytecode_cache;
+	GDScriptPrefetcher *prefetcher;
 	bool profiling;
 	uint64_t script_frame_time;
+	uint32_t inline_cache_version; // cached member lookups of older versions are ignored
+	Mutex *inline_cache_lock;
 
 public:
 	int calls;
@@ -425,6 +436,7 @@ public:
 	_FORCE_INLINE_ const Map<StringName, Variant> &get_named_globals_map() const { return named_globals; }
 
 	_FORCE_INLINE_ static GDScriptLanguage *get_singleton() { return singleton; }
+	_FORCE_INLINE_ void invalidate_inline_caches() { atomic_increment(&inline_cache_version); }
 
 	virtual String get_name() const;
 
@@ -434,6 +446,7 @@ public:
 	virtual String get_extension() const;
 	virtual Error execute_file(const String &p_path);
 	virtual void finish();
+	virtual void thread_exit();
 
 	/* EDITOR FUNCTIONS */
 	virtual void get_reserved_words(List<String> *p_words) const;
@@ -474,6 +487,7 @@ public:
 
 	virtual void reload_all_scripts();
 	virtual void reload_tool_script(const Ref<Script> &p_script, bool p_soft_reload);
+	virtual void prefetch_scripts(const Vector<String> &p_paths);
 
 	virtual void frame();
 
@@ -485,6 +499,8 @@ public:
 
 	virtual int profiling_get_accumulated_data(ProfilingInfo *p_info_arr, int p_info_max);
 	virtual int profiling_get_frame_data(ProfilingInfo *p_info_arr, int p_info_max);
+	virtual int profiling_sample_stack(const void **r_frames, int p_max);
+	virtual void profiling_get_frame_signatures(const void *const *p_frames, int p_count, StringName *r_signatures);
 
 	/* LOADER FUNCTIONS */
 
@@ -505,6 +521,7 @@ public:
 	virtual void get_recognized_extensions(List<String> *p_extensions) const;
 	virtual bool handles_type(const String &p_type) const;
 	virtual String get_resource_type(const String &p_path) const;
+	virtual bool can_load_threaded(const String &p_path) const { return false; } // compiling registers globals in the language
 };
 
 class ResourceFormatSaverGDScript : public ResourceFormatSaver {
@@ -0,0 +1,1081 @@
+/*************************************************************************/
+/*  gdscript_bytecode_cache.cpp                                          */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2018 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2018 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "gdscript_bytecode_cache.h"
+
+#include "core/engine.h"
+#include "core/io/marshalls.h"
+#include "core/io/resource_loader.h"
+#include "core/os/dir_access.h"
+#include "core/os/file_access.h"
+#include "core/project_settings.h"
+#include "core/version.h"
+#include "core/version_hash.gen.h"
+#include "thirdparty/misc/md5.h"
+
+#define BYTECODE_CACHE_VERSION 3
+
+static const uint8_t bytecode_cache_magic[4] = { 'G', 'D', 'B', 'C' };
+
+enum {
+	VALUE_VARIANT,
+	VALUE_ARRAY,
+	VALUE_DICTIONARY,
+	VALUE_NULL_OBJECT,
+	VALUE_NATIVE_CLASS,
+	VALUE_RESOURCE, // by path, followed by the inner class names for GDScript
+};
+
+struct GDScriptBytecodeCache::Writer {
+
+	Vector<uint8_t> data;
+
+	void put_32(uint32_t p_value) {
+		int ofs = data.size();
+		data.resize(ofs + 4);
+		encode_uint32(p_value, &data.write[ofs]);
+	}
+
+	void put_buffer(const uint8_t *p_buffer, int p_len) {
+		if (p_len == 0) {
+			return;
+		}
+		int ofs = data.size();
+		data.resize(ofs + p_len);
+		copymem(&data.write[ofs], p_buffer, p_len);
+	}
+
+	void put_string(const String &p_string) {
+		CharString utf8 = p_string.utf8();
+		put_32(utf8.length());
+		put_buffer((const uint8_t *)utf8.get_data(), utf8.length());
+	}
+};
+
+// Reads never go past the end of the buffer, they set error instead.
+struct GDScriptBytecodeCache::Reader {
+
+	const uint8_t *data;
+	int size;
+	int pos;
+	bool error;
+
+	uint32_t get_32() {
+		if (pos + 4 > size) {
+			error = true;
+			return 0;
+		}
+		uint32_t value = decode_uint32(&data[pos]);
+		pos += 4;
+		return value;
+	}
+
+	// element counts, every element takes at least one more byte
+	int get_count() {
+		uint32_t count = get_32();
+		if (count > uint32_t(size - pos)) {
+			error = true;
+			return 0;
+		}
+		return count;
+	}
+
+	String get_string() {
+		int len = get_count();
+		if (error) {
+			return String();
+		}
+		String string;
+		string.parse_utf8((const char *)&data[pos], len);
+		pos += len;
+		return string;
+	}
+
+	Reader(const uint8_t *p_data, int p_size) {
+		data = p_data;
+		size = p_size;
+		pos = 0;
+		error = false;
+	}
+};
+
+static String _md5(const uint8_t *p_data, int p_len) {
+
+	MD5_CTX ctx;
+	MD5Init(&ctx);
+	MD5Update(&ctx, (unsigned char *)p_data, p_len);
+	MD5Final(&ctx);
+	return String::md5(ctx.digest);
+}
+
+GDScriptBytecodeCache *GDScriptBytecodeCache::singleton = NULL;
+
+String GDScriptBytecodeCache::_get_cache_file(const String &p_path) const {
+
+	return cache_path.plus_file(p_path.md5_text() + ".gdbc");
+}
+
+String GDScriptBytecodeCache::_make_fingerprint(const String &p_source_key, const Vector<String> &p_dependencies) {
+
+	String fingerprint = p_source_key;
+
+	if (lock) {
+		lock->lock();
+	}
+
+	for (int i = 0; i < p_dependencies.size(); i++) {
+		const String *dependency = fingerprints.getptr(p_dependencies[i]);
+		fingerprint += ";" + p_dependencies[i] + ":" + (dependency ? *dependency : String());
+	}
+
+	if (lock) {
+		lock->unlock();
+	}
+
+	return fingerprint.md5_text();
+}
+
+void GDScriptBytecodeCache::_set_fingerprint(const String &p_path, const String &p_fingerprint) {
+
+	if (lock) {
+		lock->lock();
+	}
+
+	fingerprints[p_path] = p_fingerprint;
+
+	if (lock) {
+		lock->unlock();
+	}
+}
+
+bool GDScriptBytecodeCache::_write_value(Writer &w, const Variant &p_value, const GDScript *p_root) {
+
+	switch (p_value.get_type()) {
+
+		case Variant::ARRAY: {
+
+			Array array = p_value;
+			w.put_32(VALUE_ARRAY);
+			w.put_32(array.size());
+			for (int i = 0; i < array.size(); i++) {
+				if (!_write_value(w, array[i], p_root)) {
+					return false;
+				}
+			}
+		} break;
+		case Variant::DICTIONARY: {
+
+			Dictionary dict = p_value;
+			List<Variant> keys;
+			dict.get_key_list(&keys);
+			w.put_32(VALUE_DICTIONARY);
+			w.put_32(keys.size());
+			for (List<Variant>::Element *E = keys.front(); E; E = E->next()) {
+				if (!_write_value(w, E->get(), p_root) || !_write_value(w, dict[E->get()], p_root)) {
+					return false;
+				}
+			}
+		} break;
+		case Variant::OBJECT: {
+
+			Object *obj = p_value;
+			if (!obj) {
+				w.put_32(VALUE_NULL_OBJECT);
+				break;
+			}
+
+			GDScriptNativeClass *native = Object::cast_to<GDScriptNativeClass>(obj);
+			if (native) {
+				w.put_32(VALUE_NATIVE_CLASS);
+				w.put_string(native->get_name());
+				break;
+			}
+
+			Resource *res = Object::cast_to<Resource>(obj);
+			if (!res) {
+				return false;
+			}
+
+			// inner classes are found again from the script of their file
+			Vector<String> names;
+			GDScript *script = Object::cast_to<GDScript>(res);
+			if (script) {
+				while (script->_owner) {
+					names.insert(0, script->name);
+					script = script->_owner;
+				}
+				res = script;
+			}
+
+			String path;
+			if (res != p_root) {
+				path = res->get_path();
+				if (!path.is_resource_file()) {
+					return false;
+				}
+			}
+
+			w.put_32(VALUE_RESOURCE);
+			w.put_string(path);
+			w.put_32(names.size());
+			for (int i = 0; i < names.size(); i++) {
+				w.put_string(names[i]);
+			}
+		} break;
+		default: {
+
+			int len;
+			Error err = encode_variant(p_value, NULL, len);
+			if (err != OK) {
+				return false;
+			}
+			w.put_32(VALUE_VARIANT);
+			w.put_32(len);
+			int ofs = w.data.size();
+			w.data.resize(ofs + len);
+			encode_variant(p_value, &w.data.write[ofs], len);
+		} break;
+	}
+
+	return true;
+}
+
+bool GDScriptBytecodeCache::_read_value(Reader &r, Variant &r_value, GDScript *p_root) {
+
+	switch (r.get_32()) {
+
+		case VALUE_VARIANT: {
+
+			int len = r.get_count();
+			if (r.error) {
+				return false;
+			}
+			int read = 0;
+			Error err = decode_variant(r_value, &r.data[r.pos], len, &read, false);
+			if (err != OK || read != len) {
+				return false;
+			}
+			r.pos += len;
+		} break;
+		case VALUE_ARRAY: {
+
+			int size = r.get_count();
+			Array array;
+			array.resize(size);
+			for (int i = 0; i < size; i++) {
+				if (!_read_value(r, array[i], p_root)) {
+					return false;
+				}
+			}
+			r_value = array;
+		} break;
+		case VALUE_DICTIONARY: {
+
+			int size = r.get_count();
+			Dictionary dict;
+			for (int i = 0; i < size; i++) {
+				Variant key;
+				Variant value;
+				if (!_read_value(r, key, p_root) || !_read_value(r, value, p_root)) {
+					return false;
+				}
+				dict[key] = value;
+			}
+			r_value = dict;
+		} break;
+		case VALUE_NULL_OBJECT: {
+
+			r_value = (Object *)NULL;
+		} break;
+		case VALUE_NATIVE_CLASS: {
+
+			String name = r.get_string();
+			// classes with a leading underscore are exposed without it
+			StringName global_name = name.begins_with("_") ? name.substr(1, name.length()) : name;
+			const Map<StringName, int> &global_map = GDScriptLanguage::get_singleton()->get_global_map();
+			if (!global_map.has(global_name)) {
+				return false;
+			}
+			Variant global = GDScriptLanguage::get_singleton()->get_global_array()[global_map[global_name]];
+			GDScriptNativeClass *native = Object::cast_to<GDScriptNativeClass>(global.operator Object *());
+			if (!native || native->get_name() != name) {
+				return false;
+			}
+			r_value = global;
+		} break;
+		case VALUE_RESOURCE: {
+
+			String path = r.get_string();
+			int name_count = r.get_count();
+			if (r.error) {
+				return false;
+			}
+
+			RES res = path.empty() ? RES(p_root) : ResourceLoader::load(path);
+			for (int i = 0; i < name_count; i++) {
+				Ref<GDScript> script = res;
+				StringName name = r.get_string();
+				if (script.is_null() || !script->subclasses.has(name)) {
+					return false;
+				}
+				res = script->subclasses[name];
+			}
+			if (res.is_null()) {
+				return false;
+			}
+			r_value = res;
+		} break;
+		default: {
+
+			return false;
+		} break;
+	}
+
+	return !r.error;
+}
+
+bool GDScriptBytecodeCache::_write_type(Writer &w, const GDScriptDataType &p_type, const GDScript *p_root) {
+
+	w.put_32(p_type.has_type);
+	w.put_32(p_type.kind);
+	w.put_32(p_type.builtin_type);
+	w.put_string(p_type.native_type);
+	return _write_value(w, p_type.script_type, p_root);
+}
+
+bool GDScriptBytecodeCache::_read_type(Reader &r, GDScriptDataType &r_type, GDScript *p_root) {
+
+	r_type.has_type = r.get_32();
+	r_type.kind = (GDScriptDataType::Kind)r.get_32();
+	r_type.builtin_type = (Variant::Type)r.get_32();
+	r_type.native_type = r.get_string();
+
+	Variant script_type;
+	if (!_read_value(r, script_type, p_root)) {
+		return false;
+	}
+	r_type.script_type = script_type;
+	return r_type.script_type.is_valid() == (script_type.operator Object *() != NULL);
+}
+
+bool GDScriptBytecodeCache::_write_function(Writer &w, const GDScriptFunction *p_function, const GDScript *p_root) {
+
+	w.put_string(p_function->name);
+	w.put_32(p_function->_static);
+	w.put_32(p_function->rpc_mode);
+	w.put_32(p_function->_argument_count);
+	w.put_32(p_function->_stack_size);
+	w.put_32(p_function->_call_size);
+	w.put_32(p_function->_initial_line);
+	w.put_32(p_function->_borrow_args);
+	w.put_32(p_function->_borrow_shared_args);
+
+	w.put_32(p_function->argument_types.size());
+	for (int i = 0; i < p_function->argument_types.size(); i++) {
+		if (!_write_type(w, p_function->argument_types[i], p_root)) {
+			return false;
+		}
+	}
+	if (!_write_type(w, p_function->return_type, p_root)) {
+		return false;
+	}
+
+#ifdef TOOLS_ENABLED
+	w.put_32(p_function->arg_names.size());
+	for (int i = 0; i < p_function->arg_names.size(); i++) {
+		w.put_string(p_function->arg_names[i]);
+	}
+#endif
+
+	w.put_32(p_function->constants.size());
+	for (int i = 0; i < p_function->constants.size(); i++) {
+		if (!_write_value(w, p_function->constants[i], p_root)) {
+			return false;
+		}
+	}
+
+	w.put_32(p_function->global_names.size());
+	for (int i = 0; i < p_function->global_names.size(); i++) {
+		w.put_string(p_function->global_names[i]);
+	}
+
+#ifdef TOOLS_ENABLED
+	w.put_32(p_function->named_globals.size());
+	for (int i = 0; i < p_function->named_globals.size(); i++) {
+		w.put_string(p_function->named_globals[i]);
+	}
+#endif
+
+	const Map<StringName, int> &global_map = GDScriptLanguage::get_singleton()->get_global_map();
+	w.put_32(p_function->used_globals.size());
+	for (int i = 0; i < p_function->used_globals.size(); i++) {
+		w.put_string(p_function->used_globals[i]);
+		w.put_32(global_map[p_function->used_globals[i]]);
+	}
+
+	w.put_32(p_function->default_arguments.size());
+	for (int i = 0; i < p_function->default_arguments.size(); i++) {
+		w.put_32(p_function->default_arguments[i]);
+	}
+
+	w.put_32(p_function->code.size());
+	for (int i = 0; i < p_function->code.size(); i++) {
+		w.put_32(p_function->code[i]);
+	}
+
+#ifdef PTRCALL_ENABLED
+	w.put_32(p_function->ptrcalls.size());
+	for (int i = 0; i < p_function->ptrcalls.size(); i++) {
+		const GDScriptFunction::PtrCall &ptrcall = p_function->ptrcalls[i];
+		w.put_string(ptrcall.method->get_instance_class());
+		w.put_string(ptrcall.method->get_name());
+		w.put_string(ptrcall.class_name);
+		w.put_32(ptrcall.argument_types.size());
+		for (int j = 0; j < ptrcall.argument_types.size(); j++) {
+			w.put_32(ptrcall.argument_types[j]);
+			w.put_string(ptrcall.argument_classes[j]);
+		}
+		w.put_32(ptrcall.default_arguments.size());
+		for (int j = 0; j < ptrcall.default_arguments.size(); j++) {
+			if (!_write_value(w, ptrcall.default_arguments[j], p_root)) {
+				return false;
+			}
+		}
+		w.put_32(ptrcall.return_type);
+		w.put_32(ptrcall.return_enum);
+	}
+#endif
+
+	w.put_32(p_function->inline_caches.size());
+	return true;
+}
+
+GDScriptFunction *GDScriptBytecodeCache::_read_function(Reader &r, GDScript *p_script, GDScript *p_root) {
+
+	StringName name = r.get_string();
+	if (r.error || p_script->member_functions.has(name)) {
+		return NULL;
+	}
+
+	// owned by the script right away, so it's freed with it if reading fails
+	GDScriptFunction *function = memnew(GDScriptFunction);
+	p_script->member_functions[name] = function;
+
+	function->name = name;
+	function->_static = r.get_32();
+	function->rpc_mode = (MultiplayerAPI::RPCMode)r.get_32();
+	function->_argument_count = r.get_32();
+	function->_stack_size = r.get_32();
+	function->_call_size = r.get_32();
+	function->_initial_line = r.get_32();
+	function->_borrow_args = r.get_32();
+	function->_borrow_shared_args = r.get_32();
+	if (function->_argument_count < 0 || function->_stack_size < 0 || function->_call_size < 0) {
+		return NULL;
+	}
+
+	int count = r.get_count();
+	function->argument_types.resize(count);
+	for (int i = 0; i < count; i++) {
+		if (!_read_type(r, function->argument_types.write[i], p_root)) {
+			return NULL;
+		}
+	}
+	if (!_read_type(r, function->return_type, p_root)) {
+		return NULL;
+	}
+
+#ifdef TOOLS_ENABLED
+	count = r.get_count();
+	function->arg_names.resize(count);
+	for (int i = 0; i < count; i++) {
+		function->arg_names.write[i] = r.get_string();
+	}
+#endif
+
+	count = r.get_count();
+	function->constants.resize(count);
+	for (int i = 0; i < count; i++) {
+		if (!_read_value(r, function->constants.write[i], p_root)) {
+			return NULL;
+		}
+	}
+	function->_constants_ptr = count ? function->constants.ptrw() : NULL;
+	function->_constant_count = count;
+
+	count = r.get_count();
+	function->global_names.resize(count);
+	for (int i = 0; i < count; i++) {
+		function->global_names.write[i] = r.get_string();
+	}
+	function->_global_names_ptr = count ? function->global_names.ptr() : NULL;
+	function->_global_names_count = count;
+
+#ifdef TOOLS_ENABLED
+	count = r.get_count();
+	function->named_globals.resize(count);
+	for (int i = 0; i < count; i++) {
+		function->named_globals.write[i] = r.get_string();
+	}
+	function->_named_globals_ptr = count ? function->named_globals.ptr() : NULL;
+	function->_named_globals_count = count;
+#endif
+
+	// the code addresses these by index, which must not have moved
+	const Map<StringName, int> &global_map = GDScriptLanguage::get_singleton()->get_global_map();
+	count = r.get_count();
+	for (int i = 0; i < count; i++) {
+		StringName global = r.get_string();
+		int index = r.get_32();
+		if (r.error || !global_map.has(global) || global_map[global] != index) {
+			return NULL;
+		}
+		function->used_globals.push_back(global);
+	}
+
+	count = r.get_count();
+	function->default_arguments.resize(count);
+	for (int i = 0; i < count; i++) {
+		function->default_arguments.write[i] = r.get_32();
+	}
+	function->_default_arg_ptr = count ? function->default_arguments.ptr() : NULL;
+	function->_default_arg_count = count ? count - 1 : 0;
+
+	count = r.get_count();
+	if (count == 0) {
+		return NULL;
+	}
+	function->code.resize(count);
+	for (int i = 0; i < count; i++) {
+		function->code.write[i] = r.get_32();
+	}
+	function->_code_ptr = function->code.ptr();
+	function->_code_size = count;
+
+#ifdef PTRCALL_ENABLED
+	count = r.get_count();
+	function->ptrcalls.resize(count);
+	for (int i = 0; i < count; i++) {
+		GDScriptFunction::PtrCall &ptrcall = function->ptrcalls.write[i];
+		StringName class_name = r.get_string();
+		StringName method_name = r.get_string();
+		ptrcall.class_name = r.get_string();
+
+		// The types are re-derived from the method bound in this build, the
+		// cached ones only have to agree with them or the function recompiles.
+		int argument_count = r.get_count();
+#ifdef DEBUG_METHODS_ENABLED
+		if (!GDScriptFunction::_setup_ptrcall(ptrcall, ClassDB::get_method(class_name, method_name)) || ptrcall.method->get_argument_count() != argument_count) {
+			return NULL;
+		}
+		for (int j = 0; j < argument_count; j++) {
+			Variant::Type type = (Variant::Type)r.get_32();
+			StringName argument_class = r.get_string();
+			if (type != ptrcall.argument_types[j] || argument_class != ptrcall.argument_classes[j]) {
+				return NULL;
+			}
+		}
+#else
+		// without method debug info the types can't be checked, the compiler
+		// never emits ptrcalls in such builds anyway
+		return NULL;
+#endif
+
+		int default_count = r.get_count();
+		if (default_count > argument_count) {
+			return NULL;
+		}
+		ptrcall.default_arguments.resize(default_count);
+		for (int j = 0; j < default_count; j++) {
+			Variant &value = ptrcall.default_arguments.write[j];
+			if (!_read_value(r, value, p_root)) {
+				return NULL;
+			}
+			Variant::Type type = ptrcall.argument_types[argument_count - default_count + j];
+			if (type != Variant::NIL && value.get_type() != type) {
+				return NULL;
+			}
+		}
+		Variant::Type return_type = (Variant::Type)r.get_32();
+		bool return_enum = r.get_32();
+		if (return_type != ptrcall.return_type || return_enum != ptrcall.return_enum) {
+			return NULL;
+		}
+	}
+	function->_ptrcalls_ptr = function->ptrcalls.ptrw();
+	function->_ptrcalls_count = count;
+#endif
+
+	count = r.get_count();
+	function->inline_caches.resize(count);
+	function->_inline_caches_ptr = function->inline_caches.ptrw();
+	function->_inline_caches_count = count;
+
+	function->_script = p_script;
+	function->source = p_root->get_path();
+#ifdef DEBUG_ENABLED
+	function->func_cname = (String(function->source) + " - " + String(name)).utf8();
+	function->_func_cname = function->func_cname.get_data();
+#endif
+
+	return r.error ? NULL : function;
+}
+
+void GDScriptBytecodeCache::_write_tree(Writer &w, const GDScript *p_script) {
+
+	w.put_32(p_script->subclasses.size());
+	for (const Map<StringName, Ref<GDScript> >::Element *E = p_script->subclasses.front(); E; E = E->next()) {
+		w.put_string(E->key());
+		_write_tree(w, E->get().ptr());
+	}
+}
+
+bool GDScriptBytecodeCache::_read_tree(Reader &r, GDScript *p_script) {
+
+	int count = r.get_count();
+	for (int i = 0; i < count; i++) {
+		StringName name = r.get_string();
+		if (r.error || p_script->subclasses.has(name)) {
+			return false;
+		}
+
+		Ref<GDScript> subclass;
+		subclass.instance();
+		subclass->_owner = p_script;
+		p_script->subclasses.insert(name, subclass);
+
+		if (!_read_tree(r, subclass.ptr())) {
+			return false;
+		}
+	}
+
+	return !r.error;
+}
+
+bool GDScriptBytecodeCache::_write_class(Writer &w, const GDScript *p_script, const GDScript *p_root) {
+
+	w.put_32(p_script->tool);
+	w.put_string(p_script->name);
+	if (!_write_value(w, p_script->native, p_root) || !_write_value(w, p_script->base, p_root)) {
+		return false;
+	}
+
+	w.put_32(p_script->members.size());
+	for (const Set<StringName>::Element *E = p_script->members.front(); E; E = E->next()) {
+		w.put_string(E->get());
+	}
+
+	w.put_32(p_script->member_indices.size());
+	for (const Map<StringName, GDScript::MemberInfo>::Element *E = p_script->member_indices.front(); E; E = E->next()) {
+		w.put_string(E->key());
+		w.put_32(E->get().index);
+		w.put_string(E->get().setter);
+		w.put_string(E->get().getter);
+		w.put_32(E->get().rpc_mode);
+		if (!_write_type(w, E->get().data_type, p_root)) {
+			return false;
+		}
+	}
+
+	w.put_32(p_script->member_info.size());
+	for (const Map<StringName, PropertyInfo>::Element *E = p_script->member_info.front(); E; E = E->next()) {
+		w.put_32(E->get().type);
+		w.put_string(E->get().name);
+		w.put_string(E->get().class_name);
+		w.put_32(E->get().hint);
+		w.put_string(E->get().hint_string);
+		w.put_32(E->get().usage);
+	}
+
+	w.put_32(p_script->constants.size());
+	for (const Map<StringName, Variant>::Element *E = p_script->constants.front(); E; E = E->next()) {
+		w.put_string(E->key());
+		if (!_write_value(w, E->get(), p_root)) {
+			return false;
+		}
+	}
+
+	w.put_32(p_script->_signals.size());
+	for (const Map<StringName, Vector<StringName> >::Element *E = p_script->_signals.front(); E; E = E->next()) {
+		w.put_string(E->key());
+		w.put_32(E->get().size());
+		for (int i = 0; i < E->get().size(); i++) {
+			w.put_string(E->get()[i]);
+		}
+	}
+
+#ifdef TOOLS_ENABLED
+	w.put_32(p_script->member_lines.size());
+	for (const Map<StringName, int>::Element *E = p_script->member_lines.front(); E; E = E->next()) {
+		w.put_string(E->key());
+		w.put_32(E->get());
+	}
+
+	w.put_32(p_script->member_default_values.size());
+	for (const Map<StringName, Variant>::Element *E = p_script->member_default_values.front(); E; E = E->next()) {
+		w.put_string(E->key());
+		if (!_write_value(w, E->get(), p_root)) {
+			return false;
+		}
+	}
+#endif
+
+	w.put_32(p_script->member_functions.size());
+	for (const Map<StringName, GDScriptFunction *>::Element *E = p_script->member_functions.front(); E; E = E->next()) {
+		if (!_write_function(w, E->get(), p_root)) {
+			return false;
+		}
+	}
+
+	// StringName maps aren't ordered the same way across runs, so each subclass is tagged with its name
+	for (const Map<StringName, Ref<GDScript> >::Element *E = p_script->subclasses.front(); E; E = E->next()) {
+		w.put_string(E->key());
+		if (!_write_class(w, E->get().ptr(), p_root)) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+bool GDScriptBytecodeCache::_read_class(Reader &r, GDScript *p_script, GDScript *p_root) {
+
+	p_script->tool = r.get_32();
+	p_script->name = r.get_string();
+
+	Variant native;
+	Variant base;
+	if (!_read_value(r, native, p_root) || !_read_value(r, base, p_root)) {
+		return false;
+	}
+	p_script->native = native;
+	p_script->base = base;
+	p_script->_base = p_script->base.ptr();
+	if (p_script->native.is_null() == p_script->base.is_null()) {
+		return false;
+	}
+
+	int count = r.get_count();
+	for (int i = 0; i < count; i++) {
+		p_script->members.insert(r.get_string());
+	}
+
+	count = r.get_count();
+	for (int i = 0; i < count; i++) {
+		StringName name = r.get_string();
+		GDScript::MemberInfo minfo;
+		minfo.index = r.get_32();
+		minfo.setter = r.get_string();
+		minfo.getter = r.get_string();
+		minfo.rpc_mode = (MultiplayerAPI::RPCMode)r.get_32();
+		if (!_read_type(r, minfo.data_type, p_root)) {
+			return false;
+		}
+		p_script->member_indices[name] = minfo;
+	}
+
+	count = r.get_count();
+	for (int i = 0; i < count; i++) {
+		PropertyInfo info;
+		info.type = (Variant::Type)r.get_32();
+		info.name = r.get_string();
+		info.class_name = r.get_string();
+		info.hint = (PropertyHint)r.get_32();
+		info.hint_string = r.get_string();
+		info.usage = r.get_32();
+		p_script->member_info[info.name] = info;
+	}
+
+	count = r.get_count();
+	for (int i = 0; i < count; i++) {
+		StringName name = r.get_string();
+		Variant value;
+		if (!_read_value(r, value, p_root)) {
+			return false;
+		}
+		p_script->constants[name] = value;
+	}
+
+	count = r.get_count();
+	for (int i = 0; i < count; i++) {
+		StringName name = r.get_string();
+		int argument_count = r.get_count();
+		Vector<StringName> arguments;
+		arguments.resize(argument_count);
+		for (int j = 0; j < argument_count; j++) {
+			arguments.write[j] = r.get_string();
+		}
+		p_script->_signals[name] = arguments;
+	}
+
+#ifdef TOOLS_ENABLED
+	count = r.get_count();
+	for (int i = 0; i < count; i++) {
+		StringName name = r.get_string();
+		p_script->member_lines[name] = r.get_32();
+	}
+
+	count = r.get_count();
+	for (int i = 0; i < count; i++) {
+		StringName name = r.get_string();
+		Variant value;
+		if (!_read_value(r, value, p_root)) {
+			return false;
+		}
+		p_script->member_default_values[name] = value;
+	}
+#endif
+
+	count = r.get_count();
+	for (int i = 0; i < count; i++) {
+		if (!_read_function(r, p_script, p_root)) {
+			return false;
+		}
+	}
+	p_script->initializer = p_script->member_functions.has("_init") ? p_script->member_functions["_init"] : NULL;
+
+	for (int i = 0; i < p_script->subclasses.size(); i++) {
+		StringName name = r.get_string();
+		if (r.error || !p_script->subclasses.has(name)) {
+			return false;
+		}
+		if (!_read_class(r, p_script->subclasses[name].ptr(), p_root)) {
+			return false;
+		}
+	}
+
+	if (r.error) {
+		return false;
+	}
+
+	p_script->valid = true;
+	return true;
+}
+
+void GDScriptBytecodeCache::_clear(GDScript *p_script) {
+
+	for (Map<StringName, Ref<GDScript> >::Element *E = p_script->subclasses.front(); E; E = E->next()) {
+		_clear(E->get().ptr());
+	}
+	p_script->subclasses.clear();
+
+	for (Map<StringName, GDScriptFunction *>::Element *E = p_script->member_functions.front(); E; E = E->next()) {
+		memdelete(E->get());
+	}
+	p_script->member_functions.clear();
+	p_script->initializer = NULL;
+
+	p_script->native = Ref<GDScriptNativeClass>();
+	p_script->base = Ref<GDScript>();
+	p_script->_base = NULL;
+	p_script->members.clear();
+	p_script->member_indices.clear();
+	p_script->member_info.clear();
+	p_script->constants.clear();
+	p_script->_signals.clear();
+#ifdef TOOLS_ENABLED
+	p_script->member_lines.clear();
+	p_script->member_default_values.clear();
+#endif
+	p_script->valid = false;
+}
+
+bool GDScriptBytecodeCache::is_enabled() const {
+
+	// the editor changes scripts constantly, and the debugger wants the
+	// warnings and stack info that only a full compile produces
+	return enabled && !Engine::get_singleton()->is_editor_hint() && !ScriptDebugger::get_singleton();
+}
+
+bool GDScriptBytecodeCache::load(GDScript *p_script, const String &p_source_key) {
+
+	String path = p_script->get_path();
+	if (!path.is_resource_file()) {
+		return false;
+	}
+
+	String file = _get_cache_file(path);
+	if (!FileAccess::exists(file)) {
+		return false;
+	}
+
+	Vector<uint8_t> data = FileAccess::get_file_as_array(file);
+	if (data.size() < 4 || memcmp(data.ptr(), bytecode_cache_magic, 4) != 0) {
+		return false;
+	}
+
+	Reader r(data.ptr(), data.size());
+	r.pos = 4;
+	if (r.get_32() != BYTECODE_CACHE_VERSION) {
+		return false;
+	}
+	String checksum = r.get_string();
+	if (r.error || checksum != _md5(&data[r.pos], data.size() - r.pos)) {
+		return false;
+	}
+
+	if (r.get_string() != build_config || r.get_string() != p_source_key) {
+		return false;
+	}
+
+	String fingerprint = r.get_string();
+	Vector<String> dependencies;
+	int count = r.get_count();
+	for (int i = 0; i < count; i++) {
+		dependencies.push_back(r.get_string());
+	}
+	if (r.error) {
+		return false;
+	}
+
+	// loading them makes their own fingerprints known
+	for (int i = 0; i < dependencies.size(); i++) {
+		ResourceLoader::load(dependencies[i]);
+	}
+	if (_make_fingerprint(p_source_key, dependencies) != fingerprint) {
+		return false;
+	}
+
+	if (!_read_tree(r, p_script) || !_read_class(r, p_script, p_script) || r.pos != r.size) {
+		_clear(p_script);
+		return false;
+	}
+
+	for (Map<StringName, Ref<GDScript> >::Element *E = p_script->subclasses.front(); E; E = E->next()) {
+		p_script->_set_subclass_path(E->get(), p_script->path);
+	}
+
+	_set_fingerprint(path, fingerprint);
+	return true;
+}
+
+void GDScriptBytecodeCache::save(GDScript *p_script, const String &p_source_key, const Set<String> &p_dependencies) {
+
+	String path = p_script->get_path();
+	if (!path.is_resource_file()) {
+		return;
+	}
+
+	Vector<String> dependencies;
+	for (const Set<String>::Element *E = p_dependencies.front(); E; E = E->next()) {
+		if (E->get() != path) {
+			dependencies.push_back(E->get());
+		}
+	}
+
+	String fingerprint = _make_fingerprint(p_source_key, dependencies);
+	_set_fingerprint(path, fingerprint);
+
+	Writer w;
+	w.put_string(build_config);
+	w.put_string(p_source_key);
+	w.put_string(fingerprint);
+	w.put_32(dependencies.size());
+	for (int i = 0; i < dependencies.size(); i++) {
+		w.put_string(dependencies[i]);
+	}
+
+	_write_tree(w, p_script);
+	if (!_write_class(w, p_script, p_script)) {
+		// holds values that can't be stored, this script always compiles from source
+		return;
+	}
+
+	if (lock) {
+		lock->lock();
+	}
+
+	if (!cache_dir_created) {
+		DirAccess *da = DirAccess::create_for_path(cache_path);
+		if (da) {
+			da->make_dir_recursive(cache_path);
+			memdelete(da);
+		}
+		cache_dir_created = true;
+	}
+
+	if (lock) {
+		lock->unlock();
+	}
+
+	// the cache is optional, so a location that can't be written to is not an error
+	FileAccess *f = FileAccess::open(_get_cache_file(path), FileAccess::WRITE);
+	if (!f) {
+		return;
+	}
+
+	f->store_buffer(bytecode_cache_magic, 4);
+	f->store_32(BYTECODE_CACHE_VERSION);
+	f->store_pascal_string(_md5(w.data.ptr(), w.data.size()));
+	f->store_buffer(w.data.ptr(), w.data.size());
+	f->close();
+	memdelete(f);
+}
+
+GDScriptBytecodeCache::GDScriptBytecodeCache() {
+
+	singleton = this;
+
+	enabled = GLOBAL_DEF("gdscript/bytecode_cache/enabled", false);
+	cache_path = GLOBAL_DEF("gdscript/bytecode_cache/path", "user://gdscript_cache");
+	cache_dir_created = false;
+
+	// anything that changes what the compiler emits or how it's encoded
+	build_config = VERSION_FULL_BUILD;
+	build_config += " hash:" + String(VERSION_HASH);
+	build_config += " opcodes:" + itos(GDScriptFunction::OPCODE_END + 1);
+	build_config += " real:" + itos(sizeof(real_t));
+#ifdef TOOLS_ENABLED
+	build_config += " tools";
+#endif
+#ifdef DEBUG_ENABLED
+	build_config += " debug";
+#endif
+#ifdef DEBUG_METHODS_ENABLED
+	build_config += " methods";
+#endif
+#ifdef PTRCALL_ENABLED
+	build_config += " ptrcall";
+#endif
+
+#ifdef NO_THREADS
+	lock = NULL;
+#else
+	lock = Mutex::create();
+#endif
+}
+
+GDScriptBytecodeCache::~GDScriptBytecodeCache() {
+
+	if (lock) {
+		memdelete(lock);
+	}
+	singleton = NULL;
+}
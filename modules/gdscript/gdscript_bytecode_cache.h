@@ -0,0 +1,87 @@
+/*************************************************************************/
+/*  gdscript_bytecode_cache.h                                            */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2018 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2018 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef GDSCRIPT_BYTECODE_CACHE_H
+#define GDSCRIPT_BYTECODE_CACHE_H
+
+#include "core/hash_map.h"
+#include "core/os/mutex.h"
+#include "gdscript.h"
+
+// Stores the compiled form of scripts so later runs can skip parsing and
+// compiling them. A cached script is only used when the engine build, its
+// source and the scripts it was compiled against are all unchanged.
+class GDScriptBytecodeCache {
+
+	struct Writer;
+	struct Reader;
+
+	static GDScriptBytecodeCache *singleton;
+
+	bool enabled;
+	String cache_path;
+	String build_config;
+	bool cache_dir_created;
+
+	Mutex *lock;
+	HashMap<String, String> fingerprints; // script path -> hash of its source and dependencies
+
+	String _get_cache_file(const String &p_path) const;
+	String _make_fingerprint(const String &p_source_key, const Vector<String> &p_dependencies);
+	void _set_fingerprint(const String &p_path, const String &p_fingerprint);
+
+	bool _write_value(Writer &w, const Variant &p_value, const GDScript *p_root);
+	bool _write_type(Writer &w, const GDScriptDataType &p_type, const GDScript *p_root);
+	bool _write_function(Writer &w, const GDScriptFunction *p_function, const GDScript *p_root);
+	void _write_tree(Writer &w, const GDScript *p_script);
+	bool _write_class(Writer &w, const GDScript *p_script, const GDScript *p_root);
+
+	bool _read_value(Reader &r, Variant &r_value, GDScript *p_root);
+	bool _read_type(Reader &r, GDScriptDataType &r_type, GDScript *p_root);
+	GDScriptFunction *_read_function(Reader &r, GDScript *p_script, GDScript *p_root);
+	bool _read_tree(Reader &r, GDScript *p_script);
+	bool _read_class(Reader &r, GDScript *p_script, GDScript *p_root);
+
+	void _clear(GDScript *p_script);
+
+public:
+	static GDScriptBytecodeCache *get_singleton() { return singleton; }
+
+	bool is_enabled() const;
+
+	// p_source_key identifies the source the script is compiled from
+	bool load(GDScript *p_script, const String &p_source_key);
+	void save(GDScript *p_script, const String &p_source_key, const Set<String> &p_dependencies);
+
+	GDScriptBytecodeCache();
+	~GDScriptBytecodeCache();
+};
+
+#endif // GDSCRIPT_BYTECODE_CACHE_H
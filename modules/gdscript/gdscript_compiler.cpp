@@ -82,7 +82,9 @@ bool GDScriptCompiler::_create_unary_operator(CodeGen &codegen, const GDScriptPa
 	if (src_address_a < 0)
 		return false;
 
-	codegen.opcodes.push_back(GDScriptFunction::OPCODE_OPERATOR); // perform operator
+	const GDScriptParser::DataType &type_a = on->arguments[0]->get_datatype();
+
+	codegen.opcodes.push_back(_get_operator_opcode(op, type_a, type_a)); // perform operator
 	codegen.opcodes.push_back(op); //which operator
 	codegen.opcodes.push_back(src_address_a); // argument 1
 	codegen.opcodes.push_back(src_address_a); // argument 2 (repeated)
@@ -104,13 +106,170 @@ bool GDScriptCompiler::_create_binary_operator(CodeGen &codegen, const GDScriptP
 	if (src_address_b < 0)
 		return false;
 
-	codegen.opcodes.push_back(GDScriptFunction::OPCODE_OPERATOR); // perform operator
+	codegen.opcodes.push_back(_get_operator_opcode(op, on->arguments[0]->get_datatype(), on->arguments[1]->get_datatype())); // perform operator
 	codegen.opcodes.push_back(op); //which operator
 	codegen.opcodes.push_back(src_address_a); // argument 1
 	codegen.opcodes.push_back(src_address_b); // argument 2 (unary only takes one parameter)
 	return true;
 }
 
+static Variant::Type _get_builtin_type(const GDScriptParser::DataType &p_datatype) {
+
+	if (!p_datatype.has_type || p_datatype.kind != GDScriptParser::DataType::BUILTIN) {
+		return Variant::NIL;
+	}
+	return p_datatype.builtin_type;
+}
+
+GDScriptFunction::Opcode GDScriptCompiler::_get_operator_opcode(Variant::Operator op, const GDScriptParser::DataType &p_a, const GDScriptParser::DataType &p_b) const {
+
+	// Static types are only a hint, the typed opcodes check the actual operands
+	// and fall back to OPCODE_OPERATOR, so this only has to pick the likely case.
+	Variant::Type type_a = _get_builtin_type(p_a);
+	Variant::Type type_b = _get_builtin_type(p_b);
+
+	bool numeric_a = type_a == Variant::INT || type_a == Variant::REAL;
+	bool numeric_b = type_b == Variant::INT || type_b == Variant::REAL;
+
+	if (type_a == Variant::INT && type_b == Variant::INT) {
+		switch (op) {
+			case Variant::OP_EQUAL:
+			case Variant::OP_NOT_EQUAL:
+			case Variant::OP_LESS:
+			case Variant::OP_LESS_EQUAL:
+			case Variant::OP_GREATER:
+			case Variant::OP_GREATER_EQUAL:
+			case Variant::OP_ADD:
+			case Variant::OP_SUBTRACT:
+			case Variant::OP_MULTIPLY:
+			case Variant::OP_DIVIDE:
+			case Variant::OP_MODULE:
+			case Variant::OP_NEGATE:
+			case Variant::OP_SHIFT_LEFT:
+			case Variant::OP_SHIFT_RIGHT:
+			case Variant::OP_BIT_AND:
+			case Variant::OP_BIT_OR:
+			case Variant::OP_BIT_XOR:
+			case Variant::OP_BIT_NEGATE:
+				return GDScriptFunction::OPCODE_OPERATOR_INT;
+			default: {
+			}
+		}
+	} else if (numeric_a && numeric_b) {
+		switch (op) {
+			case Variant::OP_EQUAL:
+			case Variant::OP_NOT_EQUAL:
+			case Variant::OP_LESS:
+			case Variant::OP_LESS_EQUAL:
+			case Variant::OP_GREATER:
+			case Variant::OP_GREATER_EQUAL:
+			case Variant::OP_ADD:
+			case Variant::OP_SUBTRACT:
+			case Variant::OP_MULTIPLY:
+			case Variant::OP_DIVIDE:
+			case Variant::OP_NEGATE:
+				return GDScriptFunction::OPCODE_OPERATOR_REAL;
+			default: {
+			}
+		}
+	} else if ((type_a == Variant::VECTOR2 || type_a == Variant::VECTOR3) && (type_b == type_a || numeric_b)) {
+		switch (op) {
+			case Variant::OP_EQUAL:
+			case Variant::OP_NOT_EQUAL:
+			case Variant::OP_ADD:
+			case Variant::OP_SUBTRACT:
+			case Variant::OP_MULTIPLY:
+			case Variant::OP_DIVIDE:
+			case Variant::OP_NEGATE:
+				return type_a == Variant::VECTOR2 ? GDScriptFunction::OPCODE_OPERATOR_VECTOR2 : GDScriptFunction::OPCODE_OPERATOR_VECTOR3;
+			default: {
+			}
+		}
+	} else if (numeric_a && (type_b == Variant::VECTOR2 || type_b == Variant::VECTOR3) && op == Variant::OP_MULTIPLY) {
+		return type_b == Variant::VECTOR2 ? GDScriptFunction::OPCODE_OPERATOR_VECTOR2 : GDScriptFunction::OPCODE_OPERATOR_VECTOR3;
+	}
+
+	return GDScriptFunction::OPCODE_OPERATOR;
+}
+
+bool GDScriptCompiler::_is_array_index(const GDScriptParser::Node *p_base, const GDScriptParser::Node *p_index) const {
+
+	return _get_builtin_type(p_base->get_datatype()) == Variant::ARRAY && _get_builtin_type(p_index->get_datatype()) == Variant::INT;
+}
+
+bool GDScriptCompiler::_is_range_iterate(const GDScriptParser::Node *p_container) const {
+
+	Variant::Type type = _get_builtin_type(p_container->get_datatype());
+	return type == Variant::INT || type == Variant::VECTOR2 || type == Variant::VECTOR3;
+}
+
+int GDScriptCompiler::_get_ptrcall_pos(CodeGen &codegen, const GDScriptParser::OperatorNode *p_call) {
+
+	// Argument types are only known when method debug info is compiled in,
+	// without them ptrcall can't be used safely.
+#if defined(PTRCALL_ENABLED) && defined(DEBUG_METHODS_ENABLED)
+	const GDScriptParser::DataType &base_type = p_call->arguments[0]->get_datatype();
+	if (!base_type.has_type || base_type.kind != GDScriptParser::DataType::NATIVE) {
+		return -1;
+	}
+
+	const StringName &method_name = static_cast<const GDScriptParser::IdentifierNode *>(p_call->arguments[1])->name;
+	MethodBind *method = ClassDB::get_method(base_type.native_type, method_name);
+	GDScriptFunction::PtrCall ptrcall;
+	if (!GDScriptFunction::_setup_ptrcall(ptrcall, method)) {
+		return -1;
+	}
+	ptrcall.class_name = base_type.native_type;
+
+	int argc = p_call->arguments.size() - 2;
+	int argument_count = method->get_argument_count();
+	if (argc > argument_count || argc < argument_count - method->get_default_argument_count()) {
+		return -1;
+	}
+
+	for (int i = 0; i < argument_count; i++) {
+
+		Variant::Type type = ptrcall.argument_types[i];
+
+		if (i < argc) {
+			// fail early when the argument can never match
+			Variant::Type arg_type = _get_builtin_type(p_call->arguments[i + 2]->get_datatype());
+			if (type != Variant::NIL && arg_type != Variant::NIL && arg_type != type) {
+				return -1;
+			}
+		} else {
+			Variant default_value = method->get_default_argument(i);
+			if (type != Variant::NIL && default_value.get_type() != type) {
+				const Variant *value_ptr = &default_value;
+				Variant::CallError ce;
+				default_value = Variant::construct(type, &value_ptr, 1, ce);
+				if (ce.error != Variant::CallError::CALL_OK) {
+					return -1;
+				}
+			}
+			ptrcall.default_arguments.push_back(default_value);
+		}
+	}
+
+	codegen.alloc_call(argument_count);
+	codegen.ptrcalls.push_back(ptrcall);
+	return codegen.ptrcalls.size() - 1;
+#else
+	return -1;
+#endif
+}
+
+int GDScriptCompiler::_get_inline_cache_pos(CodeGen &codegen, const GDScriptParser::Node *p_base) {
+
+	// the cache only handles objects, skip receivers known to be something else
+	Variant::Type type = _get_builtin_type(p_base->get_datatype());
+	if (type != Variant::NIL && type != Variant::OBJECT) {
+		return -1;
+	}
+
+	return codegen.inline_cache_count++;
+}
+
 GDScriptDataType GDScriptCompiler::_gdtype_from_datatype(const GDScriptParser::DataType &p_datatype) const {
 	if (!p_datatype.has_type) {
 		return GDScriptDataType();
@@ -292,7 +451,7 @@ int GDScriptCompiler::_parse_expression(CodeGen &codegen, const GDScriptParser::
 
 			if (GDScriptLanguage::get_singleton()->get_global_map().has(identifier)) {
 
-				int idx = GDScriptLanguage::get_singleton()->get_global_map()[identifier];
+				int idx = codegen.get_global_pos(identifier);
 				return idx | (GDScriptFunction::ADDR_TYPE_GLOBAL << GDScriptFunction::ADDR_BITS); //argument (stack root)
 			}
 
@@ -469,7 +628,7 @@ int GDScriptCompiler::_parse_expression(CodeGen &codegen, const GDScriptParser::
 					int class_idx;
 					if (GDScriptLanguage::get_singleton()->get_global_map().has(cn->cast_type.native_type)) {
 
-						class_idx = GDScriptLanguage::get_singleton()->get_global_map()[cn->cast_type.native_type];
+						class_idx = codegen.get_global_pos(cn->cast_type.native_type);
 						class_idx |= (GDScriptFunction::ADDR_TYPE_GLOBAL << GDScriptFunction::ADDR_BITS); //argument (stack root)
 					} else {
 						_set_error("Invalid native class type '" + String(cn->cast_type.native_type) + "'.", cn);
@@ -663,6 +822,16 @@ int GDScriptCompiler::_parse_expression(CodeGen &codegen, const GDScriptParser::
 							arguments.push_back(ret);
 						}
 
+						int ptrcall_pos = _get_ptrcall_pos(codegen, on);
+						int cache_pos = ptrcall_pos < 0 ? _get_inline_cache_pos(codegen, on->arguments[0]) : -1;
+						if (ptrcall_pos >= 0) {
+							codegen.opcodes.push_back(GDScriptFunction::OPCODE_CALL_PTRCALL); // native method, try calling it directly first
+							codegen.opcodes.push_back(ptrcall_pos);
+						} else if (cache_pos >= 0) {
+							codegen.opcodes.push_back(GDScriptFunction::OPCODE_INLINE_CACHE); // method looked up on a previous call
+							codegen.opcodes.push_back(cache_pos);
+						}
+
 						codegen.opcodes.push_back(p_root ? GDScriptFunction::OPCODE_CALL : GDScriptFunction::OPCODE_CALL_RETURN); // perform operator
 						codegen.opcodes.push_back(on->arguments.size() - 2);
 						codegen.alloc_call(on->arguments.size() - 2);
@@ -754,7 +923,16 @@ int GDScriptCompiler::_parse_expression(CodeGen &codegen, const GDScriptParser::
 						}
 					}
 
-					codegen.opcodes.push_back(named ? GDScriptFunction::OPCODE_GET_NAMED : GDScriptFunction::OPCODE_GET); // perform operator
+					if (named) {
+						int cache_pos = _get_inline_cache_pos(codegen, on->arguments[0]);
+						if (cache_pos >= 0) {
+							codegen.opcodes.push_back(GDScriptFunction::OPCODE_INLINE_CACHE);
+							codegen.opcodes.push_back(cache_pos);
+						}
+						codegen.opcodes.push_back(GDScriptFunction::OPCODE_GET_NAMED); // perform operator
+					} else {
+						codegen.opcodes.push_back(_is_array_index(on->arguments[0], on->arguments[1]) ? GDScriptFunction::OPCODE_GET_ARRAY : GDScriptFunction::OPCODE_GET);
+					}
 					codegen.opcodes.push_back(from); // argument 1
 					codegen.opcodes.push_back(index); // argument 2 (unary only takes one parameter)
 
@@ -1056,6 +1234,11 @@ int GDScriptCompiler::_parse_expression(CodeGen &codegen, const GDScriptParser::
 							if (key_idx < 0) //error
 								return key_idx;
 
+							int get_cache_pos = named ? _get_inline_cache_pos(codegen, E->get()->arguments[0]) : -1;
+							if (get_cache_pos >= 0) {
+								codegen.opcodes.push_back(GDScriptFunction::OPCODE_INLINE_CACHE);
+								codegen.opcodes.push_back(get_cache_pos);
+							}
 							codegen.opcodes.push_back(named ? GDScriptFunction::OPCODE_GET_NAMED : GDScriptFunction::OPCODE_GET);
 							codegen.opcodes.push_back(prev_pos);
 							codegen.opcodes.push_back(key_idx);
@@ -1071,6 +1254,11 @@ int GDScriptCompiler::_parse_expression(CodeGen &codegen, const GDScriptParser::
 							setchain.push_back(key_idx);
 							setchain.push_back(prev_pos);
 							setchain.push_back(named ? GDScriptFunction::OPCODE_SET_NAMED : GDScriptFunction::OPCODE_SET);
+							int set_cache_pos = named ? _get_inline_cache_pos(codegen, E->get()->arguments[0]) : -1;
+							if (set_cache_pos >= 0) {
+								setchain.push_back(set_cache_pos);
+								setchain.push_back(GDScriptFunction::OPCODE_INLINE_CACHE);
+							}
 
 							prev_pos = dst_pos;
 						}
@@ -1102,7 +1290,16 @@ int GDScriptCompiler::_parse_expression(CodeGen &codegen, const GDScriptParser::
 						if (set_value < 0) //error
 							return set_value;
 
-						codegen.opcodes.push_back(named ? GDScriptFunction::OPCODE_SET_NAMED : GDScriptFunction::OPCODE_SET);
+						if (named) {
+							int cache_pos = _get_inline_cache_pos(codegen, op->arguments[0]);
+							if (cache_pos >= 0) {
+								codegen.opcodes.push_back(GDScriptFunction::OPCODE_INLINE_CACHE);
+								codegen.opcodes.push_back(cache_pos);
+							}
+							codegen.opcodes.push_back(GDScriptFunction::OPCODE_SET_NAMED);
+						} else {
+							codegen.opcodes.push_back(_is_array_index(op->arguments[0], op->arguments[1]) ? GDScriptFunction::OPCODE_SET_ARRAY : GDScriptFunction::OPCODE_SET);
+						}
 						codegen.opcodes.push_back(prev_pos);
 						codegen.opcodes.push_back(set_index);
 						codegen.opcodes.push_back(set_value);
@@ -1164,7 +1361,7 @@ int GDScriptCompiler::_parse_expression(CodeGen &codegen, const GDScriptParser::
 									int class_idx;
 									if (GDScriptLanguage::get_singleton()->get_global_map().has(assign_type.native_type)) {
 
-										class_idx = GDScriptLanguage::get_singleton()->get_global_map()[assign_type.native_type];
+										class_idx = codegen.get_global_pos(assign_type.native_type);
 										class_idx |= (GDScriptFunction::ADDR_TYPE_GLOBAL << GDScriptFunction::ADDR_BITS); //argument (stack root)
 									} else {
 										_set_error("Invalid native class type '" + String(assign_type.native_type) + "'.", on->arguments[0]);
@@ -1453,8 +1650,10 @@ Error GDScriptCompiler::_parse_block(CodeGen &codegen, const GDScriptParser::Blo
 						codegen.opcodes.push_back(container_pos);
 						codegen.opcodes.push_back(ret);
 
+						bool range = _is_range_iterate(cf->arguments[1]);
+
 						//begin loop
-						codegen.opcodes.push_back(GDScriptFunction::OPCODE_ITERATE_BEGIN);
+						codegen.opcodes.push_back(range ? GDScriptFunction::OPCODE_ITERATE_BEGIN_RANGE : GDScriptFunction::OPCODE_ITERATE_BEGIN);
 						codegen.opcodes.push_back(counter_pos);
 						codegen.opcodes.push_back(container_pos);
 						codegen.opcodes.push_back(codegen.opcodes.size() + 4);
@@ -1467,7 +1666,7 @@ Error GDScriptCompiler::_parse_block(CodeGen &codegen, const GDScriptParser::Blo
 						codegen.opcodes.push_back(0); //skip code for next
 						//next loop
 						int continue_pos = codegen.opcodes.size();
-						codegen.opcodes.push_back(GDScriptFunction::OPCODE_ITERATE);
+						codegen.opcodes.push_back(range ? GDScriptFunction::OPCODE_ITERATE_RANGE : GDScriptFunction::OPCODE_ITERATE);
 						codegen.opcodes.push_back(counter_pos);
 						codegen.opcodes.push_back(container_pos);
 						codegen.opcodes.push_back(break_pos);
@@ -1603,6 +1802,978 @@ Error GDScriptCompiler::_parse_block(CodeGen &codegen, const GDScriptParser::Blo
 	return OK;
 }
 
+/* Optimizer */
+
+// The passes below see instructions only through the role of each of their
+// words, so the layout of every opcode is described in a single place.
+enum {
+	OPTIMIZER_ROLE_NONE,
+	OPTIMIZER_ROLE_READ,
+	OPTIMIZER_ROLE_WRITE, // always written, unless the instruction fails
+	OPTIMIZER_ROLE_READ_WRITE,
+	OPTIMIZER_ROLE_JUMP,
+};
+
+static _FORCE_INLINE_ int _get_address_type(int p_address) {
+
+	return p_address >> GDScriptFunction::ADDR_BITS;
+}
+
+static _FORCE_INLINE_ int _get_address_index(int p_address) {
+
+	return p_address & GDScriptFunction::ADDR_MASK;
+}
+
+static _FORCE_INLINE_ bool _is_stack_address(int p_address) {
+
+	int type = _get_address_type(p_address);
+	return type == GDScriptFunction::ADDR_TYPE_STACK || type == GDScriptFunction::ADDR_TYPE_STACK_VARIABLE;
+}
+
+static _FORCE_INLINE_ bool _is_foldable_constant(const Variant &p_value) {
+
+	// objects and containers are shared, so they can change after folding
+	return p_value.get_type() < Variant::_RID;
+}
+
+static _FORCE_INLINE_ bool _is_live_after(const Vector<uint32_t> &p_live_in, const Vector<int> &p_successor_ofs, const Vector<int> &p_successor_list, int p_words, int p_index, int p_slot) {
+
+	for (int i = p_successor_ofs[p_index]; i < p_successor_ofs[p_index + 1]; i++) {
+		if (p_live_in[p_successor_list[i] * p_words + (p_slot >> 5)] & (1U << (p_slot & 31)))
+			return true;
+	}
+	return false;
+}
+
+struct GDScriptOptimizerCode {
+
+	struct Instruction {
+		int pos;
+		int size;
+		bool removed;
+	};
+
+	Vector<int> code;
+	Vector<uint8_t> roles;
+	Vector<Instruction> instructions;
+	Vector<int> index_at; // instruction starting at each word, or -1
+	Vector<bool> targets; // instructions reached by a jump or an entry point
+	Vector<int> entries; // function start, then default argument addresses
+	Vector<Variant> constants;
+	Vector<StringName> names;
+	int stack_size;
+
+	int decode(int p_pos);
+	bool setup(const Vector<int> &p_code);
+
+	_FORCE_INLINE_ int resolve(int p_index) const {
+		while (p_index < instructions.size() && instructions[p_index].removed)
+			p_index++;
+		return p_index;
+	}
+	_FORCE_INLINE_ int get_target(int p_pos) const { return resolve(index_at[p_pos]); }
+	_FORCE_INLINE_ int get_next(int p_index) const { return resolve(p_index + 1); }
+	_FORCE_INLINE_ int get_opcode(int p_index) const { return code[instructions[p_index].pos]; }
+
+	void rewrite(int p_index);
+	void get_successors(int p_index, Vector<int> &r_successors) const;
+	void update_targets();
+
+	bool simplify_jumps();
+	bool remove_unreachable();
+	bool eliminate_temporaries();
+	bool remove_lines(bool p_keep_breakpoints);
+
+	void compact(Vector<int> &r_code, Vector<int> &r_entries) const;
+};
+
+int GDScriptOptimizerCode::decode(int p_pos) {
+
+	const int *ip = &code[p_pos];
+	uint8_t *r = &roles.write[p_pos];
+	int avail = code.size() - p_pos;
+	int size = 0;
+	int argc = 0;
+
+#define DECODE_ARGC(m_ofs)                                          \
+	if (avail <= (m_ofs) || ip[m_ofs] < 0 || ip[m_ofs] > avail) \
+		return -1;                                                  \
+	argc = ip[m_ofs];
+
+#define DECODE_SIZE(m_size)        \
+	size = (m_size);               \
+	if (size > avail)              \
+		return -1;                 \
+	for (int i = 0; i < size; i++) \
+		r[i] = OPTIMIZER_ROLE_NONE;
+
+	switch (ip[0]) {
+		case GDScriptFunction::OPCODE_OPERATOR:
+		case GDScriptFunction::OPCODE_OPERATOR_INT:
+		case GDScriptFunction::OPCODE_OPERATOR_REAL:
+		case GDScriptFunction::OPCODE_OPERATOR_VECTOR2:
+		case GDScriptFunction::OPCODE_OPERATOR_VECTOR3: {
+			DECODE_SIZE(5);
+			r[2] = OPTIMIZER_ROLE_READ;
+			r[3] = OPTIMIZER_ROLE_READ;
+			r[4] = OPTIMIZER_ROLE_WRITE;
+		} break;
+		case GDScriptFunction::OPCODE_EXTENDS_TEST:
+		case GDScriptFunction::OPCODE_GET:
+		case GDScriptFunction::OPCODE_GET_ARRAY: {
+			DECODE_SIZE(4);
+			r[1] = OPTIMIZER_ROLE_READ;
+			r[2] = OPTIMIZER_ROLE_READ;
+			r[3] = OPTIMIZER_ROLE_WRITE;
+		} break;
+		case GDScriptFunction::OPCODE_IS_BUILTIN:
+		case GDScriptFunction::OPCODE_GET_NAMED: {
+			DECODE_SIZE(4);
+			r[1] = OPTIMIZER_ROLE_READ;
+			r[3] = OPTIMIZER_ROLE_WRITE;
+		} break;
+		case GDScriptFunction::OPCODE_SET:
+		case GDScriptFunction::OPCODE_SET_ARRAY: {
+			DECODE_SIZE(4);
+			r[1] = OPTIMIZER_ROLE_READ_WRITE;
+			r[2] = OPTIMIZER_ROLE_READ;
+			r[3] = OPTIMIZER_ROLE_READ;
+		} break;
+		case GDScriptFunction::OPCODE_SET_NAMED: {
+			DECODE_SIZE(4);
+			r[1] = OPTIMIZER_ROLE_READ_WRITE;
+			r[3] = OPTIMIZER_ROLE_READ;
+		} break;
+		case GDScriptFunction::OPCODE_SET_MEMBER: {
+			DECODE_SIZE(3);
+			r[2] = OPTIMIZER_ROLE_READ;
+		} break;
+		case GDScriptFunction::OPCODE_GET_MEMBER: {
+			DECODE_SIZE(3);
+			r[2] = OPTIMIZER_ROLE_WRITE;
+		} break;
+		case GDScriptFunction::OPCODE_ASSIGN: {
+			DECODE_SIZE(3);
+			r[1] = OPTIMIZER_ROLE_WRITE;
+			r[2] = OPTIMIZER_ROLE_READ;
+		} break;
+		case GDScriptFunction::OPCODE_ASSIGN_TRUE:
+		case GDScriptFunction::OPCODE_ASSIGN_FALSE:
+		case GDScriptFunction::OPCODE_YIELD_RESUME: {
+			DECODE_SIZE(2);
+			r[1] = OPTIMIZER_ROLE_WRITE;
+		} break;
+		case GDScriptFunction::OPCODE_ASSIGN_TYPED_BUILTIN: {
+			DECODE_SIZE(4);
+			r[2] = OPTIMIZER_ROLE_WRITE;
+			r[3] = OPTIMIZER_ROLE_READ;
+		} break;
+		case GDScriptFunction::OPCODE_ASSIGN_TYPED_NATIVE:
+		case GDScriptFunction::OPCODE_ASSIGN_TYPED_SCRIPT: {
+			DECODE_SIZE(4);
+			r[1] = OPTIMIZER_ROLE_READ;
+			r[2] = OPTIMIZER_ROLE_WRITE;
+			r[3] = OPTIMIZER_ROLE_READ;
+		} break;
+		case GDScriptFunction::OPCODE_CAST_TO_BUILTIN: {
+			DECODE_SIZE(4);
+			r[2] = OPTIMIZER_ROLE_READ;
+			r[3] = OPTIMIZER_ROLE_WRITE;
+		} break;
+		case GDScriptFunction::OPCODE_CAST_TO_NATIVE:
+		case GDScriptFunction::OPCODE_CAST_TO_SCRIPT: {
+			DECODE_SIZE(4);
+			r[1] = OPTIMIZER_ROLE_READ;
+			r[2] = OPTIMIZER_ROLE_READ;
+			r[3] = OPTIMIZER_ROLE_WRITE;
+		} break;
+		case GDScriptFunction::OPCODE_CONSTRUCT:
+		case GDScriptFunction::OPCODE_CALL_BUILT_IN:
+		case GDScriptFunction::OPCODE_CALL_SELF_BASE: {
+			DECODE_ARGC(2);
+			DECODE_SIZE(4 + argc);
+			for (int i = 0; i < argc; i++)
+				r[3 + i] = OPTIMIZER_ROLE_READ;
+			r[3 + argc] = OPTIMIZER_ROLE_WRITE;
+		} break;
+		case GDScriptFunction::OPCODE_CONSTRUCT_ARRAY: {
+			DECODE_ARGC(1);
+			DECODE_SIZE(3 + argc);
+			for (int i = 0; i < argc; i++)
+				r[2 + i] = OPTIMIZER_ROLE_READ;
+			r[2 + argc] = OPTIMIZER_ROLE_WRITE;
+		} break;
+		case GDScriptFunction::OPCODE_CONSTRUCT_DICTIONARY: {
+			DECODE_ARGC(1);
+			DECODE_SIZE(3 + argc * 2);
+			for (int i = 0; i < argc * 2; i++)
+				r[2 + i] = OPTIMIZER_ROLE_READ;
+			r[2 + argc * 2] = OPTIMIZER_ROLE_WRITE;
+		} break;
+		case GDScriptFunction::OPCODE_CALL:
+		case GDScriptFunction::OPCODE_CALL_RETURN: {
+			DECODE_ARGC(1);
+			DECODE_SIZE(5 + argc);
+			r[2] = OPTIMIZER_ROLE_READ_WRITE; // methods of builtin types can modify the base
+			for (int i = 0; i < argc; i++)
+				r[4 + i] = OPTIMIZER_ROLE_READ;
+			if (ip[0] == GDScriptFunction::OPCODE_CALL_RETURN)
+				r[4 + argc] = OPTIMIZER_ROLE_WRITE;
+		} break;
+		case GDScriptFunction::OPCODE_CALL_PTRCALL:
+		case GDScriptFunction::OPCODE_INLINE_CACHE:
+		case GDScriptFunction::OPCODE_LINE: {
+			DECODE_SIZE(2);
+		} break;
+		case GDScriptFunction::OPCODE_YIELD:
+		case GDScriptFunction::OPCODE_JUMP_TO_DEF_ARGUMENT:
+		case GDScriptFunction::OPCODE_BREAKPOINT:
+		case GDScriptFunction::OPCODE_END: {
+			DECODE_SIZE(1);
+		} break;
+		case GDScriptFunction::OPCODE_YIELD_SIGNAL: {
+			DECODE_SIZE(3);
+			r[1] = OPTIMIZER_ROLE_READ;
+			r[2] = OPTIMIZER_ROLE_READ;
+		} break;
+		case GDScriptFunction::OPCODE_JUMP: {
+			DECODE_SIZE(2);
+			r[1] = OPTIMIZER_ROLE_JUMP;
+		} break;
+		case GDScriptFunction::OPCODE_JUMP_IF:
+		case GDScriptFunction::OPCODE_JUMP_IF_NOT: {
+			DECODE_SIZE(3);
+			r[1] = OPTIMIZER_ROLE_READ;
+			r[2] = OPTIMIZER_ROLE_JUMP;
+		} break;
+		case GDScriptFunction::OPCODE_RETURN:
+		case GDScriptFunction::OPCODE_ASSERT: {
+			DECODE_SIZE(2);
+			r[1] = OPTIMIZER_ROLE_READ;
+		} break;
+		case GDScriptFunction::OPCODE_ITERATE_BEGIN:
+		case GDScriptFunction::OPCODE_ITERATE:
+		case GDScriptFunction::OPCODE_ITERATE_BEGIN_RANGE:
+		case GDScriptFunction::OPCODE_ITERATE_RANGE: {
+			DECODE_SIZE(5);
+			r[1] = OPTIMIZER_ROLE_READ_WRITE;
+			r[2] = OPTIMIZER_ROLE_READ;
+			r[3] = OPTIMIZER_ROLE_JUMP;
+			r[4] = OPTIMIZER_ROLE_READ_WRITE; // the iterator is not written when the loop ends
+		} break;
+		default: {
+			return -1;
+		}
+	}
+
+#undef DECODE_ARGC
+#undef DECODE_SIZE
+
+	return size;
+}
+
+bool GDScriptOptimizerCode::setup(const Vector<int> &p_code) {
+
+	code = p_code;
+	roles.resize(code.size());
+	index_at.resize(code.size());
+	for (int i = 0; i < index_at.size(); i++) {
+		index_at.write[i] = -1;
+	}
+
+	int pos = 0;
+	while (pos < code.size()) {
+
+		int size = decode(pos);
+		if (size < 0)
+			return false;
+
+		Instruction ins;
+		ins.pos = pos;
+		ins.size = size;
+		ins.removed = false;
+		index_at.write[pos] = instructions.size();
+		instructions.push_back(ins);
+		pos += size;
+	}
+
+	if (instructions.empty() || get_opcode(instructions.size() - 1) != GDScriptFunction::OPCODE_END)
+		return false;
+
+	for (int i = 0; i < entries.size(); i++) {
+		if (entries[i] < 0 || entries[i] >= code.size() || index_at[entries[i]] < 0)
+			return false;
+	}
+
+	for (int i = 0; i < instructions.size(); i++) {
+		const Instruction &ins = instructions[i];
+		for (int j = 1; j < ins.size; j++) {
+			if (roles[ins.pos + j] != OPTIMIZER_ROLE_JUMP)
+				continue;
+			int to = code[ins.pos + j];
+			if (to < 0 || to >= code.size() || index_at[to] < 0)
+				return false;
+		}
+	}
+
+	targets.resize(instructions.size());
+	return true;
+}
+
+void GDScriptOptimizerCode::rewrite(int p_index) {
+
+	instructions.write[p_index].size = decode(instructions[p_index].pos);
+}
+
+void GDScriptOptimizerCode::get_successors(int p_index, Vector<int> &r_successors) const {
+
+	r_successors.clear();
+
+	const Instruction &ins = instructions[p_index];
+	int opcode = code[ins.pos];
+
+	for (int j = 1; j < ins.size; j++) {
+		if (roles[ins.pos + j] == OPTIMIZER_ROLE_JUMP)
+			r_successors.push_back(get_target(code[ins.pos + j]));
+	}
+
+	if (opcode == GDScriptFunction::OPCODE_JUMP_TO_DEF_ARGUMENT) {
+		for (int i = 1; i < entries.size(); i++) {
+			r_successors.push_back(get_target(entries[i]));
+		}
+	}
+
+	if (opcode != GDScriptFunction::OPCODE_JUMP && opcode != GDScriptFunction::OPCODE_RETURN && opcode != GDScriptFunction::OPCODE_END) {
+		int next = get_next(p_index);
+		if (next < instructions.size())
+			r_successors.push_back(next);
+	}
+}
+
+void GDScriptOptimizerCode::update_targets() {
+
+	for (int i = 0; i < targets.size(); i++) {
+		targets.write[i] = false;
+	}
+
+	for (int i = 0; i < entries.size(); i++) {
+		targets.write[get_target(entries[i])] = true;
+	}
+
+	for (int i = 0; i < instructions.size(); i++) {
+		const Instruction &ins = instructions[i];
+		if (ins.removed)
+			continue;
+		for (int j = 1; j < ins.size; j++) {
+			if (roles[ins.pos + j] == OPTIMIZER_ROLE_JUMP)
+				targets.write[get_target(code[ins.pos + j])] = true;
+		}
+	}
+}
+
+bool GDScriptOptimizerCode::simplify_jumps() {
+
+	bool changed = false;
+
+	for (int i = 0; i < instructions.size(); i++) {
+
+		if (instructions[i].removed)
+			continue;
+
+		int pos = instructions[i].pos;
+
+		// jump straight to the end of a chain of jumps
+		for (int j = 1; j < instructions[i].size; j++) {
+
+			if (roles[pos + j] != OPTIMIZER_ROLE_JUMP)
+				continue;
+
+			int to = get_target(code[pos + j]);
+			for (int hops = 0; hops < instructions.size() && get_opcode(to) == GDScriptFunction::OPCODE_JUMP; hops++) {
+				int next = get_target(code[instructions[to].pos + 1]);
+				if (next == to)
+					break;
+				to = next;
+			}
+
+			if (code[pos + j] != instructions[to].pos) {
+				code.write[pos + j] = instructions[to].pos;
+				changed = true;
+			}
+		}
+
+		int opcode = code[pos];
+
+		if ((opcode == GDScriptFunction::OPCODE_JUMP_IF || opcode == GDScriptFunction::OPCODE_JUMP_IF_NOT) && _get_address_type(code[pos + 1]) == GDScriptFunction::ADDR_TYPE_LOCAL_CONSTANT) {
+
+			int index = _get_address_index(code[pos + 1]);
+			if (index < constants.size()) {
+
+				if (constants[index].booleanize() == (opcode == GDScriptFunction::OPCODE_JUMP_IF)) {
+					code.write[pos] = GDScriptFunction::OPCODE_JUMP;
+					code.write[pos + 1] = code[pos + 2];
+					rewrite(i);
+				} else {
+					instructions.write[i].removed = true;
+				}
+				changed = true;
+				continue;
+			}
+		}
+
+		if (opcode == GDScriptFunction::OPCODE_JUMP || opcode == GDScriptFunction::OPCODE_JUMP_IF || opcode == GDScriptFunction::OPCODE_JUMP_IF_NOT) {
+
+			if (get_target(code[pos + instructions[i].size - 1]) == get_next(i)) {
+				instructions.write[i].removed = true;
+				changed = true;
+			}
+		}
+	}
+
+	return changed;
+}
+
+bool GDScriptOptimizerCode::remove_unreachable() {
+
+	Vector<bool> reachable;
+	reachable.resize(instructions.size());
+	for (int i = 0; i < reachable.size(); i++) {
+		reachable.write[i] = false;
+	}
+
+	Vector<int> pending;
+	for (int i = 0; i < entries.size(); i++) {
+		pending.push_back(get_target(entries[i]));
+	}
+
+	Vector<int> successors;
+	while (pending.size()) {
+
+		int index = pending[pending.size() - 1];
+		pending.resize(pending.size() - 1);
+
+		if (reachable[index])
+			continue;
+		reachable.write[index] = true;
+
+		get_successors(index, successors);
+		for (int i = 0; i < successors.size(); i++) {
+			if (!reachable[successors[i]])
+				pending.push_back(successors[i]);
+		}
+	}
+
+	bool changed = false;
+
+	// the final OPCODE_END stays, so the code never runs past its end
+	for (int i = 0; i < instructions.size() - 1; i++) {
+		if (!instructions[i].removed && !reachable[i]) {
+			instructions.write[i].removed = true;
+			changed = true;
+		}
+	}
+
+	return changed;
+}
+
+bool GDScriptOptimizerCode::eliminate_temporaries() {
+
+	int words = (stack_size + 31) / 32;
+	if (words == 0)
+		return false;
+
+	int count = instructions.size();
+
+	// stack slots are tracked by index, as the same slot can be addressed
+	// both as a temporary and as a variable (for loop iterators)
+	Vector<int> successor_ofs;
+	Vector<int> successor_list;
+	Vector<int> successors;
+	successor_ofs.resize(count + 1);
+	for (int i = 0; i < count; i++) {
+		successor_ofs.write[i] = successor_list.size();
+		if (instructions[i].removed)
+			continue;
+		get_successors(i, successors);
+		for (int j = 0; j < successors.size(); j++) {
+			successor_list.push_back(successors[j]);
+		}
+	}
+	successor_ofs.write[count] = successor_list.size();
+
+	Vector<uint32_t> live_in;
+	live_in.resize(count * words);
+	for (int i = 0; i < live_in.size(); i++) {
+		live_in.write[i] = 0;
+	}
+
+	Vector<uint32_t> live;
+	live.resize(words);
+
+	bool dirty = true;
+	while (dirty) {
+
+		dirty = false;
+
+		for (int i = count - 1; i >= 0; i--) {
+
+			const Instruction &ins = instructions[i];
+			if (ins.removed)
+				continue;
+
+			for (int k = 0; k < words; k++) {
+				live.write[k] = 0;
+			}
+			for (int j = successor_ofs[i]; j < successor_ofs[i + 1]; j++) {
+				const uint32_t *in = &live_in[successor_list[j] * words];
+				for (int k = 0; k < words; k++) {
+					live.write[k] |= in[k];
+				}
+			}
+
+			for (int j = 1; j < ins.size; j++) {
+				int address = code[ins.pos + j];
+				if (roles[ins.pos + j] == OPTIMIZER_ROLE_WRITE && _is_stack_address(address) && _get_address_index(address) < stack_size) {
+					int slot = _get_address_index(address);
+					live.write[slot >> 5] &= ~(1U << (slot & 31));
+				}
+			}
+			for (int j = 1; j < ins.size; j++) {
+				int address = code[ins.pos + j];
+				uint8_t role = roles[ins.pos + j];
+				if ((role == OPTIMIZER_ROLE_READ || role == OPTIMIZER_ROLE_READ_WRITE) && _is_stack_address(address) && _get_address_index(address) < stack_size) {
+					int slot = _get_address_index(address);
+					live.write[slot >> 5] |= 1U << (slot & 31);
+				}
+			}
+
+			uint32_t *in = &live_in.write[i * words];
+			for (int k = 0; k < words; k++) {
+				if (in[k] != live[k]) {
+					in[k] = live[k];
+					dirty = true;
+				}
+			}
+		}
+	}
+
+	bool changed = false;
+
+	for (int i = 0; i < count; i++) {
+
+		const Instruction &ins = instructions[i];
+		if (ins.removed)
+			continue;
+
+		int *w = &code.write[ins.pos];
+		int opcode = w[0];
+
+		if (opcode == GDScriptFunction::OPCODE_ASSIGN || opcode == GDScriptFunction::OPCODE_ASSIGN_TRUE || opcode == GDScriptFunction::OPCODE_ASSIGN_FALSE) {
+
+			bool self_assign = opcode == GDScriptFunction::OPCODE_ASSIGN && (w[1] == w[2] || (_is_stack_address(w[1]) && _is_stack_address(w[2]) && _get_address_index(w[1]) == _get_address_index(w[2])));
+			bool dead = _get_address_type(w[1]) == GDScriptFunction::ADDR_TYPE_STACK && _get_address_index(w[1]) < stack_size && !_is_live_after(live_in, successor_ofs, successor_list, words, i, _get_address_index(w[1]));
+
+			if (self_assign || dead) {
+				instructions.write[i].removed = true;
+				changed = true;
+			}
+			continue;
+		}
+
+		// a result computed into a temporary that is only moved somewhere
+		// else is computed there directly
+		switch (opcode) {
+			case GDScriptFunction::OPCODE_OPERATOR:
+			case GDScriptFunction::OPCODE_OPERATOR_INT:
+			case GDScriptFunction::OPCODE_OPERATOR_REAL:
+			case GDScriptFunction::OPCODE_OPERATOR_VECTOR2:
+			case GDScriptFunction::OPCODE_OPERATOR_VECTOR3:
+			case GDScriptFunction::OPCODE_GET:
+			case GDScriptFunction::OPCODE_GET_ARRAY:
+			case GDScriptFunction::OPCODE_GET_NAMED:
+			case GDScriptFunction::OPCODE_GET_MEMBER:
+			case GDScriptFunction::OPCODE_CONSTRUCT:
+			case GDScriptFunction::OPCODE_CONSTRUCT_ARRAY:
+			case GDScriptFunction::OPCODE_CONSTRUCT_DICTIONARY:
+			case GDScriptFunction::OPCODE_CALL_RETURN:
+			case GDScriptFunction::OPCODE_CALL_BUILT_IN: {
+			} break;
+			default: {
+				continue;
+			}
+		}
+
+		int temp = w[ins.size - 1];
+		if (_get_address_type(temp) != GDScriptFunction::ADDR_TYPE_STACK || _get_address_index(temp) >= stack_size)
+			continue;
+
+		int next = get_next(i);
+		if (next >= count || targets[next] || get_opcode(next) != GDScriptFunction::OPCODE_ASSIGN)
+			continue;
+
+		const int *assign = &code[instructions[next].pos];
+		int dst = assign[1];
+		if (!_is_stack_address(dst) || !_is_stack_address(assign[2]) || _get_address_index(assign[2]) != _get_address_index(temp) || _get_address_index(dst) == _get_address_index(temp))
+			continue;
+
+		if (_is_live_after(live_in, successor_ofs, successor_list, words, next, _get_address_index(temp)))
+			continue;
+
+		// operators read their operands before writing the result, other
+		// instructions may not
+		if (opcode > GDScriptFunction::OPCODE_OPERATOR_VECTOR3) {
+			bool reads_dst = false;
+			for (int j = 1; j < ins.size - 1; j++) {
+				uint8_t role = roles[ins.pos + j];
+				if ((role == OPTIMIZER_ROLE_READ || role == OPTIMIZER_ROLE_READ_WRITE) && _is_stack_address(w[j]) && _get_address_index(w[j]) == _get_address_index(dst)) {
+					reads_dst = true;
+				}
+			}
+			if (reads_dst)
+				continue;
+		}
+
+		w[ins.size - 1] = dst;
+		instructions.write[next].removed = true;
+		changed = true;
+	}
+
+	return changed;
+}
+
+bool GDScriptOptimizerCode::remove_lines(bool p_keep_breakpoints) {
+
+	bool changed = false;
+
+	for (int i = 0; i < instructions.size(); i++) {
+
+		if (instructions[i].removed || get_opcode(i) != GDScriptFunction::OPCODE_LINE)
+			continue;
+
+		int next = get_next(i);
+		if (next >= instructions.size())
+			continue;
+
+		// the line is only used by errors and the debugger, so it is dead if
+		// nothing that can fail runs before the next one
+		bool dead;
+		if (p_keep_breakpoints) {
+			dead = get_opcode(next) == GDScriptFunction::OPCODE_LINE && code[instructions[next].pos + 1] == code[instructions[i].pos + 1];
+		} else {
+			dead = get_opcode(next) == GDScriptFunction::OPCODE_LINE || get_opcode(next) == GDScriptFunction::OPCODE_END;
+		}
+
+		if (dead) {
+			instructions.write[i].removed = true;
+			changed = true;
+		}
+	}
+
+	return changed;
+}
+
+void GDScriptOptimizerCode::compact(Vector<int> &r_code, Vector<int> &r_entries) const {
+
+	// removed instructions take the position of the next one kept
+	Vector<int> new_pos;
+	new_pos.resize(instructions.size());
+	int size = 0;
+	for (int i = 0; i < instructions.size(); i++) {
+		new_pos.write[i] = size;
+		if (!instructions[i].removed)
+			size += instructions[i].size;
+	}
+
+	r_code.resize(size);
+	int *w = r_code.ptrw();
+
+	for (int i = 0; i < instructions.size(); i++) {
+
+		const Instruction &ins = instructions[i];
+		if (ins.removed)
+			continue;
+
+		for (int j = 0; j < ins.size; j++) {
+			int word = code[ins.pos + j];
+			if (j > 0 && roles[ins.pos + j] == OPTIMIZER_ROLE_JUMP)
+				word = new_pos[index_at[word]];
+			w[new_pos[i] + j] = word;
+		}
+	}
+
+	r_entries.resize(entries.size());
+	for (int i = 0; i < entries.size(); i++) {
+		r_entries.write[i] = new_pos[index_at[entries[i]]];
+	}
+}
+
+bool GDScriptCompiler::_get_optimizer_constant(CodeGen &codegen, GDScriptOptimizerCode &p_code, int p_address, Variant &r_value) {
+
+	int index = _get_address_index(p_address);
+
+	switch (_get_address_type(p_address)) {
+		case GDScriptFunction::ADDR_TYPE_LOCAL_CONSTANT: {
+
+			if (index >= p_code.constants.size())
+				return false;
+			r_value = p_code.constants[index];
+		} break;
+		case GDScriptFunction::ADDR_TYPE_CLASS_CONSTANT: {
+
+			if (index >= p_code.names.size())
+				return false;
+
+			// same lookup as GDScriptFunction::_get_variant(), but constants
+			// from other files can change without this one being recompiled
+			GDScript *top = codegen.script;
+			while (top->_owner)
+				top = top->_owner;
+
+			for (GDScript *o = codegen.script; o; o = o->_owner) {
+				for (GDScript *s = o; s; s = s->_base) {
+
+					Map<StringName, Variant>::Element *E = s->constants.find(p_code.names[index]);
+					if (!E)
+						continue;
+
+					GDScript *s_top = s;
+					while (s_top->_owner)
+						s_top = s_top->_owner;
+					if (s_top != top)
+						return false;
+
+					r_value = E->get();
+					return _is_foldable_constant(r_value);
+				}
+			}
+			return false;
+		} break;
+		default: {
+			return false;
+		}
+	}
+
+	return _is_foldable_constant(r_value);
+}
+
+int GDScriptCompiler::_add_optimizer_constant(CodeGen &codegen, GDScriptOptimizerCode &p_code, const Variant &p_value) {
+
+	int index = codegen.get_constant_pos(p_value);
+	if (index == p_code.constants.size())
+		p_code.constants.push_back(p_value);
+	return index | (GDScriptFunction::ADDR_TYPE_LOCAL_CONSTANT << GDScriptFunction::ADDR_BITS);
+}
+
+bool GDScriptCompiler::_fold_constants(CodeGen &codegen, GDScriptOptimizerCode &p_code) {
+
+	bool changed = false;
+
+	// constant held by each temporary in the current block, as an address
+	Vector<int> known;
+	known.resize(p_code.stack_size);
+
+	Vector<Variant> args;
+	Vector<const Variant *> argptrs;
+
+	for (int i = 0; i < p_code.instructions.size(); i++) {
+
+		if (p_code.instructions[i].removed)
+			continue;
+
+		if (i == 0 || p_code.targets[i]) {
+			for (int j = 0; j < known.size(); j++) {
+				known.write[j] = -1;
+			}
+		}
+
+		int pos = p_code.instructions[i].pos;
+		int size = p_code.instructions[i].size;
+		int *w = &p_code.code.write[pos];
+
+		for (int j = 1; j < size; j++) {
+
+			if (p_code.roles[pos + j] != OPTIMIZER_ROLE_READ)
+				continue;
+
+			int address = -1;
+			Variant value;
+			if (_get_address_type(w[j]) == GDScriptFunction::ADDR_TYPE_STACK && _get_address_index(w[j]) < known.size()) {
+				address = known[_get_address_index(w[j])];
+			} else if (_get_address_type(w[j]) == GDScriptFunction::ADDR_TYPE_CLASS_CONSTANT && _get_optimizer_constant(codegen, p_code, w[j], value)) {
+				address = _add_optimizer_constant(codegen, p_code, value);
+			}
+
+			if (address != -1 && address != w[j]) {
+				w[j] = address;
+				changed = true;
+			}
+		}
+
+		Variant result;
+		bool folded = false;
+
+		switch (w[0]) {
+			case GDScriptFunction::OPCODE_OPERATOR:
+			case GDScriptFunction::OPCODE_OPERATOR_INT:
+			case GDScriptFunction::OPCODE_OPERATOR_REAL:
+			case GDScriptFunction::OPCODE_OPERATOR_VECTOR2:
+			case GDScriptFunction::OPCODE_OPERATOR_VECTOR3: {
+
+				Variant a, b;
+				if (_get_optimizer_constant(codegen, p_code, w[2], a) && _get_optimizer_constant(codegen, p_code, w[3], b)) {
+					Variant::evaluate((Variant::Operator)w[1], a, b, result, folded);
+				}
+			} break;
+			case GDScriptFunction::OPCODE_CONSTRUCT:
+			case GDScriptFunction::OPCODE_CALL_BUILT_IN: {
+
+				if (w[0] == GDScriptFunction::OPCODE_CALL_BUILT_IN && !GDScriptFunctions::is_deterministic((GDScriptFunctions::Function)w[1]))
+					break;
+
+				int argc = w[2];
+				args.resize(argc);
+				argptrs.resize(argc);
+
+				bool constant = true;
+				for (int j = 0; j < argc && constant; j++) {
+					constant = _get_optimizer_constant(codegen, p_code, w[3 + j], args.write[j]);
+					argptrs.write[j] = &args[j];
+				}
+				if (!constant)
+					break;
+
+				Variant::CallError ce;
+				const Variant **argp = argc ? argptrs.ptrw() : NULL;
+				if (w[0] == GDScriptFunction::OPCODE_CONSTRUCT) {
+					result = Variant::construct((Variant::Type)w[1], argp, argc, ce);
+				} else {
+					GDScriptFunctions::call((GDScriptFunctions::Function)w[1], argp, argc, result, ce);
+				}
+				folded = ce.error == Variant::CallError::CALL_OK;
+			} break;
+		}
+
+		if (folded && _is_foldable_constant(result)) {
+
+			int dst = w[size - 1];
+			w[0] = GDScriptFunction::OPCODE_ASSIGN;
+			w[1] = dst;
+			w[2] = _add_optimizer_constant(codegen, p_code, result);
+			p_code.rewrite(i);
+			size = p_code.instructions[i].size;
+			changed = true;
+		}
+
+		for (int j = 1; j < size; j++) {
+
+			uint8_t role = p_code.roles[pos + j];
+			if ((role == OPTIMIZER_ROLE_WRITE || role == OPTIMIZER_ROLE_READ_WRITE) && _is_stack_address(w[j]) && _get_address_index(w[j]) < known.size()) {
+				known.write[_get_address_index(w[j])] = -1;
+			}
+		}
+
+		if (w[0] == GDScriptFunction::OPCODE_ASSIGN && _get_address_type(w[1]) == GDScriptFunction::ADDR_TYPE_STACK && _get_address_index(w[1]) < known.size()) {
+
+			Variant value;
+			if (_get_address_type(w[2]) == GDScriptFunction::ADDR_TYPE_LOCAL_CONSTANT && _get_optimizer_constant(codegen, p_code, w[2], value)) {
+				known.write[_get_address_index(w[1])] = w[2];
+			}
+		}
+	}
+
+	return changed;
+}
+
+void GDScriptCompiler::_optimize_function(CodeGen &codegen, Vector<int> &r_defarg_addr) {
+
+	GDScriptOptimizerCode code;
+	code.stack_size = codegen.stack_max;
+	code.entries.push_back(0);
+	for (int i = 0; i < r_defarg_addr.size(); i++) {
+		code.entries.push_back(r_defarg_addr[i]);
+	}
+
+	if (!code.setup(codegen.opcodes))
+		return; // unknown instructions, leave the code alone
+
+	code.constants.resize(codegen.constant_map.size());
+	const Variant *K = NULL;
+	while ((K = codegen.constant_map.next(K))) {
+		code.constants.write[codegen.constant_map[*K]] = *K;
+	}
+
+	code.names.resize(codegen.name_map.size());
+	for (Map<StringName, int>::Element *E = codegen.name_map.front(); E; E = E->next()) {
+		code.names.write[E->get()] = E->key();
+	}
+
+	// every line stays when debugging, for breakpoints and stepping
+	bool keep_breakpoints = ScriptDebugger::get_singleton() != NULL;
+
+	for (int pass = 0; pass < 8; pass++) {
+
+		code.update_targets();
+		bool changed = _fold_constants(codegen, code);
+		changed = code.simplify_jumps() || changed;
+		changed = code.remove_unreachable() || changed;
+		code.update_targets();
+		changed = code.eliminate_temporaries() || changed;
+		changed = code.remove_lines(keep_breakpoints) || changed;
+
+		if (!changed)
+			break;
+	}
+
+	Vector<int> entries;
+	code.compact(codegen.opcodes, entries);
+	for (int i = 0; i < r_defarg_addr.size(); i++) {
+		r_defarg_addr.write[i] = entries[i + 1];
+	}
+}
+
+// Finds the arguments a function can borrow from its caller instead of copying them:
+// those it never writes, and for shared types those only modified in place.
+static void _find_borrowable_arguments(const Vector<int> &p_code, int p_argcount, uint32_t &r_borrow, uint32_t &r_borrow_shared) {
+
+	r_borrow = 0;
+	r_borrow_shared = 0;
+
+	GDScriptOptimizerCode code;
+	if (!code.setup(p_code))
+		return;
+
+	uint32_t args = p_argcount >= 32 ? 0xFFFFFFFF : (1U << p_argcount) - 1;
+	uint32_t written = 0;
+	uint32_t modified = 0;
+
+	for (int i = 0; i < code.instructions.size(); i++) {
+
+		const GDScriptOptimizerCode::Instruction &ins = code.instructions[i];
+		int opcode = code.code[ins.pos];
+		if (opcode == GDScriptFunction::OPCODE_YIELD || opcode == GDScriptFunction::OPCODE_YIELD_SIGNAL || opcode == GDScriptFunction::OPCODE_YIELD_RESUME)
+			return; // the stack outlives the call
+
+		for (int j = 1; j < ins.size; j++) {
+
+			uint8_t role = code.roles[ins.pos + j];
+			int address = code.code[ins.pos + j];
+			if ((role != OPTIMIZER_ROLE_WRITE && role != OPTIMIZER_ROLE_READ_WRITE) || !_is_stack_address(address) || _get_address_index(address) >= 32)
+				continue;
+
+			uint32_t bit = 1U << _get_address_index(address);
+			bool in_place = role == OPTIMIZER_ROLE_READ_WRITE && (((opcode == GDScriptFunction::OPCODE_SET || opcode == GDScriptFunction::OPCODE_SET_ARRAY || opcode == GDScriptFunction::OPCODE_SET_NAMED) && j == 1) || ((opcode == GDScriptFunction::OPCODE_CALL || opcode == GDScriptFunction::OPCODE_CALL_RETURN) && j == 2));
+			if (in_place) {
+				modified |= bit;
+			} else {
+				written |= bit;
+			}
+		}
+	}
+
+	r_borrow = args & ~(written | modified);
+	r_borrow_shared = args & modified & ~written;
+}
+
 Error GDScriptCompiler::_parse_function(GDScript *p_script, const GDScriptParser::ClassNode *p_class, const GDScriptParser::FunctionNode *p_func, bool p_for_ready) {
 
 	Vector<int> bytecode;
@@ -1614,6 +2785,7 @@ Error GDScriptCompiler::_parse_function(GDScript *p_script, const GDScriptParser
 	codegen.stack_max = 0;
 	codegen.current_line = 0;
 	codegen.call_max = 0;
+	codegen.inline_cache_count = 0;
 	codegen.debug_stack = ScriptDebugger::get_singleton() != NULL;
 	Vector<StringName> argnames;
 
@@ -1701,6 +2873,10 @@ Error GDScriptCompiler::_parse_function(GDScript *p_script, const GDScriptParser
 
 	codegen.opcodes.push_back(GDScriptFunction::OPCODE_END);
 
+	if (optimize) {
+		_optimize_function(codegen, defarg_addr);
+	}
+
 	/*
 	if (String(p_func->name)=="") { //initializer func
 		gdfunc = &p_script->initializer;
@@ -1785,6 +2961,20 @@ Error GDScriptCompiler::_parse_function(GDScript *p_script, const GDScriptParser
 		gdfunc->_code_size = 0;
 	}
 
+#ifdef PTRCALL_ENABLED
+	gdfunc->ptrcalls = codegen.ptrcalls;
+	gdfunc->_ptrcalls_ptr = gdfunc->ptrcalls.ptrw();
+	gdfunc->_ptrcalls_count = gdfunc->ptrcalls.size();
+#endif
+
+	for (Set<StringName>::Element *E = codegen.used_globals.front(); E; E = E->next()) {
+		gdfunc->used_globals.push_back(E->get());
+	}
+
+	gdfunc->inline_caches.resize(codegen.inline_cache_count);
+	gdfunc->_inline_caches_ptr = gdfunc->inline_caches.ptrw();
+	gdfunc->_inline_caches_count = gdfunc->inline_caches.size();
+
 	if (defarg_addr.size()) {
 
 		gdfunc->default_arguments = defarg_addr;
@@ -1798,6 +2988,7 @@ Error GDScriptCompiler::_parse_function(GDScript *p_script, const GDScriptParser
 	gdfunc->_argument_count = p_func ? p_func->arguments.size() : 0;
 	gdfunc->_stack_size = codegen.stack_max;
 	gdfunc->_call_size = codegen.call_max;
+	_find_borrowable_arguments(codegen.opcodes, gdfunc->_argument_count, gdfunc->_borrow_args, gdfunc->_borrow_shared_args);
 	gdfunc->name = func_name;
 #ifdef DEBUG_ENABLED
 	if (ScriptDebugger::get_singleton()) {
@@ -1872,6 +3063,9 @@ Error GDScriptCompiler::_parse_class_level(GDScript *p_script, GDScript *p_owner
 		}
 	}
 
+	// members and functions are about to change
+	GDScriptLanguage::get_singleton()->invalidate_inline_caches();
+
 	p_script->native = Ref<GDScriptNativeClass>();
 	p_script->base = Ref<GDScript>();
 	p_script->_base = NULL;
@@ -2226,5 +3420,17 @@ int GDScriptCompiler::get_error_column() const {
 	return err_column;
 }
 
+void GDScriptCompiler::set_optimize(bool p_enable) {
+
+	optimize = p_enable;
+}
+
+bool GDScriptCompiler::is_optimizing() const {
+
+	return optimize;
+}
+
 GDScriptCompiler::GDScriptCompiler() {
+
+	optimize = true;
 }
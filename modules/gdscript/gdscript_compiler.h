@@ -35,6 +35,8 @@
 #include "gdscript.h"
 #include "gdscript_parser.h"
 
+struct GDScriptOptimizerCode;
+
 class GDScriptCompiler {
 
 	const GDScriptParser *parser;
@@ -102,6 +104,10 @@ class GDScriptCompiler {
 #ifdef TOOLS_ENABLED
 		Vector<StringName> named_globals;
 #endif
+#ifdef PTRCALL_ENABLED
+		Vector<GDScriptFunction::PtrCall> ptrcalls;
+#endif
+		int inline_cache_count;
 
 		int get_name_map_pos(const StringName &p_identifier) {
 			int ret;
@@ -114,6 +120,13 @@ class GDScriptCompiler {
 			return ret;
 		}
 
+		Set<StringName> used_globals;
+
+		int get_global_pos(const StringName &p_identifier) {
+			used_globals.insert(p_identifier);
+			return GDScriptLanguage::get_singleton()->get_global_map()[p_identifier];
+		}
+
 		int get_constant_pos(const Variant &p_constant) {
 			if (constant_map.has(p_constant))
 				return constant_map[p_constant];
@@ -143,6 +156,12 @@ class GDScriptCompiler {
 	bool _create_unary_operator(CodeGen &codegen, const GDScriptParser::OperatorNode *on, Variant::Operator op, int p_stack_level);
 	bool _create_binary_operator(CodeGen &codegen, const GDScriptParser::OperatorNode *on, Variant::Operator op, int p_stack_level, bool p_initializer = false);
 
+	GDScriptFunction::Opcode _get_operator_opcode(Variant::Operator op, const GDScriptParser::DataType &p_a, const GDScriptParser::DataType &p_b) const;
+	bool _is_array_index(const GDScriptParser::Node *p_base, const GDScriptParser::Node *p_index) const;
+	bool _is_range_iterate(const GDScriptParser::Node *p_container) const;
+	int _get_ptrcall_pos(CodeGen &codegen, const GDScriptParser::OperatorNode *p_call);
+	int _get_inline_cache_pos(CodeGen &codegen, const GDScriptParser::Node *p_base);
+
 	GDScriptDataType _gdtype_from_datatype(const GDScriptParser::DataType &p_datatype) const;
 
 	int _parse_assign_right_expression(CodeGen &codegen, const GDScriptParser::OperatorNode *p_expression, int p_stack_level);
@@ -152,6 +171,13 @@ class GDScriptCompiler {
 	Error _parse_class_level(GDScript *p_script, GDScript *p_owner, const GDScriptParser::ClassNode *p_class, bool p_keep_state);
 	Error _parse_class_blocks(GDScript *p_script, const GDScriptParser::ClassNode *p_class, bool p_keep_state);
 	void _make_scripts(const GDScript *p_script, const GDScriptParser::ClassNode *p_class, bool p_keep_state);
+
+	bool _get_optimizer_constant(CodeGen &codegen, GDScriptOptimizerCode &p_code, int p_address, Variant &r_value);
+	int _add_optimizer_constant(CodeGen &codegen, GDScriptOptimizerCode &p_code, const Variant &p_value);
+	bool _fold_constants(CodeGen &codegen, GDScriptOptimizerCode &p_code);
+	void _optimize_function(CodeGen &codegen, Vector<int> &r_defarg_addr);
+
+	bool optimize;
 	int err_line;
 	int err_column;
 	StringName source;
@@ -164,6 +190,9 @@ public:
 	int get_error_line() const;
 	int get_error_column() const;
 
+	void set_optimize(bool p_enable);
+	bool is_optimizing() const;
+
 	GDScriptCompiler();
 };
 
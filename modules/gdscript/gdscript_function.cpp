@@ -30,6 +30,7 @@
 
 #include "gdscript_function.h"
 
+#include "core/core_string_names.h"
 #include "core/os/os.h"
 #include "gdscript.h"
 #include "gdscript_functions.h"
@@ -183,14 +184,244 @@ static String _get_var_type(const Variant *p_type) {
 }
 #endif
 
+// Same bounds Variant::iter_init() uses for int, Vector2 and Vector3 containers.
+static _FORCE_INLINE_ bool _get_iterate_range(const Variant *p_container, int64_t &r_from, int64_t &r_to, int64_t &r_step) {
+
+	switch (p_container->get_type()) {
+		case Variant::INT: {
+			r_from = 0;
+			r_to = *VariantInternal::get_int(p_container);
+			r_step = 1;
+		} break;
+		case Variant::VECTOR2: {
+			const Vector2 *v = VariantInternal::get_vector2(p_container);
+			r_from = v->x;
+			r_to = v->y;
+			r_step = 1;
+		} break;
+		case Variant::VECTOR3: {
+			const Vector3 *v = VariantInternal::get_vector3(p_container);
+			r_from = v->x;
+			r_to = v->y;
+			r_step = v->z;
+		} break;
+		default: {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+// Same lookup GDScriptInstance::call() does.
+static GDScriptFunction *_find_script_function(const GDScript *p_script, const StringName &p_name) {
+
+	while (p_script) {
+		const Map<StringName, GDScriptFunction *>::Element *E = p_script->get_member_functions().find(p_name);
+		if (E) {
+			return E->get();
+		}
+		p_script = p_script->get_base().ptr();
+	}
+
+	return NULL;
+}
+
+// Resolves a cache miss the way Object::get()/set()/call() would for this
+// receiver, and stores the result. Returns NULL when the access can't be
+// cached, the regular opcode then handles it.
+const GDScriptFunction::InlineCache::Entry *GDScriptFunction::_fill_inline_cache(InlineCache *p_cache, int p_opcode, const StringName &p_name, Object *p_object, GDScriptInstance *p_instance, uint32_t p_version) {
+
+	// entries of older versions can be replaced while the retired list has room,
+	// skip the lookup if nothing can be stored
+	bool can_replace = p_cache->retired_count < InlineCache::MAX_RETIRED;
+	bool has_room = false;
+	for (int i = 0; i < InlineCache::MAX_ENTRIES && !has_room; i++) {
+		const InlineCache::Entry *e = p_cache->entries[i];
+		has_room = !e || (e->version != p_version && can_replace);
+	}
+	if (!has_room) {
+		return NULL;
+	}
+
+	InlineCache::Entry entry;
+	entry.script = p_instance ? p_instance->script.ptr() : NULL;
+	entry.class_name = &p_object->get_class_name();
+	entry.version = p_version;
+	entry.member_index = -1;
+	entry.function = NULL;
+	entry.method = NULL;
+	entry.constant = NULL;
+	entry.next_retired = NULL;
+
+	const GDScript *script = entry.script;
+	const GDScriptLanguage *language = GDScriptLanguage::get_singleton();
+
+	switch (p_opcode) {
+		case OPCODE_GET_NAMED: {
+
+			if (script) {
+				const Map<StringName, GDScript::MemberInfo>::Element *E = script->member_indices.find(p_name);
+				if (E) {
+					entry.kind = InlineCache::MEMBER;
+					entry.member_index = E->get().index;
+					if (E->get().getter != StringName()) {
+						// the member itself is returned if the getter can't be called
+						entry.function = _find_script_function(script, E->get().getter);
+						if (entry.function) {
+							entry.kind = InlineCache::MEMBER_GETTER;
+						}
+					}
+					break;
+				}
+
+				for (const GDScript *sl = script; sl && !entry.constant; sl = sl->_base) {
+					const Map<StringName, Variant>::Element *C = sl->constants.find(p_name);
+					if (C) {
+						entry.kind = InlineCache::CONSTANT;
+						entry.constant = &C->get();
+					}
+				}
+				if (entry.constant) {
+					break;
+				}
+
+				if (_find_script_function(script, language->strings._get)) {
+					return NULL;
+				}
+			}
+
+			entry.kind = InlineCache::NATIVE_GETTER;
+			entry.method = ClassDB::get_property_getter_method(*entry.class_name, p_name);
+			if (!entry.method) {
+				return NULL;
+			}
+		} break;
+		case OPCODE_SET_NAMED: {
+
+			if (script) {
+				const Map<StringName, GDScript::MemberInfo>::Element *E = script->member_indices.find(p_name);
+				if (E) {
+					entry.member_index = E->get().index;
+					entry.member_type = E->get().data_type;
+					if (E->get().setter != StringName()) {
+						entry.kind = InlineCache::MEMBER_SETTER;
+						entry.function = _find_script_function(script, E->get().setter);
+						if (!entry.function) {
+							return NULL;
+						}
+					} else {
+						entry.kind = InlineCache::MEMBER;
+					}
+					break;
+				}
+
+				if (_find_script_function(script, language->strings._set)) {
+					return NULL;
+				}
+			}
+
+			entry.kind = InlineCache::NATIVE_SETTER;
+			entry.method = ClassDB::get_property_setter_method(*entry.class_name, p_name);
+			if (!entry.method) {
+				return NULL;
+			}
+		} break;
+		case OPCODE_CALL:
+		case OPCODE_CALL_RETURN: {
+
+			// both have special cases in Object::call() or in the error reporting
+			if (p_name == CoreStringNames::get_singleton()->_free || p_name == "call") {
+				return NULL;
+			}
+
+			if (script) {
+				entry.kind = InlineCache::SCRIPT_FUNCTION;
+				entry.function = _find_script_function(script, p_name);
+				if (entry.function) {
+					break;
+				}
+			}
+
+			// scripts override call() to reach their static functions
+			if (Object::cast_to<Script>(p_object)) {
+				return NULL;
+			}
+
+			entry.kind = InlineCache::NATIVE_METHOD;
+			entry.method = ClassDB::get_method(*entry.class_name, p_name);
+			if (!entry.method) {
+				return NULL;
+			}
+		} break;
+		default: {
+			return NULL;
+		}
+	}
+
+	Mutex *lock = language->inline_cache_lock;
+	if (lock) {
+		lock->lock();
+	}
+
+	// take a free slot, or the first one holding an older version
+	int slot = -1;
+	for (int i = 0; i < InlineCache::MAX_ENTRIES; i++) {
+		InlineCache::Entry *e = p_cache->entries[i];
+		if (!e) {
+			slot = i;
+			break;
+		}
+		if (e->version != p_version) {
+			if (slot < 0 && p_cache->retired_count < InlineCache::MAX_RETIRED) {
+				slot = i;
+			}
+		} else if (e->script == entry.script && e->class_name == entry.class_name) {
+			// another thread got here first
+			if (lock) {
+				lock->unlock();
+			}
+			return e;
+		}
+	}
+
+	InlineCache::Entry *published = NULL;
+	if (slot >= 0) {
+		published = memnew(InlineCache::Entry(entry));
+
+		InlineCache::Entry *replaced = p_cache->entries[slot];
+		if (replaced) {
+			replaced->next_retired = p_cache->retired;
+			p_cache->retired = replaced;
+			p_cache->retired_count++;
+		}
+
+		// the atomic also orders the writes above before the entry is published
+		atomic_increment(&p_cache->fills);
+		p_cache->entries[slot] = published;
+	}
+
+	if (lock) {
+		lock->unlock();
+	}
+
+	return published;
+}
+
 #if defined(__GNUC__)
 #define OPCODES_TABLE                         \
 	static const void *switch_table_ops[] = { \
 		&&OPCODE_OPERATOR,                    \
+		&&OPCODE_OPERATOR_INT,                \
+		&&OPCODE_OPERATOR_REAL,               \
+		&&OPCODE_OPERATOR_VECTOR2,            \
+		&&OPCODE_OPERATOR_VECTOR3,            \
 		&&OPCODE_EXTENDS_TEST,                \
 		&&OPCODE_IS_BUILTIN,                  \
 		&&OPCODE_SET,                         \
 		&&OPCODE_GET,                         \
+		&&OPCODE_SET_ARRAY,                   \
+		&&OPCODE_GET_ARRAY,                   \
 		&&OPCODE_SET_NAMED,                   \
 		&&OPCODE_GET_NAMED,                   \
 		&&OPCODE_SET_MEMBER,                  \
@@ -209,6 +440,8 @@ static String _get_var_type(const Variant *p_type) {
 		&&OPCODE_CONSTRUCT_DICTIONARY,        \
 		&&OPCODE_CALL,                        \
 		&&OPCODE_CALL_RETURN,                 \
+		&&OPCODE_CALL_PTRCALL,                \
+		&&OPCODE_INLINE_CACHE,                \
 		&&OPCODE_CALL_BUILT_IN,               \
 		&&OPCODE_CALL_SELF,                   \
 		&&OPCODE_CALL_SELF_BASE,              \
@@ -222,6 +455,8 @@ static String _get_var_type(const Variant *p_type) {
 		&&OPCODE_RETURN,                      \
 		&&OPCODE_ITERATE_BEGIN,               \
 		&&OPCODE_ITERATE,                     \
+		&&OPCODE_ITERATE_BEGIN_RANGE,         \
+		&&OPCODE_ITERATE_RANGE,               \
 		&&OPCODE_ASSERT,                      \
 		&&OPCODE_BREAKPOINT,                  \
 		&&OPCODE_LINE,                        \
@@ -251,7 +486,126 @@ static String _get_var_type(const Variant *p_type) {
 #define OPCODE_OUT break
 #endif
 
-Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_args, int p_argcount, Variant::CallError &r_err, CallState *p_state) {
+// Stack slots for the functions running on a thread. Slots stay null while
+// they are not in use, so entering a function only copies its arguments, and
+// leaving it clears the whole frame back to null (a type check for the slots
+// that were never written).
+class GDScriptStackPool {
+
+	enum {
+		SEGMENT_SLOTS = 4096
+	};
+
+	struct Segment {
+		Segment *prev;
+		Segment *next;
+		Variant *slots;
+		int size;
+		int used;
+	};
+
+	Segment *current;
+
+	Variant *_push_segment(int p_count) {
+
+		// frames never span segments, a frame that doesn't fit goes to the next one
+		Segment *next = current ? current->next : NULL;
+
+		if (!next || next->size < p_count) {
+
+			_free_segments(next);
+
+			next = memnew(Segment);
+			next->prev = current;
+			next->next = NULL;
+			next->size = MAX((int)SEGMENT_SLOTS, p_count);
+			next->slots = memnew_arr(Variant, next->size);
+			if (current)
+				current->next = next;
+		}
+
+		current = next;
+		current->used = p_count;
+		return current->slots;
+	}
+
+	void _free_segments(Segment *p_segment) {
+
+		while (p_segment) {
+			Segment *next = p_segment->next;
+			memdelete_arr(p_segment->slots);
+			memdelete(p_segment);
+			p_segment = next;
+		}
+	}
+
+public:
+	_FORCE_INLINE_ Variant *push(int p_count) {
+
+		if (likely(current && current->used + p_count <= current->size)) {
+			Variant *slots = &current->slots[current->used];
+			current->used += p_count;
+			return slots;
+		}
+		return _push_segment(p_count);
+	}
+
+	// the slots must be null again
+	_FORCE_INLINE_ void pop(int p_count) {
+
+		current->used -= p_count;
+		if (current->used == 0 && current->prev)
+			current = current->prev;
+	}
+
+	GDScriptStackPool() {
+		current = NULL;
+	}
+
+	~GDScriptStackPool() {
+
+		if (!current)
+			return;
+		while (current->prev)
+			current = current->prev;
+		_free_segments(current);
+	}
+};
+
+// Created on the first call in each thread, freed by GDScriptLanguage when the
+// thread exits (or at finish() for the main thread).
+static _THREAD_LOCAL_PTR_(GDScriptStackPool *) stack_pool = NULL;
+
+static _FORCE_INLINE_ GDScriptStackPool *_get_stack_pool() {
+
+	if (unlikely(!stack_pool)) {
+		stack_pool = memnew(GDScriptStackPool);
+	}
+	return stack_pool;
+}
+
+void GDScriptFunction::free_thread_stack() {
+
+	if (stack_pool) {
+		memdelete(stack_pool);
+		stack_pool = NULL;
+	}
+}
+
+// Arguments living on the caller's stack or in its constants can't be touched by the callee,
+// so they stay valid for the whole call and may be borrowed.
+static _FORCE_INLINE_ uint32_t _get_stable_arguments(const int *p_addresses, int p_argcount) {
+
+	uint32_t stable = 0;
+	for (int i = 0; i < p_argcount && i < 32; i++) {
+		int type = (p_addresses[i] & GDScriptFunction::ADDR_TYPE_MASK) >> GDScriptFunction::ADDR_BITS;
+		if (type == GDScriptFunction::ADDR_TYPE_STACK || type == GDScriptFunction::ADDR_TYPE_STACK_VARIABLE || type == GDScriptFunction::ADDR_TYPE_LOCAL_CONSTANT)
+			stable |= 1U << i;
+	}
+	return stable;
+}
+
+Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_args, int p_argcount, Variant::CallError &r_err, CallState *p_state, uint32_t p_stable_args) {
 
 	OPCODES_TABLE;
 
@@ -275,6 +629,7 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 #endif
 
 	uint32_t alloca_size = 0;
+	uint32_t borrowed_args = 0;
 	GDScript *_class;
 	int ip = 0;
 	int line = _initial_line;
@@ -315,49 +670,43 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 
 		alloca_size = sizeof(Variant *) * _call_size + sizeof(Variant) * _stack_size;
 
-		if (alloca_size) {
-
-			uint8_t *aptr = (uint8_t *)alloca(alloca_size);
-
-			if (_stack_size) {
-
-				stack = (Variant *)aptr;
-				for (int i = 0; i < p_argcount; i++) {
-					if (!argument_types[i].has_type) {
-						memnew_placement(&stack[i], Variant(*p_args[i]));
-						continue;
-					}
-
-					if (!argument_types[i].is_type(*p_args[i], true)) {
-						r_err.error = Variant::CallError::CALL_ERROR_INVALID_ARGUMENT;
-						r_err.argument = i;
-						r_err.expected = argument_types[i].kind == GDScriptDataType::BUILTIN ? argument_types[i].builtin_type : Variant::OBJECT;
-						return Variant();
-					}
-					if (argument_types[i].kind == GDScriptDataType::BUILTIN) {
-						Variant arg = Variant::construct(argument_types[i].builtin_type, &p_args[i], 1, r_err);
-						memnew_placement(&stack[i], Variant(arg));
-					} else {
-						memnew_placement(&stack[i], Variant(*p_args[i]));
+		if (_stack_size) {
+
+			stack = _get_stack_pool()->push(_stack_size);
+			for (int i = 0; i < p_argcount; i++) {
+				if (argument_types[i].has_type && !argument_types[i].is_type(*p_args[i], true)) {
+					r_err.error = Variant::CallError::CALL_ERROR_INVALID_ARGUMENT;
+					r_err.argument = i;
+					r_err.expected = argument_types[i].kind == GDScriptDataType::BUILTIN ? argument_types[i].builtin_type : Variant::OBJECT;
+					for (int j = 0; j < i; j++) {
+						if (borrowed_args & (1U << j)) {
+							VariantInternal::release_borrowed(&stack[j]);
+						} else {
+							VariantInternal::clear(&stack[j]);
+						}
 					}
+					stack_pool->pop(_stack_size);
+					return Variant();
 				}
-				for (int i = p_argcount; i < _stack_size; i++) {
-					memnew_placement(&stack[i], Variant);
+
+				if (argument_types[i].has_type && argument_types[i].kind == GDScriptDataType::BUILTIN && p_args[i]->get_type() != argument_types[i].builtin_type) {
+					stack[i] = Variant::construct(argument_types[i].builtin_type, &p_args[i], 1, r_err);
+				} else if (i < 32 && (p_stable_args & (1U << i)) && _can_borrow_argument(i, *p_args[i])) {
+					VariantInternal::borrow(&stack[i], p_args[i]);
+					borrowed_args |= 1U << i;
+				} else {
+					stack[i] = *p_args[i];
 				}
-			} else {
-				stack = NULL;
 			}
+		} else {
+			stack = NULL;
+		}
 
-			if (_call_size) {
-
-				call_args = (Variant **)&aptr[sizeof(Variant) * _stack_size];
-			} else {
-
-				call_args = NULL;
-			}
+		if (_call_size) {
 
+			call_args = (Variant **)alloca(sizeof(Variant *) * _call_size);
 		} else {
-			stack = NULL;
+
 			call_args = NULL;
 		}
 
@@ -433,6 +782,7 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 
 			OPCODE(OPCODE_OPERATOR) {
 
+			OPERATOR_GENERIC: // typed operators continue here when types don't match
 				CHECK_SPACE(5);
 
 				bool valid;
@@ -443,6 +793,13 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 				GET_VARIANT_PTR(b, 3);
 				GET_VARIANT_PTR(dst, 4);
 
+				Variant::ValidatedOperatorEvaluator evaluator = Variant::get_validated_operator_evaluator(op, a->get_type(), b->get_type());
+				if (evaluator) {
+					evaluator(a, b, dst);
+					ip += 5;
+					DISPATCH_OPCODE;
+				}
+
 #ifdef DEBUG_ENABLED
 
 				Variant ret;
@@ -468,6 +825,146 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 			}
 			DISPATCH_OPCODE;
 
+			OPCODE(OPCODE_OPERATOR_INT) {
+
+				CHECK_SPACE(5);
+
+				GET_VARIANT_PTR(a, 2);
+				GET_VARIANT_PTR(b, 3);
+				GET_VARIANT_PTR(dst, 4);
+
+				if (unlikely(a->get_type() != Variant::INT || b->get_type() != Variant::INT))
+					goto OPERATOR_GENERIC;
+
+				int64_t va = *VariantInternal::get_int(a);
+				int64_t vb = *VariantInternal::get_int(b);
+
+				switch (_code_ptr[ip + 1]) {
+					case Variant::OP_EQUAL: VariantInternal::set_bool(dst, va == vb); break;
+					case Variant::OP_NOT_EQUAL: VariantInternal::set_bool(dst, va != vb); break;
+					case Variant::OP_LESS: VariantInternal::set_bool(dst, va < vb); break;
+					case Variant::OP_LESS_EQUAL: VariantInternal::set_bool(dst, va <= vb); break;
+					case Variant::OP_GREATER: VariantInternal::set_bool(dst, va > vb); break;
+					case Variant::OP_GREATER_EQUAL: VariantInternal::set_bool(dst, va >= vb); break;
+					case Variant::OP_ADD: VariantInternal::set_int(dst, va + vb); break;
+					case Variant::OP_SUBTRACT: VariantInternal::set_int(dst, va - vb); break;
+					case Variant::OP_MULTIPLY: VariantInternal::set_int(dst, va * vb); break;
+					case Variant::OP_DIVIDE: {
+						if (unlikely(vb == 0))
+							goto OPERATOR_GENERIC; // reports the error
+						VariantInternal::set_int(dst, va / vb);
+					} break;
+					case Variant::OP_MODULE: {
+						if (unlikely(vb == 0))
+							goto OPERATOR_GENERIC;
+						VariantInternal::set_int(dst, va % vb);
+					} break;
+					case Variant::OP_NEGATE: VariantInternal::set_int(dst, -va); break;
+					case Variant::OP_SHIFT_LEFT: VariantInternal::set_int(dst, va << vb); break;
+					case Variant::OP_SHIFT_RIGHT: VariantInternal::set_int(dst, va >> vb); break;
+					case Variant::OP_BIT_AND: VariantInternal::set_int(dst, va & vb); break;
+					case Variant::OP_BIT_OR: VariantInternal::set_int(dst, va | vb); break;
+					case Variant::OP_BIT_XOR: VariantInternal::set_int(dst, va ^ vb); break;
+					case Variant::OP_BIT_NEGATE: VariantInternal::set_int(dst, ~va); break;
+					default: goto OPERATOR_GENERIC;
+				}
+
+				ip += 5;
+			}
+			DISPATCH_OPCODE;
+
+			OPCODE(OPCODE_OPERATOR_REAL) {
+
+				CHECK_SPACE(5);
+
+				GET_VARIANT_PTR(a, 2);
+				GET_VARIANT_PTR(b, 3);
+				GET_VARIANT_PTR(dst, 4);
+
+				// ints are fine as long as one side is a float, like in Variant::evaluate()
+				Variant::Type type_a = a->get_type();
+				Variant::Type type_b = b->get_type();
+				if (unlikely((type_a != Variant::REAL && type_a != Variant::INT) || (type_b != Variant::REAL && type_b != Variant::INT) || (type_a == Variant::INT && type_b == Variant::INT)))
+					goto OPERATOR_GENERIC;
+
+				double va = type_a == Variant::REAL ? *VariantInternal::get_real(a) : (double)*VariantInternal::get_int(a);
+				double vb = type_b == Variant::REAL ? *VariantInternal::get_real(b) : (double)*VariantInternal::get_int(b);
+
+				switch (_code_ptr[ip + 1]) {
+					case Variant::OP_EQUAL: VariantInternal::set_bool(dst, va == vb); break;
+					case Variant::OP_NOT_EQUAL: VariantInternal::set_bool(dst, va != vb); break;
+					case Variant::OP_LESS: VariantInternal::set_bool(dst, va < vb); break;
+					case Variant::OP_LESS_EQUAL: VariantInternal::set_bool(dst, va <= vb); break;
+					case Variant::OP_GREATER: VariantInternal::set_bool(dst, va > vb); break;
+					case Variant::OP_GREATER_EQUAL: VariantInternal::set_bool(dst, va >= vb); break;
+					case Variant::OP_ADD: VariantInternal::set_real(dst, va + vb); break;
+					case Variant::OP_SUBTRACT: VariantInternal::set_real(dst, va - vb); break;
+					case Variant::OP_MULTIPLY: VariantInternal::set_real(dst, va * vb); break;
+					case Variant::OP_DIVIDE: {
+#ifdef DEBUG_ENABLED
+						if (unlikely(vb == 0))
+							goto OPERATOR_GENERIC; // reports the error
+#endif
+						VariantInternal::set_real(dst, va / vb);
+					} break;
+					case Variant::OP_NEGATE: VariantInternal::set_real(dst, -va); break;
+					default: goto OPERATOR_GENERIC;
+				}
+
+				ip += 5;
+			}
+			DISPATCH_OPCODE;
+
+#define OPCODE_OPERATOR_VECTOR(m_type, m_name, m_get, m_set)                                                                         \
+	OPCODE(OPCODE_OPERATOR_##m_name) {                                                                                               \
+                                                                                                                                     \
+		CHECK_SPACE(5);                                                                                                              \
+                                                                                                                                     \
+		GET_VARIANT_PTR(a, 2);                                                                                                       \
+		GET_VARIANT_PTR(b, 3);                                                                                                       \
+		GET_VARIANT_PTR(dst, 4);                                                                                                     \
+                                                                                                                                     \
+		Variant::Type type_a = a->get_type();                                                                                        \
+		Variant::Type type_b = b->get_type();                                                                                        \
+		int op = _code_ptr[ip + 1];                                                                                                  \
+                                                                                                                                     \
+		if (type_a == Variant::m_name && type_b == Variant::m_name) {                                                                \
+			m_type va = *VariantInternal::m_get(a);                                                                                  \
+			m_type vb = *VariantInternal::m_get(b);                                                                                  \
+			switch (op) {                                                                                                            \
+				case Variant::OP_EQUAL: VariantInternal::set_bool(dst, va == vb); break;                                             \
+				case Variant::OP_NOT_EQUAL: VariantInternal::set_bool(dst, va != vb); break;                                         \
+				case Variant::OP_ADD: VariantInternal::m_set(dst, va + vb); break;                                                   \
+				case Variant::OP_SUBTRACT: VariantInternal::m_set(dst, va - vb); break;                                              \
+				case Variant::OP_MULTIPLY: VariantInternal::m_set(dst, va * vb); break;                                              \
+				case Variant::OP_DIVIDE: VariantInternal::m_set(dst, va / vb); break;                                                \
+				case Variant::OP_NEGATE: VariantInternal::m_set(dst, -va); break;                                                    \
+				default: goto OPERATOR_GENERIC;                                                                                      \
+			}                                                                                                                        \
+		} else if (type_a == Variant::m_name && (type_b == Variant::REAL || type_b == Variant::INT)) {                               \
+			m_type va = *VariantInternal::m_get(a);                                                                                  \
+			real_t vb = type_b == Variant::REAL ? (real_t)*VariantInternal::get_real(b) : (real_t)*VariantInternal::get_int(b);      \
+			switch (op) {                                                                                                            \
+				case Variant::OP_MULTIPLY: VariantInternal::m_set(dst, va * vb); break;                                              \
+				case Variant::OP_DIVIDE: VariantInternal::m_set(dst, va / vb); break;                                                \
+				default: goto OPERATOR_GENERIC;                                                                                      \
+			}                                                                                                                        \
+		} else if ((type_a == Variant::REAL || type_a == Variant::INT) && type_b == Variant::m_name && op == Variant::OP_MULTIPLY) { \
+			real_t va = type_a == Variant::REAL ? (real_t)*VariantInternal::get_real(a) : (real_t)*VariantInternal::get_int(a);      \
+			VariantInternal::m_set(dst, *VariantInternal::m_get(b) * va);                                                            \
+		} else {                                                                                                                     \
+			goto OPERATOR_GENERIC;                                                                                                   \
+		}                                                                                                                            \
+                                                                                                                                     \
+		ip += 5;                                                                                                                     \
+	}                                                                                                                                \
+	DISPATCH_OPCODE;
+
+			OPCODE_OPERATOR_VECTOR(Vector2, VECTOR2, get_vector2, set_vector2)
+			OPCODE_OPERATOR_VECTOR(Vector3, VECTOR3, get_vector3, set_vector3)
+
+#undef OPCODE_OPERATOR_VECTOR
+
 			OPCODE(OPCODE_EXTENDS_TEST) {
 
 				CHECK_SPACE(4);
@@ -551,6 +1048,7 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 
 			OPCODE(OPCODE_SET) {
 
+			SET_GENERIC: // OPCODE_SET_ARRAY continues here when types don't match
 				CHECK_SPACE(3);
 
 				GET_VARIANT_PTR(dst, 1);
@@ -578,6 +1076,7 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 
 			OPCODE(OPCODE_GET) {
 
+			GET_GENERIC: // OPCODE_GET_ARRAY continues here when types don't match
 				CHECK_SPACE(3);
 
 				GET_VARIANT_PTR(src, 1);
@@ -609,6 +1108,58 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 			}
 			DISPATCH_OPCODE;
 
+			OPCODE(OPCODE_SET_ARRAY) {
+
+				CHECK_SPACE(3);
+
+				GET_VARIANT_PTR(dst, 1);
+				GET_VARIANT_PTR(index, 2);
+				GET_VARIANT_PTR(value, 3);
+
+				if (unlikely(dst->get_type() != Variant::ARRAY || index->get_type() != Variant::INT))
+					goto SET_GENERIC;
+
+				Array *array = VariantInternal::get_array(dst);
+				int idx = *VariantInternal::get_int(index);
+				if (idx < 0)
+					idx += array->size();
+				if (unlikely(idx < 0 || idx >= array->size()))
+					goto SET_GENERIC; // reports the error
+
+				(*array)[idx] = *value;
+				ip += 4;
+			}
+			DISPATCH_OPCODE;
+
+			OPCODE(OPCODE_GET_ARRAY) {
+
+				CHECK_SPACE(3);
+
+				GET_VARIANT_PTR(src, 1);
+				GET_VARIANT_PTR(index, 2);
+				GET_VARIANT_PTR(dst, 3);
+
+				if (unlikely(src->get_type() != Variant::ARRAY || index->get_type() != Variant::INT))
+					goto GET_GENERIC;
+
+				const Array *array = VariantInternal::get_array(src);
+				int idx = *VariantInternal::get_int(index);
+				if (idx < 0)
+					idx += array->size();
+				if (unlikely(idx < 0 || idx >= array->size()))
+					goto GET_GENERIC; // reports the error
+
+				if (dst == src) {
+					// assigning would release the array the element lives in
+					Variant ret = (*array)[idx];
+					*dst = ret;
+				} else {
+					*dst = (*array)[idx];
+				}
+				ip += 4;
+			}
+			DISPATCH_OPCODE;
+
 			OPCODE(OPCODE_SET_NAMED) {
 
 				CHECK_SPACE(3);
@@ -621,6 +1172,15 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 				GD_ERR_BREAK(indexname < 0 || indexname >= _global_names_count);
 				const StringName *index = &_global_names_ptr[indexname];
 
+				// members of builtin types are written directly, objects still go through set_named()
+				if (dst->get_type() != Variant::OBJECT) {
+					Variant::ValidatedSetter setter = Variant::get_member_validated_setter(dst->get_type(), *index);
+					if (setter && setter(dst, value)) {
+						ip += 4;
+						DISPATCH_OPCODE;
+					}
+				}
+
 				bool valid;
 				dst->set_named(*index, *value, &valid);
 
@@ -647,6 +1207,15 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 				GD_ERR_BREAK(indexname < 0 || indexname >= _global_names_count);
 				const StringName *index = &_global_names_ptr[indexname];
 
+				if (src->get_type() != Variant::OBJECT) {
+					Variant::ValidatedGetter getter = Variant::get_member_validated_getter(src->get_type(), *index);
+					if (getter) {
+						getter(src, dst);
+						ip += 4;
+						DISPATCH_OPCODE;
+					}
+				}
+
 				bool valid;
 #ifdef DEBUG_ENABLED
 				//allow better error message in cases where src and dst are the same stack position
@@ -1109,6 +1678,323 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 			}
 			DISPATCH_OPCODE;
 
+			OPCODE(OPCODE_CALL_PTRCALL) {
+
+#ifdef PTRCALL_ENABLED
+				CHECK_SPACE(6);
+
+				int ptrcall_idx = _code_ptr[ip + 1];
+				GD_ERR_BREAK(ptrcall_idx < 0 || ptrcall_idx >= _ptrcalls_count);
+				PtrCall *ptrcall = &_ptrcalls_ptr[ptrcall_idx];
+
+				// the regular call follows, it runs instead whenever the fast path can't be used
+				bool call_ret = _code_ptr[ip + 2] == OPCODE_CALL_RETURN;
+				int argc = _code_ptr[ip + 3];
+				GET_VARIANT_PTR(base, 4);
+
+				Object *obj = base->get_type() == Variant::OBJECT ? VariantInternal::get_object(base) : NULL;
+				if (unlikely(!obj)) {
+					ip += 2;
+					DISPATCH_OPCODE;
+				}
+#ifdef DEBUG_ENABLED
+				if (ScriptDebugger::get_singleton() && !base->is_ref() && !ObjectDB::instance_validate(obj)) {
+					ip += 2;
+					DISPATCH_OPCODE;
+				}
+#endif
+				// scripts can define functions with the same name as native methods
+				if (obj->get_script_instance()) {
+					ip += 2;
+					DISPATCH_OPCODE;
+				}
+
+				// derived classes may bind a different method with the same name
+				const StringName &class_name = obj->get_class_name();
+				if (unlikely(class_name != ptrcall->class_name) && ClassDB::get_method(class_name, ptrcall->method->get_name()) != ptrcall->method) {
+					ip += 2;
+					DISPATCH_OPCODE;
+				}
+
+				CHECK_SPACE(6 + argc + 1);
+
+				const void **argptrs = (const void **)call_args;
+				const Variant::Type *argument_types = ptrcall->argument_types.ptr();
+				const StringName *argument_classes = ptrcall->argument_classes.ptr();
+				bool types_match = true;
+
+				for (int i = 0; i < argc; i++) {
+					GET_VARIANT_PTR(v, 6 + i);
+					Variant::Type type = v->get_type();
+					if (argument_types[i] == Variant::NIL) {
+						argptrs[i] = v;
+					} else if (type == argument_types[i] || (type == Variant::NIL && argument_types[i] == Variant::OBJECT)) {
+						if (type == Variant::OBJECT && argument_classes[i] != StringName()) {
+							// a wrong class would be cast blindly, the regular call reports it instead
+							Object *arg_obj = VariantInternal::get_object(v);
+#ifdef DEBUG_ENABLED
+							if (arg_obj && ScriptDebugger::get_singleton() && !v->is_ref() && !ObjectDB::instance_validate(arg_obj)) {
+								types_match = false;
+								break;
+							}
+#endif
+							if (arg_obj && !ClassDB::is_parent_class(arg_obj->get_class_name(), argument_classes[i])) {
+								types_match = false;
+								break;
+							}
+						}
+						argptrs[i] = VariantInternal::get_opaque_pointer(v);
+					} else {
+						types_match = false;
+						break;
+					}
+				}
+
+				if (!types_match) {
+					ip += 2;
+					DISPATCH_OPCODE;
+				}
+
+				int argument_count = ptrcall->argument_types.size();
+				for (int i = argc; i < argument_count; i++) {
+					const Variant *v = &ptrcall->default_arguments[i - (argument_count - ptrcall->default_arguments.size())];
+					argptrs[i] = argument_types[i] == Variant::NIL ? v : VariantInternal::get_opaque_pointer(v);
+				}
+
+#ifdef DEBUG_ENABLED
+				uint64_t call_time = 0;
+
+				if (GDScriptLanguage::get_singleton()->profiling) {
+					call_time = OS::get_singleton()->get_ticks_usec();
+				}
+
+#endif
+				Variant result;
+
+				if (!ptrcall->method->has_return()) {
+					ptrcall->method->ptrcall(obj, argptrs, NULL);
+				} else if (ptrcall->return_type == Variant::NIL) {
+					ptrcall->method->ptrcall(obj, argptrs, &result);
+				} else if (ptrcall->return_type == Variant::OBJECT) {
+					Object *ret_obj = NULL;
+					ptrcall->method->ptrcall(obj, argptrs, &ret_obj);
+					result = ret_obj;
+				} else {
+					Variant::CallError ce;
+					result = Variant::construct(ptrcall->return_type, NULL, 0, ce);
+					ptrcall->method->ptrcall(obj, argptrs, (void *)VariantInternal::get_opaque_pointer(&result));
+					if (ptrcall->return_enum) {
+						// enums are encoded as 32 bits
+						VariantInternal::set_int(&result, *(int32_t *)VariantInternal::get_int(&result));
+					}
+				}
+
+#ifdef DEBUG_ENABLED
+				if (GDScriptLanguage::get_singleton()->profiling) {
+					function_call_time += OS::get_singleton()->get_ticks_usec() - call_time;
+				}
+#endif
+
+				if (call_ret) {
+					GET_VARIANT_PTR(ret, 6 + argc);
+					*ret = result;
+				}
+
+				ip += 6 + argc + 1;
+#else
+				ip += 2;
+#endif
+			}
+			DISPATCH_OPCODE;
+
+			OPCODE(OPCODE_INLINE_CACHE) {
+
+				CHECK_SPACE(6);
+
+				int cache_idx = _code_ptr[ip + 1];
+				GD_ERR_BREAK(cache_idx < 0 || cache_idx >= _inline_caches_count);
+				InlineCache *cache = &_inline_caches_ptr[cache_idx];
+
+				// the cached opcode follows, it runs instead whenever the cache can't be used
+				int opcode = _code_ptr[ip + 2];
+				bool is_call = opcode == OPCODE_CALL || opcode == OPCODE_CALL_RETURN;
+				int base_ofs = is_call ? 4 : 3;
+				GET_VARIANT_PTR(base, base_ofs);
+
+				Object *obj = base->get_type() == Variant::OBJECT ? VariantInternal::get_object(base) : NULL;
+				if (unlikely(!obj)) {
+					ip += 2;
+					DISPATCH_OPCODE;
+				}
+#ifdef DEBUG_ENABLED
+				if (ScriptDebugger::get_singleton() && !base->is_ref() && !ObjectDB::instance_validate(obj)) {
+					ip += 2;
+					DISPATCH_OPCODE;
+				}
+#endif
+				// only GDScript instances are looked into, other languages and placeholders aren't cached
+				GDScriptInstance *instance = NULL;
+				ScriptInstance *script_instance = obj->get_script_instance();
+				if (script_instance) {
+					if (script_instance->get_language() != GDScriptLanguage::get_singleton() || script_instance->is_placeholder()) {
+						ip += 2;
+						DISPATCH_OPCODE;
+					}
+					instance = static_cast<GDScriptInstance *>(script_instance);
+				}
+
+				const GDScript *script = instance ? instance->script.ptr() : NULL;
+				const StringName *class_name = &obj->get_class_name();
+				uint32_t version = GDScriptLanguage::get_singleton()->inline_cache_version;
+
+				const InlineCache::Entry *entry = NULL;
+				for (int i = 0; i < InlineCache::MAX_ENTRIES; i++) {
+					const InlineCache::Entry *e = cache->entries[i];
+					if (!e) {
+						break;
+					}
+					if (e->script == script && e->class_name == class_name && e->version == version) {
+						entry = e;
+						break;
+					}
+				}
+
+				if (unlikely(!entry)) {
+					int indexname = _code_ptr[ip + (is_call ? 5 : 4)];
+					GD_ERR_BREAK(indexname < 0 || indexname >= _global_names_count);
+					entry = _fill_inline_cache(cache, opcode, _global_names_ptr[indexname], obj, instance, version);
+					if (!entry) {
+						ip += 2;
+						DISPATCH_OPCODE;
+					}
+				}
+
+				if (opcode == OPCODE_GET_NAMED) {
+
+					if (entry->kind == InlineCache::MEMBER && entry->member_index >= instance->members.size()) {
+						ip += 2;
+						DISPATCH_OPCODE;
+					}
+
+					// read into a temporary, dst may hold the last reference to the receiver
+					Variant ret;
+
+					switch (entry->kind) {
+						case InlineCache::MEMBER: {
+							ret = instance->members[entry->member_index];
+						} break;
+						case InlineCache::MEMBER_GETTER: {
+							Variant::CallError err;
+							ret = entry->function->call(instance, NULL, 0, err);
+							if (err.error != Variant::CallError::CALL_OK) {
+								ret = instance->members[entry->member_index];
+							}
+						} break;
+						case InlineCache::CONSTANT: {
+							ret = *entry->constant;
+						} break;
+						default: {
+							Variant::CallError err;
+							ret = entry->method->call(obj, NULL, 0, err);
+						}
+					}
+
+					GET_VARIANT_PTR(dst, 5);
+					*dst = ret;
+
+					ip += 6;
+
+				} else if (opcode == OPCODE_SET_NAMED) {
+
+					GET_VARIANT_PTR(value, 5);
+
+					switch (entry->kind) {
+						case InlineCache::MEMBER: {
+							if (entry->member_index >= instance->members.size() || !entry->member_type.is_type(*value)) {
+								ip += 2;
+								DISPATCH_OPCODE;
+							}
+							instance->members.write[entry->member_index] = *value;
+						} break;
+						case InlineCache::MEMBER_SETTER: {
+							const Variant *val = value;
+							Variant::CallError err;
+							entry->function->call(instance, &val, 1, err);
+						} break;
+						default: {
+							const Variant *val = value;
+							Variant::CallError err;
+							entry->method->call(obj, &val, 1, err);
+#ifdef DEBUG_ENABLED
+							if (err.error != Variant::CallError::CALL_OK) {
+								const StringName *index = &_global_names_ptr[_code_ptr[ip + 4]];
+								err_text = "Invalid set index '" + String(*index) + "' (on base: '" + _get_var_type(base) + "') with value of type '" + _get_var_type(value) + "'.";
+								OPCODE_BREAK;
+							}
+#endif
+						}
+					}
+#ifdef TOOLS_ENABLED
+					obj->_mark_edited();
+#endif
+
+					ip += 6;
+
+				} else {
+
+					int argc = _code_ptr[ip + 3];
+					GD_ERR_BREAK(argc < 0);
+					CHECK_SPACE(6 + argc + 1);
+					Variant **argptrs = call_args;
+
+					for (int i = 0; i < argc; i++) {
+						GET_VARIANT_PTR(v, 6 + i);
+						argptrs[i] = v;
+					}
+
+#ifdef DEBUG_ENABLED
+					uint64_t call_time = 0;
+
+					if (GDScriptLanguage::get_singleton()->profiling) {
+						call_time = OS::get_singleton()->get_ticks_usec();
+					}
+
+#endif
+					Variant::CallError err;
+					Variant ret;
+					{
+#ifdef DEBUG_ENABLED
+						_ObjectDebugLock debug_lock(obj);
+#endif
+						if (entry->kind == InlineCache::SCRIPT_FUNCTION) {
+							ret = entry->function->call(instance, (const Variant **)argptrs, argc, err, NULL, _get_stable_arguments(&_code_ptr[ip + 6], argc));
+						} else {
+							ret = entry->method->call(obj, (const Variant **)argptrs, argc, err);
+						}
+					}
+#ifdef DEBUG_ENABLED
+					if (GDScriptLanguage::get_singleton()->profiling) {
+						function_call_time += OS::get_singleton()->get_ticks_usec() - call_time;
+					}
+
+					if (err.error != Variant::CallError::CALL_OK) {
+
+						String methodstr = _global_names_ptr[_code_ptr[ip + 5]];
+						String basestr = _get_var_type(base);
+						err_text = _get_call_error(err, "function '" + methodstr + "' in base '" + basestr + "'", (const Variant **)argptrs);
+						OPCODE_BREAK;
+					}
+#endif
+					if (opcode == OPCODE_CALL_RETURN && err.error == Variant::CallError::CALL_OK) {
+						GET_VARIANT_PTR(dst, 6 + argc);
+						*dst = ret;
+					}
+
+					ip += 6 + argc + 1;
+				}
+			}
+			DISPATCH_OPCODE;
+
 			OPCODE(OPCODE_CALL_BUILT_IN) {
 
 				CHECK_SPACE(4);
@@ -1195,7 +2081,7 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 
 				if (E) {
 
-					*dst = E->get()->call(p_instance, (const Variant **)argptrs, argc, err);
+					*dst = E->get()->call(p_instance, (const Variant **)argptrs, argc, err, NULL, _get_stable_arguments(&_code_ptr[ip + 3], argc));
 				} else if (gds->native.ptr()) {
 
 					if (*methodname != GDScriptLanguage::get_singleton()->strings._init) {
@@ -1245,9 +2131,10 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 				gdfs->function = this;
 
 				gdfs->state.stack.resize(alloca_size);
-				//copy variant stack
+				//move variant stack, the slots left behind are null
+				Variant *state_stack = (Variant *)gdfs->state.stack.ptrw();
 				for (int i = 0; i < _stack_size; i++) {
-					memnew_placement(&gdfs->state.stack.write[sizeof(Variant) * i], Variant(stack[i]));
+					VariantInternal::move(&state_stack[i], &stack[i]);
 				}
 				gdfs->state.stack_size = _stack_size;
 				gdfs->state.self = self;
@@ -1393,6 +2280,7 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 
 			OPCODE(OPCODE_ITERATE_BEGIN) {
 
+			ITERATE_BEGIN_GENERIC: // OPCODE_ITERATE_BEGIN_RANGE continues here when types don't match
 				CHECK_SPACE(8); //space for this a regular iterate
 
 				GET_VARIANT_PTR(counter, 1);
@@ -1426,6 +2314,7 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 
 			OPCODE(OPCODE_ITERATE) {
 
+			ITERATE_GENERIC: // OPCODE_ITERATE_RANGE continues here when types don't match
 				CHECK_SPACE(4);
 
 				GET_VARIANT_PTR(counter, 1);
@@ -1457,6 +2346,57 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 			}
 			DISPATCH_OPCODE;
 
+			OPCODE(OPCODE_ITERATE_BEGIN_RANGE) {
+
+				CHECK_SPACE(8); //space for this a regular iterate
+
+				GET_VARIANT_PTR(counter, 1);
+				GET_VARIANT_PTR(container, 2);
+
+				int64_t from, to, step;
+				if (unlikely(!_get_iterate_range(container, from, to, step)))
+					goto ITERATE_BEGIN_GENERIC;
+
+				VariantInternal::set_int(counter, from);
+
+				if (step > 0 ? from >= to : (step == 0 || from <= to)) {
+					int jumpto = _code_ptr[ip + 3];
+					GD_ERR_BREAK(jumpto < 0 || jumpto > _code_size);
+					ip = jumpto;
+				} else {
+					GET_VARIANT_PTR(iterator, 4);
+					VariantInternal::set_int(iterator, from);
+					ip += 5; //skip regular iterate which is always next
+				}
+			}
+			DISPATCH_OPCODE;
+
+			OPCODE(OPCODE_ITERATE_RANGE) {
+
+				CHECK_SPACE(4);
+
+				GET_VARIANT_PTR(counter, 1);
+				GET_VARIANT_PTR(container, 2);
+
+				int64_t from, to, step;
+				if (unlikely(counter->get_type() != Variant::INT || !_get_iterate_range(container, from, to, step)))
+					goto ITERATE_GENERIC;
+
+				int64_t idx = *VariantInternal::get_int(counter) + step;
+
+				if ((step > 0 && idx >= to) || (step < 0 && idx <= to)) {
+					int jumpto = _code_ptr[ip + 3];
+					GD_ERR_BREAK(jumpto < 0 || jumpto > _code_size);
+					ip = jumpto;
+				} else {
+					VariantInternal::set_int(counter, idx);
+					GET_VARIANT_PTR(iterator, 4);
+					VariantInternal::set_int(iterator, idx);
+					ip += 5; //loop again
+				}
+			}
+			DISPATCH_OPCODE;
+
 			OPCODE(OPCODE_ASSERT) {
 				CHECK_SPACE(2);
 				GET_VARIANT_PTR(test, 1);
@@ -1579,8 +2519,18 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 
 	if (_stack_size) {
 		//free stack
-		for (int i = 0; i < _stack_size; i++)
-			stack[i].~Variant();
+		if (p_state) {
+			for (int i = 0; i < _stack_size; i++)
+				stack[i].~Variant();
+		} else {
+			for (int i = 0; borrowed_args; i++, borrowed_args >>= 1) {
+				if (borrowed_args & 1)
+					VariantInternal::release_borrowed(&stack[i]);
+			}
+			for (int i = 0; i < _stack_size; i++)
+				VariantInternal::clear(&stack[i]);
+			stack_pool->pop(_stack_size);
+		}
 	}
 
 	return retvalue;
@@ -1706,11 +2656,66 @@ void GDScriptFunction::debug_get_stack_member_state(int p_line, List<Pair<String
 	}
 }
 
+#if defined(PTRCALL_ENABLED) && defined(DEBUG_METHODS_ENABLED)
+// Fills the argument and return types of a ptrcall to p_method,
+// returns false if the method can't be called this way.
+bool GDScriptFunction::_setup_ptrcall(PtrCall &r_ptrcall, MethodBind *p_method) {
+
+	if (!p_method || p_method->is_vararg()) {
+		return false;
+	}
+
+	int argument_count = p_method->get_argument_count();
+	r_ptrcall.method = p_method;
+	r_ptrcall.argument_types.resize(argument_count);
+	r_ptrcall.argument_classes.resize(argument_count);
+
+	for (int i = 0; i < argument_count; i++) {
+
+		Variant::Type type = p_method->get_argument_type(i);
+		r_ptrcall.argument_types.write[i] = type;
+		r_ptrcall.argument_classes.write[i] = StringName();
+
+		if (type == Variant::OBJECT) {
+			// PtrToArg casts object arguments blindly, so their class is checked before the call
+			PropertyInfo argument_info = p_method->get_argument_info(i);
+			if (argument_info.class_name != StringName()) {
+				r_ptrcall.argument_classes.write[i] = argument_info.class_name;
+			} else if (argument_info.hint == PROPERTY_HINT_RESOURCE_TYPE) {
+				r_ptrcall.argument_classes.write[i] = argument_info.hint_string;
+			}
+		}
+	}
+
+	r_ptrcall.return_type = p_method->get_argument_type(-1);
+	r_ptrcall.return_enum = false;
+
+	if (p_method->has_return()) {
+		PropertyInfo return_info = p_method->get_return_info();
+		if (r_ptrcall.return_type == Variant::OBJECT && ClassDB::is_parent_class(return_info.class_name, "Reference")) {
+			// encoded as Ref<>, which can't be told apart from a plain pointer here
+			return false;
+		}
+		r_ptrcall.return_enum = return_info.usage & PROPERTY_USAGE_CLASS_IS_ENUM;
+	}
+
+	return true;
+}
+#endif
+
 GDScriptFunction::GDScriptFunction() :
 		function_list(this) {
 
 	_stack_size = 0;
 	_call_size = 0;
+	_borrow_args = 0;
+	_borrow_shared_args = 0;
+#ifdef PTRCALL_ENABLED
+	_ptrcalls_ptr = NULL;
+	_ptrcalls_count = 0;
+#endif
+	_inline_caches_ptr = NULL;
+	_inline_caches_count = 0;
 	rpc_mode = MultiplayerAPI::RPC_MODE_DISABLED;
 	name = "<anonymous>";
 #ifdef DEBUG_ENABLED
@@ -1739,6 +2744,21 @@ GDScriptFunction::GDScriptFunction() :
 }
 
 GDScriptFunction::~GDScriptFunction() {
+
+	for (int i = 0; i < inline_caches.size(); i++) {
+		for (int j = 0; j < InlineCache::MAX_ENTRIES; j++) {
+			if (inline_caches[i].entries[j]) {
+				memdelete(inline_caches[i].entries[j]);
+			}
+		}
+		InlineCache::Entry *retired = inline_caches[i].retired;
+		while (retired) {
+			InlineCache::Entry *next = retired->next_retired;
+			memdelete(retired);
+			retired = next;
+		}
+	}
+
 #ifdef DEBUG_ENABLED
 	if (GDScriptLanguage::get_singleton()->lock) {
 		GDScriptLanguage::get_singleton()->lock->lock();
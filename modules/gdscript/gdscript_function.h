@@ -44,7 +44,7 @@ class GDScript;
 
 struct GDScriptDataType {
 	bool has_type;
-	enum {
+	enum Kind {
 		BUILTIN,
 		NATIVE,
 		SCRIPT,
@@ -135,10 +135,16 @@ class GDScriptFunction {
 public:
 	enum Opcode {
 		OPCODE_OPERATOR,
+		OPCODE_OPERATOR_INT, // typed versions, fall back to OPCODE_OPERATOR if types don't match
+		OPCODE_OPERATOR_REAL,
+		OPCODE_OPERATOR_VECTOR2,
+		OPCODE_OPERATOR_VECTOR3,
 		OPCODE_EXTENDS_TEST,
 		OPCODE_IS_BUILTIN,
 		OPCODE_SET,
 		OPCODE_GET,
+		OPCODE_SET_ARRAY, // int index on an array, fall back to OPCODE_SET/GET
+		OPCODE_GET_ARRAY,
 		OPCODE_SET_NAMED,
 		OPCODE_GET_NAMED,
 		OPCODE_SET_MEMBER,
@@ -157,6 +163,8 @@ public:
 		OPCODE_CONSTRUCT_DICTIONARY,
 		OPCODE_CALL,
 		OPCODE_CALL_RETURN,
+		OPCODE_CALL_PTRCALL, // prefix of an OPCODE_CALL/OPCODE_CALL_RETURN to a native method, skips it if possible
+		OPCODE_INLINE_CACHE, // prefix of an OPCODE_GET_NAMED/OPCODE_SET_NAMED/OPCODE_CALL(_RETURN), skips it on a cache hit
 		OPCODE_CALL_BUILT_IN,
 		OPCODE_CALL_SELF,
 		OPCODE_CALL_SELF_BASE,
@@ -170,6 +178,8 @@ public:
 		OPCODE_RETURN,
 		OPCODE_ITERATE_BEGIN,
 		OPCODE_ITERATE,
+		OPCODE_ITERATE_BEGIN_RANGE, // int, Vector2 or Vector3 from range(), fall back to OPCODE_ITERATE*
+		OPCODE_ITERATE_RANGE,
 		OPCODE_ASSERT,
 		OPCODE_BREAKPOINT,
 		OPCODE_LINE,
@@ -192,6 +202,71 @@ public:
 		ADDR_TYPE_NIL = 9
 	};
 
+#ifdef PTRCALL_ENABLED
+	struct PtrCall {
+
+		MethodBind *method;
+		StringName class_name; // static type of the receiver, known to bind method
+		Vector<Variant::Type> argument_types; // NIL takes any Variant
+		Vector<StringName> argument_classes; // class object arguments must inherit, empty takes any object
+		Vector<Variant> default_arguments; // already converted to the argument types
+		Variant::Type return_type;
+		bool return_enum;
+	};
+#endif
+
+	struct InlineCache {
+
+		enum {
+			MAX_ENTRIES = 4, // once all are used by the current version, misses take the regular path
+			MAX_RETIRED = 16 // entries replaced so far, beyond this stale ones are kept and misses take the regular path
+		};
+
+		enum Kind {
+			MEMBER,
+			MEMBER_GETTER,
+			MEMBER_SETTER,
+			CONSTANT,
+			NATIVE_GETTER,
+			NATIVE_SETTER,
+			SCRIPT_FUNCTION,
+			NATIVE_METHOD,
+		};
+
+		struct Entry {
+
+			// receiver, script is NULL for objects without one
+			const GDScript *script;
+			const StringName *class_name;
+			uint32_t version;
+
+			Kind kind;
+			int member_index;
+			GDScriptDataType member_type;
+			GDScriptFunction *function;
+			MethodBind *method;
+			const Variant *constant;
+
+			Entry *next_retired;
+		};
+
+		// entries don't change once published, so threads can share them without locking
+		Entry *entries[MAX_ENTRIES];
+		uint32_t fills;
+		// Entries of older versions that were replaced. Another thread may be inside a call
+		// made through one for any length of time, so they are only freed with the function.
+		Entry *retired;
+		uint32_t retired_count;
+
+		InlineCache() {
+			for (int i = 0; i < MAX_ENTRIES; i++)
+				entries[i] = NULL;
+			fills = 0;
+			retired = NULL;
+			retired_count = 0;
+		}
+	};
+
 	struct StackDebug {
 
 		int line;
@@ -202,6 +277,7 @@ public:
 
 private:
 	friend class GDScriptCompiler;
+	friend class GDScriptBytecodeCache;
 
 	StringName source;
 
@@ -216,12 +292,20 @@ private:
 #endif
 	const int *_default_arg_ptr;
 	int _default_arg_count;
+#ifdef PTRCALL_ENABLED
+	PtrCall *_ptrcalls_ptr;
+	int _ptrcalls_count;
+#endif
+	InlineCache *_inline_caches_ptr;
+	int _inline_caches_count;
 	const int *_code_ptr;
 	int _code_size;
 	int _argument_count;
 	int _stack_size;
 	int _call_size;
 	int _initial_line;
+	uint32_t _borrow_args; // arguments the function never writes, bit per argument
+	uint32_t _borrow_shared_args; // arguments only modified in place, safe to borrow for shared types
 	bool _static;
 	MultiplayerAPI::RPCMode rpc_mode;
 
@@ -234,6 +318,11 @@ private:
 	Vector<StringName> named_globals;
 #endif
 	Vector<int> default_arguments;
+#ifdef PTRCALL_ENABLED
+	Vector<PtrCall> ptrcalls;
+#endif
+	Vector<InlineCache> inline_caches;
+	Vector<StringName> used_globals; // indexed through ADDR_TYPE_GLOBAL, checked when loading cached bytecode
 	Vector<int> code;
 	Vector<GDScriptDataType> argument_types;
 	GDScriptDataType return_type;
@@ -246,6 +335,21 @@ private:
 
 	_FORCE_INLINE_ Variant *_get_variant(int p_address, GDScriptInstance *p_instance, GDScript *p_script, Variant &self, Variant *p_stack, String &r_error) const;
 	_FORCE_INLINE_ String _get_call_error(const Variant::CallError &p_err, const String &p_where, const Variant **argptrs) const;
+	_FORCE_INLINE_ bool _can_borrow_argument(int p_arg, const Variant &p_value) const {
+		if (_borrow_args & (1U << p_arg))
+			return true;
+		if (_borrow_shared_args & (1U << p_arg)) {
+			Variant::Type type = p_value.get_type();
+			return type == Variant::ARRAY || type == Variant::DICTIONARY || type == Variant::OBJECT;
+		}
+		return false;
+	}
+
+	const InlineCache::Entry *_fill_inline_cache(InlineCache *p_cache, int p_opcode, const StringName &p_name, Object *p_object, GDScriptInstance *p_instance, uint32_t p_version);
+
+#if defined(PTRCALL_ENABLED) && defined(DEBUG_METHODS_ENABLED)
+	static bool _setup_ptrcall(PtrCall &r_ptrcall, MethodBind *p_method);
+#endif
 
 	friend class GDScriptLanguage;
 
@@ -304,9 +408,14 @@ public:
 
 	void debug_get_stack_member_state(int p_line, List<Pair<StringName, int> > *r_stackvars) const;
 
+	// frees the stack slots pooled for the calling thread
+	static void free_thread_stack();
+
 	_FORCE_INLINE_ bool is_empty() const { return _code_size == 0; }
 
 	int get_argument_count() const { return _argument_count; }
+	// whether a caller may pass p_value as argument p_arg without copying it
+	bool can_borrow_argument(int p_arg, const Variant &p_value) const { return p_arg < 32 && _can_borrow_argument(p_arg, p_value); }
 	StringName get_argument_name(int p_idx) const {
 #ifdef TOOLS_ENABLED
 		ERR_FAIL_INDEX_V(p_idx, arg_names.size(), StringName());
@@ -320,7 +429,9 @@ public:
 		return default_arguments[p_idx];
 	}
 
-	Variant call(GDScriptInstance *p_instance, const Variant **p_args, int p_argcount, Variant::CallError &r_err, CallState *p_state = NULL);
+	// p_stable_args has a bit set for each argument the caller keeps alive and unchanged during the call,
+	// those can be borrowed instead of copied when the function doesn't write them.
+	Variant call(GDScriptInstance *p_instance, const Variant **p_args, int p_argcount, Variant::CallError &r_err, CallState *p_state = NULL, uint32_t p_stable_args = 0);
 
 	_FORCE_INLINE_ MultiplayerAPI::RPCMode get_rpc_mode() const { return rpc_mode; }
 	GDScriptFunction();
@@ -472,48 +472,69 @@ GDScriptParser::Node *GDScriptParser::_parse_expression(Node *p_parent, bool p_s
 				return NULL;
 			}
 
-			Ref<Resource> res;
-			if (!validating) {
+			if (defer_preloads) {
 
-				//this can be too slow for just validating code
-				if (for_completion && ScriptCodeCompletionCache::get_singleton() && FileAccess::exists(path)) {
-					res = ScriptCodeCompletionCache::get_singleton()->get_cached_resource(path);
-				} else if (!for_completion || FileAccess::exists(path)) {
-					res = ResourceLoader::load(path);
+				PendingPreload preload;
+				preload.path = path;
+				preload.line = tokenizer->get_token_line();
+
+				if (tokenizer->get_token() != GDScriptTokenizer::TK_PARENTHESIS_CLOSE) {
+					_set_error("Expected ')' after 'preload' path");
+					return NULL;
 				}
+				tokenizer->advance();
+
+				preload.constant = alloc_node<ConstantNode>();
+				pending_preloads.push_back(preload);
+
+				expr = preload.constant;
+
 			} else {
 
-				if (!FileAccess::exists(path)) {
+				Ref<Resource> res;
+				if (!validating) {
+
+					//this can be too slow for just validating code
+					if (for_completion && ScriptCodeCompletionCache::get_singleton() && FileAccess::exists(path)) {
+						res = ScriptCodeCompletionCache::get_singleton()->get_cached_resource(path);
+					} else if (!for_completion || FileAccess::exists(path)) {
+						res = ResourceLoader::load(path);
+					}
+				} else {
+
+					if (!FileAccess::exists(path)) {
+						_set_error("Can't preload resource at path: " + path);
+						return NULL;
+					} else if (ScriptCodeCompletionCache::get_singleton()) {
+						res = ScriptCodeCompletionCache::get_singleton()->get_cached_resource(path);
+					}
+				}
+
+				if (!res.is_valid()) {
 					_set_error("Can't preload resource at path: " + path);
 					return NULL;
-				} else if (ScriptCodeCompletionCache::get_singleton()) {
-					res = ScriptCodeCompletionCache::get_singleton()->get_cached_resource(path);
 				}
-			}
-
-			if (!res.is_valid()) {
-				_set_error("Can't preload resource at path: " + path);
-				return NULL;
-			}
+				_add_dependency(res);
 
-			if (tokenizer->get_token() != GDScriptTokenizer::TK_PARENTHESIS_CLOSE) {
-				_set_error("Expected ')' after 'preload' path");
-				return NULL;
-			}
+				if (tokenizer->get_token() != GDScriptTokenizer::TK_PARENTHESIS_CLOSE) {
+					_set_error("Expected ')' after 'preload' path");
+					return NULL;
+				}
 
-			Ref<GDScript> gds = res;
-			if (gds.is_valid() && !gds->is_valid()) {
-				_set_error("Could not fully preload the script, possible cyclic reference or compilation error.");
-				return NULL;
-			}
+				Ref<GDScript> gds = res;
+				if (gds.is_valid() && !gds->is_valid()) {
+					_set_error("Could not fully preload the script, possible cyclic reference or compilation error.");
+					return NULL;
+				}
 
-			tokenizer->advance();
+				tokenizer->advance();
 
-			ConstantNode *constant = alloc_node<ConstantNode>();
-			constant->value = res;
-			constant->datatype = _type_from_variant(constant->value);
+				ConstantNode *constant = alloc_node<ConstantNode>();
+				constant->value = res;
+				constant->datatype = _type_from_variant(constant->value);
 
-			expr = constant;
+				expr = constant;
+			}
 		} else if (tokenizer->get_token() == GDScriptTokenizer::TK_PR_YIELD) {
 
 			if (!current_function) {
@@ -1607,7 +1628,7 @@ GDScriptParser::Node *GDScriptParser::_reduce_expression(Node *p_node, bool p_to
 					all_constants = false;
 			}
 
-			if (all_constants && p_to_const) {
+			if (all_constants && p_to_const && !_reads_pending_preload(an->elements)) {
 				//reduce constant array expression
 
 				ConstantNode *cn = alloc_node<ConstantNode>();
@@ -1640,6 +1661,12 @@ GDScriptParser::Node *GDScriptParser::_reduce_expression(Node *p_node, bool p_to
 					all_constants = false;
 			}
 
+			for (int i = 0; all_constants && p_to_const && i < dn->elements.size(); i++) {
+
+				if (_reads_pending_preload(dn->elements[i].key) || _reads_pending_preload(dn->elements[i].value))
+					all_constants = false;
+			}
+
 			if (all_constants && p_to_const) {
 				//reduce constant array expression
 
@@ -1685,7 +1712,7 @@ GDScriptParser::Node *GDScriptParser::_reduce_expression(Node *p_node, bool p_to
 
 			} else if (op->op == OperatorNode::OP_CALL) {
 				//can reduce base type constructors
-				if ((op->arguments[0]->type == Node::TYPE_TYPE || (op->arguments[0]->type == Node::TYPE_BUILT_IN_FUNCTION && GDScriptFunctions::is_deterministic(static_cast<BuiltInFunctionNode *>(op->arguments[0])->function))) && last_not_constant == 0) {
+				if ((op->arguments[0]->type == Node::TYPE_TYPE || (op->arguments[0]->type == Node::TYPE_BUILT_IN_FUNCTION && GDScriptFunctions::is_deterministic(static_cast<BuiltInFunctionNode *>(op->arguments[0])->function))) && last_not_constant == 0 && !_reads_pending_preload(op->arguments, 1)) {
 
 					//native type constructor or intrinsic function
 					const Variant **vptr = NULL;
@@ -1768,7 +1795,7 @@ GDScriptParser::Node *GDScriptParser::_reduce_expression(Node *p_node, bool p_to
 			} else if (op->op == OperatorNode::OP_INDEX) {
 				//can reduce indices into constant arrays or dictionaries
 
-				if (all_constants) {
+				if (all_constants && !_reads_pending_preload(op->arguments)) {
 
 					ConstantNode *ca = static_cast<ConstantNode *>(op->arguments[0]);
 					ConstantNode *cb = static_cast<ConstantNode *>(op->arguments[1]);
@@ -1792,7 +1819,7 @@ GDScriptParser::Node *GDScriptParser::_reduce_expression(Node *p_node, bool p_to
 
 			} else if (op->op == OperatorNode::OP_INDEX_NAMED) {
 
-				if (op->arguments[0]->type == Node::TYPE_CONSTANT && op->arguments[1]->type == Node::TYPE_IDENTIFIER) {
+				if (op->arguments[0]->type == Node::TYPE_CONSTANT && op->arguments[1]->type == Node::TYPE_IDENTIFIER && !_reads_pending_preload(op->arguments[0])) {
 
 					ConstantNode *ca = static_cast<ConstantNode *>(op->arguments[0]);
 					IdentifierNode *ib = static_cast<IdentifierNode *>(op->arguments[1]);
@@ -1848,7 +1875,7 @@ GDScriptParser::Node *GDScriptParser::_reduce_expression(Node *p_node, bool p_to
 				default: { break; }
 			}
 			//now se if all are constants
-			if (!all_constants)
+			if (!all_constants || _reads_pending_preload(op->arguments))
 				return op; //nothing to reduce from here on
 #define _REDUCE_UNARY(m_vop)                                                                               \
 	bool valid = false;                                                                                    \
@@ -4313,6 +4340,10 @@ void GDScriptParser::_parse_class(ClassNode *p_class) {
 						}
 						parenthesis--;
 
+						if (_reads_pending_preload(subexpr)) {
+							return;
+						}
+
 						if (subexpr->type != Node::TYPE_CONSTANT) {
 							current_export = PropertyInfo();
 							_set_error("Expected a constant expression.");
@@ -4631,6 +4662,10 @@ void GDScriptParser::_parse_class(ClassNode *p_class) {
 
 					member.expression = subexpr;
 
+					if ((autoexport || member._export.type != Variant::NIL) && _reads_pending_preload(subexpr)) {
+						return;
+					}
+
 					if (autoexport && !member.data_type.has_type) {
 
 						if (subexpr->type != Node::TYPE_CONSTANT) {
@@ -5007,6 +5042,7 @@ void GDScriptParser::_determine_inheritance(ClassNode *p_class) {
 				_set_error("Script not fully loaded (cyclic preload?): " + path, p_class->line);
 				return;
 			}
+			_add_dependency(script);
 
 			if (p_class->extends_class.size()) {
 
@@ -5044,6 +5080,7 @@ void GDScriptParser::_determine_inheritance(ClassNode *p_class) {
 					_set_error("Class '" + base + "' could not be fully loaded (script error or cyclic inheritance).", p_class->line);
 					return;
 				}
+				_add_dependency(base_script);
 				p = NULL;
 			}
 
@@ -5367,6 +5404,7 @@ GDScriptParser::DataType GDScriptParser::_resolve_type(const DataType &p_source,
 					result.class_type = current_class;
 				} else {
 					Ref<Script> script = ResourceLoader::load(script_path);
+					_add_dependency(script);
 					Ref<GDScript> gds = script;
 					if (gds.is_valid()) {
 						if (!gds->is_valid()) {
@@ -7136,6 +7174,7 @@ GDScriptParser::DataType GDScriptParser::_reduce_identifier_type(const DataType
 		if (ScriptServer::is_global_class(p_identifier)) {
 			Ref<Script> scr = ResourceLoader::load(ScriptServer::get_global_class_path(p_identifier));
 			if (scr.is_valid()) {
+				_add_dependency(scr);
 				DataType result;
 				result.has_type = true;
 				result.script_type = scr;
@@ -7187,6 +7226,7 @@ GDScriptParser::DataType GDScriptParser::_reduce_identifier_type(const DataType
 				}
 				Ref<Script> singleton = ResourceLoader::load(script);
 				if (singleton.is_valid()) {
+					_add_dependency(singleton);
 					DataType result;
 					result.has_type = true;
 					result.script_type = singleton;
@@ -8025,7 +8065,32 @@ int GDScriptParser::get_error_column() const {
 	return error_column;
 }
 
-Error GDScriptParser::_parse(const String &p_base_path) {
+bool GDScriptParser::_reads_pending_preload(const Node *p_node) {
+
+	if (p_node->type != Node::TYPE_CONSTANT)
+		return false;
+
+	for (int i = 0; i < pending_preloads.size(); i++) {
+		if (pending_preloads[i].constant == p_node) {
+			preload_value_used = true;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+bool GDScriptParser::_reads_pending_preload(const Vector<Node *> &p_nodes, int p_from) {
+
+	for (int i = p_from; i < p_nodes.size(); i++) {
+		if (_reads_pending_preload(p_nodes[i]))
+			return true;
+	}
+
+	return false;
+}
+
+Error GDScriptParser::_parse_syntax(const String &p_base_path) {
 
 	base_path = p_base_path;
 
@@ -8048,6 +8113,13 @@ Error GDScriptParser::_parse(const String &p_base_path) {
 		return ERR_PARSE_ERROR;
 	}
 
+	return OK;
+}
+
+Error GDScriptParser::_resolve() {
+
+	ClassNode *main_class = static_cast<ClassNode *>(head);
+
 	_determine_inheritance(main_class);
 
 	if (error_set) {
@@ -8111,6 +8183,16 @@ Error GDScriptParser::_parse(const String &p_base_path) {
 	return OK;
 }
 
+Error GDScriptParser::_parse(const String &p_base_path) {
+
+	Error err = _parse_syntax(p_base_path);
+	if (err) {
+		return err;
+	}
+
+	return _resolve();
+}
+
 Error GDScriptParser::parse_bytecode(const Vector<uint8_t> &p_bytecode, const String &p_base_path, const String &p_self_path) {
 
 	clear();
@@ -8125,6 +8207,75 @@ Error GDScriptParser::parse_bytecode(const Vector<uint8_t> &p_bytecode, const St
 	return ret;
 }
 
+Error GDScriptParser::parse_recorded(GDScriptTokenizerRecorded *p_tokenizer, const String &p_base_path, const String &p_self_path) {
+
+	clear();
+
+	self_path = p_self_path;
+	p_tokenizer->rewind();
+	tokenizer = p_tokenizer;
+	Error ret = _parse(p_base_path);
+	tokenizer = NULL;
+	return ret;
+}
+
+Error GDScriptParser::parse_recorded_syntax(GDScriptTokenizerRecorded *p_tokenizer, const String &p_base_path, const String &p_self_path) {
+
+	clear();
+
+	self_path = p_self_path;
+	p_tokenizer->rewind();
+	tokenizer = p_tokenizer;
+	defer_preloads = true;
+	Error ret = _parse_syntax(p_base_path);
+	if (ret == OK && preload_value_used) {
+		ret = ERR_UNAVAILABLE;
+	}
+	if (ret) {
+		tokenizer = NULL;
+	}
+	return ret;
+}
+
+Error GDScriptParser::finish_recorded() {
+
+	ERR_FAIL_COND_V(!tokenizer || !defer_preloads, ERR_UNCONFIGURED);
+
+	defer_preloads = false;
+	Error ret = OK;
+
+	// Loaded in source order, as parse() would have, now that other scripts can be compiled.
+	for (int i = 0; i < pending_preloads.size(); i++) {
+
+		const PendingPreload &preload = pending_preloads[i];
+
+		Ref<Resource> res = ResourceLoader::load(preload.path);
+		if (!res.is_valid()) {
+			_set_error("Can't preload resource at path: " + preload.path, preload.line);
+			ret = ERR_PARSE_ERROR;
+			break;
+		}
+		_add_dependency(res);
+
+		Ref<GDScript> gds = res;
+		if (gds.is_valid() && !gds->is_valid()) {
+			_set_error("Could not fully preload the script, possible cyclic reference or compilation error.", preload.line);
+			ret = ERR_PARSE_ERROR;
+			break;
+		}
+
+		preload.constant->value = res;
+		preload.constant->datatype = _type_from_variant(preload.constant->value);
+	}
+	pending_preloads.clear();
+
+	if (ret == OK) {
+		ret = _resolve();
+	}
+	tokenizer = NULL;
+	return ret;
+}
+
 Error GDScriptParser::parse(const String &p_code, const String &p_base_path, bool p_just_validate, const String &p_self_path, bool p_for_completion, Set<int> *r_safe_lines) {
 
 	clear();
@@ -8155,6 +8306,13 @@ const GDScriptParser::Node *GDScriptParser::get_parse_tree() const {
 	return head;
 }
 
+void GDScriptParser::_add_dependency(const RES &p_resource) {
+
+	if (Object::cast_to<Script>(p_resource.ptr()) && p_resource->get_path().is_resource_file()) {
+		dependencies.insert(p_resource->get_path());
+	}
+}
+
 void GDScriptParser::clear() {
 
 	while (list) {
@@ -8185,12 +8343,16 @@ void GDScriptParser::clear() {
 	error_set = false;
 	tab_level.clear();
 	tab_level.push_back(0);
+	dependencies.clear();
 	error_line = 0;
 	error_column = 0;
 	pending_newline = -1;
 	parenthesis = 0;
 	current_export.type = Variant::NIL;
 	check_types = true;
+	defer_preloads = false;
+	preload_value_used = false;
+	pending_preloads.clear();
 	error = "";
 #ifdef DEBUG_ENABLED
 	safe_lines = NULL;
@@ -623,6 +623,26 @@ private:
 #endif // DEBUG_ENABLED
 	}
 
+	Set<String> dependencies; // scripts whose contents the parse result depends on
+
+	void _add_dependency(const RES &p_resource);
+
+	// Preloads found while parsing off the main thread, loaded by finish_recorded()
+	struct PendingPreload {
+		ConstantNode *constant;
+		String path;
+		int line;
+	};
+
+	bool defer_preloads;
+	bool preload_value_used; // the syntax depends on a deferred value, parse again with parse_recorded()
+	Vector<PendingPreload> pending_preloads;
+
+	bool _reads_pending_preload(const Node *p_node);
+	bool _reads_pending_preload(const Vector<Node *> &p_nodes, int p_from = 0);
+
+	Error _parse_syntax(const String &p_base_path);
+	Error _resolve();
 	Error _parse(const String &p_base_path);
 
 public:
@@ -634,9 +654,15 @@ public:
 #endif // DEBUG_ENABLED
 	Error parse(const String &p_code, const String &p_base_path = "", bool p_just_validate = false, const String &p_self_path = "", bool p_for_completion = false, Set<int> *r_safe_lines = NULL);
 	Error parse_bytecode(const Vector<uint8_t> &p_bytecode, const String &p_base_path = "", const String &p_self_path = "");
+	Error parse_recorded(GDScriptTokenizerRecorded *p_tokenizer, const String &p_base_path = "", const String &p_self_path = "");
+	// Parses without loading any resource, so it can run on any thread. The
+	// tokenizer must be kept until finish_recorded() resolves the result.
+	Error parse_recorded_syntax(GDScriptTokenizerRecorded *p_tokenizer, const String &p_base_path = "", const String &p_self_path = "");
+	Error finish_recorded();
 
 	bool is_tool_script() const;
 	const Node *get_parse_tree() const;
+	const Set<String> &get_dependencies() const { return dependencies; }
 
 	//completion info
 
@@ -0,0 +1,267 @@
+/*************************************************************************/
+/*  gdscript_prefetcher.cpp                                              */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2018 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2018 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+
+#include "gdscript_prefetcher.h"
+
+#include "core/io/resource_loader.h"
+#include "core/os/file_access.h"
+#include "core/os/os.h"
+#include "core/os/worker_thread_pool.h"
+#include "core/project_settings.h"
+
+GDScriptPrefetcher *GDScriptPrefetcher::singleton = NULL;
+
+void GDScriptPrefetcher::_read_script(uint32_t p_index, Script *p_scripts) {
+
+	Script &script = p_scripts[p_index];
+
+	// exported projects may only ship the compiled script, that is not an error
+	FileAccess *f = FileAccess::open(script.path, FileAccess::READ);
+	if (!f)
+		return;
+
+	Vector<uint8_t> data;
+	data.resize(f->get_len());
+	int r = f->get_buffer(data.ptrw(), data.size());
+	f->close();
+	memdelete(f);
+
+	if (r != data.size() || script.source.parse_utf8((const char *)data.ptr(), data.size()))
+		return; // loading the script reports it
+
+	script.tokens = memnew(GDScriptTokenizerRecorded);
+	script.tokens->record(script.source);
+
+	_find_dependencies(script);
+
+	// Resources are not loaded here, the parser leaves preloads for finish_recorded().
+	script.parser = memnew(GDScriptParser);
+	if (script.parser->parse_recorded_syntax(script.tokens, script.path.get_base_dir(), script.path) != OK) {
+		memdelete(script.parser);
+		script.parser = NULL;
+	}
+}
+
+void GDScriptPrefetcher::_free_script(Script &p_script) {
+
+	if (p_script.parser) {
+		memdelete(p_script.parser);
+	}
+	if (p_script.tokens) {
+		memdelete(p_script.tokens);
+	}
+}
+
+void GDScriptPrefetcher::_find_dependencies(Script &p_script) {
+
+	GDScriptTokenizerRecorded *tk = p_script.tokens;
+	String base_dir = p_script.path.get_base_dir();
+
+	while (tk->get_token() != GDScriptTokenizer::TK_EOF && tk->get_token() != GDScriptTokenizer::TK_ERROR) {
+
+		int ofs = -1;
+		if (tk->get_token() == GDScriptTokenizer::TK_PR_PRELOAD && tk->get_token(1) == GDScriptTokenizer::TK_PARENTHESIS_OPEN) {
+			ofs = 2;
+		} else if (tk->get_token() == GDScriptTokenizer::TK_PR_EXTENDS) {
+			ofs = 1;
+		}
+
+		if (ofs > 0 && tk->get_token(ofs) == GDScriptTokenizer::TK_CONSTANT && tk->get_token_constant(ofs).get_type() == Variant::STRING) {
+
+			// same resolution as the parser
+			String path = tk->get_token_constant(ofs);
+			if (path.is_rel_path())
+				path = base_dir.plus_file(path);
+			p_script.dependencies.push_back(path.replace("///", "//").simplify_path());
+		}
+
+		tk->advance();
+	}
+
+	tk->rewind();
+}
+
+void GDScriptPrefetcher::_discover(const String &p_path, Set<String> &r_visited, Vector<String> &r_scripts) {
+
+	if (r_visited.has(p_path))
+		return;
+	r_visited.insert(p_path);
+
+	String ext = p_path.get_extension().to_lower();
+
+	if (ext == "gd") {
+		r_scripts.push_back(p_path);
+	} else if (ext == "tscn" || ext == "scn" || ext == "tres" || ext == "res") {
+		// only scenes and resources can hold scripts, other files are not opened
+		List<String> dependencies;
+		ResourceLoader::get_dependencies(p_path, &dependencies);
+		for (List<String>::Element *E = dependencies.front(); E; E = E->next()) {
+			_discover(E->get(), r_visited, r_scripts);
+		}
+	}
+}
+
+void GDScriptPrefetcher::prefetch(const Vector<String> &p_paths) {
+
+	if (!enabled)
+		return;
+
+	uint64_t begin = OS::get_singleton()->get_ticks_usec();
+
+	Set<String> visited;
+	Vector<String> pending;
+
+	for (int i = 0; i < p_paths.size(); i++) {
+		_discover(p_paths[i], visited, pending);
+	}
+
+	int count = 0;
+	int parsed = 0;
+
+	// Each pass reads the scripts found by the previous one, which only knows
+	// about the scripts it preloads or extends once it is tokenized.
+	while (pending.size()) {
+
+		Vector<Script> pass;
+		pass.resize(pending.size());
+		for (int i = 0; i < pending.size(); i++) {
+			pass.write[i].path = pending[i];
+			pass.write[i].tokens = NULL;
+			pass.write[i].parser = NULL;
+		}
+		pending.clear();
+
+		WorkerThreadPool::get_singleton()->parallel_for(pass.size(), 1, this, &GDScriptPrefetcher::_read_script, pass.ptrw());
+
+		if (lock) {
+			lock->lock();
+		}
+
+		for (int i = 0; i < pass.size(); i++) {
+
+			if (!pass[i].tokens)
+				continue;
+
+			Script *prev = scripts.getptr(pass[i].path);
+			if (prev) {
+				_free_script(*prev);
+			}
+			scripts[pass[i].path] = pass[i];
+			count++;
+			if (pass[i].parser) {
+				parsed++;
+			}
+		}
+
+		if (lock) {
+			lock->unlock();
+		}
+
+		for (int i = 0; i < pass.size(); i++) {
+			for (int j = 0; j < pass[i].dependencies.size(); j++) {
+				_discover(pass[i].dependencies[j], visited, pending);
+			}
+		}
+	}
+
+	print_verbose("GDScript: Prefetched " + itos(count) + " scripts (" + itos(parsed) + " parsed) in " + itos((OS::get_singleton()->get_ticks_usec() - begin) / 1000) + " msec.");
+}
+
+GDScriptTokenizerRecorded *GDScriptPrefetcher::take(const String &p_path, const String &p_source, GDScriptParser **r_parser) {
+
+	*r_parser = NULL;
+
+	if (!enabled)
+		return NULL;
+
+	if (lock) {
+		lock->lock();
+	}
+
+	GDScriptTokenizerRecorded *tokens = NULL;
+
+	Script *script = scripts.getptr(p_path);
+	if (script) {
+		if (script->source == p_source) {
+			tokens = script->tokens;
+			*r_parser = script->parser;
+		} else {
+			_free_script(*script); // changed since, tokenize again
+		}
+		scripts.erase(p_path);
+	}
+
+	if (lock) {
+		lock->unlock();
+	}
+
+	return tokens;
+}
+
+void GDScriptPrefetcher::clear() {
+
+	if (lock) {
+		lock->lock();
+	}
+
+	const String *k = NULL;
+	while ((k = scripts.next(k))) {
+		_free_script(scripts[*k]);
+	}
+	scripts.clear();
+
+	if (lock) {
+		lock->unlock();
+	}
+}
+
+GDScriptPrefetcher::GDScriptPrefetcher() {
+
+	singleton = this;
+
+	enabled = GLOBAL_DEF("gdscript/prefetch/enabled", false);
+
+#ifdef NO_THREADS
+	lock = NULL;
+#else
+	lock = Mutex::create();
+#endif
+}
+
+GDScriptPrefetcher::~GDScriptPrefetcher() {
+
+	clear();
+
+	if (lock) {
+		memdelete(lock);
+	}
+	singleton = NULL;
+}
@@ -0,0 +1,82 @@
+/*************************************************************************/
+/*  gdscript_prefetcher.h                                                */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2018 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2018 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+
+#ifndef GDSCRIPT_PREFETCHER_H
+#define GDSCRIPT_PREFETCHER_H
+
+#include "core/hash_map.h"
+#include "core/os/mutex.h"
+#include "core/set.h"
+#include "gdscript_parser.h"
+#include "gdscript_tokenizer.h"
+
+// Gets the scripts a project starts with ready before they are loaded. They
+// are found from the main scene and autoloads, then read, tokenized and parsed
+// on worker threads. Preloads, inheritance and types are resolved and the
+// script compiled when each script is loaded, as they need other scripts.
+class GDScriptPrefetcher {
+
+	struct Script {
+		String path;
+		String source;
+		GDScriptTokenizerRecorded *tokens;
+		GDScriptParser *parser; // NULL if it has to be parsed again when loaded
+		Vector<String> dependencies; // preloaded and extended scripts or scenes
+	};
+
+	static GDScriptPrefetcher *singleton;
+
+	bool enabled;
+
+	Mutex *lock;
+	HashMap<String, Script> scripts; // prefetched and not loaded yet
+
+	void _read_script(uint32_t p_index, Script *p_scripts);
+	void _free_script(Script &p_script);
+	void _find_dependencies(Script &p_script);
+	void _discover(const String &p_path, Set<String> &r_visited, Vector<String> &r_scripts);
+
+public:
+	static GDScriptPrefetcher *get_singleton() { return singleton; }
+
+	bool is_enabled() const { return enabled; }
+
+	void prefetch(const Vector<String> &p_paths);
+	// Hands over the tokens of p_path if they were recorded from p_source, NULL
+	// otherwise. r_parser is set when they were parsed with parse_recorded_syntax().
+	GDScriptTokenizerRecorded *take(const String &p_path, const String &p_source, GDScriptParser **r_parser);
+	void clear();
+
+	GDScriptPrefetcher();
+	~GDScriptPrefetcher();
+};
+
+#endif // GDSCRIPT_PREFETCHER_H
@@ -1499,3 +1499,197 @@ GDScriptTokenizerBuffer::GDScriptTokenizerBuffer() {
 
 	token = 0;
 }
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void GDScriptTokenizerRecorded::record(const String &p_code) {
+
+	tokens.clear();
+	constants.clear();
+	identifiers.clear();
+#ifdef DEBUG_ENABLED
+	warning_global_skip_list.clear();
+	ignore_warnings_from = -1;
+	int global_skip_count = 0;
+#endif // DEBUG_ENABLED
+
+	GDScriptTokenizerText tt;
+	tt.set_code(p_code);
+
+	while (true) {
+
+		TokenData td;
+		td.type = tt.get_token();
+		td.line = tt.get_token_line();
+		td.col = tt.get_token_column();
+		td.data = 0;
+
+		switch (td.type) {
+			case TK_IDENTIFIER: {
+				td.data = identifiers.size();
+				identifiers.push_back(tt.get_token_identifier());
+			} break;
+			case TK_CONSTANT: {
+				td.data = constants.size();
+				constants.push_back(tt.get_token_constant());
+			} break;
+			case TK_BUILT_IN_TYPE: {
+				td.data = tt.get_token_type();
+			} break;
+			case TK_BUILT_IN_FUNC: {
+				td.data = tt.get_token_built_in_func();
+			} break;
+			case TK_NEWLINE: {
+				td.data = tt.get_token_line_indent();
+			} break;
+			case TK_ERROR: {
+				td.data = constants.size();
+				constants.push_back(tt.get_token_error());
+			} break;
+			default: {
+			}
+		}
+
+#ifdef DEBUG_ENABLED
+		// the text tokenizer finds these while reading ahead, note the token the parser is at then
+		if (ignore_warnings_from < 0 && tt.is_ignoring_warnings()) {
+			ignore_warnings_from = tokens.size();
+		}
+		if (tt.get_warning_global_skips().size() != global_skip_count) {
+			for (const Set<String>::Element *E = tt.get_warning_global_skips().front(); E; E = E->next()) {
+				bool found = false;
+				for (int i = 0; i < warning_global_skip_list.size(); i++) {
+					if (warning_global_skip_list[i].second == E->get()) {
+						found = true;
+						break;
+					}
+				}
+				if (!found) {
+					warning_global_skip_list.push_back(Pair<int, String>(tokens.size(), E->get()));
+				}
+			}
+			global_skip_count = tt.get_warning_global_skips().size();
+		}
+#endif // DEBUG_ENABLED
+
+		tokens.push_back(td);
+
+		if (td.type == TK_EOF || td.type == TK_ERROR) {
+			break; // the text tokenizer repeats these forever
+		}
+		tt.advance();
+	}
+
+#ifdef DEBUG_ENABLED
+	warning_skips = tt.get_warning_skips();
+#endif // DEBUG_ENABLED
+
+	rewind();
+}
+
+void GDScriptTokenizerRecorded::rewind() {
+
+	token = 0;
+#ifdef DEBUG_ENABLED
+	warning_global_skips.clear();
+	warning_global_skip_pos = 0;
+	_update_warnings();
+#endif // DEBUG_ENABLED
+}
+
+#ifdef DEBUG_ENABLED
+void GDScriptTokenizerRecorded::_update_warnings() {
+
+	while (warning_global_skip_pos < warning_global_skip_list.size() && warning_global_skip_list[warning_global_skip_pos].first <= token) {
+		warning_global_skips.insert(warning_global_skip_list[warning_global_skip_pos].second);
+		warning_global_skip_pos++;
+	}
+}
+#endif // DEBUG_ENABLED
+
+const GDScriptTokenizerRecorded::TokenData &GDScriptTokenizerRecorded::_get_token_data(int p_offset) const {
+
+	static const TokenData empty = { TK_EMPTY, 0, 0, 0 };
+
+	int offset = token + p_offset;
+	if (offset < 0 || tokens.empty())
+		return empty;
+	if (offset >= tokens.size())
+		return tokens[tokens.size() - 1]; // EOF or error
+	return tokens[offset];
+}
+
+GDScriptTokenizer::Token GDScriptTokenizerRecorded::get_token(int p_offset) const {
+
+	return _get_token_data(p_offset).type;
+}
+
+StringName GDScriptTokenizerRecorded::get_token_identifier(int p_offset) const {
+
+	const TokenData &td = _get_token_data(p_offset);
+	ERR_FAIL_COND_V(td.type != TK_IDENTIFIER, StringName());
+	return identifiers[td.data];
+}
+
+GDScriptFunctions::Function GDScriptTokenizerRecorded::get_token_built_in_func(int p_offset) const {
+
+	const TokenData &td = _get_token_data(p_offset);
+	ERR_FAIL_COND_V(td.type != TK_BUILT_IN_FUNC, GDScriptFunctions::FUNC_MAX);
+	return GDScriptFunctions::Function(td.data);
+}
+
+Variant::Type GDScriptTokenizerRecorded::get_token_type(int p_offset) const {
+
+	const TokenData &td = _get_token_data(p_offset);
+	ERR_FAIL_COND_V(td.type != TK_BUILT_IN_TYPE, Variant::NIL);
+	return Variant::Type(td.data);
+}
+
+int GDScriptTokenizerRecorded::get_token_line(int p_offset) const {
+
+	return _get_token_data(p_offset).line;
+}
+
+int GDScriptTokenizerRecorded::get_token_column(int p_offset) const {
+
+	return _get_token_data(p_offset).col;
+}
+
+int GDScriptTokenizerRecorded::get_token_line_indent(int p_offset) const {
+
+	const TokenData &td = _get_token_data(p_offset);
+	ERR_FAIL_COND_V(td.type != TK_NEWLINE, 0);
+	return td.data;
+}
+
+const Variant &GDScriptTokenizerRecorded::get_token_constant(int p_offset) const {
+
+	const TokenData &td = _get_token_data(p_offset);
+	ERR_FAIL_COND_V(td.type != TK_CONSTANT, nil);
+	return constants[td.data];
+}
+
+String GDScriptTokenizerRecorded::get_token_error(int p_offset) const {
+
+	const TokenData &td = _get_token_data(p_offset);
+	ERR_FAIL_COND_V(td.type != TK_ERROR, String());
+	return constants[td.data];
+}
+
+void GDScriptTokenizerRecorded::advance(int p_amount) {
+
+	ERR_FAIL_COND(p_amount <= 0);
+	token += p_amount;
+#ifdef DEBUG_ENABLED
+	_update_warnings();
+#endif // DEBUG_ENABLED
+}
+
+GDScriptTokenizerRecorded::GDScriptTokenizerRecorded() {
+
+	token = 0;
+#ifdef DEBUG_ENABLED
+	warning_global_skip_pos = 0;
+	ignore_warnings_from = -1;
+#endif // DEBUG_ENABLED
+}
@@ -297,4 +297,54 @@ public:
 	GDScriptTokenizerBuffer();
 };
 
+// Replays the tokens of a GDScriptTokenizerText run. Recording touches no
+// shared state, so scripts can be tokenized on worker threads and parsed later.
+class GDScriptTokenizerRecorded : public GDScriptTokenizer {
+
+	struct TokenData {
+		Token type;
+		int line;
+		int col;
+		int data; // constant or identifier index, type, built-in function or line indent
+	};
+
+	Vector<TokenData> tokens;
+	Vector<Variant> constants; // error texts are stored here too
+	Vector<StringName> identifiers;
+	Variant nil;
+	int token;
+#ifdef DEBUG_ENABLED
+	Vector<Pair<int, String> > warning_skips;
+	Vector<Pair<int, String> > warning_global_skip_list; // token from which each one applies
+	Set<String> warning_global_skips;
+	int warning_global_skip_pos;
+	int ignore_warnings_from;
+
+	void _update_warnings();
+#endif // DEBUG_ENABLED
+
+	const TokenData &_get_token_data(int p_offset) const;
+
+public:
+	void record(const String &p_code);
+	void rewind();
+
+	virtual Token get_token(int p_offset = 0) const;
+	virtual StringName get_token_identifier(int p_offset = 0) const;
+	virtual GDScriptFunctions::Function get_token_built_in_func(int p_offset = 0) const;
+	virtual Variant::Type get_token_type(int p_offset = 0) const;
+	virtual int get_token_line(int p_offset = 0) const;
+	virtual int get_token_column(int p_offset = 0) const;
+	virtual int get_token_line_indent(int p_offset = 0) const;
+	virtual const Variant &get_token_constant(int p_offset = 0) const;
+	virtual String get_token_error(int p_offset = 0) const;
+	virtual void advance(int p_amount = 1);
+#ifdef DEBUG_ENABLED
+	virtual const Vector<Pair<int, String> > &get_warning_skips() const { return warning_skips; }
+	virtual const Set<String> &get_warning_global_skips() const { return warning_global_skips; }
+	virtual const bool is_ignoring_warnings() const { return ignore_warnings_from >= 0 && token >= ignore_warnings_from; }
+#endif // DEBUG_ENABLED
+	GDScriptTokenizerRecorded();
+};
+
 #endif // GDSCRIPT_TOKENIZER_H
@@ -599,6 +599,14 @@ public:
 
 	virtual int step(const Variant **p_inputs, Variant **p_outputs, StartMode p_start_mode, Variant *p_working_mem, Variant::CallError &r_error, String &r_error_str) {
 
+		// unary evaluators don't look at the second operand
+		const Variant *b = unary ? p_inputs[0] : p_inputs[1];
+		Variant::ValidatedOperatorEvaluator evaluator = Variant::get_validated_operator_evaluator(op, p_inputs[0]->get_type(), b->get_type());
+		if (evaluator) {
+			evaluator(p_inputs[0], b, p_outputs[0]);
+			return 0;
+		}
+
 		bool valid;
 		if (unary) {
 
@@ -75,15 +75,13 @@ static PoolVector<uint8_t> _webp_lossy_pack(const Ref<Image> &p_image, float p_q
 	return dst;
 }
 
-static Ref<Image> _webp_lossy_unpack(const PoolVector<uint8_t> &p_buffer) {
+static Ref<Image> _webp_lossy_unpack_buffer(const uint8_t *p_buffer, int p_size) {
 
-	int size = p_buffer.size() - 4;
+	int size = p_size - 4;
 	ERR_FAIL_COND_V(size <= 0, Ref<Image>());
-	PoolVector<uint8_t>::Read r = p_buffer.read();
-
-	ERR_FAIL_COND_V(r[0] != 'W' || r[1] != 'E' || r[2] != 'B' || r[3] != 'P', Ref<Image>());
+	ERR_FAIL_COND_V(p_buffer[0] != 'W' || p_buffer[1] != 'E' || p_buffer[2] != 'B' || p_buffer[3] != 'P', Ref<Image>());
 	WebPBitstreamFeatures features;
-	if (WebPGetFeatures(&r[4], size, &features) != VP8_STATUS_OK) {
+	if (WebPGetFeatures(&p_buffer[4], size, &features) != VP8_STATUS_OK) {
 		ERR_EXPLAIN("Error unpacking WEBP image:");
 		ERR_FAIL_V(Ref<Image>());
 	}
@@ -102,9 +100,9 @@ static Ref<Image> _webp_lossy_unpack(const PoolVector<uint8_t> &p_buffer) {
 
 	bool errdec = false;
 	if (features.has_alpha) {
-		errdec = WebPDecodeRGBAInto(&r[4], size, dst_w.ptr(), datasize, 4 * features.width) == NULL;
+		errdec = WebPDecodeRGBAInto(&p_buffer[4], size, dst_w.ptr(), datasize, 4 * features.width) == NULL;
 	} else {
-		errdec = WebPDecodeRGBInto(&r[4], size, dst_w.ptr(), datasize, 3 * features.width) == NULL;
+		errdec = WebPDecodeRGBInto(&p_buffer[4], size, dst_w.ptr(), datasize, 3 * features.width) == NULL;
 	}
 
 	//ERR_EXPLAIN("Error decoding webp! - "+p_file);
@@ -116,6 +114,12 @@ static Ref<Image> _webp_lossy_unpack(const PoolVector<uint8_t> &p_buffer) {
 	return img;
 }
 
+static Ref<Image> _webp_lossy_unpack(const PoolVector<uint8_t> &p_buffer) {
+
+	PoolVector<uint8_t>::Read r = p_buffer.read();
+	return _webp_lossy_unpack_buffer(r.ptr(), p_buffer.size());
+}
+
 Error webp_load_image_from_buffer(Image *p_image, const uint8_t *p_buffer, int p_buffer_len) {
 
 	ERR_FAIL_NULL_V(p_image, ERR_INVALID_PARAMETER);
@@ -185,4 +189,5 @@ ImageLoaderWEBP::ImageLoaderWEBP() {
 	Image::_webp_mem_loader_func = _webp_mem_loader_func;
 	Image::lossy_packer = _webp_lossy_pack;
 	Image::lossy_unpacker = _webp_lossy_unpack;
+	Image::lossy_buffer_unpacker = _webp_lossy_unpack_buffer;
 }
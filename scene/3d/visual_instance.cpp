@@ -68,10 +68,12 @@ void VisualInstance::_notification(int p_what) {
 		case NOTIFICATION_TRANSFORM_CHANGED: {
 
 			Transform gt = get_global_transform();
-			VisualServer::get_singleton()->instance_set_transform(instance, gt);
+			get_tree()->_queue_instance_transform(instance, gt);
 		} break;
 		case NOTIFICATION_EXIT_WORLD: {
 
+			// the instance may be freed next, don't leave it in a pending batch
+			get_tree()->_flush_instance_transforms();
 			VisualServer::get_singleton()->instance_set_scenario(instance, RID());
 			VisualServer::get_singleton()->instance_attach_skeleton(instance, RID());
 			//VS::get_singleton()->instance_geometry_set_baked_light_sampler(instance, RID() );
@@ -47,6 +47,7 @@
 #include "scene/scene_string_names.h"
 #include "servers/physics_2d_server.h"
 #include "servers/physics_server.h"
+#include "servers/visual_server.h"
 #include "viewport.h"
 
 #include <stdio.h>
@@ -140,6 +141,9 @@ void SceneTree::make_group_changed(const StringName &p_group) {
 
 void SceneTree::flush_transform_notifications() {
 
+	bool was_batching = xform_batching; // if nested, the outer flush submits
+	xform_batching = true;
+
 	SelfList<Node> *n = xform_change_list.first();
 	while (n) {
 
@@ -149,6 +153,32 @@ void SceneTree::flush_transform_notifications() {
 		n = nx;
 		node->notification(NOTIFICATION_TRANSFORM_CHANGED);
 	}
+
+	xform_batching = was_batching;
+	if (!xform_batching) {
+		_flush_instance_transforms();
+	}
+}
+
+void SceneTree::_queue_instance_transform(RID p_instance, const Transform &p_transform) {
+
+	if (!xform_batching) {
+		VS::get_singleton()->instance_set_transform(p_instance, p_transform);
+		return;
+	}
+
+	xform_batch_instances.push_back(p_instance);
+	xform_batch_transforms.push_back(p_transform);
+}
+
+void SceneTree::_flush_instance_transforms() {
+
+	if (xform_batch_instances.size() == 0)
+		return;
+
+	VS::get_singleton()->instances_set_transform(xform_batch_instances, xform_batch_transforms);
+	xform_batch_instances.clear();
+	xform_batch_transforms.clear();
 }
 
 void SceneTree::_flush_ugc() {
@@ -1956,6 +1986,7 @@ SceneTree::SceneTree() {
 	node_added_name = "node_added";
 	node_removed_name = "node_removed";
 	ugc_locked = false;
+	xform_batching = false;
 	call_lock = 0;
 	root_lock = 0;
 	node_count = 0;
@@ -217,9 +217,18 @@ private:
 	friend class CanvasItem;
 	friend class Spatial;
 	friend class Viewport;
+	friend class VisualInstance;
 
 	SelfList<Node>::List xform_change_list;
 
+	// transforms of visual instances moved while flushing xform_change_list,
+	// sent to the VisualServer in a single call afterwards
+	bool xform_batching;
+	Vector<RID> xform_batch_instances;
+	Vector<Transform> xform_batch_transforms;
+	void _queue_instance_transform(RID p_instance, const Transform &p_transform);
+	void _flush_instance_transforms();
+
 #ifdef DEBUG_ENABLED
 
 	Map<int, NodePath> live_edit_node_path_cache;
@@ -561,18 +561,28 @@ Error StreamTexture::_load_data(const String &p_path, int &tw, int &th, int &fla
 				size = f->get_32();
 			}
 
-			PoolVector<uint8_t> pv;
-			pv.resize(size);
-			{
-				PoolVector<uint8_t>::Write w = pv.write();
-				f->get_buffer(w.ptr(), size);
-			}
-
 			Ref<Image> img;
-			if (df & FORMAT_BIT_LOSSLESS) {
-				img = Image::lossless_unpacker(pv);
+			const uint8_t *view = f->get_buffer_view(size);
+			if (view) {
+				//file is memory mapped, decode straight from it
+				if (df & FORMAT_BIT_LOSSLESS) {
+					img = Image::lossless_buffer_unpacker(view, size);
+				} else {
+					img = Image::lossy_buffer_unpacker(view, size);
+				}
 			} else {
-				img = Image::lossy_unpacker(pv);
+				PoolVector<uint8_t> pv;
+				pv.resize(size);
+				{
+					PoolVector<uint8_t>::Write w = pv.write();
+					f->get_buffer(w.ptr(), size);
+				}
+
+				if (df & FORMAT_BIT_LOSSLESS) {
+					img = Image::lossless_unpacker(pv);
+				} else {
+					img = Image::lossy_unpacker(pv);
+				}
 			}
 
 			if (img.is_null() || img->empty()) {
@@ -703,17 +713,36 @@ Error StreamTexture::load(const String &p_path) {
 	if (err)
 		return err;
 
-	VS::get_singleton()->texture_allocate(texture, image->get_width(), image->get_height(), 0, image->get_format(), VS::TEXTURE_TYPE_2D, lflags);
-	VS::get_singleton()->texture_set_data(texture, image);
-
 	w = lw;
 	h = lh;
 	flags = lflags;
 	path_to_file = p_path;
 	format = image->get_format();
 
+	if (ResourceLoader::is_loading_threaded()) {
+		// decoded on a loader thread, the upload is spread over frames on the main thread
+		ResourceLoader::add_threaded_finalizer(&StreamTexture::_finalize_upload, REF(this), image);
+	} else {
+		_upload(image);
+	}
+
 	return OK;
 }
+
+void StreamTexture::_upload(const Ref<Image> &p_image) {
+
+	VS::get_singleton()->texture_allocate(texture, p_image->get_width(), p_image->get_height(), 0, p_image->get_format(), VS::TEXTURE_TYPE_2D, flags);
+	VS::get_singleton()->texture_set_data(texture, p_image);
+}
+
+void StreamTexture::_finalize_upload(const REF &p_texture, const Variant &p_image) {
+
+	Ref<StreamTexture> st = p_texture;
+	Ref<Image> image = p_image;
+	ERR_FAIL_COND(st.is_null() || image.is_null());
+
+	st->_upload(image);
+}
 String StreamTexture::get_load_path() const {
 
 	return path_to_file;
@@ -2208,14 +2237,20 @@ RES ResourceFormatLoaderTextureLayered::load(const String &p_path, const String
 			for (int i = 0; i < mipmaps; i++) {
 				uint32_t size = f->get_32();
 
-				PoolVector<uint8_t> pv;
-				pv.resize(size);
-				{
-					PoolVector<uint8_t>::Write w = pv.write();
-					f->get_buffer(w.ptr(), size);
-				}
+				Ref<Image> img;
+				const uint8_t *view = f->get_buffer_view(size);
+				if (view) {
+					img = Image::lossless_buffer_unpacker(view, size);
+				} else {
+					PoolVector<uint8_t> pv;
+					pv.resize(size);
+					{
+						PoolVector<uint8_t>::Write w = pv.write();
+						f->get_buffer(w.ptr(), size);
+					}
 
-				Ref<Image> img = Image::lossless_unpacker(pv);
+					img = Image::lossless_unpacker(pv);
+				}
 
 				if (img.is_null() || img->empty() || format != img->get_format()) {
 					if (r_error) {
@@ -200,6 +200,9 @@ private:
 	static void _requested_srgb(void *p_ud);
 	static void _requested_normal(void *p_ud);
 
+	void _upload(const Ref<Image> &p_image);
+	static void _finalize_upload(const REF &p_texture, const Variant &p_image);
+
 protected:
 	static void _bind_methods();
 
@@ -0,0 +1,425 @@
+/*************************************************************************/
+/*  broad_phase_aabb_tree.cpp                                            */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2018 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2018 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "broad_phase_aabb_tree.h"
+#include "collision_object_sw.h"
+
+// Leaves are grown by this margin, so small motions don't reinsert them.
+#define FAT_AABB_MARGIN 0.1
+// Leaves are also extended along the motion, so fast objects don't reinsert every step.
+#define FAT_AABB_DISPLACEMENT_FACTOR 2.0
+
+void BroadPhaseAABBTree::_queue_move(ID p_id) {
+
+	Element &e = elements.write[p_id - 1];
+	if (!e.moved) {
+		e.moved = true;
+		move_buffer.push_back(p_id);
+	}
+}
+
+bool BroadPhaseAABBTree::_test_pair(ID p_a, ID p_b) const {
+
+	const Element &a = elements[p_a - 1];
+	const Element &b = elements[p_b - 1];
+
+	if (a.owner == b.owner || (a._static && b._static))
+		return false;
+	if (a.leaf == NODE_NULL || b.leaf == NODE_NULL)
+		return false;
+
+	return nodes[a.leaf].aabb.intersects_inclusive(nodes[b.leaf].aabb);
+}
+
+void BroadPhaseAABBTree::_pair(ID p_a, ID p_b) {
+
+	if (p_a > p_b)
+		SWAP(p_a, p_b);
+
+	Element &a = elements.write[p_a - 1];
+	Element &b = elements.write[p_b - 1];
+
+	void *data = NULL;
+	if (pair_callback)
+		data = pair_callback(a.owner, a.subindex, b.owner, b.subindex, pair_userdata);
+
+	pair_map.set(_pair_key(p_a, p_b), data);
+	a.pairs.push_back(p_b);
+	b.pairs.push_back(p_a);
+}
+
+void BroadPhaseAABBTree::_unpair(ID p_a, ID p_b) {
+
+	if (p_a > p_b)
+		SWAP(p_a, p_b);
+
+	uint64_t key = _pair_key(p_a, p_b);
+	void **data = pair_map.getptr(key);
+	ERR_FAIL_COND(!data);
+
+	Element &a = elements.write[p_a - 1];
+	Element &b = elements.write[p_b - 1];
+
+	if (unpair_callback)
+		unpair_callback(a.owner, a.subindex, b.owner, b.subindex, *data, unpair_userdata);
+
+	pair_map.erase(key);
+	a.pairs.erase(p_b);
+	b.pairs.erase(p_a);
+}
+
+BroadPhaseSW::ID BroadPhaseAABBTree::create(CollisionObjectSW *p_object, int p_subindex) {
+
+	ERR_FAIL_COND_V(p_object == NULL, 0);
+
+	ID id;
+	if (free_elements.size()) {
+		id = free_elements[free_elements.size() - 1];
+		free_elements.resize(free_elements.size() - 1);
+	} else {
+		elements.resize(elements.size() + 1);
+		id = elements.size();
+	}
+
+	Element &e = elements.write[id - 1];
+	e.owner = p_object;
+	e.aabb = AABB();
+	e.subindex = p_subindex;
+	e.leaf = NODE_NULL;
+	e._static = false;
+	e.moved = false;
+
+	return id;
+}
+
+void BroadPhaseAABBTree::move(ID p_id, const AABB &p_aabb) {
+
+	ERR_FAIL_INDEX(p_id - 1, (ID)elements.size());
+	Element &e = elements.write[p_id - 1];
+	ERR_FAIL_COND(!e.owner);
+
+	AABB prev_aabb = e.aabb;
+	e.aabb = p_aabb;
+
+	if (p_aabb.has_no_surface()) {
+
+		if (e.leaf != NODE_NULL) {
+			_remove_leaf(root, e.leaf);
+			_free_node(e.leaf);
+			e.leaf = NODE_NULL;
+			_queue_move(p_id);
+		}
+		return;
+	}
+
+	AABB fat_aabb = p_aabb.grow(FAT_AABB_MARGIN);
+
+	if (e.leaf != NODE_NULL) {
+
+		Vector3 displacement = (p_aabb.position - prev_aabb.position) * FAT_AABB_DISPLACEMENT_FACTOR;
+		for (int i = 0; i < 3; i++) {
+			if (displacement[i] < 0) {
+				fat_aabb.position[i] += displacement[i];
+				fat_aabb.size[i] -= displacement[i];
+			} else {
+				fat_aabb.size[i] += displacement[i];
+			}
+		}
+
+		// still inside its fat AABB, and that one didn't grow too large
+		const AABB &tree_aabb = nodes[e.leaf].aabb;
+		if (tree_aabb.encloses(p_aabb) && fat_aabb.grow(FAT_AABB_MARGIN * 4.0).encloses(tree_aabb))
+			return;
+
+		_remove_leaf(root, e.leaf);
+	} else {
+
+		e.leaf = _allocate_node();
+		nodes.write[e.leaf].element = p_id;
+	}
+
+	nodes.write[e.leaf].aabb = fat_aabb;
+	_insert_leaf(root, e.leaf);
+	_queue_move(p_id);
+}
+
+void BroadPhaseAABBTree::set_static(ID p_id, bool p_static) {
+
+	ERR_FAIL_INDEX(p_id - 1, (ID)elements.size());
+	Element &e = elements.write[p_id - 1];
+	ERR_FAIL_COND(!e.owner);
+
+	if (e._static == p_static)
+		return;
+
+	e._static = p_static;
+	_queue_move(p_id);
+}
+
+void BroadPhaseAABBTree::remove(ID p_id) {
+
+	ERR_FAIL_INDEX(p_id - 1, (ID)elements.size());
+	ERR_FAIL_COND(!elements[p_id - 1].owner);
+
+	//unpair must be done immediately on removal to avoid potential invalid pointers
+	while (elements[p_id - 1].pairs.size()) {
+		const Vector<ID> &pairs = elements[p_id - 1].pairs;
+		_unpair(p_id, pairs[pairs.size() - 1]);
+	}
+
+	Element &e = elements.write[p_id - 1];
+	if (e.leaf != NODE_NULL) {
+		_remove_leaf(root, e.leaf);
+		_free_node(e.leaf);
+	}
+
+	e.owner = NULL;
+	e.leaf = NODE_NULL;
+	e.moved = false;
+	free_elements.push_back(p_id);
+}
+
+CollisionObjectSW *BroadPhaseAABBTree::get_object(ID p_id) const {
+
+	ERR_FAIL_INDEX_V(p_id - 1, (ID)elements.size(), NULL);
+	const Element &e = elements[p_id - 1];
+	ERR_FAIL_COND_V(!e.owner, NULL);
+	return e.owner;
+}
+
+bool BroadPhaseAABBTree::is_static(ID p_id) const {
+
+	ERR_FAIL_INDEX_V(p_id - 1, (ID)elements.size(), false);
+	const Element &e = elements[p_id - 1];
+	ERR_FAIL_COND_V(!e.owner, false);
+	return e._static;
+}
+
+int BroadPhaseAABBTree::get_subindex(ID p_id) const {
+
+	ERR_FAIL_INDEX_V(p_id - 1, (ID)elements.size(), -1);
+	const Element &e = elements[p_id - 1];
+	ERR_FAIL_COND_V(!e.owner, -1);
+	return e.subindex;
+}
+
+int BroadPhaseAABBTree::cull_point(const Vector3 &p_point, CollisionObjectSW **p_results, int p_max_results, int *p_result_indices) {
+
+	if (root == NODE_NULL)
+		return 0;
+
+	const Node *n = nodes.ptr();
+	const Element *el = elements.ptr();
+	int *stack = (int *)alloca(sizeof(int) * (n[root].height + 2));
+	int stack_size = 0;
+	int rc = 0;
+
+	stack[stack_size++] = root;
+	while (stack_size && rc < p_max_results) {
+
+		const Node &node = n[stack[--stack_size]];
+		if (!node.aabb.has_point(p_point))
+			continue;
+
+		if (node.is_leaf()) {
+
+			const Element &e = el[node.element - 1];
+			if (!e.aabb.has_point(p_point))
+				continue;
+
+			p_results[rc] = e.owner;
+			if (p_result_indices)
+				p_result_indices[rc] = e.subindex;
+			rc++;
+		} else {
+
+			stack[stack_size++] = node.children[0];
+			stack[stack_size++] = node.children[1];
+		}
+	}
+
+	return rc;
+}
+
+int BroadPhaseAABBTree::cull_segment(const Vector3 &p_from, const Vector3 &p_to, CollisionObjectSW **p_results, int p_max_results, int *p_result_indices) {
+
+	if (root == NODE_NULL)
+		return 0;
+
+	const Node *n = nodes.ptr();
+	const Element *el = elements.ptr();
+	int *stack = (int *)alloca(sizeof(int) * (n[root].height + 2));
+	int stack_size = 0;
+	int rc = 0;
+
+	stack[stack_size++] = root;
+	while (stack_size && rc < p_max_results) {
+
+		const Node &node = n[stack[--stack_size]];
+		if (!node.aabb.intersects_segment(p_from, p_to))
+			continue;
+
+		if (node.is_leaf()) {
+
+			const Element &e = el[node.element - 1];
+			if (!e.aabb.intersects_segment(p_from, p_to))
+				continue;
+
+			p_results[rc] = e.owner;
+			if (p_result_indices)
+				p_result_indices[rc] = e.subindex;
+			rc++;
+		} else {
+
+			stack[stack_size++] = node.children[0];
+			stack[stack_size++] = node.children[1];
+		}
+	}
+
+	return rc;
+}
+
+int BroadPhaseAABBTree::cull_aabb(const AABB &p_aabb, CollisionObjectSW **p_results, int p_max_results, int *p_result_indices) {
+
+	if (root == NODE_NULL)
+		return 0;
+
+	const Node *n = nodes.ptr();
+	const Element *el = elements.ptr();
+	int *stack = (int *)alloca(sizeof(int) * (n[root].height + 2));
+	int stack_size = 0;
+	int rc = 0;
+
+	stack[stack_size++] = root;
+	while (stack_size && rc < p_max_results) {
+
+		const Node &node = n[stack[--stack_size]];
+		if (!node.aabb.intersects_inclusive(p_aabb))
+			continue;
+
+		if (node.is_leaf()) {
+
+			const Element &e = el[node.element - 1];
+			if (!e.aabb.intersects_inclusive(p_aabb))
+				continue;
+
+			p_results[rc] = e.owner;
+			if (p_result_indices)
+				p_result_indices[rc] = e.subindex;
+			rc++;
+		} else {
+
+			stack[stack_size++] = node.children[0];
+			stack[stack_size++] = node.children[1];
+		}
+	}
+
+	return rc;
+}
+
+void BroadPhaseAABBTree::set_pair_callback(PairCallback p_pair_callback, void *p_userdata) {
+
+	pair_callback = p_pair_callback;
+	pair_userdata = p_userdata;
+}
+
+void BroadPhaseAABBTree::set_unpair_callback(UnpairCallback p_unpair_callback, void *p_userdata) {
+
+	unpair_callback = p_unpair_callback;
+	unpair_userdata = p_userdata;
+}
+
+void BroadPhaseAABBTree::update() {
+
+	if (move_buffer.empty())
+		return;
+
+	// pairs are only created and dropped here, the tree doesn't change until the next move
+	int *stack = root != NODE_NULL ? (int *)alloca(sizeof(int) * (nodes[root].height + 2)) : NULL;
+
+	for (int i = 0; i < move_buffer.size(); i++) {
+
+		ID id = move_buffer[i];
+		Element &e = elements.write[id - 1];
+		if (!e.owner || !e.moved)
+			continue;
+		e.moved = false;
+
+		for (int j = e.pairs.size() - 1; j >= 0; j--) {
+			if (!_test_pair(id, e.pairs[j]))
+				_unpair(id, e.pairs[j]);
+		}
+
+		if (e.leaf == NODE_NULL)
+			continue;
+
+		const AABB aabb = nodes[e.leaf].aabb;
+		int stack_size = 0;
+		stack[stack_size++] = root;
+
+		while (stack_size) {
+
+			const Node &node = nodes[stack[--stack_size]];
+			if (!node.aabb.intersects_inclusive(aabb))
+				continue;
+
+			if (node.is_leaf()) {
+
+				if (node.element != id && _test_pair(id, node.element) && !pair_map.has(_pair_key(id, node.element)))
+					_pair(id, node.element);
+			} else {
+
+				stack[stack_size++] = node.children[0];
+				stack[stack_size++] = node.children[1];
+			}
+		}
+	}
+
+	move_buffer.clear();
+}
+
+int BroadPhaseAABBTree::get_tree_height() const {
+
+	return root != NODE_NULL ? nodes[root].height : 0;
+}
+
+BroadPhaseSW *BroadPhaseAABBTree::_create() {
+
+	return memnew(BroadPhaseAABBTree);
+}
+
+BroadPhaseAABBTree::BroadPhaseAABBTree() {
+
+	root = NODE_NULL;
+	pair_callback = NULL;
+	pair_userdata = NULL;
+	unpair_callback = NULL;
+	unpair_userdata = NULL;
+}
@@ -0,0 +1,111 @@
+/*************************************************************************/
+/*  broad_phase_aabb_tree.h                                              */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2018 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2018 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef BROAD_PHASE_AABB_TREE_H
+#define BROAD_PHASE_AABB_TREE_H
+
+#include "broad_phase_sw.h"
+#include "core/hash_map.h"
+#include "core/math/aabb_tree.h"
+#include "core/vector.h"
+
+/**
+ * Broad phase based on a dynamic AABB tree.
+ *
+ * Leaves store a fattened AABB, so objects moving inside it don't touch the
+ * tree at all. Leaves are reinserted (using the surface area heuristic and
+ * AVL-like rotations to keep the tree balanced) only when the object leaves
+ * its fat AABB, and pairs for those leaves are found in one batch during
+ * update(). Pairs are based on fat AABBs, the narrow phase takes care of the
+ * exact overlap.
+ */
+
+class BroadPhaseAABBTree : public BroadPhaseSW, private AABBTree {
+
+	struct Element {
+
+		CollisionObjectSW *owner; // NULL if free
+		AABB aabb;
+		int subindex;
+		int leaf;
+		bool _static;
+		bool moved;
+		Vector<ID> pairs;
+	};
+
+	int root;
+
+	Vector<Element> elements; // indexed by ID - 1
+	Vector<ID> free_elements;
+	Vector<ID> move_buffer;
+
+	HashMap<uint64_t, void *> pair_map;
+
+	PairCallback pair_callback;
+	void *pair_userdata;
+	UnpairCallback unpair_callback;
+	void *unpair_userdata;
+
+	_FORCE_INLINE_ static uint64_t _pair_key(ID p_a, ID p_b) {
+		return p_a < p_b ? (uint64_t(p_a) << 32) | p_b : (uint64_t(p_b) << 32) | p_a;
+	}
+
+	void _queue_move(ID p_id);
+	bool _test_pair(ID p_a, ID p_b) const;
+	void _pair(ID p_a, ID p_b);
+	void _unpair(ID p_a, ID p_b);
+
+public:
+	// 0 is an invalid ID
+	virtual ID create(CollisionObjectSW *p_object, int p_subindex = 0);
+	virtual void move(ID p_id, const AABB &p_aabb);
+	virtual void set_static(ID p_id, bool p_static);
+	virtual void remove(ID p_id);
+
+	virtual CollisionObjectSW *get_object(ID p_id) const;
+	virtual bool is_static(ID p_id) const;
+	virtual int get_subindex(ID p_id) const;
+
+	virtual int cull_point(const Vector3 &p_point, CollisionObjectSW **p_results, int p_max_results, int *p_result_indices = NULL);
+	virtual int cull_segment(const Vector3 &p_from, const Vector3 &p_to, CollisionObjectSW **p_results, int p_max_results, int *p_result_indices = NULL);
+	virtual int cull_aabb(const AABB &p_aabb, CollisionObjectSW **p_results, int p_max_results, int *p_result_indices = NULL);
+
+	virtual void set_pair_callback(PairCallback p_pair_callback, void *p_userdata);
+	virtual void set_unpair_callback(UnpairCallback p_unpair_callback, void *p_userdata);
+
+	virtual void update();
+
+	int get_tree_height() const;
+
+	static BroadPhaseSW *_create();
+	BroadPhaseAABBTree();
+};
+
+#endif // BROAD_PHASE_AABB_TREE_H
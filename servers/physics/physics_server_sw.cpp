@@ -30,9 +30,11 @@
 
 #include "physics_server_sw.h"
 
+#include "broad_phase_aabb_tree.h"
 #include "broad_phase_basic.h"
 #include "broad_phase_octree.h"
 #include "core/os/os.h"
+#include "core/project_settings.h"
 #include "core/script_language.h"
 #include "joints/cone_twist_joint_sw.h"
 #include "joints/generic_6dof_joint_sw.h"
@@ -1436,12 +1438,14 @@ void PhysicsServerSW::step(real_t p_step) {
 	island_count = 0;
 	active_objects = 0;
 	collision_pairs = 0;
+	island_solve_time = 0;
 	for (Set<const SpaceSW *>::Element *E = active_spaces.front(); E; E = E->next()) {
 
 		stepper->step((SpaceSW *)E->get(), p_step, iterations);
 		island_count += E->get()->get_island_count();
 		active_objects += E->get()->get_active_objects();
 		collision_pairs += E->get()->get_collision_pairs();
+		island_solve_time = MAX(island_solve_time, stepper->get_max_island_solve_time());
 	}
 #endif
 }
@@ -1524,6 +1528,10 @@ int PhysicsServerSW::get_process_info(ProcessInfo p_info) {
 
 			return island_count;
 		} break;
+		case INFO_ISLAND_SOLVE_TIME: {
+
+			return island_solve_time;
+		} break;
 	}
 
 	return 0;
@@ -1574,10 +1582,19 @@ void PhysicsServerSW::_shape_col_cbk(const Vector3 &p_point_A, const Vector3 &p_
 PhysicsServerSW *PhysicsServerSW::singleton = NULL;
 PhysicsServerSW::PhysicsServerSW() {
 	singleton = this;
-	BroadPhaseSW::create_func = BroadPhaseOctree::_create;
+
+	int broadphase = GLOBAL_DEF_RST("physics/3d/broadphase", 0);
+	ProjectSettings::get_singleton()->set_custom_property_info("physics/3d/broadphase", PropertyInfo(Variant::INT, "physics/3d/broadphase", PROPERTY_HINT_ENUM, "Octree,AABB Tree"));
+	if (broadphase == 1) {
+		BroadPhaseSW::create_func = BroadPhaseAABBTree::_create;
+	} else {
+		BroadPhaseSW::create_func = BroadPhaseOctree::_create;
+	}
+
 	island_count = 0;
 	active_objects = 0;
 	collision_pairs = 0;
+	island_solve_time = 0;
 
 	active = true;
 };
@@ -50,6 +50,7 @@ class PhysicsServerSW : public PhysicsServer {
 	int island_count;
 	int active_objects;
 	int collision_pairs;
+	uint64_t island_solve_time;
 
 	StepSW *stepper;
 	Set<const SpaceSW *> active_spaces;
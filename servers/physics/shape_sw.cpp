@@ -33,6 +33,7 @@
 #include "core/math/geometry.h"
 #include "core/math/quick_hull.h"
 #include "core/sort.h"
+#include "vertex_scan_sw.h"
 
 #define _POINT_SNAP 0.001953125
 #define _EDGE_IS_VALID_SUPPORT_THRESHOLD 0.0002
@@ -729,6 +730,16 @@ void ConvexPolygonShapeSW::project_range(const Vector3 &p_normal, const Transfor
 
 	const Vector3 *vrts = &mesh.vertices[0];
 
+	if (VertexScanSW::is_simd_enabled()) {
+
+		// Project on the axis brought to local space instead of transforming every vertex.
+		VertexScanSW::project_range(vrts, vertex_count, p_transform.basis.xform_inv(p_normal), r_min, r_max);
+		real_t ofs = p_normal.dot(p_transform.origin);
+		r_min += ofs;
+		r_max += ofs;
+		return;
+	}
+
 	for (int i = 0; i < vertex_count; i++) {
 
 		real_t d = p_normal.dot(p_transform.xform(vrts[i]));
@@ -742,28 +753,13 @@ void ConvexPolygonShapeSW::project_range(const Vector3 &p_normal, const Transfor
 
 Vector3 ConvexPolygonShapeSW::get_support(const Vector3 &p_normal) const {
 
-	Vector3 n = p_normal;
-
-	int vert_support_idx = -1;
-	real_t support_max = 0;
-
 	int vertex_count = mesh.vertices.size();
 	if (vertex_count == 0)
 		return Vector3();
 
 	const Vector3 *vrts = &mesh.vertices[0];
 
-	for (int i = 0; i < vertex_count; i++) {
-
-		real_t d = n.dot(vrts[i]);
-
-		if (i == 0 || d > support_max) {
-			support_max = d;
-			vert_support_idx = i;
-		}
-	}
-
-	return vrts[vert_support_idx];
+	return vrts[VertexScanSW::get_support(vrts, vertex_count, p_normal)];
 }
 
 void ConvexPolygonShapeSW::get_supports(const Vector3 &p_normal, int p_max, Vector3 *r_supports, int &r_amount) const {
@@ -778,18 +774,7 @@ void ConvexPolygonShapeSW::get_supports(const Vector3 &p_normal, int p_max, Vect
 	int vc = mesh.vertices.size();
 
 	//find vertex first
-	real_t max = 0;
-	int vtx = 0;
-
-	for (int i = 0; i < vc; i++) {
-
-		real_t d = p_normal.dot(vertices[i]);
-
-		if (i == 0 || d > max) {
-			max = d;
-			vtx = i;
-		}
-	}
+	int vtx = vc ? VertexScanSW::get_support(vertices, vc, p_normal) : 0;
 
 	for (int i = 0; i < fc; i++) {
 
@@ -32,6 +32,9 @@
 #include "joints_sw.h"
 
 #include "core/os/os.h"
+#include "core/os/worker_thread_pool.h"
+#include "core/project_settings.h"
+#include "core/safe_refcount.h"
 
 void StepSW::_populate_island(BodySW *p_body, BodySW **p_island, ConstraintSW **p_constraint_island) {
 
@@ -107,6 +110,15 @@ void StepSW::_solve_island(ConstraintSW *p_island, int p_iterations, real_t p_de
 	}
 }
 
+void StepSW::_solve_island_threaded(uint32_t p_index, void *p_userdata) {
+
+	uint64_t begtime = OS::get_singleton()->get_ticks_usec();
+
+	_solve_island(constraint_islands[p_index], solve_iterations, solve_delta);
+
+	atomic_exchange_if_greater(&max_island_solve_time, OS::get_singleton()->get_ticks_usec() - begtime);
+}
+
 void StepSW::_check_suspend(BodySW *p_island, real_t p_delta) {
 
 	bool can_sleep = true;
@@ -248,12 +260,31 @@ void StepSW::step(SpaceSW *p_space, real_t p_delta, int p_iterations) {
 	/* SOLVE CONSTRAINT ISLANDS */
 
 	{
+		// Islands share no dynamic bodies, so they can be solved concurrently.
+		// Static and kinematic bodies may be shared, the solvers only read them
+		// as BodySW skips impulses on them. Each island is solved exactly as it
+		// would be serially, so results don't depend on the thread count.
+		int count = 0;
 		ConstraintSW *ci = constraint_island_list;
 		while (ci) {
-			//iterating each island separatedly improves cache efficiency
-			_solve_island(ci, p_iterations, p_delta);
+			count++;
 			ci = ci->get_island_list_next();
 		}
+
+		constraint_islands.resize(count);
+		ConstraintSW **islands = constraint_islands.ptrw();
+		ci = constraint_island_list;
+		for (int i = 0; i < count; i++) {
+			islands[i] = ci;
+			ci = ci->get_island_list_next();
+		}
+
+		solve_iterations = p_iterations;
+		solve_delta = p_delta;
+		max_island_solve_time = 0;
+
+		//iterating each island separatedly improves cache efficiency
+		WorkerThreadPool::get_singleton()->parallel_for(count, 1, this, &StepSW::_solve_island_threaded, (void *)NULL, solver_threads);
 	}
 
 	{ //profile
@@ -296,4 +327,10 @@ void StepSW::step(SpaceSW *p_space, real_t p_delta, int p_iterations) {
 StepSW::StepSW() {
 
 	_step = 1;
+	solve_iterations = 0;
+	solve_delta = 0;
+	max_island_solve_time = 0;
+
+	solver_threads = GLOBAL_DEF("physics/3d/solver/thread_count", -1);
+	ProjectSettings::get_singleton()->set_custom_property_info("physics/3d/solver/thread_count", PropertyInfo(Variant::INT, "physics/3d/solver/thread_count", PROPERTY_HINT_RANGE, "-1,256,1"));
 }
@@ -37,13 +37,24 @@ class StepSW {
 
 	uint64_t _step;
 
+	int solver_threads;
+
+	Vector<ConstraintSW *> constraint_islands;
+	int solve_iterations;
+	real_t solve_delta;
+	volatile uint64_t max_island_solve_time;
+
 	void _populate_island(BodySW *p_body, BodySW **p_island, ConstraintSW **p_constraint_island);
 	void _setup_island(ConstraintSW *p_island, real_t p_delta);
 	void _solve_island(ConstraintSW *p_island, int p_iterations, real_t p_delta);
+	void _solve_island_threaded(uint32_t p_index, void *p_userdata);
 	void _check_suspend(BodySW *p_island, real_t p_delta);
 
 public:
 	void step(SpaceSW *p_space, real_t p_delta, int p_iterations);
+
+	uint64_t get_max_island_solve_time() const { return max_island_solve_time; }
+
 	StepSW();
 };
 
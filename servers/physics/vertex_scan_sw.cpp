@@ -0,0 +1,313 @@
+/*************************************************************************/
+/*  vertex_scan_sw.cpp                                                   */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2018 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2018 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "vertex_scan_sw.h"
+
+#ifndef REAL_T_IS_DOUBLE
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define VERTEX_SCAN_SSE2
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define VERTEX_SCAN_NEON
+#include <arm_neon.h>
+#endif
+#endif
+
+bool VertexScanSW::simd_enabled = true;
+
+void VertexScanSW::project_range_scalar(const Vector3 *p_vertices, int p_count, const Vector3 &p_axis, real_t &r_min, real_t &r_max) {
+
+	for (int i = 0; i < p_count; i++) {
+
+		real_t d = p_axis.dot(p_vertices[i]);
+
+		if (i == 0 || d > r_max)
+			r_max = d;
+		if (i == 0 || d < r_min)
+			r_min = d;
+	}
+}
+
+int VertexScanSW::get_support_scalar(const Vector3 *p_vertices, int p_count, const Vector3 &p_dir) {
+
+	int idx = -1;
+	real_t max = 0;
+
+	for (int i = 0; i < p_count; i++) {
+
+		real_t d = p_dir.dot(p_vertices[i]);
+
+		if (i == 0 || d > max) {
+			max = d;
+			idx = i;
+		}
+	}
+
+	return idx;
+}
+
+#ifdef VERTEX_SCAN_SSE2
+
+// Loads four packed Vector3 (12 floats) and transposes them to x, y, z lanes.
+static _FORCE_INLINE_ void _load_soa(const float *p_src, __m128 &r_x, __m128 &r_y, __m128 &r_z) {
+
+	__m128 a = _mm_loadu_ps(p_src); // x0 y0 z0 x1
+	__m128 b = _mm_loadu_ps(p_src + 4); // y1 z1 x2 y2
+	__m128 c = _mm_loadu_ps(p_src + 8); // z2 x3 y3 z3
+
+	r_x = _mm_shuffle_ps(a, _mm_shuffle_ps(b, c, _MM_SHUFFLE(1, 0, 0, 2)), _MM_SHUFFLE(3, 0, 3, 0));
+	r_y = _mm_shuffle_ps(_mm_shuffle_ps(a, b, _MM_SHUFFLE(0, 0, 1, 1)), _mm_shuffle_ps(b, c, _MM_SHUFFLE(2, 2, 3, 3)), _MM_SHUFFLE(2, 0, 2, 0));
+	r_z = _mm_shuffle_ps(_mm_shuffle_ps(a, b, _MM_SHUFFLE(1, 1, 2, 2)), _mm_shuffle_ps(c, c, _MM_SHUFFLE(3, 3, 0, 0)), _MM_SHUFFLE(2, 0, 2, 0));
+}
+
+static _FORCE_INLINE_ __m128 _dot4(const float *p_src, const __m128 &p_ax, const __m128 &p_ay, const __m128 &p_az) {
+
+	__m128 x, y, z;
+	_load_soa(p_src, x, y, z);
+	return _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, p_ax), _mm_mul_ps(y, p_ay)), _mm_mul_ps(z, p_az));
+}
+
+static int _project_range_simd(const Vector3 *p_vertices, int p_count, const Vector3 &p_axis, real_t &r_min, real_t &r_max) {
+
+	int blocks = p_count / 4;
+	if (blocks == 0)
+		return 0;
+
+	const float *src = &p_vertices[0].x;
+	__m128 ax = _mm_set1_ps(p_axis.x);
+	__m128 ay = _mm_set1_ps(p_axis.y);
+	__m128 az = _mm_set1_ps(p_axis.z);
+
+	__m128 vmin = _dot4(src, ax, ay, az);
+	__m128 vmax = vmin;
+
+	for (int i = 1; i < blocks; i++) {
+
+		__m128 d = _dot4(src + i * 12, ax, ay, az);
+		vmin = _mm_min_ps(vmin, d);
+		vmax = _mm_max_ps(vmax, d);
+	}
+
+	float mins[4], maxs[4];
+	_mm_storeu_ps(mins, vmin);
+	_mm_storeu_ps(maxs, vmax);
+
+	r_min = MIN(MIN(mins[0], mins[1]), MIN(mins[2], mins[3]));
+	r_max = MAX(MAX(maxs[0], maxs[1]), MAX(maxs[2], maxs[3]));
+
+	return blocks * 4;
+}
+
+static int _get_support_simd(const Vector3 *p_vertices, int p_count, const Vector3 &p_dir, real_t &r_max) {
+
+	int blocks = p_count / 4;
+	if (blocks == 0)
+		return -1;
+
+	const float *src = &p_vertices[0].x;
+	__m128 ax = _mm_set1_ps(p_dir.x);
+	__m128 ay = _mm_set1_ps(p_dir.y);
+	__m128 az = _mm_set1_ps(p_dir.z);
+
+	__m128 best = _dot4(src, ax, ay, az);
+	__m128i best_idx = _mm_set_epi32(3, 2, 1, 0);
+	__m128i idx = best_idx;
+	const __m128i four = _mm_set1_epi32(4);
+
+	for (int i = 1; i < blocks; i++) {
+
+		__m128 d = _dot4(src + i * 12, ax, ay, az);
+		idx = _mm_add_epi32(idx, four);
+
+		// Strictly greater keeps the first occurrence in every lane.
+		__m128 gt = _mm_cmpgt_ps(d, best);
+		__m128i gti = _mm_castps_si128(gt);
+		best = _mm_or_ps(_mm_and_ps(gt, d), _mm_andnot_ps(gt, best));
+		best_idx = _mm_or_si128(_mm_and_si128(gti, idx), _mm_andnot_si128(gti, best_idx));
+	}
+
+	float vals[4];
+	int32_t idxs[4];
+	_mm_storeu_ps(vals, best);
+	_mm_storeu_si128((__m128i *)idxs, best_idx);
+
+	int res = idxs[0];
+	r_max = vals[0];
+	for (int i = 1; i < 4; i++) {
+		if (vals[i] > r_max || (vals[i] == r_max && idxs[i] < res)) {
+			r_max = vals[i];
+			res = idxs[i];
+		}
+	}
+
+	return res;
+}
+
+#elif defined(VERTEX_SCAN_NEON)
+
+static _FORCE_INLINE_ float32x4_t _dot4(const float *p_src, const float32x4_t &p_ax, const float32x4_t &p_ay, const float32x4_t &p_az) {
+
+	float32x4x3_t v = vld3q_f32(p_src);
+	return vaddq_f32(vaddq_f32(vmulq_f32(v.val[0], p_ax), vmulq_f32(v.val[1], p_ay)), vmulq_f32(v.val[2], p_az));
+}
+
+static int _project_range_simd(const Vector3 *p_vertices, int p_count, const Vector3 &p_axis, real_t &r_min, real_t &r_max) {
+
+	int blocks = p_count / 4;
+	if (blocks == 0)
+		return 0;
+
+	const float *src = &p_vertices[0].x;
+	float32x4_t ax = vdupq_n_f32(p_axis.x);
+	float32x4_t ay = vdupq_n_f32(p_axis.y);
+	float32x4_t az = vdupq_n_f32(p_axis.z);
+
+	float32x4_t vmin = _dot4(src, ax, ay, az);
+	float32x4_t vmax = vmin;
+
+	for (int i = 1; i < blocks; i++) {
+
+		float32x4_t d = _dot4(src + i * 12, ax, ay, az);
+		vmin = vminq_f32(vmin, d);
+		vmax = vmaxq_f32(vmax, d);
+	}
+
+	float mins[4], maxs[4];
+	vst1q_f32(mins, vmin);
+	vst1q_f32(maxs, vmax);
+
+	r_min = MIN(MIN(mins[0], mins[1]), MIN(mins[2], mins[3]));
+	r_max = MAX(MAX(maxs[0], maxs[1]), MAX(maxs[2], maxs[3]));
+
+	return blocks * 4;
+}
+
+static int _get_support_simd(const Vector3 *p_vertices, int p_count, const Vector3 &p_dir, real_t &r_max) {
+
+	int blocks = p_count / 4;
+	if (blocks == 0)
+		return -1;
+
+	const float *src = &p_vertices[0].x;
+	float32x4_t ax = vdupq_n_f32(p_dir.x);
+	float32x4_t ay = vdupq_n_f32(p_dir.y);
+	float32x4_t az = vdupq_n_f32(p_dir.z);
+
+	static const uint32_t first_idx[4] = { 0, 1, 2, 3 };
+	float32x4_t best = _dot4(src, ax, ay, az);
+	uint32x4_t best_idx = vld1q_u32(first_idx);
+	uint32x4_t idx = best_idx;
+	const uint32x4_t four = vdupq_n_u32(4);
+
+	for (int i = 1; i < blocks; i++) {
+
+		float32x4_t d = _dot4(src + i * 12, ax, ay, az);
+		idx = vaddq_u32(idx, four);
+
+		// Strictly greater keeps the first occurrence in every lane.
+		uint32x4_t gt = vcgtq_f32(d, best);
+		best = vbslq_f32(gt, d, best);
+		best_idx = vbslq_u32(gt, idx, best_idx);
+	}
+
+	float vals[4];
+	uint32_t idxs[4];
+	vst1q_f32(vals, best);
+	vst1q_u32(idxs, best_idx);
+
+	int res = idxs[0];
+	r_max = vals[0];
+	for (int i = 1; i < 4; i++) {
+		if (vals[i] > r_max || (vals[i] == r_max && (int)idxs[i] < res)) {
+			r_max = vals[i];
+			res = idxs[i];
+		}
+	}
+
+	return res;
+}
+
+#endif
+
+void VertexScanSW::project_range(const Vector3 *p_vertices, int p_count, const Vector3 &p_axis, real_t &r_min, real_t &r_max) {
+
+#if defined(VERTEX_SCAN_SSE2) || defined(VERTEX_SCAN_NEON)
+	if (simd_enabled) {
+
+		int done = _project_range_simd(p_vertices, p_count, p_axis, r_min, r_max);
+
+		for (int i = done; i < p_count; i++) {
+
+			real_t d = p_axis.dot(p_vertices[i]);
+
+			if (i == 0 || d > r_max)
+				r_max = d;
+			if (i == 0 || d < r_min)
+				r_min = d;
+		}
+		return;
+	}
+#endif
+	project_range_scalar(p_vertices, p_count, p_axis, r_min, r_max);
+}
+
+int VertexScanSW::get_support(const Vector3 *p_vertices, int p_count, const Vector3 &p_dir) {
+
+#if defined(VERTEX_SCAN_SSE2) || defined(VERTEX_SCAN_NEON)
+	if (simd_enabled) {
+
+		real_t max = 0;
+		int idx = _get_support_simd(p_vertices, p_count, p_dir, max);
+
+		// The remainder comes after every vertex scanned above, so only a
+		// strictly greater value may replace the support found so far.
+		for (int i = (p_count / 4) * 4; i < p_count; i++) {
+
+			real_t d = p_dir.dot(p_vertices[i]);
+
+			if (idx < 0 || d > max) {
+				max = d;
+				idx = i;
+			}
+		}
+		return idx;
+	}
+#endif
+	return get_support_scalar(p_vertices, p_count, p_dir);
+}
+
+bool VertexScanSW::has_simd() {
+
+#if defined(VERTEX_SCAN_SSE2) || defined(VERTEX_SCAN_NEON)
+	return true;
+#else
+	return false;
+#endif
+}
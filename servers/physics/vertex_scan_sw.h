@@ -0,0 +1,65 @@
+/*************************************************************************/
+/*  vertex_scan_sw.h                                                     */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2018 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2018 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef VERTEX_SCAN_SW_H
+#define VERTEX_SCAN_SW_H
+
+#include "core/math/vector3.h"
+
+/**
+ * Vertex scans used by the narrow phase: projecting a point cloud on an axis
+ * (SAT) and finding its support vertex (SAT contact generation, GJK/EPA).
+ *
+ * The kernels process four vertices at a time using SSE2 or NEON when the
+ * engine is built with single precision floats for a platform providing them,
+ * and fall back to the scalar loop otherwise. Dot products are evaluated in
+ * the same order as Vector3::dot() and ties resolve to the lowest index, so
+ * both paths return the same results.
+ */
+
+class VertexScanSW {
+
+	static bool simd_enabled;
+
+public:
+	static void project_range_scalar(const Vector3 *p_vertices, int p_count, const Vector3 &p_axis, real_t &r_min, real_t &r_max);
+	static int get_support_scalar(const Vector3 *p_vertices, int p_count, const Vector3 &p_dir);
+
+	static void project_range(const Vector3 *p_vertices, int p_count, const Vector3 &p_axis, real_t &r_min, real_t &r_max);
+	static int get_support(const Vector3 *p_vertices, int p_count, const Vector3 &p_dir);
+
+	static bool has_simd();
+
+	// Only meant to compare against the scalar reference (tests, benchmarks).
+	static void set_simd_enabled(bool p_enabled) { simd_enabled = p_enabled; }
+	static bool is_simd_enabled() { return simd_enabled && has_simd(); }
+};
+
+#endif // VERTEX_SCAN_SW_H
@@ -77,6 +77,7 @@ class BodyPair2DSW : public Constraint2DSW {
 	Contact contacts[MAX_CONTACTS];
 	int contact_count;
 	bool collided;
+	bool can_collide;
 	bool oneway_disabled;
 	int cc;
 
@@ -86,6 +87,7 @@ class BodyPair2DSW : public Constraint2DSW {
 	_FORCE_INLINE_ void _contact_added_callback(const Vector2 &p_point_A, const Vector2 &p_point_B);
 
 public:
+	void pre_setup(real_t p_step);
 	bool setup(real_t p_step);
 	void solve(real_t p_step);
 
@@ -29,6 +29,7 @@
 /*************************************************************************/
 
 #include "broad_phase_2d_basic.h"
+#include "core/list.h"
 
 BroadPhase2DBasic::ID BroadPhase2DBasic::create(CollisionObject2DSW *p_object_, int p_subindex) {
 
@@ -59,6 +60,25 @@ void BroadPhase2DBasic::remove(ID p_id) {
 
 	Map<ID, Element>::Element *E = element_map.find(p_id);
 	ERR_FAIL_COND(!E);
+	List<PairKey> to_erase;
+	//unpair must be done immediately on removal to avoid potential invalid pointers
+	for (Map<PairKey, void *>::Element *F = pair_map.front(); F; F = F->next()) {
+
+		if (F->key().a == p_id || F->key().b == p_id) {
+
+			if (unpair_callback) {
+				Element *elem_A = &element_map[F->key().a];
+				Element *elem_B = &element_map[F->key().b];
+				unpair_callback(elem_A->owner, elem_A->subindex, elem_B->owner, elem_B->subindex, F->get(), unpair_userdata);
+			}
+			to_erase.push_back(F->key());
+		}
+	}
+	while (to_erase.size()) {
+
+		pair_map.erase(to_erase.front()->get());
+		to_erase.pop_front();
+	}
 	element_map.erase(E);
 }
 
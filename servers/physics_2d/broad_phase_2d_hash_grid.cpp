@@ -97,50 +97,56 @@ void BroadPhase2DHashGrid::_check_motion(Element *p_elem) {
 	}
 }
 
-void BroadPhase2DHashGrid::_enter_grid(Element *p_elem, const Rect2 &p_rect, bool p_static) {
+int BroadPhase2DHashGrid::_get_level(const Rect2 &p_rect) const {
 
 	Vector2 sz = (p_rect.size / cell_size * LARGE_ELEMENT_FI); //use magic number to avoid floating point issues
-	if (sz.width * sz.height > large_object_min_surface) {
-		//large object, do not use grid, must check against all elements
-		for (Map<ID, Element>::Element *E = element_map.front(); E; E = E->next()) {
-			if (E->key() == p_elem->self)
-				continue; // do not pair against itself
-			if (E->get().owner == p_elem->owner)
-				continue;
-			if (E->get()._static && p_static)
-				continue;
 
-			_pair_attempt(p_elem, &E->get());
-		}
+	for (int i = 0; i < GRID_LEVELS; i++) {
 
-		large_elements[p_elem].inc();
-		return;
+		if (sz.width * sz.height <= large_object_min_surface)
+			return i;
+		sz /= GRID_LEVEL_SCALE;
 	}
 
-	Point2i from = (p_rect.position / cell_size).floor();
-	Point2i to = ((p_rect.position + p_rect.size) / cell_size).floor();
+	return -1; // too large even for the coarsest level
+}
 
-	for (int i = from.x; i <= to.x; i++) {
+void BroadPhase2DHashGrid::_get_cells(const Rect2 &p_rect, int p_level, Point2i &r_from, Point2i &r_to) const {
 
-		for (int j = from.y; j <= to.y; j++) {
+	r_from = (p_rect.position / level_cell_size[p_level]).floor();
+	r_to = ((p_rect.position + p_rect.size) / level_cell_size[p_level]).floor();
+}
 
-			PosKey pk;
-			pk.x = i;
-			pk.y = j;
+BroadPhase2DHashGrid::PosBin *BroadPhase2DHashGrid::_get_bin(const PosKey &p_key, uint32_t &r_idx) const {
 
-			uint32_t idx = pk.hash() % hash_table_size;
-			PosBin *pb = hash_table[idx];
+	r_idx = p_key.hash() % hash_table_size;
+	PosBin *pb = hash_table[r_idx];
 
-			while (pb) {
+	while (pb) {
 
-				if (pb->key == pk) {
-					break;
-				}
+		if (pb->key == p_key) {
+			break;
+		}
 
-				pb = pb->next;
-			}
+		pb = pb->next;
+	}
+
+	return pb;
+}
+
+void BroadPhase2DHashGrid::_enter_cells(Element *p_elem, int p_level, const Point2i &p_from, const Point2i &p_to, bool p_small, bool p_static) {
+
+	for (int i = p_from.x; i <= p_to.x; i++) {
 
-			bool entered = false;
+		for (int j = p_from.y; j <= p_to.y; j++) {
+
+			PosKey pk;
+			pk.x = i;
+			pk.y = j;
+			pk.level = p_level;
+
+			uint32_t idx;
+			PosBin *pb = _get_bin(pk, idx);
 
 			if (!pb) {
 				//does not exist, create!
@@ -150,115 +156,74 @@ void BroadPhase2DHashGrid::_enter_grid(Element *p_elem, const Rect2 &p_rect, boo
 				hash_table[idx] = pb;
 			}
 
-			if (p_static) {
-				if (pb->static_object_set[p_elem].inc() == 1) {
-					entered = true;
-				}
-			} else {
-				if (pb->object_set[p_elem].inc() == 1) {
+			Map<Element *, RC> &set = p_small ? (p_static ? pb->small_static_object_set : pb->small_object_set) : (p_static ? pb->static_object_set : pb->object_set);
 
-					entered = true;
-				}
+			if (set[p_elem].inc() != 1)
+				continue;
+
+			// elements of this level pair with everything in the cell, small ones only with elements of this level
+
+			for (Map<Element *, RC>::Element *E = pb->object_set.front(); E; E = E->next()) {
+
+				if (E->key()->owner == p_elem->owner)
+					continue;
+				_pair_attempt(p_elem, E->key());
 			}
 
-			if (entered) {
+			if (!p_static) {
 
-				for (Map<Element *, RC>::Element *E = pb->object_set.front(); E; E = E->next()) {
+				for (Map<Element *, RC>::Element *E = pb->static_object_set.front(); E; E = E->next()) {
 
 					if (E->key()->owner == p_elem->owner)
 						continue;
 					_pair_attempt(p_elem, E->key());
 				}
-
-				if (!p_static) {
-
-					for (Map<Element *, RC>::Element *E = pb->static_object_set.front(); E; E = E->next()) {
-
-						if (E->key()->owner == p_elem->owner)
-							continue;
-						_pair_attempt(p_elem, E->key());
-					}
-				}
 			}
-		}
-	}
-
-	//pair separatedly with large elements
-
-	for (Map<Element *, RC>::Element *E = large_elements.front(); E; E = E->next()) {
 
-		if (E->key() == p_elem)
-			continue; // do not pair against itself
-		if (E->key()->owner == p_elem->owner)
-			continue;
-		if (E->key()->_static && p_static)
-			continue;
+			if (p_small)
+				continue;
 
-		_pair_attempt(E->key(), p_elem);
-	}
-}
+			for (Map<Element *, RC>::Element *E = pb->small_object_set.front(); E; E = E->next()) {
 
-void BroadPhase2DHashGrid::_exit_grid(Element *p_elem, const Rect2 &p_rect, bool p_static) {
+				if (E->key()->owner == p_elem->owner)
+					continue;
+				_pair_attempt(p_elem, E->key());
+			}
 
-	Vector2 sz = (p_rect.size / cell_size * LARGE_ELEMENT_FI);
-	if (sz.width * sz.height > large_object_min_surface) {
+			if (!p_static) {
 
-		//unpair all elements, instead of checking all, just check what is already paired, so we at least save from checking static vs static
-		Map<Element *, PairData *>::Element *E = p_elem->paired.front();
-		while (E) {
-			Map<Element *, PairData *>::Element *next = E->next();
-			_unpair_attempt(p_elem, E->key());
-			E = next;
-		}
+				for (Map<Element *, RC>::Element *E = pb->small_static_object_set.front(); E; E = E->next()) {
 
-		if (large_elements[p_elem].dec() == 0) {
-			large_elements.erase(p_elem);
+					if (E->key()->owner == p_elem->owner)
+						continue;
+					_pair_attempt(p_elem, E->key());
+				}
+			}
 		}
-		return;
 	}
+}
 
-	Point2i from = (p_rect.position / cell_size).floor();
-	Point2i to = ((p_rect.position + p_rect.size) / cell_size).floor();
+void BroadPhase2DHashGrid::_exit_cells(Element *p_elem, int p_level, const Point2i &p_from, const Point2i &p_to, bool p_small, bool p_static) {
 
-	for (int i = from.x; i <= to.x; i++) {
+	for (int i = p_from.x; i <= p_to.x; i++) {
 
-		for (int j = from.y; j <= to.y; j++) {
+		for (int j = p_from.y; j <= p_to.y; j++) {
 
 			PosKey pk;
 			pk.x = i;
 			pk.y = j;
+			pk.level = p_level;
 
-			uint32_t idx = pk.hash() % hash_table_size;
-			PosBin *pb = hash_table[idx];
-
-			while (pb) {
-
-				if (pb->key == pk) {
-					break;
-				}
-
-				pb = pb->next;
-			}
+			uint32_t idx;
+			PosBin *pb = _get_bin(pk, idx);
 
 			ERR_CONTINUE(!pb); //should exist!!
 
-			bool exited = false;
-
-			if (p_static) {
-				if (pb->static_object_set[p_elem].dec() == 0) {
-
-					pb->static_object_set.erase(p_elem);
-					exited = true;
-				}
-			} else {
-				if (pb->object_set[p_elem].dec() == 0) {
+			Map<Element *, RC> &set = p_small ? (p_static ? pb->small_static_object_set : pb->small_object_set) : (p_static ? pb->static_object_set : pb->object_set);
 
-					pb->object_set.erase(p_elem);
-					exited = true;
-				}
-			}
+			if (set[p_elem].dec() == 0) {
 
-			if (exited) {
+				set.erase(p_elem);
 
 				for (Map<Element *, RC>::Element *E = pb->object_set.front(); E; E = E->next()) {
 
@@ -276,9 +241,29 @@ void BroadPhase2DHashGrid::_exit_grid(Element *p_elem, const Rect2 &p_rect, bool
 						_unpair_attempt(p_elem, E->key());
 					}
 				}
+
+				if (!p_small) {
+
+					for (Map<Element *, RC>::Element *E = pb->small_object_set.front(); E; E = E->next()) {
+
+						if (E->key()->owner == p_elem->owner)
+							continue;
+						_unpair_attempt(p_elem, E->key());
+					}
+
+					if (!p_static) {
+
+						for (Map<Element *, RC>::Element *E = pb->small_static_object_set.front(); E; E = E->next()) {
+
+							if (E->key()->owner == p_elem->owner)
+								continue;
+							_unpair_attempt(p_elem, E->key());
+						}
+					}
+				}
 			}
 
-			if (pb->object_set.empty() && pb->static_object_set.empty()) {
+			if (pb->object_set.empty() && pb->static_object_set.empty() && pb->small_object_set.empty() && pb->small_static_object_set.empty()) {
 
 				if (hash_table[idx] == pb) {
 					hash_table[idx] = pb->next;
@@ -303,6 +288,79 @@ void BroadPhase2DHashGrid::_exit_grid(Element *p_elem, const Rect2 &p_rect, bool
 			}
 		}
 	}
+}
+
+void BroadPhase2DHashGrid::_enter_grid(Element *p_elem, const Rect2 &p_rect, bool p_static) {
+
+	int level = _get_level(p_rect);
+
+	if (level < 0) {
+		//large object, do not use grid, must check against all elements
+		for (Map<ID, Element>::Element *E = element_map.front(); E; E = E->next()) {
+			if (E->key() == p_elem->self)
+				continue; // do not pair against itself
+			if (E->get().owner == p_elem->owner)
+				continue;
+			if (E->get()._static && p_static)
+				continue;
+			if (E->get().aabb == Rect2())
+				continue; // not in the grid, will pair with large elements when entering it
+
+			_pair_attempt(p_elem, &E->get());
+		}
+
+		large_elements[p_elem].inc();
+		return;
+	}
+
+	for (int i = level; i < GRID_LEVELS; i++) {
+
+		Point2i from, to;
+		_get_cells(p_rect, i, from, to);
+		_enter_cells(p_elem, i, from, to, i != level, p_static);
+	}
+
+	//pair separatedly with large elements
+
+	for (Map<Element *, RC>::Element *E = large_elements.front(); E; E = E->next()) {
+
+		if (E->key() == p_elem)
+			continue; // do not pair against itself
+		if (E->key()->owner == p_elem->owner)
+			continue;
+		if (E->key()->_static && p_static)
+			continue;
+
+		_pair_attempt(E->key(), p_elem);
+	}
+}
+
+void BroadPhase2DHashGrid::_exit_grid(Element *p_elem, const Rect2 &p_rect, bool p_static) {
+
+	int level = _get_level(p_rect);
+
+	if (level < 0) {
+
+		//unpair all elements, instead of checking all, just check what is already paired, so we at least save from checking static vs static
+		Map<Element *, PairData *>::Element *E = p_elem->paired.front();
+		while (E) {
+			Map<Element *, PairData *>::Element *next = E->next();
+			_unpair_attempt(p_elem, E->key());
+			E = next;
+		}
+
+		if (large_elements[p_elem].dec() == 0) {
+			large_elements.erase(p_elem);
+		}
+		return;
+	}
+
+	for (int i = level; i < GRID_LEVELS; i++) {
+
+		Point2i from, to;
+		_get_cells(p_rect, i, from, to);
+		_exit_cells(p_elem, i, from, to, i != level, p_static);
+	}
 
 	for (Map<Element *, RC>::Element *E = large_elements.front(); E; E = E->next()) {
 		if (E->key() == p_elem)
@@ -317,6 +375,49 @@ void BroadPhase2DHashGrid::_exit_grid(Element *p_elem, const Rect2 &p_rect, bool
 	}
 }
 
+void BroadPhase2DHashGrid::_move_in_grid(Element *p_elem, const Rect2 &p_from_rect, const Rect2 &p_to_rect) {
+
+	int from_level = _get_level(p_from_rect);
+	int to_level = _get_level(p_to_rect);
+
+	if (from_level < 0 && to_level < 0)
+		return; // large elements are paired with everything already
+
+	if (from_level < 0 || to_level < 0) {
+		// large elements drop all their pairs when exiting, so exit first
+		_exit_grid(p_elem, p_from_rect, p_elem->_static);
+		_enter_grid(p_elem, p_to_rect, p_elem->_static);
+		return;
+	}
+
+	// only touch the levels where the covered cells changed, entering all of them
+	// before exiting so pairs that remain are not dropped and created again
+
+	Point2i from[GRID_LEVELS], to[GRID_LEVELS];
+	bool changed[GRID_LEVELS];
+
+	for (int i = MIN(from_level, to_level); i < GRID_LEVELS; i++) {
+
+		Point2i prev_from, prev_to;
+		_get_cells(p_from_rect, i, prev_from, prev_to);
+		_get_cells(p_to_rect, i, from[i], to[i]);
+
+		changed[i] = (i < from_level) != (i < to_level) || (i == from_level) != (i == to_level) || prev_from != from[i] || prev_to != to[i];
+
+		if (changed[i] && i >= to_level) {
+			_enter_cells(p_elem, i, from[i], to[i], i != to_level, p_elem->_static);
+		}
+	}
+
+	for (int i = MIN(from_level, to_level); i < GRID_LEVELS; i++) {
+
+		if (changed[i] && i >= from_level) {
+			_get_cells(p_from_rect, i, from[i], to[i]);
+			_exit_cells(p_elem, i, from[i], to[i], i != from_level, p_elem->_static);
+		}
+	}
+}
+
 BroadPhase2DHashGrid::ID BroadPhase2DHashGrid::create(CollisionObject2DSW *p_object, int p_subindex) {
 
 	current++;
@@ -342,14 +443,20 @@ void BroadPhase2DHashGrid::move(ID p_id, const Rect2 &p_aabb) {
 	if (p_aabb == e.aabb)
 		return;
 
-	if (p_aabb != Rect2()) {
+	if (p_aabb != Rect2() && e.aabb != Rect2()) {
 
-		_enter_grid(&e, p_aabb, e._static);
-	}
+		_move_in_grid(&e, e.aabb, p_aabb);
+	} else {
 
-	if (e.aabb != Rect2()) {
+		if (p_aabb != Rect2()) {
 
-		_exit_grid(&e, e.aabb, e._static);
+			_enter_grid(&e, p_aabb, e._static);
+		}
+
+		if (e.aabb != Rect2()) {
+
+			_exit_grid(&e, e.aabb, e._static);
+		}
 	}
 
 	e.aabb = p_aabb;
@@ -411,27 +518,21 @@ int BroadPhase2DHashGrid::get_subindex(ID p_id) const {
 }
 
 template <bool use_aabb, bool use_segment>
-void BroadPhase2DHashGrid::_cull(const Point2i p_cell, const Rect2 &p_aabb, const Point2 &p_from, const Point2 &p_to, CollisionObject2DSW **p_results, int p_max_results, int *p_result_indices, int &index) {
+void BroadPhase2DHashGrid::_cull(const Point2i p_cell, int p_level, const Rect2 &p_aabb, const Point2 &p_from, const Point2 &p_to, CollisionObject2DSW **p_results, int p_max_results, int *p_result_indices, int &index) {
 
 	PosKey pk;
 	pk.x = p_cell.x;
 	pk.y = p_cell.y;
+	pk.level = p_level;
 
-	uint32_t idx = pk.hash() % hash_table_size;
-	PosBin *pb = hash_table[idx];
-
-	while (pb) {
-
-		if (pb->key == pk) {
-			break;
-		}
-
-		pb = pb->next;
-	}
+	uint32_t idx;
+	PosBin *pb = _get_bin(pk, idx);
 
 	if (!pb)
 		return;
 
+	// small elements are found in their own level
+
 	for (Map<Element *, RC>::Element *E = pb->object_set.front(); E; E = E->next()) {
 
 		if (index >= p_max_results)
@@ -486,66 +587,73 @@ int BroadPhase2DHashGrid::cull_segment(const Vector2 &p_from, const Vector2 &p_t
 		dir.x = 0.000001;
 	if (dir.y == 0.0)
 		dir.y = 0.000001;
-	Vector2 delta = dir.abs();
 
-	delta.x = cell_size / delta.x;
-	delta.y = cell_size / delta.y;
+	int cullcount = 0;
 
-	Point2i pos = (p_from / cell_size).floor();
-	Point2i end = (p_to / cell_size).floor();
+	for (int level = 0; level < GRID_LEVELS; level++) {
 
-	Point2i step = Vector2(SGN(dir.x), SGN(dir.y));
+		real_t level_size = level_cell_size[level];
 
-	Vector2 max;
+		Vector2 delta = dir.abs();
 
-	if (dir.x < 0)
-		max.x = (Math::floor((double)pos.x) * cell_size - p_from.x) / dir.x;
-	else
-		max.x = (Math::floor((double)pos.x + 1) * cell_size - p_from.x) / dir.x;
+		delta.x = level_size / delta.x;
+		delta.y = level_size / delta.y;
 
-	if (dir.y < 0)
-		max.y = (Math::floor((double)pos.y) * cell_size - p_from.y) / dir.y;
-	else
-		max.y = (Math::floor((double)pos.y + 1) * cell_size - p_from.y) / dir.y;
+		Point2i pos = (p_from / level_size).floor();
+		Point2i end = (p_to / level_size).floor();
 
-	int cullcount = 0;
-	_cull<false, true>(pos, Rect2(), p_from, p_to, p_results, p_max_results, p_result_indices, cullcount);
+		Point2i step = Vector2(SGN(dir.x), SGN(dir.y));
 
-	bool reached_x = false;
-	bool reached_y = false;
+		Vector2 max;
 
-	while (true) {
+		if (dir.x < 0)
+			max.x = (Math::floor((double)pos.x) * level_size - p_from.x) / dir.x;
+		else
+			max.x = (Math::floor((double)pos.x + 1) * level_size - p_from.x) / dir.x;
 
-		if (max.x < max.y) {
+		if (dir.y < 0)
+			max.y = (Math::floor((double)pos.y) * level_size - p_from.y) / dir.y;
+		else
+			max.y = (Math::floor((double)pos.y + 1) * level_size - p_from.y) / dir.y;
 
-			max.x += delta.x;
-			pos.x += step.x;
-		} else {
+		_cull<false, true>(pos, level, Rect2(), p_from, p_to, p_results, p_max_results, p_result_indices, cullcount);
 
-			max.y += delta.y;
-			pos.y += step.y;
-		}
+		bool reached_x = false;
+		bool reached_y = false;
+
+		while (true) {
+
+			if (max.x < max.y) {
+
+				max.x += delta.x;
+				pos.x += step.x;
+			} else {
+
+				max.y += delta.y;
+				pos.y += step.y;
+			}
+
+			if (step.x > 0) {
+				if (pos.x >= end.x)
+					reached_x = true;
+			} else if (pos.x <= end.x) {
 
-		if (step.x > 0) {
-			if (pos.x >= end.x)
 				reached_x = true;
-		} else if (pos.x <= end.x) {
+			}
 
-			reached_x = true;
-		}
+			if (step.y > 0) {
+				if (pos.y >= end.y)
+					reached_y = true;
+			} else if (pos.y <= end.y) {
 
-		if (step.y > 0) {
-			if (pos.y >= end.y)
 				reached_y = true;
-		} else if (pos.y <= end.y) {
-
-			reached_y = true;
-		}
+			}
 
-		_cull<false, true>(pos, Rect2(), p_from, p_to, p_results, p_max_results, p_result_indices, cullcount);
+			_cull<false, true>(pos, level, Rect2(), p_from, p_to, p_results, p_max_results, p_result_indices, cullcount);
 
-		if (reached_x && reached_y)
-			break;
+			if (reached_x && reached_y)
+				break;
+		}
 	}
 
 	for (Map<Element *, RC>::Element *E = large_elements.front(); E; E = E->next()) {
@@ -577,15 +685,19 @@ int BroadPhase2DHashGrid::cull_aabb(const Rect2 &p_aabb, CollisionObject2DSW **p
 
 	pass++;
 
-	Point2i from = (p_aabb.position / cell_size).floor();
-	Point2i to = ((p_aabb.position + p_aabb.size) / cell_size).floor();
 	int cullcount = 0;
 
-	for (int i = from.x; i <= to.x; i++) {
+	for (int level = 0; level < GRID_LEVELS; level++) {
+
+		Point2i from, to;
+		_get_cells(p_aabb, level, from, to);
 
-		for (int j = from.y; j <= to.y; j++) {
+		for (int i = from.x; i <= to.x; i++) {
 
-			_cull<true, false>(Point2i(i, j), p_aabb, Point2(), Point2(), p_results, p_max_results, p_result_indices, cullcount);
+			for (int j = from.y; j <= to.y; j++) {
+
+				_cull<true, false>(Point2i(i, j), level, p_aabb, Point2(), Point2(), p_results, p_max_results, p_result_indices, cullcount);
+			}
 		}
 	}
 
@@ -641,6 +753,10 @@ BroadPhase2DHashGrid::BroadPhase2DHashGrid() {
 	cell_size = GLOBAL_DEF("physics/2d/cell_size", 128);
 	large_object_min_surface = GLOBAL_DEF("physics/2d/large_object_surface_threshold_in_cells", 512);
 
+	level_cell_size[0] = cell_size;
+	for (int i = 1; i < GRID_LEVELS; i++)
+		level_cell_size[i] = level_cell_size[i - 1] * GRID_LEVEL_SCALE;
+
 	for (uint32_t i = 0; i < hash_table_size; i++)
 		hash_table[i] = NULL;
 	pass = 1;
@@ -34,8 +34,23 @@
 #include "broad_phase_2d_sw.h"
 #include "core/map.h"
 
+/**
+ * Hierarchical hash grid. Every level uses cells GRID_LEVEL_SCALE times
+ * larger than the previous one, and elements live in the finest level where
+ * they cover no more than large_object_min_surface cells. They are also
+ * registered in the cells of every coarser level as small elements, so they
+ * pair with the larger elements living there without those having to cover
+ * many fine cells. Only elements too large for the coarsest level are kept
+ * in the large element list and checked against everything.
+ */
+
 class BroadPhase2DHashGrid : public BroadPhase2DSW {
 
+	enum {
+		GRID_LEVELS = 4,
+		GRID_LEVEL_SCALE = 8
+	};
+
 	struct PairData {
 
 		bool colliding;
@@ -114,16 +129,20 @@ class BroadPhase2DHashGrid : public BroadPhase2DSW {
 
 	int cell_size;
 	int large_object_min_surface;
+	real_t level_cell_size[GRID_LEVELS];
 
 	PairCallback pair_callback;
 	void *pair_userdata;
 	UnpairCallback unpair_callback;
 	void *unpair_userdata;
 
+	int _get_level(const Rect2 &p_rect) const;
+	_FORCE_INLINE_ void _get_cells(const Rect2 &p_rect, int p_level, Point2i &r_from, Point2i &r_to) const;
 	void _enter_grid(Element *p_elem, const Rect2 &p_rect, bool p_static);
 	void _exit_grid(Element *p_elem, const Rect2 &p_rect, bool p_static);
+	void _move_in_grid(Element *p_elem, const Rect2 &p_from_rect, const Rect2 &p_to_rect);
 	template <bool use_aabb, bool use_segment>
-	_FORCE_INLINE_ void _cull(const Point2i p_cell, const Rect2 &p_aabb, const Point2 &p_from, const Point2 &p_to, CollisionObject2DSW **p_results, int p_max_results, int *p_result_indices, int &index);
+	_FORCE_INLINE_ void _cull(const Point2i p_cell, int p_level, const Rect2 &p_aabb, const Point2 &p_from, const Point2 &p_to, CollisionObject2DSW **p_results, int p_max_results, int *p_result_indices, int &index);
 
 	struct PosKey {
 
@@ -134,9 +153,10 @@ class BroadPhase2DHashGrid : public BroadPhase2DSW {
 			};
 			uint64_t key;
 		};
+		int32_t level;
 
 		_FORCE_INLINE_ uint32_t hash() const {
-			uint64_t k = key;
+			uint64_t k = key + level * 0x9E3779B97F4A7C15ULL;
 			k = (~k) + (k << 18); // k = (k << 18) - k - 1;
 			k = k ^ (k >> 31);
 			k = k * 21; // k = (k + (k << 2)) + (k << 4);
@@ -146,9 +166,9 @@ class BroadPhase2DHashGrid : public BroadPhase2DSW {
 			return k;
 		}
 
-		bool operator==(const PosKey &p_key) const { return key == p_key.key; }
+		bool operator==(const PosKey &p_key) const { return key == p_key.key && level == p_key.level; }
 		_FORCE_INLINE_ bool operator<(const PosKey &p_key) const {
-			return key < p_key.key;
+			return level == p_key.level ? key < p_key.key : level < p_key.level;
 		}
 	};
 
@@ -157,12 +177,19 @@ class BroadPhase2DHashGrid : public BroadPhase2DSW {
 		PosKey key;
 		Map<Element *, RC> object_set;
 		Map<Element *, RC> static_object_set;
+		// elements living in a finer level
+		Map<Element *, RC> small_object_set;
+		Map<Element *, RC> small_static_object_set;
 		PosBin *next;
 	};
 
 	uint32_t hash_table_size;
 	PosBin **hash_table;
 
+	_FORCE_INLINE_ PosBin *_get_bin(const PosKey &p_key, uint32_t &r_idx) const;
+	void _enter_cells(Element *p_elem, int p_level, const Point2i &p_from, const Point2i &p_to, bool p_small, bool p_static);
+	void _exit_cells(Element *p_elem, int p_level, const Point2i &p_from, const Point2i &p_to, bool p_small, bool p_static);
+
 	void _pair_attempt(Element *p_elem, Element *p_with);
 	void _unpair_attempt(Element *p_elem, Element *p_with);
 	void _check_motion(Element *p_elem);
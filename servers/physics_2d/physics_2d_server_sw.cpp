@@ -1377,6 +1377,9 @@ int Physics2DServerSW::get_process_info(ProcessInfo p_info) {
 
 			return island_count;
 		} break;
+		default: {
+			// command queue info comes from Physics2DServerWrapMT
+		}
 	}
 
 	return 0;
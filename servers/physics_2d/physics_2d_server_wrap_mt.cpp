@@ -61,8 +61,8 @@ void Physics2DServerWrapMT::thread_loop() {
 	exit = false;
 	step_thread_up = true;
 	while (!exit) {
-		// flush commands one by one, until exit is requested
-		command_queue.wait_and_flush_one();
+		// flush commands as they come, until exit is requested
+		command_queue.wait_and_flush();
 	}
 
 	command_queue.flush_all(); // flush all
@@ -74,6 +74,8 @@ void Physics2DServerWrapMT::thread_loop() {
 
 void Physics2DServerWrapMT::step(real_t p_step) {
 
+	frame_stall_usec = command_queue.take_stall_usec();
+
 	if (create_thread) {
 
 		command_queue.push(this, &Physics2DServerWrapMT::thread_step, p_step);
@@ -160,6 +162,7 @@ Physics2DServerWrapMT::Physics2DServerWrapMT(Physics2DServer *p_contained, bool
 	thread = NULL;
 	step_sem = NULL;
 	step_pending = 0;
+	frame_stall_usec = 0;
 	step_thread_up = false;
 	alloc_mutex = Mutex::create();
 
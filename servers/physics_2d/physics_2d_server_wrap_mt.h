@@ -60,6 +60,7 @@ class Physics2DServerWrapMT : public Physics2DServer {
 
 	Semaphore *step_sem;
 	int step_pending;
+	uint32_t frame_stall_usec;
 	void thread_step(real_t p_delta);
 	void thread_flush();
 
@@ -307,7 +308,11 @@ public:
 	virtual void finish();
 
 	int get_process_info(ProcessInfo p_info) {
-		return physics_2d_server->get_process_info(p_info);
+		switch (p_info) {
+			case INFO_COMMAND_QUEUE_DEPTH: return command_queue.get_pending_count();
+			case INFO_COMMAND_QUEUE_STALL_TIME: return frame_stall_usec;
+			default: return physics_2d_server->get_process_info(p_info);
+		}
 	}
 
 	Physics2DServerWrapMT(Physics2DServer *p_contained, bool p_create_thread);
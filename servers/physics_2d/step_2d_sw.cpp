@@ -30,6 +30,8 @@
 
 #include "step_2d_sw.h"
 #include "core/os/os.h"
+#include "core/os/worker_thread_pool.h"
+#include "core/project_settings.h"
 
 void Step2DSW::_populate_island(Body2DSW *p_body, Body2DSW **p_island, Constraint2DSW **p_constraint_island) {
 
@@ -57,6 +59,11 @@ void Step2DSW::_populate_island(Body2DSW *p_body, Body2DSW **p_island, Constrain
 	}
 }
 
+void Step2DSW::_pre_setup_constraint(uint32_t p_index, void *p_userdata) {
+
+	constraints[p_index]->pre_setup(solve_delta);
+}
+
 bool Step2DSW::_setup_island(Constraint2DSW *p_island, real_t p_delta) {
 
 	Constraint2DSW *ci = p_island;
@@ -94,6 +101,11 @@ void Step2DSW::_solve_island(Constraint2DSW *p_island, int p_iterations, real_t
 	}
 }
 
+void Step2DSW::_solve_island_threaded(uint32_t p_index, void *p_userdata) {
+
+	_solve_island(constraint_islands[p_index], solve_iterations, solve_delta);
+}
+
 void Step2DSW::_check_suspend(Body2DSW *p_island, real_t p_delta) {
 
 	bool can_sleep = true;
@@ -217,6 +229,32 @@ void Step2DSW::step(Space2DSW *p_space, real_t p_delta, int p_iterations) {
 
 	/* SETUP CONSTRAINT ISLANDS */
 
+	solve_iterations = p_iterations;
+	solve_delta = p_delta;
+
+	{
+		// Narrow phase of every pair, as one parallel batch. The rest of the
+		// setup has side effects on shared bodies and stays serial, in the
+		// same order as always, so results don't depend on the thread count.
+		int count = 0;
+		for (Constraint2DSW *ci = constraint_island_list; ci; ci = ci->get_island_list_next()) {
+			for (Constraint2DSW *c = ci; c; c = c->get_island_next()) {
+				count++;
+			}
+		}
+
+		constraints.resize(count);
+		Constraint2DSW **cptr = constraints.ptrw();
+		int idx = 0;
+		for (Constraint2DSW *ci = constraint_island_list; ci; ci = ci->get_island_list_next()) {
+			for (Constraint2DSW *c = ci; c; c = c->get_island_next()) {
+				cptr[idx++] = c;
+			}
+		}
+
+		WorkerThreadPool::get_singleton()->parallel_for(count, 32, this, &Step2DSW::_pre_setup_constraint, (void *)NULL, solver_threads);
+	}
+
 	{
 		Constraint2DSW *ci = constraint_island_list;
 		Constraint2DSW *prev_ci = NULL;
@@ -264,12 +302,25 @@ void Step2DSW::step(Space2DSW *p_space, real_t p_delta, int p_iterations) {
 	/* SOLVE CONSTRAINT ISLANDS */
 
 	{
+		// Islands share no dynamic bodies, and static or kinematic ones are only
+		// read by the solvers, as Body2DSW skips impulses on them. So islands can
+		// be solved concurrently with the exact same result as solving them one
+		// after the other.
+		int count = 0;
+		for (Constraint2DSW *ci = constraint_island_list; ci; ci = ci->get_island_list_next()) {
+			count++;
+		}
+
+		constraint_islands.resize(count);
+		Constraint2DSW **islands = constraint_islands.ptrw();
 		Constraint2DSW *ci = constraint_island_list;
-		while (ci) {
-			//iterating each island separatedly improves cache efficiency
-			_solve_island(ci, p_iterations, p_delta);
+		for (int i = 0; i < count; i++) {
+			islands[i] = ci;
 			ci = ci->get_island_list_next();
 		}
+
+		//iterating each island separatedly improves cache efficiency
+		WorkerThreadPool::get_singleton()->parallel_for(count, 1, this, &Step2DSW::_solve_island_threaded, (void *)NULL, solver_threads);
 	}
 
 	{ //profile
@@ -313,4 +364,9 @@ void Step2DSW::step(Space2DSW *p_space, real_t p_delta, int p_iterations) {
 Step2DSW::Step2DSW() {
 
 	_step = 1;
+	solve_iterations = 0;
+	solve_delta = 0;
+
+	solver_threads = GLOBAL_DEF("physics/2d/solver/thread_count", -1);
+	ProjectSettings::get_singleton()->set_custom_property_info("physics/2d/solver/thread_count", PropertyInfo(Variant::INT, "physics/2d/solver/thread_count", PROPERTY_HINT_RANGE, "-1,256,1"));
 }
@@ -37,9 +37,18 @@ class Step2DSW {
 
 	uint64_t _step;
 
+	int solver_threads;
+
+	Vector<Constraint2DSW *> constraints;
+	Vector<Constraint2DSW *> constraint_islands;
+	int solve_iterations;
+	real_t solve_delta;
+
 	void _populate_island(Body2DSW *p_body, Body2DSW **p_island, Constraint2DSW **p_constraint_island);
+	void _pre_setup_constraint(uint32_t p_index, void *p_userdata);
 	bool _setup_island(Constraint2DSW *p_island, real_t p_delta);
 	void _solve_island(Constraint2DSW *p_island, int p_iterations, real_t p_delta);
+	void _solve_island_threaded(uint32_t p_index, void *p_userdata);
 	void _check_suspend(Body2DSW *p_island, real_t p_delta);
 
 public:
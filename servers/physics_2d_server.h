@@ -580,7 +580,9 @@ public:
 
 		INFO_ACTIVE_OBJECTS,
 		INFO_COLLISION_PAIRS,
-		INFO_ISLAND_COUNT
+		INFO_ISLAND_COUNT,
+		INFO_COMMAND_QUEUE_DEPTH,
+		INFO_COMMAND_QUEUE_STALL_TIME
 	};
 
 	virtual int get_process_info(ProcessInfo p_info) = 0;
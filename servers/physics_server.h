@@ -748,7 +748,8 @@ public:
 
 		INFO_ACTIVE_OBJECTS,
 		INFO_COLLISION_PAIRS,
-		INFO_ISLAND_COUNT
+		INFO_ISLAND_COUNT,
+		INFO_ISLAND_SOLVE_TIME
 	};
 
 	virtual int get_process_info(ProcessInfo p_info) = 0;
@@ -30,6 +30,8 @@
 
 #include "visual_server_scene.h"
 #include "core/os/os.h"
+#include "core/os/worker_thread_pool.h"
+#include "core/project_settings.h"
 #include "visual_server_global.h"
 #include "visual_server_raster.h"
 /* CAMERA API */
@@ -91,7 +93,112 @@ void VisualServerScene::camera_set_use_vertical_aspect(RID p_camera, bool p_enab
 
 /* SCENARIO API */
 
-void *VisualServerScene::_instance_pair(void *p_self, OctreeElementID, Instance *p_A, int, OctreeElementID, Instance *p_B, int) {
+VisualServerScene::SpatialPartitionID VisualServerScene::SpatialPartitioningScene_Octree::create(Instance *p_userdata, const AABB &p_aabb, int p_subindex, bool p_pairable, uint32_t p_pairable_type, uint32_t p_pairable_mask) {
+
+	return octree.create(p_userdata, p_aabb, p_subindex, p_pairable, p_pairable_type, p_pairable_mask);
+}
+
+void VisualServerScene::SpatialPartitioningScene_Octree::erase(SpatialPartitionID p_handle) {
+
+	octree.erase(p_handle);
+}
+
+void VisualServerScene::SpatialPartitioningScene_Octree::move(SpatialPartitionID p_handle, const AABB &p_aabb) {
+
+	octree.move(p_handle, p_aabb);
+}
+
+void VisualServerScene::SpatialPartitioningScene_Octree::set_pairable(SpatialPartitionID p_handle, bool p_pairable, uint32_t p_pairable_type, uint32_t p_pairable_mask) {
+
+	octree.set_pairable(p_handle, p_pairable, p_pairable_type, p_pairable_mask);
+}
+
+int VisualServerScene::SpatialPartitioningScene_Octree::cull_convex(const Vector<Plane> &p_convex, Instance **p_result_array, int p_result_max, uint32_t p_mask) {
+
+	return octree.cull_convex(p_convex, p_result_array, p_result_max, p_mask);
+}
+
+int VisualServerScene::SpatialPartitioningScene_Octree::cull_convex_threaded(const Vector<Plane> &p_convex, Instance **p_result_array, int p_result_max, uint32_t p_mask, int p_max_threads) const {
+
+	return octree.cull_convex_threaded(p_convex, p_result_array, p_result_max, p_mask, p_max_threads);
+}
+
+int VisualServerScene::SpatialPartitioningScene_Octree::cull_aabb(const AABB &p_aabb, Instance **p_result_array, int p_result_max, int *p_subindex_array, uint32_t p_mask) {
+
+	return octree.cull_aabb(p_aabb, p_result_array, p_result_max, p_subindex_array, p_mask);
+}
+
+int VisualServerScene::SpatialPartitioningScene_Octree::cull_segment(const Vector3 &p_from, const Vector3 &p_to, Instance **p_result_array, int p_result_max, int *p_subindex_array, uint32_t p_mask) {
+
+	return octree.cull_segment(p_from, p_to, p_result_array, p_result_max, p_subindex_array, p_mask);
+}
+
+void VisualServerScene::SpatialPartitioningScene_Octree::set_pair_callback(PairCallback p_callback, void *p_userdata) {
+
+	octree.set_pair_callback(p_callback, p_userdata);
+}
+
+void VisualServerScene::SpatialPartitioningScene_Octree::set_unpair_callback(UnpairCallback p_callback, void *p_userdata) {
+
+	octree.set_unpair_callback(p_callback, p_userdata);
+}
+
+VisualServerScene::SpatialPartitionID VisualServerScene::SpatialPartitioningScene_BVH::create(Instance *p_userdata, const AABB &p_aabb, int p_subindex, bool p_pairable, uint32_t p_pairable_type, uint32_t p_pairable_mask) {
+
+	return bvh.create(p_userdata, p_aabb, p_subindex, p_pairable, p_pairable_type, p_pairable_mask);
+}
+
+void VisualServerScene::SpatialPartitioningScene_BVH::erase(SpatialPartitionID p_handle) {
+
+	bvh.erase(p_handle);
+}
+
+void VisualServerScene::SpatialPartitioningScene_BVH::move(SpatialPartitionID p_handle, const AABB &p_aabb) {
+
+	bvh.move(p_handle, p_aabb);
+}
+
+void VisualServerScene::SpatialPartitioningScene_BVH::set_pairable(SpatialPartitionID p_handle, bool p_pairable, uint32_t p_pairable_type, uint32_t p_pairable_mask) {
+
+	bvh.set_pairable(p_handle, p_pairable, p_pairable_type, p_pairable_mask);
+}
+
+void VisualServerScene::SpatialPartitioningScene_BVH::update() {
+
+	bvh.update();
+}
+
+int VisualServerScene::SpatialPartitioningScene_BVH::cull_convex(const Vector<Plane> &p_convex, Instance **p_result_array, int p_result_max, uint32_t p_mask) {
+
+	return bvh.cull_convex(p_convex, p_result_array, p_result_max, p_mask);
+}
+
+int VisualServerScene::SpatialPartitioningScene_BVH::cull_convex_threaded(const Vector<Plane> &p_convex, Instance **p_result_array, int p_result_max, uint32_t p_mask, int p_max_threads) const {
+
+	return bvh.cull_convex_threaded(p_convex, p_result_array, p_result_max, p_mask, p_max_threads);
+}
+
+int VisualServerScene::SpatialPartitioningScene_BVH::cull_aabb(const AABB &p_aabb, Instance **p_result_array, int p_result_max, int *p_subindex_array, uint32_t p_mask) {
+
+	return bvh.cull_aabb(p_aabb, p_result_array, p_result_max, p_subindex_array, p_mask);
+}
+
+int VisualServerScene::SpatialPartitioningScene_BVH::cull_segment(const Vector3 &p_from, const Vector3 &p_to, Instance **p_result_array, int p_result_max, int *p_subindex_array, uint32_t p_mask) {
+
+	return bvh.cull_segment(p_from, p_to, p_result_array, p_result_max, p_subindex_array, p_mask);
+}
+
+void VisualServerScene::SpatialPartitioningScene_BVH::set_pair_callback(PairCallback p_callback, void *p_userdata) {
+
+	bvh.set_pair_callback(p_callback, p_userdata);
+}
+
+void VisualServerScene::SpatialPartitioningScene_BVH::set_unpair_callback(UnpairCallback p_callback, void *p_userdata) {
+
+	bvh.set_unpair_callback(p_callback, p_userdata);
+}
+
+void *VisualServerScene::_instance_pair(void *p_self, SpatialPartitionID, Instance *p_A, int, SpatialPartitionID, Instance *p_B, int) {
 
 	//VisualServerScene *self = (VisualServerScene*)p_self;
 	Instance *A = p_A;
@@ -170,7 +277,7 @@ void *VisualServerScene::_instance_pair(void *p_self, OctreeElementID, Instance
 
 	return NULL;
 }
-void VisualServerScene::_instance_unpair(void *p_self, OctreeElementID, Instance *p_A, int, OctreeElementID, Instance *p_B, int, void *udata) {
+void VisualServerScene::_instance_unpair(void *p_self, SpatialPartitionID, Instance *p_A, int, SpatialPartitionID, Instance *p_B, int, void *udata) {
 
 	//VisualServerScene *self = (VisualServerScene*)p_self;
 	Instance *A = p_A;
@@ -246,8 +353,8 @@ RID VisualServerScene::scenario_create() {
 	RID scenario_rid = scenario_owner.make_rid(scenario);
 	scenario->self = scenario_rid;
 
-	scenario->octree.set_pair_callback(_instance_pair, this);
-	scenario->octree.set_unpair_callback(_instance_unpair, this);
+	scenario->spatial_partitioning = default_spatial_partitioning;
+	_scenario_create_spatial_partitioning(scenario);
 	scenario->reflection_probe_shadow_atlas = VSG::scene_render->shadow_atlas_create();
 	VSG::scene_render->shadow_atlas_set_size(scenario->reflection_probe_shadow_atlas, 1024); //make enough shadows for close distance, don't bother with rest
 	VSG::scene_render->shadow_atlas_set_quadrant_subdivision(scenario->reflection_probe_shadow_atlas, 0, 4);
@@ -266,6 +373,62 @@ void VisualServerScene::scenario_set_debug(RID p_scenario, VS::ScenarioDebugMode
 	scenario->debug = p_debug_mode;
 }
 
+void VisualServerScene::scenario_set_spatial_partitioning(RID p_scenario, VS::ScenarioSpatialPartitioning p_type) {
+
+	Scenario *scenario = scenario_owner.get(p_scenario);
+	ERR_FAIL_COND(!scenario);
+	ERR_FAIL_INDEX(p_type, 2);
+
+	if (scenario->spatial_partitioning == p_type)
+		return;
+
+	//take everything out of the old one (unpairing all), then put it back in the new one
+	for (SelfList<Instance> *E = scenario->instances.first(); E; E = E->next()) {
+
+		Instance *instance = E->self();
+		if (instance->spatial_partition_id) {
+			scenario->sps->erase(instance->spatial_partition_id);
+			instance->spatial_partition_id = 0;
+		}
+	}
+
+	scenario->spatial_partitioning = p_type;
+	_scenario_create_spatial_partitioning(scenario);
+
+	for (SelfList<Instance> *E = scenario->instances.first(); E; E = E->next()) {
+
+		Instance *instance = E->self();
+		if (instance->update_item.in_list()) {
+			_update_dirty_instance(instance);
+		} else {
+			_update_instance(instance);
+		}
+	}
+}
+
+void VisualServerScene::_scenario_create_spatial_partitioning(Scenario *p_scenario) {
+
+	if (p_scenario->sps) {
+		memdelete(p_scenario->sps);
+	}
+
+	if (p_scenario->spatial_partitioning == VS::SCENARIO_SPATIAL_PARTITIONING_BVH) {
+		p_scenario->sps = memnew(SpatialPartitioningScene_BVH);
+	} else {
+		p_scenario->sps = memnew(SpatialPartitioningScene_Octree);
+	}
+
+	p_scenario->sps->set_pair_callback(_instance_pair, this);
+	p_scenario->sps->set_unpair_callback(_instance_unpair, this);
+}
+
+void VisualServerScene::_scenario_queue_update(Scenario *p_scenario) {
+
+	if (!p_scenario->update_item.in_list()) {
+		_scenario_update_list.add(&p_scenario->update_item);
+	}
+}
+
 void VisualServerScene::scenario_set_environment(RID p_scenario, RID p_environment) {
 
 	Scenario *scenario = scenario_owner.get(p_scenario);
@@ -344,9 +507,9 @@ void VisualServerScene::instance_set_base(RID p_instance, RID p_base) {
 			}
 		}
 
-		if (scenario && instance->octree_id) {
-			scenario->octree.erase(instance->octree_id); //make dependencies generated by the octree go away
-			instance->octree_id = 0;
+		if (scenario && instance->spatial_partition_id) {
+			scenario->sps->erase(instance->spatial_partition_id); //make dependencies generated by the spatial partitioning go away
+			instance->spatial_partition_id = 0;
 		}
 
 		switch (instance->base_type) {
@@ -492,9 +655,9 @@ void VisualServerScene::instance_set_scenario(RID p_instance, RID p_scenario) {
 
 		instance->scenario->instances.remove(&instance->scenario_item);
 
-		if (instance->octree_id) {
-			instance->scenario->octree.erase(instance->octree_id); //make dependencies generated by the octree go away
-			instance->octree_id = 0;
+		if (instance->spatial_partition_id) {
+			instance->scenario->sps->erase(instance->spatial_partition_id); //make dependencies generated by the spatial partitioning go away
+			instance->spatial_partition_id = 0;
 		}
 
 		switch (instance->base_type) {
@@ -576,6 +739,24 @@ void VisualServerScene::instance_set_transform(RID p_instance, const Transform &
 	instance->transform = p_transform;
 	_instance_queue_update(instance, true);
 }
+void VisualServerScene::instances_set_transform(const Vector<RID> &p_instances, const Vector<Transform> &p_transforms) {
+
+	ERR_FAIL_COND(p_instances.size() != p_transforms.size());
+
+	const RID *instances = p_instances.ptr();
+	const Transform *transforms = p_transforms.ptr();
+	for (int i = 0; i < p_instances.size(); i++) {
+
+		Instance *instance = instance_owner.get(instances[i]);
+		ERR_CONTINUE(!instance);
+
+		if (instance->transform == transforms[i])
+			continue;
+
+		instance->transform = transforms[i];
+		_instance_queue_update(instance, true);
+	}
+}
 void VisualServerScene::instance_attach_object_instance_id(RID p_instance, ObjectID p_ID) {
 
 	Instance *instance = instance_owner.get(p_instance);
@@ -630,31 +811,35 @@ void VisualServerScene::instance_set_visible(RID p_instance, bool p_visible) {
 
 	switch (instance->base_type) {
 		case VS::INSTANCE_LIGHT: {
-			if (VSG::storage->light_get_type(instance->base) != VS::LIGHT_DIRECTIONAL && instance->octree_id && instance->scenario) {
-				instance->scenario->octree.set_pairable(instance->octree_id, p_visible, 1 << VS::INSTANCE_LIGHT, p_visible ? VS::INSTANCE_GEOMETRY_MASK : 0);
+			if (VSG::storage->light_get_type(instance->base) != VS::LIGHT_DIRECTIONAL && instance->spatial_partition_id && instance->scenario) {
+				instance->scenario->sps->set_pairable(instance->spatial_partition_id, p_visible, 1 << VS::INSTANCE_LIGHT, p_visible ? VS::INSTANCE_GEOMETRY_MASK : 0);
 			}
 
 		} break;
 		case VS::INSTANCE_REFLECTION_PROBE: {
-			if (instance->octree_id && instance->scenario) {
-				instance->scenario->octree.set_pairable(instance->octree_id, p_visible, 1 << VS::INSTANCE_REFLECTION_PROBE, p_visible ? VS::INSTANCE_GEOMETRY_MASK : 0);
+			if (instance->spatial_partition_id && instance->scenario) {
+				instance->scenario->sps->set_pairable(instance->spatial_partition_id, p_visible, 1 << VS::INSTANCE_REFLECTION_PROBE, p_visible ? VS::INSTANCE_GEOMETRY_MASK : 0);
 			}
 
 		} break;
 		case VS::INSTANCE_LIGHTMAP_CAPTURE: {
-			if (instance->octree_id && instance->scenario) {
-				instance->scenario->octree.set_pairable(instance->octree_id, p_visible, 1 << VS::INSTANCE_LIGHTMAP_CAPTURE, p_visible ? VS::INSTANCE_GEOMETRY_MASK : 0);
+			if (instance->spatial_partition_id && instance->scenario) {
+				instance->scenario->sps->set_pairable(instance->spatial_partition_id, p_visible, 1 << VS::INSTANCE_LIGHTMAP_CAPTURE, p_visible ? VS::INSTANCE_GEOMETRY_MASK : 0);
 			}
 
 		} break;
 		case VS::INSTANCE_GI_PROBE: {
-			if (instance->octree_id && instance->scenario) {
-				instance->scenario->octree.set_pairable(instance->octree_id, p_visible, 1 << VS::INSTANCE_GI_PROBE, p_visible ? (VS::INSTANCE_GEOMETRY_MASK | (1 << VS::INSTANCE_LIGHT)) : 0);
+			if (instance->spatial_partition_id && instance->scenario) {
+				instance->scenario->sps->set_pairable(instance->spatial_partition_id, p_visible, 1 << VS::INSTANCE_GI_PROBE, p_visible ? (VS::INSTANCE_GEOMETRY_MASK | (1 << VS::INSTANCE_LIGHT)) : 0);
 			}
 
 		} break;
 		default: {}
 	}
+
+	if (instance->spatial_partition_id && instance->scenario) {
+		_scenario_queue_update(instance->scenario); // new pairs are found on update
+	}
 }
 inline bool is_geometry_instance(VisualServer::InstanceType p_type) {
 	return p_type == VS::INSTANCE_MESH || p_type == VS::INSTANCE_MULTIMESH || p_type == VS::INSTANCE_PARTICLES || p_type == VS::INSTANCE_IMMEDIATE;
@@ -752,7 +937,7 @@ Vector<ObjectID> VisualServerScene::instances_cull_aabb(const AABB &p_aabb, RID
 
 	int culled = 0;
 	Instance *cull[1024];
-	culled = scenario->octree.cull_aabb(p_aabb, cull, 1024);
+	culled = scenario->sps->cull_aabb(p_aabb, cull, 1024);
 
 	for (int i = 0; i < culled; i++) {
 
@@ -775,7 +960,7 @@ Vector<ObjectID> VisualServerScene::instances_cull_ray(const Vector3 &p_from, co
 
 	int culled = 0;
 	Instance *cull[1024];
-	culled = scenario->octree.cull_segment(p_from, p_from + p_to * 10000, cull, 1024);
+	culled = scenario->sps->cull_segment(p_from, p_from + p_to * 10000, cull, 1024);
 
 	for (int i = 0; i < culled; i++) {
 		Instance *instance = cull[i];
@@ -798,7 +983,7 @@ Vector<ObjectID> VisualServerScene::instances_cull_convex(const Vector<Plane> &p
 	int culled = 0;
 	Instance *cull[1024];
 
-	culled = scenario->octree.cull_convex(p_convex, cull, 1024);
+	culled = scenario->sps->cull_convex(p_convex, cull, 1024);
 
 	for (int i = 0; i < culled; i++) {
 
@@ -926,7 +1111,7 @@ void VisualServerScene::_update_instance(Instance *p_instance) {
 		return;
 	}
 
-	if (p_instance->octree_id == 0) {
+	if (p_instance->spatial_partition_id == 0) {
 
 		uint32_t base_type = 1 << p_instance->base_type;
 		uint32_t pairable_mask = 0;
@@ -944,8 +1129,8 @@ void VisualServerScene::_update_instance(Instance *p_instance) {
 			pairable = true;
 		}
 
-		// not inside octree
-		p_instance->octree_id = p_instance->scenario->octree.create(p_instance, new_aabb, 0, pairable, base_type, pairable_mask);
+		// not inside spatial partitioning
+		p_instance->spatial_partition_id = p_instance->scenario->sps->create(p_instance, new_aabb, 0, pairable, base_type, pairable_mask);
 
 	} else {
 
@@ -954,8 +1139,10 @@ void VisualServerScene::_update_instance(Instance *p_instance) {
 			return;
 		*/
 
-		p_instance->scenario->octree.move(p_instance->octree_id, new_aabb);
+		p_instance->scenario->sps->move(p_instance->spatial_partition_id, new_aabb);
 	}
+
+	_scenario_queue_update(p_instance->scenario);
 }
 
 void VisualServerScene::_update_instance_aabb(Instance *p_instance) {
@@ -1263,6 +1450,136 @@ void VisualServerScene::_update_instance_lightmap_captures(Instance *p_instance)
 	}
 }
 
+bool VisualServerScene::_is_cull_threaded() const {
+
+	return cull_threads != 1 && WorkerThreadPool::get_singleton()->get_thread_count() > 0;
+}
+
+int VisualServerScene::_cull_convex(Scenario *p_scenario, const Vector<Plane> &p_planes, Instance **r_result, int p_result_max, uint32_t p_mask) {
+
+	if (_is_cull_threaded()) {
+		return p_scenario->sps->cull_convex_threaded(p_planes, r_result, p_result_max, p_mask, cull_threads);
+	} else {
+		return p_scenario->sps->cull_convex(p_planes, r_result, p_result_max, p_mask);
+	}
+}
+
+int VisualServerScene::_cull_shadow_casters(Scenario *p_scenario, const Vector<Plane> &p_planes, Vector<Instance *> &r_result) {
+
+	if (r_result.size() == 0) {
+		r_result.resize(1024);
+	}
+
+	while (true) {
+
+		int cull_count = _cull_convex(p_scenario, p_planes, r_result.ptrw(), r_result.size(), VS::INSTANCE_GEOMETRY_MASK);
+		if (cull_count < r_result.size() || r_result.size() >= MAX_INSTANCE_CULL) {
+			return cull_count;
+		}
+
+		//full, grow and cull again
+		r_result.resize(MIN(r_result.size() * 2, (int)MAX_INSTANCE_CULL));
+	}
+}
+
+VisualServerScene::ShadowPass &VisualServerScene::_add_shadow_pass(RID p_light_instance, int p_pass, const Plane &p_near_plane) {
+
+	if (shadow_pass_count == shadow_passes.size()) {
+		shadow_passes.resize(shadow_pass_count + 1);
+	}
+
+	ShadowPass &shadow_pass = shadow_passes.write[shadow_pass_count++];
+	shadow_pass.light_instance = p_light_instance;
+	shadow_pass.pass = p_pass;
+	shadow_pass.planes.clear();
+	shadow_pass.near_plane = p_near_plane;
+	shadow_pass.projection = CameraMatrix();
+	shadow_pass.transform = Transform();
+	shadow_pass.far = 0;
+	shadow_pass.split = 0;
+	shadow_pass.bias_scale = 1.0;
+	shadow_pass.fit_depth_range = false;
+	shadow_pass.cull_count = 0;
+
+	return shadow_pass;
+}
+
+void VisualServerScene::_cull_shadow_pass(uint32_t p_index, Scenario *p_scenario) {
+
+	ShadowPass &shadow_pass = shadow_passes.write[p_index];
+
+	if (shadow_pass.planes.empty())
+		return;
+
+	int cull_count = _cull_shadow_casters(p_scenario, shadow_pass.planes, shadow_pass.cull_result);
+	Instance **cull_result = shadow_pass.cull_result.ptrw();
+
+	for (int j = 0; j < cull_count; j++) {
+
+		Instance *instance = cull_result[j];
+		if (!instance->visible || !((1 << instance->base_type) & VS::INSTANCE_GEOMETRY_MASK) || !static_cast<InstanceGeometryData *>(instance->base_data)->can_cast_shadows) {
+			cull_count--;
+			SWAP(cull_result[j], cull_result[cull_count]);
+			j--;
+			continue;
+		}
+
+		if (shadow_pass.fit_depth_range) {
+
+			float min, max;
+			instance->transformed_aabb.project_range_in_plane(Plane(shadow_pass.z_vec, 0), min, max);
+			if (max > shadow_pass.z_max)
+				shadow_pass.z_max = max;
+		}
+	}
+
+	shadow_pass.cull_count = cull_count;
+
+	if (shadow_pass.fit_depth_range) {
+
+		CameraMatrix ortho_camera;
+		ortho_camera.set_orthogonal(-shadow_pass.half_x, shadow_pass.half_x, -shadow_pass.half_y, shadow_pass.half_y, 0, (shadow_pass.z_max - shadow_pass.z_min));
+
+		shadow_pass.projection = ortho_camera;
+		shadow_pass.transform.origin += shadow_pass.z_vec * shadow_pass.z_max;
+	}
+}
+
+void VisualServerScene::_render_shadow_passes(RID p_shadow_atlas, Scenario *p_scenario) {
+
+	// Culling only reads the scenario, so passes can be culled concurrently.
+	// Depths are shared by all passes an instance is in, so they are set right
+	// before rendering each pass, on this thread.
+	if (_is_cull_threaded()) {
+		WorkerThreadPool::get_singleton()->parallel_for(shadow_pass_count, 1, this, &VisualServerScene::_cull_shadow_pass, p_scenario, cull_threads);
+	} else {
+		for (int i = 0; i < shadow_pass_count; i++) {
+			_cull_shadow_pass(i, p_scenario);
+		}
+	}
+
+	for (int i = 0; i < shadow_pass_count; i++) {
+
+		ShadowPass &shadow_pass = shadow_passes.write[i];
+
+		VSG::scene_render->light_instance_set_shadow_transform(shadow_pass.light_instance, shadow_pass.projection, shadow_pass.transform, shadow_pass.far, shadow_pass.split, shadow_pass.pass, shadow_pass.bias_scale);
+
+		if (shadow_pass.planes.empty())
+			continue;
+
+		Instance **cull_result = shadow_pass.cull_result.ptrw();
+		for (int j = 0; j < shadow_pass.cull_count; j++) {
+
+			cull_result[j]->depth = shadow_pass.near_plane.distance_to(cull_result[j]->transform.origin);
+			cull_result[j]->depth_layer = 0;
+		}
+
+		VSG::scene_render->render_shadow(shadow_pass.light_instance, p_shadow_atlas, shadow_pass.pass, (RasterizerScene::InstanceBase **)cull_result, shadow_pass.cull_count);
+	}
+
+	shadow_pass_count = 0;
+}
+
 void VisualServerScene::_light_instance_update_shadow(Instance *p_instance, const Transform p_cam_transform, const CameraMatrix &p_cam_projection, bool p_cam_orthogonal, RID p_shadow_atlas, Scenario *p_scenario) {
 
 	InstanceLightData *light = static_cast<InstanceLightData *>(p_instance->base_data);
@@ -1287,7 +1604,7 @@ void VisualServerScene::_light_instance_update_shadow(Instance *p_instance, cons
 			if (depth_range_mode == VS::LIGHT_DIRECTIONAL_SHADOW_DEPTH_RANGE_OPTIMIZED) {
 				//optimize min/max
 				Vector<Plane> planes = p_cam_projection.get_projection_planes(p_cam_transform);
-				int cull_count = p_scenario->octree.cull_convex(planes, instance_shadow_cull_result, MAX_INSTANCE_CULL, VS::INSTANCE_GEOMETRY_MASK);
+				int cull_count = _cull_shadow_casters(p_scenario, planes, instance_shadow_cull_result);
 				Plane base(p_cam_transform.origin, -p_cam_transform.basis.get_axis(2));
 				//check distance max and min
 
@@ -1481,46 +1798,24 @@ void VisualServerScene::_light_instance_update_shadow(Instance *p_instance, cons
 				light_frustum_planes.write[4] = Plane(z_vec, z_max + 1e6);
 				light_frustum_planes.write[5] = Plane(-z_vec, -z_min); // z_min is ok, since casters further than far-light plane are not needed
 
-				int cull_count = p_scenario->octree.cull_convex(light_frustum_planes, instance_shadow_cull_result, MAX_INSTANCE_CULL, VS::INSTANCE_GEOMETRY_MASK);
-
 				// a pre pass will need to be needed to determine the actual z-near to be used
 
 				Plane near_plane(light_transform.origin, -light_transform.basis.get_axis(2));
 
-				for (int j = 0; j < cull_count; j++) {
-
-					float min, max;
-					Instance *instance = instance_shadow_cull_result[j];
-					if (!instance->visible || !((1 << instance->base_type) & VS::INSTANCE_GEOMETRY_MASK) || !static_cast<InstanceGeometryData *>(instance->base_data)->can_cast_shadows) {
-						cull_count--;
-						SWAP(instance_shadow_cull_result[j], instance_shadow_cull_result[cull_count]);
-						j--;
-						continue;
-					}
-
-					instance->transformed_aabb.project_range_in_plane(Plane(z_vec, 0), min, max);
-					instance->depth = near_plane.distance_to(instance->transform.origin);
-					instance->depth_layer = 0;
-					if (max > z_max)
-						z_max = max;
-				}
-
-				{
-
-					CameraMatrix ortho_camera;
-					real_t half_x = (x_max_cam - x_min_cam) * 0.5;
-					real_t half_y = (y_max_cam - y_min_cam) * 0.5;
-
-					ortho_camera.set_orthogonal(-half_x, half_x, -half_y, half_y, 0, (z_max - z_min_cam));
-
-					Transform ortho_transform;
-					ortho_transform.basis = transform.basis;
-					ortho_transform.origin = x_vec * (x_min_cam + half_x) + y_vec * (y_min_cam + half_y) + z_vec * z_max;
-
-					VSG::scene_render->light_instance_set_shadow_transform(light->instance, ortho_camera, ortho_transform, 0, distances[i + 1], i, bias_scale);
-				}
-
-				VSG::scene_render->render_shadow(light->instance, p_shadow_atlas, i, (RasterizerScene::InstanceBase **)instance_shadow_cull_result, cull_count);
+				ShadowPass &shadow_pass = _add_shadow_pass(light->instance, i, near_plane);
+				shadow_pass.planes = light_frustum_planes;
+				shadow_pass.split = distances[i + 1];
+				shadow_pass.bias_scale = bias_scale;
+
+				// the far end of the ortho camera is moved to the furthest caster once culled
+				shadow_pass.fit_depth_range = true;
+				shadow_pass.z_vec = z_vec;
+				shadow_pass.z_min = z_min_cam;
+				shadow_pass.z_max = z_max;
+				shadow_pass.half_x = (x_max_cam - x_min_cam) * 0.5;
+				shadow_pass.half_y = (y_max_cam - y_min_cam) * 0.5;
+				shadow_pass.transform.basis = transform.basis;
+				shadow_pass.transform.origin = x_vec * (x_min_cam + shadow_pass.half_x) + y_vec * (y_min_cam + shadow_pass.half_y);
 			}
 
 		} break;
@@ -1546,24 +1841,12 @@ void VisualServerScene::_light_instance_update_shadow(Instance *p_instance, cons
 						planes.write[3] = light_transform.xform(Plane(Vector3(0, 1, z).normalized(), radius));
 						planes.write[4] = light_transform.xform(Plane(Vector3(0, -1, z).normalized(), radius));
 
-						int cull_count = p_scenario->octree.cull_convex(planes, instance_shadow_cull_result, MAX_INSTANCE_CULL, VS::INSTANCE_GEOMETRY_MASK);
 						Plane near_plane(light_transform.origin, light_transform.basis.get_axis(2) * z);
 
-						for (int j = 0; j < cull_count; j++) {
-
-							Instance *instance = instance_shadow_cull_result[j];
-							if (!instance->visible || !((1 << instance->base_type) & VS::INSTANCE_GEOMETRY_MASK) || !static_cast<InstanceGeometryData *>(instance->base_data)->can_cast_shadows) {
-								cull_count--;
-								SWAP(instance_shadow_cull_result[j], instance_shadow_cull_result[cull_count]);
-								j--;
-							} else {
-								instance->depth = near_plane.distance_to(instance->transform.origin);
-								instance->depth_layer = 0;
-							}
-						}
-
-						VSG::scene_render->light_instance_set_shadow_transform(light->instance, CameraMatrix(), light_transform, radius, 0, i);
-						VSG::scene_render->render_shadow(light->instance, p_shadow_atlas, i, (RasterizerScene::InstanceBase **)instance_shadow_cull_result, cull_count);
+						ShadowPass &shadow_pass = _add_shadow_pass(light->instance, i, near_plane);
+						shadow_pass.planes = planes;
+						shadow_pass.transform = light_transform;
+						shadow_pass.far = radius;
 					}
 				} break;
 				case VS::LIGHT_OMNI_SHADOW_CUBE: {
@@ -1597,28 +1880,19 @@ void VisualServerScene::_light_instance_update_shadow(Instance *p_instance, cons
 
 						Vector<Plane> planes = cm.get_projection_planes(xform);
 
-						int cull_count = p_scenario->octree.cull_convex(planes, instance_shadow_cull_result, MAX_INSTANCE_CULL, VS::INSTANCE_GEOMETRY_MASK);
-
 						Plane near_plane(xform.origin, -xform.basis.get_axis(2));
-						for (int j = 0; j < cull_count; j++) {
 
-							Instance *instance = instance_shadow_cull_result[j];
-							if (!instance->visible || !((1 << instance->base_type) & VS::INSTANCE_GEOMETRY_MASK) || !static_cast<InstanceGeometryData *>(instance->base_data)->can_cast_shadows) {
-								cull_count--;
-								SWAP(instance_shadow_cull_result[j], instance_shadow_cull_result[cull_count]);
-								j--;
-							} else {
-								instance->depth = near_plane.distance_to(instance->transform.origin);
-								instance->depth_layer = 0;
-							}
-						}
-
-						VSG::scene_render->light_instance_set_shadow_transform(light->instance, cm, xform, radius, 0, i);
-						VSG::scene_render->render_shadow(light->instance, p_shadow_atlas, i, (RasterizerScene::InstanceBase **)instance_shadow_cull_result, cull_count);
+						ShadowPass &shadow_pass = _add_shadow_pass(light->instance, i, near_plane);
+						shadow_pass.planes = planes;
+						shadow_pass.projection = cm;
+						shadow_pass.transform = xform;
+						shadow_pass.far = radius;
 					}
 
 					//restore the regular DP matrix
-					VSG::scene_render->light_instance_set_shadow_transform(light->instance, CameraMatrix(), light_transform, radius, 0, 0);
+					ShadowPass &restore_pass = _add_shadow_pass(light->instance, 0, Plane());
+					restore_pass.transform = light_transform;
+					restore_pass.far = radius;
 
 				} break;
 			}
@@ -1633,24 +1907,13 @@ void VisualServerScene::_light_instance_update_shadow(Instance *p_instance, cons
 			cm.set_perspective(angle * 2.0, 1.0, 0.01, radius);
 
 			Vector<Plane> planes = cm.get_projection_planes(light_transform);
-			int cull_count = p_scenario->octree.cull_convex(planes, instance_shadow_cull_result, MAX_INSTANCE_CULL, VS::INSTANCE_GEOMETRY_MASK);
-
 			Plane near_plane(light_transform.origin, -light_transform.basis.get_axis(2));
-			for (int j = 0; j < cull_count; j++) {
-
-				Instance *instance = instance_shadow_cull_result[j];
-				if (!instance->visible || !((1 << instance->base_type) & VS::INSTANCE_GEOMETRY_MASK) || !static_cast<InstanceGeometryData *>(instance->base_data)->can_cast_shadows) {
-					cull_count--;
-					SWAP(instance_shadow_cull_result[j], instance_shadow_cull_result[cull_count]);
-					j--;
-				} else {
-					instance->depth = near_plane.distance_to(instance->transform.origin);
-					instance->depth_layer = 0;
-				}
-			}
 
-			VSG::scene_render->light_instance_set_shadow_transform(light->instance, cm, light_transform, radius, 0, 0);
-			VSG::scene_render->render_shadow(light->instance, p_shadow_atlas, 0, (RasterizerScene::InstanceBase **)instance_shadow_cull_result, cull_count);
+			ShadowPass &shadow_pass = _add_shadow_pass(light->instance, 0, near_plane);
+			shadow_pass.planes = planes;
+			shadow_pass.projection = cm;
+			shadow_pass.transform = light_transform;
+			shadow_pass.far = radius;
 
 		} break;
 	}
@@ -1800,7 +2063,7 @@ void VisualServerScene::_prepare_scene(const Transform p_cam_transform, const Ca
 	float z_far = p_cam_projection.get_z_far();
 
 	/* STEP 2 - CULL */
-	instance_cull_count = scenario->octree.cull_convex(planes, instance_cull_result, MAX_INSTANCE_CULL);
+	instance_cull_count = _cull_convex(scenario, planes, instance_cull_result, MAX_INSTANCE_CULL);
 	light_cull_count = 0;
 
 	reflection_probe_cull_count = 0;
@@ -2099,6 +2362,8 @@ void VisualServerScene::_prepare_scene(const Transform p_cam_transform, const Ca
 			}
 		}
 	}
+
+	_render_shadow_passes(p_shadow_atlas, scenario);
 }
 
 void VisualServerScene::_render_scene(const Transform p_cam_transform, const CameraMatrix &p_cam_projection, bool p_cam_orthogonal, RID p_force_environment, RID p_scenario, RID p_shadow_atlas, RID p_reflection_probe, int p_reflection_probe_pass) {
@@ -3374,6 +3639,14 @@ void VisualServerScene::update_dirty_instances() {
 
 		_update_dirty_instance(_instance_update_list.first()->self());
 	}
+
+	//apply deferred changes (and pairing) of the spatial partitioning before anything culls
+	while (_scenario_update_list.first()) {
+
+		Scenario *scenario = _scenario_update_list.first()->self();
+		_scenario_update_list.remove(&scenario->update_item);
+		scenario->sps->update();
+	}
 }
 
 bool VisualServerScene::free(RID p_rid) {
@@ -3434,6 +3707,13 @@ VisualServerScene::VisualServerScene() {
 
 	render_pass = 1;
 	singleton = this;
+
+	shadow_pass_count = 0;
+	cull_threads = GLOBAL_DEF("rendering/threads/cull_thread_count", -1);
+	ProjectSettings::get_singleton()->set_custom_property_info("rendering/threads/cull_thread_count", PropertyInfo(Variant::INT, "rendering/threads/cull_thread_count", PROPERTY_HINT_RANGE, "-1,256,1"));
+
+	default_spatial_partitioning = VS::ScenarioSpatialPartitioning(int(GLOBAL_DEF("rendering/quality/spatial_partitioning/type", 0)));
+	ProjectSettings::get_singleton()->set_custom_property_info("rendering/quality/spatial_partitioning/type", PropertyInfo(Variant::INT, "rendering/quality/spatial_partitioning/type", PROPERTY_HINT_ENUM, "Octree,BVH"));
 }
 
 VisualServerScene::~VisualServerScene() {
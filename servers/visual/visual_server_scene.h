@@ -34,6 +34,7 @@
 #include "servers/visual/rasterizer.h"
 
 #include "core/allocators.h"
+#include "core/math/dynamic_bvh.h"
 #include "core/math/geometry.h"
 #include "core/math/octree.h"
 #include "core/os/semaphore.h"
@@ -116,13 +117,80 @@ public:
 
 	struct Instance;
 
+	typedef uint32_t SpatialPartitionID;
+
+	// Spatial index of a scenario, the octree is the default, the BVH is
+	// better when many instances move every frame. Changes may be applied
+	// (and pairs found) only on update(), which must be called before culling.
+	class SpatialPartitioningScene {
+	public:
+		typedef void *(*PairCallback)(void *, SpatialPartitionID, Instance *, int, SpatialPartitionID, Instance *, int);
+		typedef void (*UnpairCallback)(void *, SpatialPartitionID, Instance *, int, SpatialPartitionID, Instance *, int, void *);
+
+		virtual SpatialPartitionID create(Instance *p_userdata, const AABB &p_aabb = AABB(), int p_subindex = 0, bool p_pairable = false, uint32_t p_pairable_type = 0, uint32_t p_pairable_mask = 1) = 0;
+		virtual void erase(SpatialPartitionID p_handle) = 0;
+		virtual void move(SpatialPartitionID p_handle, const AABB &p_aabb) = 0;
+		virtual void set_pairable(SpatialPartitionID p_handle, bool p_pairable = false, uint32_t p_pairable_type = 0, uint32_t p_pairable_mask = 1) = 0;
+		virtual void update() {}
+
+		virtual int cull_convex(const Vector<Plane> &p_convex, Instance **p_result_array, int p_result_max, uint32_t p_mask = 0xFFFFFFFF) = 0;
+		virtual int cull_convex_threaded(const Vector<Plane> &p_convex, Instance **p_result_array, int p_result_max, uint32_t p_mask = 0xFFFFFFFF, int p_max_threads = -1) const = 0;
+		virtual int cull_aabb(const AABB &p_aabb, Instance **p_result_array, int p_result_max, int *p_subindex_array = NULL, uint32_t p_mask = 0xFFFFFFFF) = 0;
+		virtual int cull_segment(const Vector3 &p_from, const Vector3 &p_to, Instance **p_result_array, int p_result_max, int *p_subindex_array = NULL, uint32_t p_mask = 0xFFFFFFFF) = 0;
+
+		virtual void set_pair_callback(PairCallback p_callback, void *p_userdata) = 0;
+		virtual void set_unpair_callback(UnpairCallback p_callback, void *p_userdata) = 0;
+
+		virtual ~SpatialPartitioningScene() {}
+	};
+
+	class SpatialPartitioningScene_Octree : public SpatialPartitioningScene {
+
+		Octree<Instance, true> octree;
+
+	public:
+		virtual SpatialPartitionID create(Instance *p_userdata, const AABB &p_aabb = AABB(), int p_subindex = 0, bool p_pairable = false, uint32_t p_pairable_type = 0, uint32_t p_pairable_mask = 1);
+		virtual void erase(SpatialPartitionID p_handle);
+		virtual void move(SpatialPartitionID p_handle, const AABB &p_aabb);
+		virtual void set_pairable(SpatialPartitionID p_handle, bool p_pairable = false, uint32_t p_pairable_type = 0, uint32_t p_pairable_mask = 1);
+
+		virtual int cull_convex(const Vector<Plane> &p_convex, Instance **p_result_array, int p_result_max, uint32_t p_mask = 0xFFFFFFFF);
+		virtual int cull_convex_threaded(const Vector<Plane> &p_convex, Instance **p_result_array, int p_result_max, uint32_t p_mask = 0xFFFFFFFF, int p_max_threads = -1) const;
+		virtual int cull_aabb(const AABB &p_aabb, Instance **p_result_array, int p_result_max, int *p_subindex_array = NULL, uint32_t p_mask = 0xFFFFFFFF);
+		virtual int cull_segment(const Vector3 &p_from, const Vector3 &p_to, Instance **p_result_array, int p_result_max, int *p_subindex_array = NULL, uint32_t p_mask = 0xFFFFFFFF);
+
+		virtual void set_pair_callback(PairCallback p_callback, void *p_userdata);
+		virtual void set_unpair_callback(UnpairCallback p_callback, void *p_userdata);
+	};
+
+	class SpatialPartitioningScene_BVH : public SpatialPartitioningScene {
+
+		DynamicBVH<Instance> bvh;
+
+	public:
+		virtual SpatialPartitionID create(Instance *p_userdata, const AABB &p_aabb = AABB(), int p_subindex = 0, bool p_pairable = false, uint32_t p_pairable_type = 0, uint32_t p_pairable_mask = 1);
+		virtual void erase(SpatialPartitionID p_handle);
+		virtual void move(SpatialPartitionID p_handle, const AABB &p_aabb);
+		virtual void set_pairable(SpatialPartitionID p_handle, bool p_pairable = false, uint32_t p_pairable_type = 0, uint32_t p_pairable_mask = 1);
+		virtual void update();
+
+		virtual int cull_convex(const Vector<Plane> &p_convex, Instance **p_result_array, int p_result_max, uint32_t p_mask = 0xFFFFFFFF);
+		virtual int cull_convex_threaded(const Vector<Plane> &p_convex, Instance **p_result_array, int p_result_max, uint32_t p_mask = 0xFFFFFFFF, int p_max_threads = -1) const;
+		virtual int cull_aabb(const AABB &p_aabb, Instance **p_result_array, int p_result_max, int *p_subindex_array = NULL, uint32_t p_mask = 0xFFFFFFFF);
+		virtual int cull_segment(const Vector3 &p_from, const Vector3 &p_to, Instance **p_result_array, int p_result_max, int *p_subindex_array = NULL, uint32_t p_mask = 0xFFFFFFFF);
+
+		virtual void set_pair_callback(PairCallback p_callback, void *p_userdata);
+		virtual void set_unpair_callback(UnpairCallback p_callback, void *p_userdata);
+	};
+
 	struct Scenario : RID_Data {
 
 		VS::ScenarioDebugMode debug;
 		RID self;
-		// well wtf, balloon allocator is slower?
 
-		Octree<Instance, true> octree;
+		VS::ScenarioSpatialPartitioning spatial_partitioning;
+		SpatialPartitioningScene *sps;
+		SelfList<Scenario> update_item;
 
 		List<Instance *> directional_lights;
 		RID environment;
@@ -132,13 +200,28 @@ public:
 
 		SelfList<Instance>::List instances;
 
-		Scenario() { debug = VS::SCENARIO_DEBUG_DISABLED; }
+		Scenario() :
+				update_item(this) {
+			debug = VS::SCENARIO_DEBUG_DISABLED;
+			spatial_partitioning = VS::SCENARIO_SPATIAL_PARTITIONING_OCTREE;
+			sps = NULL;
+		}
+
+		~Scenario() {
+			if (sps)
+				memdelete(sps);
+		}
 	};
 
 	mutable RID_Owner<Scenario> scenario_owner;
 
-	static void *_instance_pair(void *p_self, OctreeElementID, Instance *p_A, int, OctreeElementID, Instance *p_B, int);
-	static void _instance_unpair(void *p_self, OctreeElementID, Instance *p_A, int, OctreeElementID, Instance *p_B, int, void *);
+	VS::ScenarioSpatialPartitioning default_spatial_partitioning;
+	SelfList<Scenario>::List _scenario_update_list;
+	void _scenario_queue_update(Scenario *p_scenario);
+	void _scenario_create_spatial_partitioning(Scenario *p_scenario);
+
+	static void *_instance_pair(void *p_self, SpatialPartitionID, Instance *p_A, int, SpatialPartitionID, Instance *p_B, int);
+	static void _instance_unpair(void *p_self, SpatialPartitionID, Instance *p_A, int, SpatialPartitionID, Instance *p_B, int, void *);
 
 	virtual RID scenario_create();
 
@@ -146,6 +229,7 @@ public:
 	virtual void scenario_set_environment(RID p_scenario, RID p_environment);
 	virtual void scenario_set_fallback_environment(RID p_scenario, RID p_environment);
 	virtual void scenario_set_reflection_atlas_size(RID p_scenario, int p_size, int p_subdiv);
+	virtual void scenario_set_spatial_partitioning(RID p_scenario, VS::ScenarioSpatialPartitioning p_type);
 
 	/* INSTANCING API */
 
@@ -158,7 +242,7 @@ public:
 
 		RID self;
 		//scenario stuff
-		OctreeElementID octree_id;
+		SpatialPartitionID spatial_partition_id;
 		Scenario *scenario;
 		SelfList<Instance> scenario_item;
 
@@ -206,7 +290,7 @@ public:
 				scenario_item(this),
 				update_item(this) {
 
-			octree_id = 0;
+			spatial_partition_id = 0;
 			scenario = NULL;
 
 			update_aabb = false;
@@ -436,7 +520,7 @@ public:
 
 	int instance_cull_count;
 	Instance *instance_cull_result[MAX_INSTANCE_CULL];
-	Instance *instance_shadow_cull_result[MAX_INSTANCE_CULL]; //used for generating shadowmaps
+	Vector<Instance *> instance_shadow_cull_result; //used for fitting directional shadow depth ranges
 	Instance *light_cull_result[MAX_LIGHTS_CULLED];
 	RID light_instance_cull_result[MAX_LIGHTS_CULLED];
 	int light_cull_count;
@@ -453,6 +537,7 @@ public:
 	virtual void instance_set_scenario(RID p_instance, RID p_scenario); // from can be mesh, light, poly, area and portal so far.
 	virtual void instance_set_layer_mask(RID p_instance, uint32_t p_mask);
 	virtual void instance_set_transform(RID p_instance, const Transform &p_transform);
+	virtual void instances_set_transform(const Vector<RID> &p_instances, const Vector<Transform> &p_transforms);
 	virtual void instance_attach_object_instance_id(RID p_instance, ObjectID p_ID);
 	virtual void instance_set_blend_shape_weight(RID p_instance, int p_shape, float p_weight);
 	virtual void instance_set_surface_material(RID p_instance, int p_surface, RID p_material);
@@ -483,6 +568,44 @@ public:
 	_FORCE_INLINE_ void _update_dirty_instance(Instance *p_instance);
 	_FORCE_INLINE_ void _update_instance_lightmap_captures(Instance *p_instance);
 
+	// Shadow passes are set up first, then all of them are culled (concurrently
+	// when threaded culling is enabled), then rendered in the order they were added.
+	struct ShadowPass {
+
+		RID light_instance;
+		int pass;
+		Vector<Plane> planes; //empty if only the shadow transform is set
+		Plane near_plane;
+
+		CameraMatrix projection;
+		Transform transform;
+		float far;
+		float split;
+		float bias_scale;
+
+		// directional splits extend their depth range to the casters found
+		bool fit_depth_range;
+		Vector3 z_vec;
+		float z_min;
+		float z_max;
+		float half_x;
+		float half_y;
+
+		Vector<Instance *> cull_result; //kept between frames, only grows
+		int cull_count;
+	};
+
+	Vector<ShadowPass> shadow_passes;
+	int shadow_pass_count;
+	int cull_threads;
+
+	_FORCE_INLINE_ bool _is_cull_threaded() const;
+	int _cull_convex(Scenario *p_scenario, const Vector<Plane> &p_planes, Instance **r_result, int p_result_max, uint32_t p_mask = 0xFFFFFFFF);
+	int _cull_shadow_casters(Scenario *p_scenario, const Vector<Plane> &p_planes, Vector<Instance *> &r_result);
+	ShadowPass &_add_shadow_pass(RID p_light_instance, int p_pass, const Plane &p_near_plane);
+	void _cull_shadow_pass(uint32_t p_index, Scenario *p_scenario);
+	void _render_shadow_passes(RID p_shadow_atlas, Scenario *p_scenario);
+
 	_FORCE_INLINE_ void _light_instance_update_shadow(Instance *p_instance, const Transform p_cam_transform, const CameraMatrix &p_cam_projection, bool p_cam_orthogonal, RID p_shadow_atlas, Scenario *p_scenario);
 
 	void _prepare_scene(const Transform p_cam_transform, const CameraMatrix &p_cam_projection, bool p_cam_orthogonal, RID p_force_environment, uint32_t p_visible_layers, RID p_scenario, RID p_shadow_atlas, RID p_reflection_probe);
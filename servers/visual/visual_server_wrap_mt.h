@@ -55,6 +55,7 @@ class VisualServerWrapMT : public VisualServer {
 	bool create_thread;
 
 	uint64_t draw_pending;
+	uint32_t frame_stall_usec;
 	void thread_draw(bool p_swap_buffers, double frame_step);
 	void thread_flush();
 
@@ -446,6 +447,7 @@ public:
 	FUNC2(scenario_set_environment, RID, RID)
 	FUNC3(scenario_set_reflection_atlas_size, RID, int, int)
 	FUNC2(scenario_set_fallback_environment, RID, RID)
+	FUNC2(scenario_set_spatial_partitioning, RID, ScenarioSpatialPartitioning)
 
 	/* INSTANCING API */
 	// from can be mesh, light,  area and portal so far.
@@ -455,6 +457,7 @@ public:
 	FUNC2(instance_set_scenario, RID, RID) // from can be mesh, light, poly, area and portal so far.
 	FUNC2(instance_set_layer_mask, RID, uint32_t)
 	FUNC2(instance_set_transform, RID, const Transform &)
+	FUNC2(instances_set_transform, const Vector<RID> &, const Vector<Transform> &)
 	FUNC2(instance_attach_object_instance_id, RID, ObjectID)
 	FUNC3(instance_set_blend_shape_weight, RID, int, float)
 	FUNC3(instance_set_surface_material, RID, int, RID)
@@ -592,7 +595,11 @@ public:
 
 	//this passes directly to avoid stalling
 	virtual int get_render_info(RenderInfo p_info) {
-		return visual_server->get_render_info(p_info);
+		switch (p_info) {
+			case INFO_COMMAND_QUEUE_DEPTH: return command_queue.get_pending_count();
+			case INFO_COMMAND_QUEUE_STALL_TIME: return frame_stall_usec;
+			default: return visual_server->get_render_info(p_info);
+		}
 	}
 
 	FUNC3(set_boot_image, const Ref<Image> &, const Color &, bool)